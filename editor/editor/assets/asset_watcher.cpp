@@ -1,8 +1,10 @@
 #include "asset_watcher.h"
 #include <engine/animation/animation.h>
 #include <engine/assets/asset_manager.h>
+#include <engine/assets/impl/asset_cache.h>
 #include <engine/assets/impl/asset_compiler.h>
 #include <engine/assets/impl/asset_extensions.h>
+#include <engine/assets/impl/importers/mesh_importer.h>
 #include <engine/audio/audio_clip.h>
 #include <engine/ecs/ecs.h>
 #include <engine/ecs/prefab.h>
@@ -15,6 +17,7 @@
 #include <engine/scripting/ecs/systems/script_system.h>
 
 #include <engine/meta/assets/asset_database.hpp>
+#include <engine/meta/ecs/entity.hpp>
 #include <engine/threading/threader.h>
 
 #include <editor/editing/thumbnail_manager.h>
@@ -32,70 +35,10 @@ namespace
 {
 using namespace std::literals;
 
-void resolve_includes(const fs::path& filePath, std::set<fs::path>& processedFiles)
-{
-    if(!processedFiles.insert(filePath).second)
-    {
-        return; // Avoid processing the same file multiple times
-    }
-
-    std::ifstream file(filePath);
-    if(!file.is_open())
-    {
-        // std::cerr << "Failed to open file: " << filePath << '\n';
-        return;
-    }
-
-    const std::string includeKeyword = "#include";
-    const std::string bgfxIncludePath = "/path/to/bgfx/include"; // Assuming bgfx include path is known
-
-    std::string line;
-    while(std::getline(file, line))
-    {
-        // Trim leading whitespace
-        line.erase(0, line.find_first_not_of(" \t"));
-
-        // Check for #include directive
-        if(line.compare(0, includeKeyword.length(), includeKeyword) == 0)
-        {
-            // Find the start and end of the include path
-            size_t start = line.find_first_of("\"<") + 1;
-            size_t end = line.find_last_of("\">");
-
-            if(start == std::string::npos || end == std::string::npos || start >= end)
-            {
-                // std::cerr << "Invalid include directive: " << line << '\n';
-                continue;
-            }
-
-            std::string includePath = line.substr(start, end - start);
-            fs::path resolvedPath;
-
-            if(line[start - 1] == '<' && line[end] == '>')
-            {
-                // Resolve system include path (e.g., bgfx_shader.sh)
-                // resolvedPath = fs::path(bgfxIncludePath) / includePath;
-                continue;
-            }
-            else
-            {
-                // Resolve local include path relative to the current file
-                resolvedPath = filePath.parent_path() / includePath;
-            }
-
-            resolvedPath = fs::absolute(resolvedPath);
-            // std::cout << "Resolved include: " << resolvedPath << '\n';
-
-            // Recurse into the included file
-            resolve_includes(resolvedPath, processedFiles);
-        }
-    }
-}
-
 auto has_depencency(const fs::path& file, const fs::path& dep_to_check) -> bool
 {
     std::set<fs::path> dependecies;
-    resolve_includes(file, dependecies);
+    resolve_includes(file, {fs::resolve_protocol("engine:/data/shaders")}, dependecies);
 
     return dependecies.contains(dep_to_check);
 }
@@ -141,6 +84,80 @@ auto get_meta_key(const fs::path& path) -> std::string
     return key + ".meta";
 }
 
+template<typename T>
+auto get_import_category() -> import_scheduler::category
+{
+    if constexpr(std::is_same<T, gfx::texture>::value)
+    {
+        return import_scheduler::category::texture;
+    }
+    else if constexpr(std::is_same<T, gfx::shader>::value)
+    {
+        return import_scheduler::category::shader;
+    }
+    else if constexpr(std::is_same<T, mesh>::value)
+    {
+        return import_scheduler::category::mesh;
+    }
+    else
+    {
+        return import_scheduler::category::copy;
+    }
+}
+
+template<typename T>
+auto get_import_dependencies(const fs::path& source) -> std::vector<fs::path>
+{
+    std::vector<fs::path> dependencies;
+
+    if constexpr(std::is_same<T, gfx::shader>::value)
+    {
+        std::set<fs::path> includes;
+        resolve_includes(source, {fs::resolve_protocol("engine:/data/shaders")}, includes);
+        dependencies.assign(includes.begin(), includes.end());
+    }
+    else if constexpr(std::is_same<T, mesh>::value)
+    {
+        // Imported materials reference textures next to the model, compile those first.
+        dependencies = importer::get_referenced_textures(source);
+    }
+
+    return dependencies;
+}
+
+// Outputs that exist are skipped on the initial listing, unless they can no longer be loaded.
+template<typename T>
+auto is_compiled_stale(const fs::path& output) -> bool
+{
+    if constexpr(std::is_same<T, prefab>::value)
+    {
+        std::ifstream stream(output, std::ios::binary);
+        prefab_template templ;
+        load_from_stream_bin(stream, templ);
+        return is_stale(templ);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename T>
+void schedule_compile(asset_manager& am, import_scheduler& scheduler, const fs::path& ref_path, const fs::path& output)
+{
+    import_scheduler::job_desc job;
+    job.source = fs::resolve_protocol(get_asset_key(output));
+    job.output = output;
+    job.type = get_import_category<T>();
+    job.dependencies = get_import_dependencies<T>(job.source);
+    job.task = [&am, ref_path, output]()
+    {
+        return asset_compiler::compile<T>(am, ref_path, output);
+    };
+
+    scheduler.submit(std::move(job));
+}
+
 template<typename T>
 auto watch_assets(rtti::context& ctx, const fs::path& dir, const fs::path& wildcard, bool reload_async) -> uint64_t
 {
@@ -290,31 +307,25 @@ static void add_to_syncer(rtti::context& ctx,
                           const fs::syncer::on_entry_removed_t& on_removed,
                           const fs::syncer::on_entry_renamed_t& on_renamed)
 {
-    auto& ts = ctx.get_cached<threader>();
     auto& am = ctx.get_cached<asset_manager>();
+    auto& scheduler = ctx.get_cached<asset_watcher>().get_scheduler();
 
-    auto on_modified =
-        [&ts, &am](const std::string& ext, const auto& ref_path, const auto& synced_paths, bool is_initial_listing)
+    auto on_modified = [&am, &scheduler](const std::string& ext,
+                                         const auto& ref_path,
+                                         const auto& synced_paths,
+                                         bool is_initial_listing)
     {
         auto paths = remove_meta_tag(synced_paths);
 
         for(const auto& output : paths)
         {
             fs::error_code err;
-            if(is_initial_listing && fs::exists(output, err))
+            if(is_initial_listing && fs::exists(output, err) && !is_compiled_stale<T>(output))
             {
                 continue;
             }
-            auto task = ts.pool->schedule(
-                [&am, ref_path, output]()
-                {
-                    asset_compiler::compile<T>(am, ref_path, output);
-                });
 
-            //        if(is_initial_listing)
-            //        {
-            //            task.wait();
-            //        }
+            schedule_compile<T>(am, scheduler, ref_path, output);
         }
     };
 
@@ -340,11 +351,13 @@ void add_to_syncer<gfx::shader>(rtti::context& ctx,
                                 const fs::syncer::on_entry_removed_t& on_removed,
                                 const fs::syncer::on_entry_renamed_t& on_renamed)
 {
-    auto& ts = ctx.get_cached<threader>();
     auto& am = ctx.get_cached<asset_manager>();
+    auto& scheduler = ctx.get_cached<asset_watcher>().get_scheduler();
 
-    auto on_modified =
-        [&ts, &am](const std::string& ext, const auto& ref_path, const auto& synced_paths, bool is_initial_listing)
+    auto on_modified = [&am, &scheduler](const std::string& ext,
+                                         const auto& ref_path,
+                                         const auto& synced_paths,
+                                         bool is_initial_listing)
     {
         auto paths = remove_meta_tag(synced_paths);
         if(paths.empty())
@@ -369,15 +382,7 @@ void add_to_syncer<gfx::shader>(rtti::context& ctx,
                 continue;
             }
 
-            auto task = ts.pool->schedule(
-                [&am, ref_path, output]()
-                {
-                    asset_compiler::compile<gfx::shader>(am, ref_path, output);
-                });
-            //        if(is_initial_listing)
-            //        {
-            //            task.wait();
-            //        }
+            schedule_compile<gfx::shader>(am, scheduler, ref_path, output);
         }
     };
 
@@ -549,10 +554,15 @@ void asset_watcher::setup_cache_syncer(rtti::context& ctx,
     add_to_syncer<audio_clip>(ctx, syncer, on_removed, on_renamed);
     add_to_syncer<script>(ctx, syncer, on_removed, on_renamed);
 
+    // Collect the whole listing first so the scheduler can order it by dependencies.
+    scheduler_.begin_batch();
     syncer.sync(meta_dir, cache_dir);
+    scheduler_.end_batch();
 
     if(wait)
     {
+        scheduler_.wait();
+
         auto& ts = ctx.get_cached<threader>();
         ts.pool->wait_all();
     }
@@ -606,6 +616,9 @@ auto asset_watcher::init(rtti::context& ctx) -> bool
     auto& ev = ctx.get_cached<events>();
     ev.on_os_event.connect(sentinel_, 1000, this, &asset_watcher::on_os_event);
 
+    auto& ts = ctx.get_cached<threader>();
+    scheduler_.init(*ts.pool);
+
     watch_assets(ctx, "engine:/", true);
 
     return true;
@@ -616,6 +629,7 @@ auto asset_watcher::deinit(rtti::context& ctx) -> bool
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
     unwatch_assets(ctx, "engine:/");
+    scheduler_.deinit();
     return true;
 }
 
@@ -642,6 +656,11 @@ void asset_watcher::watch_assets(rtti::context& ctx, const std::string& protocol
                        wait);
 }
 
+auto asset_watcher::get_scheduler() -> import_scheduler&
+{
+    return scheduler_;
+}
+
 void asset_watcher::unwatch_assets(rtti::context& ctx, const std::string& protocol)
 {
     auto& w = watched_protocols_[protocol];
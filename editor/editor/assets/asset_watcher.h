@@ -1,4 +1,6 @@
 #pragma once
+#include "import_scheduler.h"
+
 #include <context/context.hpp>
 #include <filesystem/syncer.h>
 #include <ospp/event.h>
@@ -20,6 +22,8 @@ public:
     void watch_assets(rtti::context& ctx, const std::string& protocol, bool wait = false);
     void unwatch_assets(rtti::context& ctx, const std::string& protocol);
 
+    auto get_scheduler() -> import_scheduler&;
+
 private:
     void on_os_event(rtti::context& ctx, os::event& e);
 
@@ -46,6 +50,6 @@ private:
 
     std::map<std::string, watched> watched_protocols_{};
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
-
+    import_scheduler scheduler_;
 };
 } // namespace ace
@@ -0,0 +1,576 @@
+#include "import_scheduler.h"
+
+#include <logging/logging.h>
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <unordered_set>
+
+namespace ace
+{
+namespace
+{
+
+auto to_key(const fs::path& path) -> std::string
+{
+    return path.lexically_normal().generic_string();
+}
+
+auto to_ms(import_scheduler::clock_t::duration d) -> double
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+void write_json_string(std::ofstream& out, const std::string& str)
+{
+    out << '"';
+    for(char c : str)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+auto get_default_report_path() -> fs::path
+{
+    fs::error_code err;
+    return fs::temp_directory_path(err) / "ace" / "import_report.json";
+}
+
+// Called from the main thread. Jobs may hand work to it and wait, e.g. prefab compilation,
+// so its queued tasks keep being processed.
+template<typename Predicate>
+void wait_processing(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, Predicate&& pred)
+{
+    while(!cv.wait_for(lock, std::chrono::milliseconds(1), pred))
+    {
+        lock.unlock();
+        tpp::this_thread::process();
+        lock.lock();
+    }
+}
+
+} // namespace
+
+import_scheduler::import_scheduler() : report_path_(get_default_report_path())
+{
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // Assimp imports hold whole scenes in memory, the compiler subprocesses each keep a core busy
+    // and copies mostly wait on the disk.
+    limits_[size_t(category::texture)] = std::max<size_t>(1, cores / 2);
+    limits_[size_t(category::shader)] = std::max<size_t>(1, cores / 2);
+    limits_[size_t(category::mesh)] = std::max<size_t>(1, cores / 4);
+    limits_[size_t(category::copy)] = cores * 2;
+}
+
+import_scheduler::~import_scheduler()
+{
+    deinit();
+}
+
+void import_scheduler::init(tpp::thread_pool& pool)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    pool_ = &pool;
+    dispatch(lock);
+}
+
+void import_scheduler::deinit()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for(auto it = jobs_.begin(); it != jobs_.end();)
+    {
+        if(it->second.started)
+        {
+            ++it;
+            continue;
+        }
+
+        unfinished_[size_t(it->second.desc.type)]--;
+        it = jobs_.erase(it);
+    }
+
+    for(auto& queue : ready_)
+    {
+        queue.clear();
+    }
+    by_source_.clear();
+    by_dependency_.clear();
+    by_output_.clear();
+
+    wait_processing(idle_,
+                    lock,
+                    [this]()
+                    {
+                        return jobs_.empty();
+                    });
+
+    pool_ = nullptr;
+}
+
+void import_scheduler::submit(job_desc desc)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto output_key = to_key(desc.output);
+    uint64_t running_same_output = 0;
+
+    auto existing = by_output_.find(output_key);
+    if(existing != by_output_.end())
+    {
+        auto& other = jobs_.at(existing->second);
+        if(!other.started)
+        {
+            // It has not read its source yet, so it will compile the latest content anyway.
+            return;
+        }
+        running_same_output = existing->second;
+    }
+
+    if(jobs_.empty())
+    {
+        started_ = clock_t::now();
+        total_ = 0;
+        completed_ = 0;
+        failed_ = 0;
+        records_.clear();
+        total_ms_ = {};
+        samples_ = {};
+    }
+
+    const auto id = next_id_++;
+    auto& j = jobs_[id];
+    j.source_key = to_key(desc.source);
+    j.output_key = output_key;
+    j.queued = clock_t::now();
+    for(const auto& dependency : desc.dependencies)
+    {
+        auto key = to_key(dependency);
+        if(key != j.source_key)
+        {
+            j.dependency_keys.emplace_back(std::move(key));
+        }
+    }
+    j.desc = std::move(desc);
+
+    total_++;
+    unfinished_[size_t(j.desc.type)]++;
+
+    if(running_same_output)
+    {
+        add_edge(running_same_output, id);
+    }
+
+    // Wait for unfinished jobs compiling what this one depends on.
+    for(const auto& key : j.dependency_keys)
+    {
+        auto range = by_source_.equal_range(key);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            add_edge(it->second, id);
+        }
+    }
+
+    // Queued jobs that depend on this source wait for it too, unless they already lead back to this
+    // job through a chain of dependencies, which would close a cycle.
+    auto range = by_dependency_.equal_range(j.source_key);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        auto& dependent = jobs_.at(it->second);
+        if(dependent.started)
+        {
+            continue;
+        }
+
+        const auto& ours = j.dependents;
+        bool is_linked = std::find(ours.begin(), ours.end(), it->second) != ours.end();
+        if(!is_linked && !reaches(it->second, id))
+        {
+            remove_ready(it->second);
+            add_edge(id, it->second);
+        }
+    }
+
+    by_source_.emplace(j.source_key, id);
+    by_output_[output_key] = id;
+    for(const auto& key : j.dependency_keys)
+    {
+        by_dependency_.emplace(key, id);
+    }
+
+    if(j.waiting_on == 0)
+    {
+        make_ready(id);
+    }
+
+    dispatch(lock);
+}
+
+void import_scheduler::begin_batch()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch_depth_++;
+}
+
+void import_scheduler::end_batch()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(batch_depth_ > 0)
+    {
+        batch_depth_--;
+    }
+    dispatch(lock);
+}
+
+void import_scheduler::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    wait_processing(idle_,
+                    lock,
+                    [this]()
+                    {
+                        return jobs_.empty() || batch_depth_ > 0;
+                    });
+}
+
+void import_scheduler::set_limit(category type, size_t limit)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    limits_[size_t(type)] = std::max<size_t>(1, limit);
+    dispatch(lock);
+}
+
+auto import_scheduler::get_limit(category type) const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_[size_t(type)];
+}
+
+void import_scheduler::set_report_path(const fs::path& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_path_ = path;
+}
+
+auto import_scheduler::get_report_path() const -> fs::path
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return report_path_;
+}
+
+auto import_scheduler::get_progress() const -> progress
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    progress result;
+    result.total = total_;
+    result.completed = completed_;
+    result.failed = failed_;
+    result.current = current_;
+    for(auto count : running_)
+    {
+        result.running += count;
+    }
+
+    double all_ms = 0.0;
+    size_t all_samples = 0;
+    for(size_t i = 0; i < category_count; ++i)
+    {
+        all_ms += total_ms_[i];
+        all_samples += samples_[i];
+    }
+
+    if(all_samples == 0)
+    {
+        return result;
+    }
+
+    // Categories run side by side, so the slowest one decides when the batch is done.
+    double eta_ms = 0.0;
+    for(size_t i = 0; i < category_count; ++i)
+    {
+        double average = samples_[i] > 0 ? total_ms_[i] / double(samples_[i]) : all_ms / double(all_samples);
+        eta_ms = std::max(eta_ms, average * double(unfinished_[i]) / double(limits_[i]));
+    }
+
+    result.eta = std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double, std::milli>(eta_ms));
+    return result;
+}
+
+auto import_scheduler::to_string(category type) -> const char*
+{
+    switch(type)
+    {
+        case category::texture:
+            return "texture";
+        case category::shader:
+            return "shader";
+        case category::mesh:
+            return "mesh";
+        case category::copy:
+            return "copy";
+        default:
+            return "unknown";
+    }
+}
+
+void import_scheduler::add_edge(uint64_t from, uint64_t to)
+{
+    jobs_.at(from).dependents.emplace_back(to);
+    jobs_.at(to).waiting_on++;
+}
+
+auto import_scheduler::reaches(uint64_t from, uint64_t to) const -> bool
+{
+    std::vector<uint64_t> stack{from};
+    std::unordered_set<uint64_t> visited{from};
+    while(!stack.empty())
+    {
+        auto id = stack.back();
+        stack.pop_back();
+        if(id == to)
+        {
+            return true;
+        }
+
+        auto found = jobs_.find(id);
+        if(found == jobs_.end())
+        {
+            continue;
+        }
+
+        for(auto dependent : found->second.dependents)
+        {
+            if(visited.emplace(dependent).second)
+            {
+                stack.emplace_back(dependent);
+            }
+        }
+    }
+
+    return false;
+}
+
+void import_scheduler::make_ready(uint64_t id)
+{
+    const auto& j = jobs_.at(id);
+    ready_[size_t(j.desc.type)].emplace_back(id);
+}
+
+void import_scheduler::remove_ready(uint64_t id)
+{
+    const auto& j = jobs_.at(id);
+    auto& queue = ready_[size_t(j.desc.type)];
+    queue.erase(std::remove(queue.begin(), queue.end(), id), queue.end());
+}
+
+void import_scheduler::dispatch(std::unique_lock<std::mutex>& lock)
+{
+    if(batch_depth_ > 0 || !pool_)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> to_run;
+    for(size_t i = 0; i < category_count; ++i)
+    {
+        auto& queue = ready_[i];
+        while(!queue.empty() && running_[i] < limits_[i])
+        {
+            auto id = queue.front();
+            queue.pop_front();
+
+            auto& j = jobs_.at(id);
+            j.started = true;
+            running_[i]++;
+            current_ = j.desc.source.filename().string();
+
+            to_run.emplace_back(id);
+        }
+    }
+
+    auto* pool = pool_;
+    lock.unlock();
+
+    for(auto id : to_run)
+    {
+        pool->schedule(
+            [this, id]()
+            {
+                run(id);
+            });
+    }
+
+    lock.lock();
+}
+
+void import_scheduler::run(uint64_t id)
+{
+    std::function<bool()> task;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task = jobs_.at(id).desc.task;
+    }
+
+    auto start = clock_t::now();
+    bool ok = task ? task() : false;
+    auto end = clock_t::now();
+
+    finish(id, ok, start, end);
+}
+
+void import_scheduler::finish(uint64_t id, bool ok, clock_t::time_point start, clock_t::time_point end)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto it = jobs_.find(id);
+    auto& j = it->second;
+    const auto type = size_t(j.desc.type);
+
+    record r;
+    r.source = j.desc.source.string();
+    r.output = j.desc.output.string();
+    r.type = j.desc.type;
+    r.wait_ms = to_ms(start - j.queued);
+    r.duration_ms = to_ms(end - start);
+    r.ok = ok;
+
+    if(!ok)
+    {
+        failed_++;
+    }
+    completed_++;
+    running_[type]--;
+    unfinished_[type]--;
+    total_ms_[type] += r.duration_ms;
+    samples_[type]++;
+    records_.emplace_back(std::move(r));
+
+    for(auto dependent : j.dependents)
+    {
+        auto found = jobs_.find(dependent);
+        if(found != jobs_.end() && --found->second.waiting_on == 0)
+        {
+            make_ready(dependent);
+        }
+    }
+
+    auto erase_from = [id](auto& map, const std::string& key)
+    {
+        auto range = map.equal_range(key);
+        for(auto entry = range.first; entry != range.second; ++entry)
+        {
+            if(entry->second == id)
+            {
+                map.erase(entry);
+                return;
+            }
+        }
+    };
+
+    erase_from(by_source_, j.source_key);
+    for(const auto& key : j.dependency_keys)
+    {
+        erase_from(by_dependency_, key);
+    }
+    auto output = by_output_.find(j.output_key);
+    if(output != by_output_.end() && output->second == id)
+    {
+        by_output_.erase(output);
+    }
+
+    jobs_.erase(it);
+
+    if(!jobs_.empty())
+    {
+        dispatch(lock);
+        return;
+    }
+
+    auto records = std::move(records_);
+    auto elapsed = end - started_;
+    records_.clear();
+    lock.unlock();
+
+    write_report(records, elapsed);
+
+    lock.lock();
+    idle_.notify_all();
+}
+
+void import_scheduler::write_report(const std::vector<record>& records, clock_t::duration elapsed) const
+{
+    auto path = get_report_path();
+
+    fs::error_code err;
+    fs::create_directories(path.parent_path(), err);
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if(!out.is_open())
+    {
+        APPLOG_ERROR("Failed to write import report to {}", path.string());
+        return;
+    }
+
+    std::array<double, category_count> category_ms{};
+    std::array<size_t, category_count> category_jobs{};
+    size_t failed = 0;
+    for(const auto& r : records)
+    {
+        category_ms[size_t(r.type)] += r.duration_ms;
+        category_jobs[size_t(r.type)]++;
+        failed += r.ok ? 0 : 1;
+    }
+
+    // Slowest first, that is what the report is read for.
+    std::vector<const record*> sorted;
+    sorted.reserve(records.size());
+    for(const auto& r : records)
+    {
+        sorted.emplace_back(&r);
+    }
+    std::sort(sorted.begin(),
+              sorted.end(),
+              [](const record* lhs, const record* rhs)
+              {
+                  return lhs->duration_ms > rhs->duration_ms;
+              });
+
+    out << "{\"elapsed_ms\":" << to_ms(elapsed) << ",\"jobs\":" << records.size() << ",\"failed\":" << failed;
+
+    out << ",\"categories\":{";
+    for(size_t i = 0; i < category_count; ++i)
+    {
+        out << (i > 0 ? "," : "") << '"' << to_string(category(i)) << "\":{\"jobs\":" << category_jobs[i]
+            << ",\"total_ms\":" << category_ms[i] << ",\"limit\":" << get_limit(category(i)) << "}";
+    }
+    out << "}";
+
+    out << ",\"assets\":[";
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        const auto& r = *sorted[i];
+        out << (i > 0 ? ",\n" : "\n") << "{\"source\":";
+        write_json_string(out, r.source);
+        out << ",\"output\":";
+        write_json_string(out, r.output);
+        out << ",\"category\":\"" << to_string(r.type) << "\",\"wait_ms\":" << r.wait_ms
+            << ",\"duration_ms\":" << r.duration_ms << ",\"ok\":" << (r.ok ? "true" : "false") << "}";
+    }
+    out << "]}\n";
+
+    APPLOG_INFO("Imported {} assets in {:.2f}s ({} failed), timing report {}",
+                records.size(),
+                to_ms(elapsed) / 1000.0,
+                failed,
+                path.string());
+}
+
+} // namespace ace
@@ -0,0 +1,165 @@
+#pragma once
+#include <filesystem/filesystem.h>
+#include <threadpp/thread_pool.h>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class import_scheduler
+ * @brief Runs asset compiles as a dependency graph with bounded parallelism.
+ *
+ * Every job names its source file and the source files it depends on. A job only starts once
+ * all unfinished jobs for its dependencies are done, e.g. a mesh waits for the textures its
+ * materials reference. Each compiler category has its own concurrency limit, so a burst of
+ * assimp imports can not starve the cheap copies. When the scheduler runs out of work it
+ * writes a timing report of the finished batch.
+ */
+class import_scheduler
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    enum class category : uint8_t
+    {
+        texture, ///< texturec subprocess
+        shader,  ///< shaderc subprocess
+        mesh,    ///< in process assimp import, CPU and memory heavy
+        copy,    ///< serialization and copies, mostly I/O
+        count
+    };
+
+    struct job_desc
+    {
+        fs::path source;                    ///< Absolute path of the file being compiled.
+        fs::path output;                    ///< Absolute path of the compiled artifact.
+        category type{category::copy};      ///< Selects the concurrency limit.
+        std::vector<fs::path> dependencies; ///< Absolute paths of sources that must compile first.
+        std::function<bool()> task;         ///< The compile, returns false on failure.
+    };
+
+    struct progress
+    {
+        size_t total{};          ///< Jobs submitted since the scheduler was last idle.
+        size_t completed{};      ///< Finished jobs, including failed ones.
+        size_t failed{};         ///< Jobs whose compile returned false.
+        size_t running{};        ///< Jobs currently executing.
+        clock_t::duration eta{}; ///< Estimated time until all submitted jobs are done.
+        std::string current;     ///< File name of the most recently started job.
+    };
+
+    import_scheduler();
+    ~import_scheduler();
+
+    void init(tpp::thread_pool& pool);
+
+    /**
+     * @brief Cancels jobs that have not started and waits for the running ones, like wait().
+     */
+    void deinit();
+
+    /**
+     * @brief Queues a compile. A job for an output that is queued and not started yet is
+     * coalesced with it, a job for an output that is compiling runs after it.
+     */
+    void submit(job_desc desc);
+
+    /**
+     * @brief Holds back dispatch until the matching end_batch, so jobs submitted together are
+     * ordered by their dependencies regardless of submission order. Batches nest.
+     */
+    void begin_batch();
+    void end_batch();
+
+    /**
+     * @brief Blocks until all submitted jobs are done, processing main thread tasks meanwhile.
+     */
+    void wait();
+
+    void set_limit(category type, size_t limit);
+    auto get_limit(category type) const -> size_t;
+
+    /**
+     * @brief Sets where the timing report is written. Defaults to a file in the temp directory.
+     */
+    void set_report_path(const fs::path& path);
+    auto get_report_path() const -> fs::path;
+
+    auto get_progress() const -> progress;
+
+    static auto to_string(category type) -> const char*;
+
+private:
+    struct job
+    {
+        job_desc desc;
+        std::string source_key;
+        std::string output_key;
+        std::vector<std::string> dependency_keys;
+        std::vector<uint64_t> dependents;
+        size_t waiting_on{};
+        bool started{};
+        clock_t::time_point queued{};
+    };
+
+    struct record
+    {
+        std::string source;
+        std::string output;
+        category type{};
+        double wait_ms{};
+        double duration_ms{};
+        bool ok{};
+    };
+
+    static constexpr size_t category_count = size_t(category::count);
+
+    void add_edge(uint64_t from, uint64_t to);
+    /// Whether the job to waits on from, directly or through other jobs. An edge back would close a cycle.
+    auto reaches(uint64_t from, uint64_t to) const -> bool;
+    void make_ready(uint64_t id);
+    void remove_ready(uint64_t id);
+    void dispatch(std::unique_lock<std::mutex>& lock);
+    void run(uint64_t id);
+    void finish(uint64_t id, bool ok, clock_t::time_point start, clock_t::time_point end);
+    void write_report(const std::vector<record>& records, clock_t::duration elapsed) const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+    tpp::thread_pool* pool_{};
+
+    uint64_t next_id_{1};
+    std::unordered_map<uint64_t, job> jobs_;
+    std::unordered_multimap<std::string, uint64_t> by_source_;
+    std::unordered_multimap<std::string, uint64_t> by_dependency_;
+    std::unordered_map<std::string, uint64_t> by_output_;
+
+    std::array<std::deque<uint64_t>, category_count> ready_{};
+    std::array<size_t, category_count> running_{};
+    std::array<size_t, category_count> limits_{};
+    std::array<size_t, category_count> unfinished_{};
+    std::array<double, category_count> total_ms_{};
+    std::array<size_t, category_count> samples_{};
+    size_t batch_depth_{};
+
+    size_t total_{};
+    size_t completed_{};
+    size_t failed_{};
+    std::string current_;
+    clock_t::time_point started_{};
+    std::vector<record> records_;
+    fs::path report_path_;
+};
+
+} // namespace ace
@@ -11,6 +11,7 @@ struct deploy_settings
     fs::path deploy_location{};
     bool deploy_dependencies{true};
     bool deploy_and_run{};
+    bool compress_data{true};
 };
 
 
@@ -6,6 +6,8 @@
 #include <engine/scripting/ecs/systems/script_system.h>
 #include <imgui_widgets/gizmo.h>
 
+#include <chrono>
+
 namespace ace
 {
 
@@ -82,10 +84,13 @@ void editing_manager::save_checkpoint(rtti::context& ctx)
 
     unselect();
 
-    scene_cache_ = {};
     scene_cache_source_ = scn.source;
-    // first save scene
-    save_to_stream(scene_cache_, scn);
+
+    const auto start = std::chrono::steady_clock::now();
+    save_to_snapshot(scn, scene_cache_);
+    const auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    APPLOG_INFO("Scene checkpoint of {} entities saved in {:.2f} ms", scene_cache_.entities.size(), duration.count());
 }
 
 void editing_manager::load_checkpoint(rtti::context& ctx, bool recover_selection)
@@ -93,11 +98,15 @@ void editing_manager::load_checkpoint(rtti::context& ctx, bool recover_selection
     auto& ec = ctx.get_cached<ecs>();
     auto& scn = ec.get_scene();
 
-    // clear scene
-    scn.unload();
+    // Only what was added or removed since the checkpoint is recreated,
+    // components owning script objects are always loaded again with the new domain.
+    const auto start = std::chrono::steady_clock::now();
+    load_from_snapshot(scene_cache_, scn, scene_snapshot::restore_mode::changed);
+    const auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
 
-    // recover scene with the new domain
-    load_from_stream(scene_cache_, scn);
+    APPLOG_INFO("Scene checkpoint of {} entities restored in {:.2f} ms",
+                scene_cache_.entities.size(),
+                duration.count());
 
     scn.source = scene_cache_source_;
 
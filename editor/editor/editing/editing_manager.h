@@ -7,6 +7,7 @@
 #include <rttr/variant.h>
 
 #include <engine/ecs/components/transform_component.h>
+#include <engine/meta/ecs/entity.hpp>
 #include <engine/rendering/ecs/components/camera_component.h>
 
 #include <editor/imgui/integration/imgui.h>
@@ -171,7 +172,7 @@ private:
 
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 
-    std::stringstream scene_cache_;
+    scene_snapshot scene_cache_;
     asset_handle<scene_prefab> scene_cache_source_;
 
 };
@@ -15,6 +15,7 @@
 #include <editor/system/project_manager.h>
 
 #include <filedialog/filedialog.h>
+#include <filesystem/archive.h>
 #include <filesystem/filesystem.h>
 #include <subprocess/subprocess.hpp>
 
@@ -716,6 +717,50 @@ auto get_dependencies(const fs::path& file) -> std::vector<std::string>
     return parse_dependencies(result.out_output, parent_path);
 }
 
+void deploy_compiled_data(const fs::path& compiled_dir, const fs::path& data_dir, bool compress)
+{
+    fs::path loose_dir = data_dir / "compiled";
+    fs::path archive_path = data_dir / "compiled.pak";
+
+    fs::error_code ec;
+    APPLOG_TRACE("Clearing {}", loose_dir.string());
+    fs::remove_all(loose_dir, ec);
+    fs::create_directories(loose_dir, ec);
+
+    // Sorted, so the same data always produces the same archive.
+    std::map<std::string, fs::path> files;
+    for(const auto& entry : fs::recursive_directory_iterator(compiled_dir, ec))
+    {
+        if(entry.is_regular_file(ec))
+        {
+            files.emplace(entry.path().lexically_relative(compiled_dir).generic_string(), entry.path());
+        }
+    }
+
+    // Compiled assets go into the archive, anything else, e.g. the script assemblies, stays loose.
+    fs::archive_writer writer;
+    auto compression = compress ? fs::archive_compression::lz4 : fs::archive_compression::none;
+    for(const auto& [name, file] : files)
+    {
+        if(file.filename().string().find(".asset") != std::string::npos)
+        {
+            writer.add_file(name, file, compression);
+            continue;
+        }
+
+        auto loose_file = loose_dir / name;
+        fs::create_directories(loose_file.parent_path(), ec);
+        APPLOG_TRACE("Copying {} -> {}", file.string(), loose_file.string());
+        fs::copy_file(file, loose_file, fs::copy_options::overwrite_existing, ec);
+    }
+
+    APPLOG_TRACE("Creating Archive -> {}", archive_path.string());
+    if(!writer.write(archive_path))
+    {
+        APPLOG_ERROR("Failed to write {}", archive_path.string());
+    }
+}
+
 auto save_scene_impl(rtti::context& ctx, const fs::path& path) -> bool
 {
     auto& ec = ctx.get_cached<ecs>();
@@ -932,18 +977,9 @@ auto editor_actions::deploy_project(rtti::context& ctx, const deploy_settings& p
                            {
                                APPLOG_INFO("Deploying Project Data...");
 
-                               fs::error_code ec;
-                               {
-                                   auto data = fs::resolve_protocol("app:/compiled");
-                                   fs::path cached_data = params.deploy_location / "data" / "app" / "compiled";
-
-                                   APPLOG_TRACE("Clearing {}", cached_data.string());
-                                   fs::remove_all(cached_data, ec);
-                                   fs::create_directories(cached_data, ec);
-
-                                   APPLOG_TRACE("Copying {} -> {}", data.string(), cached_data.string());
-                                   fs::copy(data, cached_data, fs::copy_options::recursive, ec);
-                               }
+                               deploy_compiled_data(fs::resolve_protocol("app:/compiled"),
+                                                    params.deploy_location / "data" / "app",
+                                                    params.compress_data);
 
                                {
                                    fs::path cached_data = params.deploy_location / "data" / "app" / "assets.pack";
@@ -966,18 +1002,9 @@ auto editor_actions::deploy_project(rtti::context& ctx, const deploy_settings& p
                            {
                                APPLOG_INFO("Deploying Engine Data...");
 
-                               fs::error_code ec;
-                               {
-                                   fs::path cached_data = params.deploy_location / "data" / "engine" / "compiled";
-                                   auto data = fs::resolve_protocol("engine:/compiled");
-
-                                   APPLOG_TRACE("Clearing {}", cached_data.string());
-                                   fs::remove_all(cached_data, ec);
-                                   fs::create_directories(cached_data, ec);
-
-                                   APPLOG_TRACE("Copying {} -> {}", data.string(), cached_data.string());
-                                   fs::copy(data, cached_data, fs::copy_options::recursive, ec);
-                               }
+                               deploy_compiled_data(fs::resolve_protocol("engine:/compiled"),
+                                                    params.deploy_location / "data" / "engine",
+                                                    params.compress_data);
 
                                {
                                    fs::path cached_data = params.deploy_location / "data" / "engine" / "assets.pack";
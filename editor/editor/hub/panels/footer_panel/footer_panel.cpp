@@ -1,6 +1,7 @@
 #include "footer_panel.h"
 #include "../panels_defs.h"
 
+#include <editor/assets/asset_watcher.h>
 #include <engine/threading/threader.h>
 
 #include <imgui/imgui.h>
@@ -24,6 +25,29 @@ void draw_footer_child(rtti::context& ctx, float footerSize, const std::function
 
     ImGui::SameLine();
 
+    auto imports = ctx.get_cached<asset_watcher>().get_scheduler().get_progress();
+    if(imports.completed < imports.total)
+    {
+        auto eta = std::chrono::duration_cast<std::chrono::seconds>(imports.eta).count();
+        auto overlay = fmt::format("Importing {}/{}", imports.completed, imports.total);
+
+        ImGui::AlignTextToFramePadding();
+        ImGui::ProgressBar(float(imports.completed) / float(imports.total),
+                           ImVec2(ImGui::GetFrameHeight() * 10.0f, 0.0f),
+                           overlay.c_str());
+        ImGui::SameLine();
+        ImGui::AlignTextToFramePadding();
+        ImGui::HelpMarker(
+            fmt::format("{} ETA {}s", imports.current, eta).c_str(),
+            false,
+            [&]()
+            {
+                auto details = fmt::format("Running : {}, Failed : {}", imports.running, imports.failed);
+                ImGui::TextUnformatted(details.c_str());
+            });
+        ImGui::SameLine();
+    }
+
     auto threads = tpp::get_all_registered_threads();
     size_t total_jobs = 0;
     for(const auto& id : threads)
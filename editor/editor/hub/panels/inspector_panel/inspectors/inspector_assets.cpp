@@ -13,6 +13,7 @@
 
 #include <engine/rendering/material.h>
 #include <engine/rendering/mesh.h>
+#include <engine/rendering/texture_streamer.h>
 #include <engine/meta/rendering/texture.hpp>
 #include <engine/meta/rendering/material.hpp>
 #include <engine/meta/ecs/entity.hpp>
@@ -260,6 +261,10 @@ void inspector_asset_handle_texture::draw_image(const asset_handle<gfx::texture>
                 mip = 0;
             }
 
+            // Inspecting a texture streams in its full mip chain so every mip can be browsed.
+            const auto full_size = std::max(tex->info.width, tex->info.height) << tex->skipped_mips;
+            get_texture_streamer().record_usage(tex.get(), float(full_size));
+
             auto sz = ImGui::GetSize(data, size);
             ImGui::ImageWithAspect(ImGui::ToId(tex, mip), sz, size);
 
@@ -1,7 +1,15 @@
 #include "statistics_panel.h"
 #include "../panels_defs.h"
 
+#include <engine/animation/ecs/systems/animation_system.h>
+#include <engine/assets/asset_manager.h>
+#include <engine/assets/impl/asset_cache.h>
 #include <engine/profiler/profiler.h>
+#include <engine/rendering/ecs/systems/rendering_system.h>
+#include <engine/rendering/shadow_atlas.h>
+#include <engine/rendering/texture_streamer.h>
+#include <engine/threading/threader.h>
+#include <filesystem/filesystem.h>
 
 #include <graphics/graphics.h>
 #include <math/math.h>
@@ -134,7 +142,69 @@ static void resource_bar(const char* _name,
     }
 }
 
-void draw_statistics(bool& enable_profiler)
+// One row per thread that ran a task, the critical path in red.
+void schedule_timeline(const frame_graph& graph)
+{
+    const auto& schedule = graph.get_schedule();
+    ImGui::Text("%s: %.2f ms  Critical path: %.2f ms", graph.get_name(), schedule.total_ms, schedule.critical_ms);
+    if(schedule.tasks.empty() || schedule.total_ms <= 0.0)
+    {
+        return;
+    }
+
+    std::vector<size_t> rows(schedule.threads + 1, size_t(-1));
+    size_t row_count = 0;
+    for(const auto& timing : schedule.tasks)
+    {
+        auto& row = rows[std::min(timing.thread, schedule.threads)];
+        if(row == size_t(-1))
+        {
+            row = row_count++;
+        }
+    }
+
+    const float row_height = ImGui::GetTextLineHeightWithSpacing();
+    const float width = ImGui::GetContentRegionAvail().x;
+    const float scale = width / float(schedule.total_ms);
+    const auto origin = ImGui::GetCursorScreenPos();
+
+    ImGui::InvisibleButton(graph.get_name(), ImVec2(width, row_height * float(row_count)));
+    const bool hovered = ImGui::IsItemHovered();
+
+    auto draw_list = ImGui::GetWindowDrawList();
+    for(const auto& timing : schedule.tasks)
+    {
+        const auto row = rows[std::min(timing.thread, schedule.threads)];
+        const ImVec2 min(origin.x + float(timing.start_ms) * scale, origin.y + float(row) * row_height);
+        const ImVec2 max(std::max(min.x + 1.0f, origin.x + float(timing.end_ms) * scale), min.y + row_height - 1.0f);
+
+        draw_list->AddRectFilled(min, max, timing.critical ? IM_COL32(190, 70, 60, 255) : IM_COL32(70, 110, 170, 255));
+        draw_list->PushClipRect(min, max, true);
+        draw_list->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, timing.name);
+        draw_list->PopClipRect();
+
+        if(hovered && ImGui::IsMouseHoveringRect(min, max))
+        {
+            std::string after;
+            for(auto index : timing.after)
+            {
+                after += after.empty() ? "" : ", ";
+                after += schedule.tasks[index].name;
+            }
+
+            ImGui::BeginTooltip();
+            ImGui::Text("%s", timing.name);
+            ImGui::Text("%.3f ms at %.3f ms%s",
+                        timing.end_ms - timing.start_ms,
+                        timing.start_ms,
+                        timing.on_main_thread ? ", main thread" : "");
+            ImGui::Text("After: %s", after.empty() ? "-" : after.c_str());
+            ImGui::EndTooltip();
+        }
+    }
+}
+
+void draw_statistics(rtti::context& ctx, bool& enable_profiler)
 {
     auto& io = ImGui::GetIO();
 
@@ -378,6 +448,154 @@ void draw_statistics(bool& enable_profiler)
                          itemHeight);
             ImGui::PopFont();
         }
+        if(ImGui::CollapsingHeader(ICON_MDI_DATABASE "\tAsset Cache"))
+        {
+            const auto& cache = get_asset_cache();
+            const auto cache_stats = cache.get_stats();
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::TextUnformatted(cache.get_directory().string().c_str());
+            ImGui::Text("Hits: %llu", (unsigned long long)cache_stats.hits);
+            ImGui::Text("Misses: %llu", (unsigned long long)cache_stats.misses);
+            ImGui::Text("Stores: %llu", (unsigned long long)cache_stats.stores);
+            ImGui::Text("Failures: %llu", (unsigned long long)cache_stats.failures);
+            ImGui::PopFont();
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_DOWNLOAD "\tAsset Streaming"))
+        {
+            auto& stream = ctx.get_cached<asset_manager>().get_stream();
+            const auto stream_stats = stream.get_stats();
+
+            auto latency_text = [](const char* label, const asset_stream::latency& latency)
+            {
+                ImGui::Text("%-8s avg %7.2f ms  max %7.2f ms", label, latency.avg_ms, latency.max_ms);
+            };
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::Text("Queued: %zu  Reading: %zu", stream_stats.queued, stream_stats.reading);
+            ImGui::Text("Read ahead: %zu  Decoding: %zu", stream_stats.read_ahead, stream_stats.decoding);
+            ImGui::Text("Completed: %llu  Cancelled: %llu  Failed: %llu",
+                        (unsigned long long)stream_stats.completed,
+                        (unsigned long long)stream_stats.cancelled,
+                        (unsigned long long)stream_stats.failed);
+            latency_text("Queue", stream_stats.queue);
+            latency_text("Read", stream_stats.read);
+            latency_text("Decode", stream_stats.decode);
+            latency_text("Total", stream_stats.total);
+            ImGui::PopFont();
+
+            if(ImGui::Button("Reset"))
+            {
+                stream.reset_stats();
+            }
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_IMAGE_MULTIPLE "\tTexture Streaming"))
+        {
+            const auto streaming_stats = get_texture_streamer().get_stats();
+            const auto to_mb = [](uint64_t bytes)
+            {
+                return double(bytes) / (1024.0 * 1024.0);
+            };
+
+            const float usage = streaming_stats.budget > 0
+                                    ? float(double(streaming_stats.resident_bytes) / double(streaming_stats.budget))
+                                    : 0.0f;
+            auto overlay = fmt::format("{:.1f} / {:.1f} MB",
+                                       to_mb(streaming_stats.resident_bytes),
+                                       to_mb(streaming_stats.budget));
+            ImGui::ProgressBar(std::min(usage, 1.0f), ImVec2(-1.0f, 0.0f), overlay.c_str());
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::Text("Textures: %zu  Fully resident: %zu  Pending: %zu",
+                        streaming_stats.textures,
+                        streaming_stats.fully_resident,
+                        streaming_stats.pending);
+            ImGui::Text("Wanted: %.1f MB  All mips: %.1f MB",
+                        to_mb(streaming_stats.wanted_bytes),
+                        to_mb(streaming_stats.full_bytes));
+            ImGui::Text("Upgrades: %llu  Downgrades: %llu  Evictions: %llu",
+                        (unsigned long long)streaming_stats.upgrades,
+                        (unsigned long long)streaming_stats.downgrades,
+                        (unsigned long long)streaming_stats.evictions);
+            ImGui::PopFont();
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_BOX_SHADOW "\tShadow Atlas"))
+        {
+            const auto& atlas_stats = ctx.get_cached<shadow_atlas>().get_stats();
+            const auto to_mb = [](uint64_t bytes)
+            {
+                return double(bytes) / (1024.0 * 1024.0);
+            };
+
+            const float usage = atlas_stats.budget_bytes > 0
+                                    ? float(double(atlas_stats.used_bytes) / double(atlas_stats.budget_bytes))
+                                    : 0.0f;
+            auto overlay =
+                fmt::format("{:.1f} / {:.1f} MB", to_mb(atlas_stats.used_bytes), to_mb(atlas_stats.budget_bytes));
+            ImGui::ProgressBar(std::min(usage, 1.0f), ImVec2(-1.0f, 0.0f), overlay.c_str());
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::Text("Lights: %u  Resident maps: %u  Free maps: %u",
+                        atlas_stats.allocations,
+                        atlas_stats.resident_maps,
+                        atlas_stats.free_maps);
+            ImGui::Text("Evictions: %u  Failed: %u", atlas_stats.evictions, atlas_stats.failed_acquires);
+            ImGui::PopFont();
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_ANIMATION_PLAY "\tAnimation"))
+        {
+            const auto& anim_stats = ctx.get_cached<animation_system>().get_stats();
+            const auto& characters = anim_stats.characters;
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::Text("Full: %zu  Reduced: %zu  Minimal: %zu  Frozen: %zu",
+                        characters[size_t(animation_lod::full)],
+                        characters[size_t(animation_lod::reduced)],
+                        characters[size_t(animation_lod::minimal)],
+                        characters[size_t(animation_lod::frozen)]);
+            ImGui::Text("Sampled: %zu  Interpolated: %zu", anim_stats.sampled, anim_stats.interpolated);
+            ImGui::PopFont();
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_CHIP "\tJobs"))
+        {
+            auto& th = ctx.get_cached<threader>();
+            const auto job_stats = th.jobs->get_frame_stats();
+            const auto thread_count = job_stats.threads.size();
+
+            // Busy time of all threads against the time they had during the frame.
+            const double available_ms = job_stats.frame_ms * double(thread_count);
+            const float utilization = available_ms > 0.0 ? float(job_stats.busy_ms / available_ms) : 0.0f;
+            auto overlay = fmt::format("{:.0f}% of {} threads", utilization * 100.0f, thread_count);
+            ImGui::ProgressBar(std::min(utilization, 1.0f), ImVec2(-1.0f, 0.0f), overlay.c_str());
+
+            ImGui::PushFont(ImGui::Font::Mono);
+            ImGui::Text("Jobs: %llu  Stolen: %llu  Helped: %llu  Parallel loops: %llu",
+                        (unsigned long long)job_stats.jobs,
+                        (unsigned long long)job_stats.stolen,
+                        (unsigned long long)job_stats.helped,
+                        (unsigned long long)job_stats.parallel_fors);
+            for(size_t i = 0; i < thread_count; ++i)
+            {
+                const auto& thread = job_stats.threads[i];
+                const auto name = i + 1 < thread_count ? fmt::format("Worker {}", i) : std::string("Others");
+                ImGui::Text("%-10s %6.2f ms  Jobs: %llu  Stolen: %llu",
+                            name.c_str(),
+                            thread.busy_ms,
+                            (unsigned long long)thread.jobs,
+                            (unsigned long long)thread.stolen);
+            }
+            ImGui::PopFont();
+        }
+
+        if(ImGui::CollapsingHeader(ICON_MDI_SITEMAP "\tFrame Graph"))
+        {
+            schedule_timeline(ctx.get_cached<rendering_system>().get_prepare_graph());
+        }
 
         if(ImGui::CollapsingHeader(ICON_MDI_CLOCK_OUTLINE "\tProfiler"))
         {
@@ -520,7 +738,7 @@ void statistics_panel::on_frame_ui_render(rtti::context& ctx, const char* name)
     if(ImGui::Begin(name, nullptr, ImGuiWindowFlags_MenuBar))
     {
         draw_menubar(ctx);
-        draw_statistics(enable_profiler_);
+        draw_statistics(ctx, enable_profiler_);
     }
     ImGui::End();
 }
@@ -529,6 +747,42 @@ void statistics_panel::draw_menubar(rtti::context& ctx)
 {
     if(ImGui::BeginMenuBar())
     {
+        auto profiler = get_app_profiler();
+
+        if(ImGui::BeginMenu("Capture", !profiler->is_capturing()))
+        {
+            // Chrome trace json, open with chrome://tracing or Perfetto.
+            auto path = (fs::temp_directory_path() / "ace_trace.json").string();
+
+            for(uint32_t frames : {60u, 300u, 1000u})
+            {
+                if(ImGui::MenuItem(fmt::format("{} Frames", frames).c_str()))
+                {
+                    profiler->start_capture(frames, path);
+                }
+            }
+
+            ImGui::Separator();
+            if(ImGui::MenuItem("Frame Graph Schedule"))
+            {
+                auto temp = fs::temp_directory_path();
+                ctx.get_cached<rendering_system>().get_prepare_graph().save_trace(
+                    (temp / "ace_prepare_graph.json").string());
+            }
+            ImGui::EndMenu();
+        }
+
+        if(profiler->is_capturing())
+        {
+            ImGui::TextUnformatted("Capturing...");
+        }
+
+        auto dropped = profiler->get_dropped_events();
+        if(dropped > 0)
+        {
+            ImGui::TextUnformatted(fmt::format("Dropped events: {}", dropped).c_str());
+        }
+
         ImGui::EndMenuBar();
     }
 }
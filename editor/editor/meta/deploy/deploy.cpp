@@ -19,7 +19,10 @@ REFLECT(deploy_settings)
             rttr::metadata("tooltip", "This takes some time and if already done should't be necessary."))
         .property("run",
                   &deploy_settings::deploy_and_run)(rttr::metadata("pretty_name", "Deploy & Run"),
-                                                  rttr::metadata("tooltip", "Run the application after the deploy."));
+                                                  rttr::metadata("tooltip", "Run the application after the deploy."))
+        .property("compress_data", &deploy_settings::compress_data)(
+            rttr::metadata("pretty_name", "Compress Data"),
+            rttr::metadata("tooltip", "Compress packed data with LZ4 where it saves space."));
 }
 
 SAVE(deploy_settings)
@@ -27,6 +30,7 @@ SAVE(deploy_settings)
     try_save(ar, ser20::make_nvp("deploy_location", obj.deploy_location.generic_string()));
     try_save(ar, ser20::make_nvp("deploy_dependencies", obj.deploy_dependencies));
     try_save(ar, ser20::make_nvp("deploy_and_run", obj.deploy_and_run));
+    try_save(ar, ser20::make_nvp("compress_data", obj.compress_data));
 }
 SAVE_INSTANTIATE(deploy_settings, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(deploy_settings, ser20::oarchive_binary_t);
@@ -40,6 +44,7 @@ LOAD(deploy_settings)
     }
     try_load(ar, ser20::make_nvp("deploy_dependencies", obj.deploy_dependencies));
     try_load(ar, ser20::make_nvp("deploy_and_run", obj.deploy_and_run));
+    try_load(ar, ser20::make_nvp("compress_data", obj.compress_data));
 }
 LOAD_INSTANTIATE(deploy_settings, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(deploy_settings, ser20::iarchive_binary_t);
@@ -8,14 +8,19 @@
 #include <editor/meta/settings/settings.hpp>
 
 #include <engine/animation/animation.h>
+#include <engine/animation/ecs/systems/animation_system.h>
 #include <engine/assets/asset_manager.h>
 #include <engine/assets/impl/asset_compiler.h>
 #include <engine/assets/impl/asset_extensions.h>
 #include <engine/ecs/ecs.h>
+#include <engine/engine.h>
 #include <engine/events.h>
 #include <engine/meta/settings/settings.hpp>
 #include <engine/rendering/material.h>
+#include <engine/rendering/ecs/systems/rendering_system.h>
 #include <engine/rendering/mesh.h>
+#include <engine/rendering/shadow_atlas.h>
+#include <engine/rendering/texture_streamer.h>
 #include <engine/scripting/ecs/systems/script_system.h>
 #include <engine/threading/threader.h>
 
@@ -29,6 +34,49 @@
 namespace ace
 {
 
+namespace
+{
+void apply_graphics_settings(const settings::graphics_settings& graphics)
+{
+    auto& streamer = get_texture_streamer();
+    auto streaming = streamer.get_settings();
+    streaming.budget = uint64_t(graphics.texture_streaming_budget) << 20;
+    streaming.initial_size = graphics.texture_streaming_initial_size;
+    streamer.set_settings(streaming);
+
+    auto& rpath = engine::context().get_cached<rendering_system>();
+    rpath.set_culling_method(graphics.batched_culling ? rendering::pipeline::culling_method::batched
+                                                      : rendering::pipeline::culling_method::hierarchical);
+
+    auto& atlas = engine::context().get_cached<shadow_atlas>();
+    auto shadows = atlas.get_settings();
+    shadows.budget_bytes = uint64_t(graphics.shadow_atlas_budget) << 20;
+    shadows.min_size = uint16_t(std::min<uint32_t>(graphics.shadow_map_min_size, 1u << 15));
+    shadows.max_size = uint16_t(std::min<uint32_t>(graphics.shadow_map_max_size, 1u << 15));
+    atlas.set_settings(shadows);
+}
+
+void apply_animation_settings(const settings::animation_settings& animation)
+{
+    animation_compression_settings compression;
+    compression.sample_rate = animation.compression_sample_rate;
+    compression.position_tolerance = animation.compression_position_tolerance;
+    compression.rotation_tolerance = animation.compression_rotation_tolerance;
+    compression.scaling_tolerance = animation.compression_scaling_tolerance;
+    asset_compiler::set_animation_compression(compression);
+
+    auto& anim = engine::context().get_cached<animation_system>();
+    auto lod = anim.get_lod_settings();
+    lod.enabled = animation.lod_enabled;
+    lod.reduced_size = animation.lod_reduced_size;
+    lod.minimal_size = animation.lod_minimal_size;
+    lod.frozen_size = animation.lod_frozen_size;
+    lod.reduced_interval = animation.lod_reduced_interval;
+    lod.minimal_interval = animation.lod_minimal_interval;
+    anim.set_lod_settings(lod);
+}
+} // namespace
+
 void project_manager::close_project(rtti::context& ctx)
 {
     if(has_open_project())
@@ -105,11 +153,15 @@ auto project_manager::open_project(rtti::context& ctx, const fs::path& project_p
 void project_manager::load_project_settings()
 {
     load_from_file(fs::resolve_protocol("app:/settings/settings.cfg").string(), project_settings_);
+    apply_graphics_settings(project_settings_.graphics);
+    apply_animation_settings(project_settings_.animation);
 }
 
 void project_manager::save_project_settings()
 {
     save_to_file(fs::resolve_protocol("app:/settings/settings.cfg").string(), project_settings_);
+    apply_graphics_settings(project_settings_.graphics);
+    apply_animation_settings(project_settings_.animation);
 }
 
 void project_manager::load_deploy_settings()
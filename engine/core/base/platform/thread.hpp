@@ -58,6 +58,11 @@ inline void set_thread_name(const char* threadName)
     //DWORD threadId = ::GetThreadId(reinterpret_cast<HANDLE>(thread.native_handle()));
     set_thread_name(threadId, threadName);
 }
+
+inline void set_thread_affinity(std::thread& thread, size_t core)
+{
+    SetThreadAffinityMask(reinterpret_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << core);
+}
 } // namespace platform
 #elif ACE_PLATFORM_LINUX
 #include <pthread.h>
@@ -67,6 +72,14 @@ inline void set_thread_name(const char* threadName)
 {
     pthread_setname_np(pthread_self(), threadName);
 }
+
+inline void set_thread_affinity(std::thread& thread, size_t core)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+}
 } // namespace platform
 #elif ACE_PLATFORM_OSX
 #include <pthread.h>
@@ -76,6 +89,11 @@ inline void set_thread_name(const char* threadName)
 {
     pthread_setname_np(threadName);
 }
+
+// There is no way to pin a thread to a core on macOS.
+inline void set_thread_affinity(std::thread& thread, size_t core)
+{
+}
 } // namespace platform
 #else
 namespace platform
@@ -83,6 +101,10 @@ namespace platform
 inline void set_thread_name(const char* threadName)
 {
 }
+
+inline void set_thread_affinity(std::thread& thread, size_t core)
+{
+}
 } // namespace platform
 #endif
 
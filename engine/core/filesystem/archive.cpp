@@ -0,0 +1,739 @@
+#include "archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs
+{
+
+namespace
+{
+constexpr char archive_magic[8] = {'A', 'C', 'E', 'P', 'A', 'C', 'K', '\0'};
+
+// Entries that do not shrink by at least 1/8 are stored as is, decompressing them is not worth it.
+constexpr size_t min_saving_divisor = 8;
+
+struct archive_header
+{
+    char magic[8]{};
+    std::uint32_t version{};
+    std::uint32_t entry_count{};
+    std::uint64_t toc_offset{};
+    std::uint64_t toc_size{};
+};
+
+struct toc_record
+{
+    std::uint64_t offset{};
+    std::uint64_t size{};
+    std::uint64_t stored_size{};
+    std::uint32_t compression{};
+    std::uint32_t name_length{};
+};
+
+struct mount
+{
+    std::string prefix;
+    std::shared_ptr<archive> pack;
+};
+
+auto get_mounts() -> std::vector<mount>&
+{
+    static std::vector<mount> mounts;
+    return mounts;
+}
+
+auto get_mounts_mutex() -> std::shared_mutex&
+{
+    static std::shared_mutex mutex;
+    return mutex;
+}
+
+auto find_mounted(const path& _path, std::string& name) -> std::shared_ptr<archive>
+{
+    const auto key = _path.generic_string();
+
+    std::shared_lock<std::shared_mutex> lock(get_mounts_mutex());
+    for(const auto& m : get_mounts())
+    {
+        if(key.size() > m.prefix.size() && key.compare(0, m.prefix.size(), m.prefix) == 0)
+        {
+            name = key.substr(m.prefix.size());
+            return m.pack;
+        }
+    }
+
+    return nullptr;
+}
+
+auto read_u16(const std::uint8_t* p) -> std::uint32_t
+{
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8);
+}
+
+auto read_u32(const std::uint8_t* p) -> std::uint32_t
+{
+    std::uint32_t value{};
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+auto mapped_file::open(const path& file) -> bool
+{
+    close();
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(file.c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+    if(handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size{};
+    if(!GetFileSizeEx(handle, &file_size))
+    {
+        CloseHandle(handle);
+        return false;
+    }
+
+    size_ = size_t(file_size.QuadPart);
+    if(size_ > 0)
+    {
+        HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping)
+        {
+            data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(handle);
+
+    if(size_ > 0 && !data_)
+    {
+        size_ = 0;
+        return false;
+    }
+#else
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info{};
+    if(::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size_ = size_t(info.st_size);
+    if(size_ > 0)
+    {
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped != MAP_FAILED)
+        {
+            data_ = static_cast<const std::uint8_t*>(mapped);
+        }
+    }
+    ::close(fd);
+
+    if(size_ > 0 && !data_)
+    {
+        size_ = 0;
+        return false;
+    }
+#endif
+
+    // Empty files can not be mapped, point them at something valid anyway.
+    if(!data_)
+    {
+        static const std::uint8_t empty{};
+        data_ = &empty;
+    }
+    else
+    {
+        mapping_ = const_cast<std::uint8_t*>(data_);
+    }
+
+    return true;
+}
+
+void mapped_file::close()
+{
+    if(mapping_)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(mapping_);
+#else
+        ::munmap(mapping_, size_);
+#endif
+    }
+
+    mapping_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+auto mapped_file::data() const -> const std::uint8_t*
+{
+    return data_;
+}
+
+auto mapped_file::size() const -> size_t
+{
+    return size_;
+}
+
+auto archive::open(const path& file) -> bool
+{
+    entries_.clear();
+
+    if(!file_.open(file))
+    {
+        return false;
+    }
+
+    const auto* base = file_.data();
+    const auto total = file_.size();
+
+    archive_header header;
+    if(total < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+
+    if(std::memcmp(header.magic, archive_magic, sizeof(archive_magic)) != 0 || header.version != version)
+    {
+        return false;
+    }
+
+    if(header.toc_offset > total || header.toc_size > total - header.toc_offset)
+    {
+        return false;
+    }
+
+    const auto* toc = base + header.toc_offset;
+    const auto* toc_end = toc + header.toc_size;
+
+    entries_.reserve(header.entry_count);
+    for(std::uint32_t i = 0; i < header.entry_count; ++i)
+    {
+        toc_record record;
+        if(size_t(toc_end - toc) < sizeof(record))
+        {
+            return false;
+        }
+        std::memcpy(&record, toc, sizeof(record));
+        toc += sizeof(record);
+
+        if(size_t(toc_end - toc) < record.name_length)
+        {
+            return false;
+        }
+        std::string name(reinterpret_cast<const char*>(toc), record.name_length);
+        toc += record.name_length;
+
+        if(record.offset > total || record.stored_size > total - record.offset)
+        {
+            return false;
+        }
+
+        // Uncompressed entries are served straight from the mapping, their size has to fit too.
+        switch(archive_compression(record.compression))
+        {
+            case archive_compression::none:
+                if(record.size != record.stored_size)
+                {
+                    return false;
+                }
+                break;
+            case archive_compression::lz4:
+                break;
+            default:
+                return false;
+        }
+
+        entry e;
+        e.offset = record.offset;
+        e.size = record.size;
+        e.stored_size = record.stored_size;
+        e.compression = archive_compression(record.compression);
+        entries_.emplace(std::move(name), e);
+    }
+
+    return true;
+}
+
+auto archive::find(const std::string& name) const -> const entry*
+{
+    auto it = entries_.find(name);
+    if(it == entries_.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+auto archive::get_entries() const -> const std::unordered_map<std::string, entry>&
+{
+    return entries_;
+}
+
+auto archive::read(const std::string& name) const -> data_view
+{
+    const auto* e = find(name);
+    if(!e)
+    {
+        return {};
+    }
+
+    const auto* stored = file_.data() + e->offset;
+
+    data_view result;
+    result.size = size_t(e->size);
+
+    switch(e->compression)
+    {
+        case archive_compression::none:
+        {
+            result.data = stored;
+            result.owner = shared_from_this();
+            return result;
+        }
+        case archive_compression::lz4:
+        {
+            auto buffer = std::make_shared<std::vector<std::uint8_t>>(result.size);
+            if(!lz4::decompress(stored, size_t(e->stored_size), buffer->data(), buffer->size()))
+            {
+                return {};
+            }
+            result.data = buffer->data();
+            result.owner = std::move(buffer);
+            return result;
+        }
+        default:
+            return {};
+    }
+}
+
+void archive_writer::add_file(const std::string& name, const path& file, archive_compression compression)
+{
+    sources_.push_back({name, file, compression});
+}
+
+void archive_writer::add_directory(const path& dir, archive_compression compression)
+{
+    // Sorted, so the same input always produces the same archive.
+    std::map<std::string, path> files;
+
+    error_code err;
+    for(const auto& entry : recursive_directory_iterator(dir, err))
+    {
+        if(entry.is_regular_file(err))
+        {
+            files.emplace(entry.path().lexically_relative(dir).generic_string(), entry.path());
+        }
+    }
+
+    for(const auto& [name, file] : files)
+    {
+        add_file(name, file, compression);
+    }
+}
+
+auto archive_writer::write(const path& file) const -> bool
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if(!out.is_open())
+    {
+        return false;
+    }
+
+    auto pad_to = [&out](std::uint64_t position)
+    {
+        static const char zeros[archive::alignment]{};
+        auto aligned = (position + archive::alignment - 1) / archive::alignment * archive::alignment;
+        out.write(zeros, std::streamsize(aligned - position));
+        return aligned;
+    };
+
+    archive_header header;
+    std::memcpy(header.magic, archive_magic, sizeof(archive_magic));
+    header.version = archive::version;
+    header.entry_count = std::uint32_t(sources_.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t position = pad_to(sizeof(header));
+
+    std::vector<std::uint8_t> compressed;
+    std::string toc;
+    for(const auto& src : sources_)
+    {
+        std::ifstream in(src.file, std::ios::binary);
+        auto content = read_stream(in);
+
+        toc_record record;
+        record.offset = position;
+        record.size = content.size();
+        record.stored_size = content.size();
+        record.compression = std::uint32_t(archive_compression::none);
+
+        const std::uint8_t* payload = content.data();
+
+        if(src.compression == archive_compression::lz4 && !content.empty())
+        {
+            compressed.resize(lz4::compress_bound(content.size()));
+            auto size = lz4::compress(content.data(), content.size(), compressed.data(), compressed.size());
+            if(size > 0 && size <= content.size() - content.size() / min_saving_divisor)
+            {
+                record.stored_size = size;
+                record.compression = std::uint32_t(archive_compression::lz4);
+                payload = compressed.data();
+            }
+        }
+
+        out.write(reinterpret_cast<const char*>(payload), std::streamsize(record.stored_size));
+        position = pad_to(position + record.stored_size);
+
+        record.name_length = std::uint32_t(src.name.size());
+        toc.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        toc.append(src.name);
+    }
+
+    header.toc_offset = position;
+    header.toc_size = toc.size();
+    out.write(toc.data(), std::streamsize(toc.size()));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    return out.good();
+}
+
+auto mount_archive(const std::string& mount_point, const path& file) -> bool
+{
+    auto pack = std::make_shared<archive>();
+    if(!pack->open(file))
+    {
+        return false;
+    }
+
+    auto prefix = path(mount_point).generic_string();
+    if(prefix.empty() || prefix.back() != '/')
+    {
+        prefix += '/';
+    }
+
+    std::unique_lock<std::shared_mutex> lock(get_mounts_mutex());
+    auto& mounts = get_mounts();
+    mounts.erase(std::remove_if(mounts.begin(),
+                                mounts.end(),
+                                [&](const mount& m)
+                                {
+                                    return m.prefix == prefix;
+                                }),
+                 mounts.end());
+    mounts.push_back({prefix, std::move(pack)});
+
+    // Longest prefix first, so nested mount points win.
+    std::sort(mounts.begin(),
+              mounts.end(),
+              [](const mount& lhs, const mount& rhs)
+              {
+                  return lhs.prefix.size() > rhs.prefix.size();
+              });
+
+    return true;
+}
+
+void unmount_archive(const std::string& mount_point)
+{
+    auto prefix = path(mount_point).generic_string();
+    if(prefix.empty() || prefix.back() != '/')
+    {
+        prefix += '/';
+    }
+
+    std::unique_lock<std::shared_mutex> lock(get_mounts_mutex());
+    auto& mounts = get_mounts();
+    mounts.erase(std::remove_if(mounts.begin(),
+                                mounts.end(),
+                                [&](const mount& m)
+                                {
+                                    return m.prefix == prefix;
+                                }),
+                 mounts.end());
+}
+
+auto exists_view(const path& _path) -> bool
+{
+    std::string name;
+    if(auto pack = find_mounted(_path, name))
+    {
+        if(pack->find(name))
+        {
+            return true;
+        }
+    }
+
+    error_code err;
+    return exists(resolve_protocol(_path), err);
+}
+
+auto open_view(const path& _path) -> data_view
+{
+    std::string name;
+    if(auto pack = find_mounted(_path, name))
+    {
+        auto view = pack->read(name);
+        if(!view.empty())
+        {
+            return view;
+        }
+    }
+
+    // Loose files are read, not mapped. The asset compilers overwrite them in place, which would
+    // change or truncate a mapping that is still in use.
+    std::ifstream stream(resolve_protocol(_path), std::ios::binary);
+    if(!stream.is_open())
+    {
+        return {};
+    }
+
+    auto buffer = std::make_shared<byte_array_t>(read_stream(stream));
+
+    data_view view;
+    view.data = buffer->data();
+    view.size = buffer->size();
+    view.owner = std::move(buffer);
+    return view;
+}
+
+namespace lz4
+{
+
+namespace
+{
+constexpr size_t min_match = 4;
+constexpr size_t last_literals = 5;
+constexpr size_t match_find_limit = 12;
+constexpr size_t max_offset = 65535;
+constexpr int hash_log = 16;
+
+void write_length(std::uint8_t*& op, size_t length)
+{
+    while(length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = std::uint8_t(length);
+}
+
+} // namespace
+
+auto compress_bound(size_t size) -> size_t
+{
+    return size + size / 255 + 16;
+}
+
+auto compress(const std::uint8_t* src, size_t size, std::uint8_t* dst, size_t capacity) -> size_t
+{
+    // Match positions are stored in 32 bits.
+    if(capacity < compress_bound(size) || size >= std::numeric_limits<std::uint32_t>::max())
+    {
+        return 0;
+    }
+
+    std::vector<std::uint32_t> table(size_t(1) << hash_log, 0);
+    auto hash = [](std::uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - hash_log);
+    };
+
+    const std::uint8_t* ip = src;
+    const std::uint8_t* anchor = src;
+    const std::uint8_t* end = src + size;
+    std::uint8_t* op = dst;
+
+    auto emit = [&](const std::uint8_t* literals, size_t literal_length, size_t offset, size_t match_length)
+    {
+        auto* token = op++;
+        *token = std::uint8_t(std::min<size_t>(literal_length, 15) << 4);
+        if(literal_length >= 15)
+        {
+            write_length(op, literal_length - 15);
+        }
+        if(literal_length > 0)
+        {
+            std::memcpy(op, literals, literal_length);
+            op += literal_length;
+        }
+
+        if(match_length == 0)
+        {
+            return;
+        }
+
+        *op++ = std::uint8_t(offset & 0xff);
+        *op++ = std::uint8_t(offset >> 8);
+
+        const auto extra = match_length - min_match;
+        *token |= std::uint8_t(std::min<size_t>(extra, 15));
+        if(extra >= 15)
+        {
+            write_length(op, extra - 15);
+        }
+    };
+
+    if(size > match_find_limit)
+    {
+        // Table entries are positions + 1 so zero means empty.
+        while(ip + match_find_limit <= end)
+        {
+            const auto sequence = read_u32(ip);
+            auto& slot = table[hash(sequence)];
+            const std::uint8_t* ref = slot ? src + (slot - 1) : nullptr;
+            slot = std::uint32_t(ip - src) + 1;
+
+            if(!ref || size_t(ip - ref) > max_offset || read_u32(ref) != sequence)
+            {
+                ++ip;
+                continue;
+            }
+
+            size_t length = min_match;
+            while(ip + length < end - last_literals && ip[length] == ref[length])
+            {
+                ++length;
+            }
+
+            emit(anchor, size_t(ip - anchor), size_t(ip - ref), length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    emit(anchor, size_t(end - anchor), 0, 0);
+    return size_t(op - dst);
+}
+
+auto decompress(const std::uint8_t* src, size_t size, std::uint8_t* dst, size_t capacity) -> bool
+{
+    const std::uint8_t* ip = src;
+    const std::uint8_t* end = src + size;
+    std::uint8_t* op = dst;
+    std::uint8_t* out_end = dst + capacity;
+
+    auto read_length = [&](size_t& length) -> bool
+    {
+        std::uint8_t byte = 255;
+        while(byte == 255)
+        {
+            if(ip >= end)
+            {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+        }
+        return true;
+    };
+
+    while(ip < end)
+    {
+        const auto token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if(literal_length == 15 && !read_length(literal_length))
+        {
+            return false;
+        }
+
+        if(size_t(end - ip) < literal_length || size_t(out_end - op) < literal_length)
+        {
+            return false;
+        }
+        if(literal_length > 0)
+        {
+            std::memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+        }
+
+        // The last sequence has literals only.
+        if(ip >= end)
+        {
+            break;
+        }
+
+        if(end - ip < 2)
+        {
+            return false;
+        }
+        const auto offset = read_u16(ip);
+        ip += 2;
+        if(offset == 0 || size_t(op - dst) < offset)
+        {
+            return false;
+        }
+
+        size_t match_length = token & 15;
+        if(match_length == 15 && !read_length(match_length))
+        {
+            return false;
+        }
+        match_length += min_match;
+
+        if(size_t(out_end - op) < match_length)
+        {
+            return false;
+        }
+
+        // Byte wise, the match may overlap the bytes it produces.
+        const std::uint8_t* match = op - offset;
+        for(size_t i = 0; i < match_length; ++i)
+        {
+            op[i] = match[i];
+        }
+        op += match_length;
+    }
+
+    return op == out_end;
+}
+
+} // namespace lz4
+
+} // namespace fs
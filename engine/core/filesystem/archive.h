@@ -0,0 +1,196 @@
+#pragma once
+
+#include "filesystem.h"
+
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs
+{
+
+//-----------------------------------------------------------------------------
+//  Name : data_view
+/// <summary>
+/// Read only view of file contents. Points either straight into a memory
+/// mapped archive or into a copy, owner keeps whichever alive.
+/// </summary>
+//-----------------------------------------------------------------------------
+struct data_view
+{
+    class membuf : public std::streambuf
+    {
+    public:
+        membuf(const std::uint8_t* begin, size_t size)
+        {
+            auto cbegin = reinterpret_cast<char*>(const_cast<std::uint8_t*>(begin));
+            this->setg(cbegin, cbegin, cbegin + size);
+        }
+    };
+
+    auto get_stream_buf() const -> membuf
+    {
+        return membuf(data, size);
+    }
+
+    auto empty() const -> bool
+    {
+        return owner == nullptr;
+    }
+
+    const std::uint8_t* data{};
+    size_t size{};
+    std::shared_ptr<const void> owner{};
+};
+
+//-----------------------------------------------------------------------------
+//  Name : mapped_file
+/// <summary>
+/// Read only memory mapping of a whole file.
+/// </summary>
+//-----------------------------------------------------------------------------
+class mapped_file
+{
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    auto operator=(const mapped_file&) -> mapped_file& = delete;
+
+    auto open(const path& file) -> bool;
+    void close();
+
+    auto data() const -> const std::uint8_t*;
+    auto size() const -> size_t;
+
+private:
+    const std::uint8_t* data_{};
+    size_t size_{};
+    void* mapping_{};
+};
+
+enum class archive_compression : std::uint32_t
+{
+    none = 0,
+    lz4 = 1, ///< LZ4 block format.
+};
+
+//-----------------------------------------------------------------------------
+//  Name : archive
+/// <summary>
+/// Packed, memory mapped collection of files. The layout is a fixed header,
+/// the file blobs aligned to 'alignment' and a table of contents at the end.
+/// Uncompressed entries are served as views straight into the mapping.
+/// </summary>
+//-----------------------------------------------------------------------------
+class archive : public std::enable_shared_from_this<archive>
+{
+public:
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::uint64_t alignment = 64;
+
+    struct entry
+    {
+        std::uint64_t offset{};
+        std::uint64_t size{};
+        std::uint64_t stored_size{};
+        archive_compression compression{archive_compression::none};
+    };
+
+    auto open(const path& file) -> bool;
+
+    auto find(const std::string& name) const -> const entry*;
+    auto get_entries() const -> const std::unordered_map<std::string, entry>&;
+
+    //-----------------------------------------------------------------------------
+    //  Name : read ()
+    /// <summary>
+    /// Returns a view of an entry, empty when it does not exist or is corrupt.
+    /// Only compressed entries allocate.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto read(const std::string& name) const -> data_view;
+
+private:
+    mapped_file file_;
+    std::unordered_map<std::string, entry> entries_;
+};
+
+//-----------------------------------------------------------------------------
+//  Name : archive_writer
+/// <summary>
+/// Collects files and writes them as an archive.
+/// </summary>
+//-----------------------------------------------------------------------------
+class archive_writer
+{
+public:
+    //-----------------------------------------------------------------------------
+    //  Name : add_file ()
+    /// <summary>
+    /// Adds a file under the given name. A compressed entry is only stored
+    /// compressed if that saves enough space to be worth decompressing.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void add_file(const std::string& name, const path& file, archive_compression compression);
+
+    //-----------------------------------------------------------------------------
+    //  Name : add_directory ()
+    /// <summary>
+    /// Adds all files under dir recursively, named by their path relative to dir.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void add_directory(const path& dir, archive_compression compression);
+
+    auto write(const path& file) const -> bool;
+
+private:
+    struct source
+    {
+        std::string name;
+        path file;
+        archive_compression compression{};
+    };
+
+    std::vector<source> sources_;
+};
+
+//-----------------------------------------------------------------------------
+//  Name : mount_archive ()
+/// <summary>
+/// Serves all paths under mount_point, e.g. "engine:/compiled", from the
+/// archive instead of the directory the protocol resolves to.
+/// </summary>
+//-----------------------------------------------------------------------------
+auto mount_archive(const std::string& mount_point, const path& file) -> bool;
+void unmount_archive(const std::string& mount_point);
+
+//-----------------------------------------------------------------------------
+//  Name : exists_view ()
+/// <summary>
+/// Checks a protocol path against the mounted archives, then the disk.
+/// </summary>
+//-----------------------------------------------------------------------------
+auto exists_view(const path& _path) -> bool;
+
+//-----------------------------------------------------------------------------
+//  Name : open_view ()
+/// <summary>
+/// Opens a protocol path from the mounted archives, falling back to reading
+/// the file the protocol resolves to. Empty if neither exists.
+/// </summary>
+//-----------------------------------------------------------------------------
+auto open_view(const path& _path) -> data_view;
+
+namespace lz4
+{
+auto compress_bound(size_t size) -> size_t;
+auto compress(const std::uint8_t* src, size_t size, std::uint8_t* dst, size_t capacity) -> size_t;
+auto decompress(const std::uint8_t* src, size_t size, std::uint8_t* dst, size_t capacity) -> bool;
+} // namespace lz4
+
+} // namespace fs
@@ -16,6 +16,37 @@ texture::texture(const char* _path,
     }
 
     flags = _flags;
+    skipped_mips = _skip;
+}
+
+texture::texture(const char* _name,
+                 const void* _data,
+                 std::uint32_t _size,
+                 std::uint64_t _flags,
+                 std::uint8_t _skip /*= 0 */,
+                 texture_info* _info /*= nullptr*/)
+{
+    handle_ = loadTexture(_data, _size, _name, _flags, _skip, &info);
+
+    if(_info != nullptr)
+    {
+        *_info = info;
+    }
+
+    flags = _flags;
+    skipped_mips = _skip;
+}
+
+void texture::replace(texture& _other)
+{
+    // Destruction is deferred by bgfx, draws already submitted this frame are fine.
+    dispose();
+    handle_ = _other.handle_;
+    info = _other.info;
+    skipped_mips = _other.skipped_mips;
+    flags = _other.flags;
+
+    _other.handle_ = invalid_handle();
 }
 
 texture::texture(std::uint16_t _width,
@@ -74,4 +105,24 @@ auto texture::is_render_target() const -> bool
 {
     return 0 != (flags & BGFX_TEXTURE_RT_MASK);
 }
+
+auto parse_texture_info(const void* _data, std::uint32_t _size, texture_info& _info) -> bool
+{
+    bimg::ImageContainer container;
+    if(!bimg::imageParse(container, _data, _size))
+    {
+        return false;
+    }
+
+    calc_texture_size(_info,
+                      std::uint16_t(container.m_width),
+                      std::uint16_t(container.m_height),
+                      std::uint16_t(container.m_depth),
+                      container.m_cubeMap,
+                      container.m_numMips > 1,
+                      container.m_numLayers,
+                      texture_format(container.m_format));
+    return true;
+}
+
 } // namespace gfx
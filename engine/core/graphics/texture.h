@@ -23,6 +23,20 @@ struct texture : public handle_impl<texture, texture_handle>
             std::uint8_t _skip = 0,
             texture_info* _info = nullptr);
 
+    //-----------------------------------------------------------------------------
+    //  Name : Texture ()
+    /// <summary>
+    /// Creates the texture from an image file already in memory, e.g. a mapped
+    /// archive entry. _name is used as the debug name.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    texture(const char* _name,
+            const void* _data,
+            std::uint32_t _size,
+            std::uint64_t _flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+            std::uint8_t _skip = 0,
+            texture_info* _info = nullptr);
+
     //-----------------------------------------------------------------------------
     //  Name : Texture ()
     /// <summary>
@@ -71,6 +85,16 @@ struct texture : public handle_impl<texture, texture_handle>
             std::uint64_t _flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
             const memory_view* _mem = nullptr);
 
+    //-----------------------------------------------------------------------------
+    //  Name : replace ()
+    /// <summary>
+    /// Takes over the handle and mips of _other, which is left empty. Holders
+    /// of this object see the new mips. _other can be created on any thread,
+    /// the swap belongs on the render thread.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void replace(texture& _other);
+
     //-----------------------------------------------------------------------------
     //  Name : get_size ()
     /// <summary>
@@ -93,7 +117,19 @@ struct texture : public handle_impl<texture, texture_handle>
 
     /// Texture detail info.
     texture_info info{};
+    /// Number of top mips that are not resident.
+    std::uint8_t skipped_mips = 0;
     /// Creation flags.
     std::uint64_t flags = BGFX_TEXTURE_NONE;
 };
+
+//-----------------------------------------------------------------------------
+//  Name : parse_texture_info ()
+/// <summary>
+/// Reads the size, format and mip count of an image file in memory without
+/// decoding it. The info describes the full mip chain.
+/// </summary>
+//-----------------------------------------------------------------------------
+auto parse_texture_info(const void* _data, std::uint32_t _size, texture_info& _info) -> bool;
+
 } // namespace gfx
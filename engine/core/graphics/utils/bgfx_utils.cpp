@@ -225,21 +225,56 @@ static void imageReleaseCb(void* _ptr, void* _userData)
     bimg::imageFree(imageContainer);
 }
 
-bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
-                                const char* _filePath,
+static const bgfx::Memory* copyMipChain(const bimg::ImageContainer& _imageContainer, uint8_t _skip)
+{
+    // bgfx expects every side with its mips in a row, see imageGetRawData for the source layout.
+    const uint16_t numSides = _imageContainer.m_numLayers * (_imageContainer.m_cubeMap ? 6 : 1);
+
+    uint32_t size = 0;
+    bimg::ImageMip mip;
+    for (uint16_t side = 0; side < numSides; ++side)
+    {
+        for (uint8_t lod = _skip; lod < _imageContainer.m_numMips; ++lod)
+        {
+            if (bimg::imageGetRawData(_imageContainer, side, lod, _imageContainer.m_data, _imageContainer.m_size, mip) )
+            {
+                size += mip.m_size;
+            }
+        }
+    }
+
+    const bgfx::Memory* mem = bgfx::alloc(size);
+
+    uint8_t* dst = mem->data;
+    for (uint16_t side = 0; side < numSides; ++side)
+    {
+        for (uint8_t lod = _skip; lod < _imageContainer.m_numMips; ++lod)
+        {
+            if (bimg::imageGetRawData(_imageContainer, side, lod, _imageContainer.m_data, _imageContainer.m_size, mip) )
+            {
+                bx::memCopy(dst, mip.m_data, mip.m_size);
+                dst += mip.m_size;
+            }
+        }
+    }
+
+    return mem;
+}
+
+bgfx::TextureHandle loadTexture(const void* _data,
+                                uint32_t _size,
+                                const char* _name,
                                 uint64_t _flags,
                                 uint8_t _skip,
                                 bgfx::TextureInfo* _info,
                                 bimg::Orientation::Enum* _orientation)
 {
-    BX_UNUSED(_skip);
     bgfx::TextureHandle handle = BGFX_INVALID_HANDLE;
 
-    uint32_t size;
-    void* data = load(_reader, entry::getAllocator(), _filePath, &size);
-    if (NULL != data)
+    if (NULL != _data)
     {
-        bimg::ImageContainer* imageContainer = bimg::imageParse(entry::getAllocator(), data, size);
+        // The container owns a copy, the caller's memory can go away after this.
+        bimg::ImageContainer* imageContainer = bimg::imageParse(entry::getAllocator(), _data, _size);
 
         if (NULL != imageContainer)
         {
@@ -248,23 +283,34 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
                 *_orientation = imageContainer->m_orientation;
             }
 
-            const bgfx::Memory* mem = bgfx::makeRef(
-                imageContainer->m_data
-                , imageContainer->m_size
-                , imageReleaseCb
-                , imageContainer
-                );
-            unload(data);
+            // Volumes halve their depth per mip as well, they are always loaded whole.
+            const uint8_t skip = 1 < imageContainer->m_depth
+                ? 0
+                : uint8_t(bx::min<uint32_t>(_skip, imageContainer->m_numMips - 1) )
+                ;
+            const uint16_t width   = uint16_t(bx::max<uint32_t>(imageContainer->m_width  >> skip, 1) );
+            const uint16_t height  = uint16_t(bx::max<uint32_t>(imageContainer->m_height >> skip, 1) );
+            const bool     hasMips = 1 < imageContainer->m_numMips - skip;
+
+            const bgfx::Memory* mem = 0 == skip
+                ? bgfx::makeRef(
+                      imageContainer->m_data
+                    , imageContainer->m_size
+                    , imageReleaseCb
+                    , imageContainer
+                    )
+                : copyMipChain(*imageContainer, skip)
+                ;
 
             if (NULL != _info)
             {
                 bgfx::calcTextureSize(
                     *_info
-                    , uint16_t(imageContainer->m_width)
-                    , uint16_t(imageContainer->m_height)
+                    , width
+                    , height
                     , uint16_t(imageContainer->m_depth)
                     , imageContainer->m_cubeMap
-                    , 1 < imageContainer->m_numMips
+                    , hasMips
                     , imageContainer->m_numLayers
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     );
@@ -273,8 +319,8 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
             if (imageContainer->m_cubeMap)
             {
                 handle = bgfx::createTextureCube(
-                    uint16_t(imageContainer->m_width)
-                    , 1 < imageContainer->m_numMips
+                    width
+                    , hasMips
                     , imageContainer->m_numLayers
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     , _flags
@@ -284,10 +330,10 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
             else if (1 < imageContainer->m_depth)
             {
                 handle = bgfx::createTexture3D(
-                    uint16_t(imageContainer->m_width)
-                    , uint16_t(imageContainer->m_height)
+                    width
+                    , height
                     , uint16_t(imageContainer->m_depth)
-                    , 1 < imageContainer->m_numMips
+                    , hasMips
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     , _flags
                     , mem
@@ -296,9 +342,9 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
             else if (bgfx::isTextureValid(0, false, imageContainer->m_numLayers, bgfx::TextureFormat::Enum(imageContainer->m_format), _flags) )
             {
                 handle = bgfx::createTexture2D(
-                    uint16_t(imageContainer->m_width)
-                    , uint16_t(imageContainer->m_height)
-                    , 1 < imageContainer->m_numMips
+                    width
+                    , height
+                    , hasMips
                     , imageContainer->m_numLayers
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     , _flags
@@ -308,15 +354,36 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
 
             if (bgfx::isValid(handle) )
             {
-                const bx::StringView name(_filePath);
+                const bx::StringView name(_name);
                 bgfx::setName(handle, name.getPtr(), name.getLength() );
             }
+
+            // The copied chain no longer references the container.
+            if (0 != skip)
+            {
+                bimg::imageFree(imageContainer);
+            }
         }
     }
 
     return handle;
 }
 
+bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
+                                const char* _filePath,
+                                uint64_t _flags,
+                                uint8_t _skip,
+                                bgfx::TextureInfo* _info,
+                                bimg::Orientation::Enum* _orientation)
+{
+    uint32_t size = 0;
+    void* data = load(_reader, entry::getAllocator(), _filePath, &size);
+    bgfx::TextureHandle handle = loadTexture(data, size, _filePath, _flags, _skip, _info, _orientation);
+    unload(data);
+
+    return handle;
+}
+
 bgfx::TextureHandle loadTexture(const char* _name,
                                 uint64_t _flags,
                                 uint8_t _skip,
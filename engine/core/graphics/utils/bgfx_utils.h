@@ -39,6 +39,15 @@ bgfx::TextureHandle loadTexture(const char* _name,
                                 bgfx::TextureInfo* _info = NULL,
                                 bimg::Orientation::Enum* _orientation = NULL);
 
+/// Same as above for an image already in memory, _name is only used as the debug name.
+bgfx::TextureHandle loadTexture(const void* _data,
+                                uint32_t _size,
+                                const char* _name,
+                                uint64_t _flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                uint8_t _skip = 0,
+                                bgfx::TextureInfo* _info = NULL,
+                                bimg::Orientation::Enum* _orientation = NULL);
+
 ///
 bimg::ImageContainer* imageLoad(const void* data, uint32_t size, bgfx::TextureFormat::Enum _dstFormat = bgfx::TextureFormat::Count);
 bimg::ImageContainer* imageLoad(const char* _filePath, bgfx::TextureFormat::Enum _dstFormat = bgfx::TextureFormat::Count);
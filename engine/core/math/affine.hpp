@@ -0,0 +1,209 @@
+#pragma once
+//-----------------------------------------------------------------------------
+// affine Header Includes
+//-----------------------------------------------------------------------------
+#include "transform.hpp"
+
+namespace math
+{
+using namespace glm;
+
+/**
+ * @brief Compact translation, rotation and scale transform for hot paths.
+ *
+ * Unlike transform_t it keeps no matrix and no skew or perspective, so it never has to
+ * decompose. Composing, inverting and interpolating work directly on the components.
+ * Composition is exact as long as the result has no skew, see can_compose_exactly. Use
+ * transform_t where skew or perspective matter, e.g. in the editor.
+ */
+template<typename T, precision Q = defaultp>
+struct affine_t
+{
+    using mat4_t = mat<4, 4, T, Q>;
+    using vec3_t = vec<3, T, Q>;
+    using quat_t = qua<T, Q>;
+    using transform_type = transform_t<T, Q>;
+
+    affine_t() = default;
+
+    /**
+     * @brief Constructor from components.
+     */
+    affine_t(const vec3_t& t, const quat_t& r, const vec3_t& s = vec3_t(T(1))) noexcept;
+
+    /**
+     * @brief Constructor from a transform, dropping any skew and perspective.
+     */
+    explicit affine_t(const transform_type& t) noexcept;
+
+    /**
+     * @brief Checks if a transform has no skew and no perspective, so it converts without loss.
+     */
+    static auto is_representable(const transform_type& t) noexcept -> bool;
+
+    /**
+     * @brief Checks if parent * child can be represented without skew. That holds when the
+     * parent scale is uniform or the child is not rotated.
+     */
+    static auto can_compose_exactly(const affine_t& parent, const affine_t& child) noexcept -> bool;
+
+    /**
+     * @brief Gets the identity transform.
+     */
+    static auto identity() noexcept -> affine_t;
+
+    /**
+     * @brief Composes two transforms, applying t first.
+     */
+    auto operator*(const affine_t& t) const noexcept -> affine_t;
+
+    /**
+     * @brief Gets the inverse. Exact for uniform scale.
+     */
+    auto inverse() const noexcept -> affine_t;
+
+    /**
+     * @brief Transforms a point.
+     */
+    auto transform_coord(const vec3_t& v) const noexcept -> vec3_t;
+
+    /**
+     * @brief Transforms a direction, ignoring translation.
+     */
+    auto transform_normal(const vec3_t& v) const noexcept -> vec3_t;
+
+    auto has_uniform_scale() const noexcept -> bool;
+
+    /**
+     * @brief Builds the equivalent 4x4 matrix.
+     */
+    auto to_mat4() const noexcept -> mat4_t;
+
+    /**
+     * @brief Builds the equivalent full transform.
+     */
+    auto to_transform() const noexcept -> transform_type;
+
+    vec3_t translation = glm::zero<vec3_t>();
+    quat_t rotation = glm::identity<quat_t>();
+    vec3_t scale = glm::one<vec3_t>();
+};
+
+template<typename T, precision Q>
+TRANSFORM_INLINE affine_t<T, Q>::affine_t(const vec3_t& t, const quat_t& r, const vec3_t& s) noexcept
+    : translation(t)
+    , rotation(r)
+    , scale(s)
+{
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE affine_t<T, Q>::affine_t(const transform_type& t) noexcept
+    : translation(t.get_translation())
+    , rotation(t.get_rotation())
+    , scale(t.get_scale())
+{
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::is_representable(const transform_type& t) noexcept -> bool
+{
+    return glm::all(glm::epsilonEqual(t.get_skew(), glm::zero<vec3_t>(), glm::epsilon<T>())) &&
+           glm::all(glm::epsilonEqual(t.get_perspective(), vec<4, T, Q>(0, 0, 0, 1), glm::epsilon<T>()));
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::can_compose_exactly(const affine_t& parent, const affine_t& child) noexcept
+    -> bool
+{
+    if(parent.has_uniform_scale())
+    {
+        return true;
+    }
+
+    return glm::abs(glm::dot(child.rotation, glm::identity<quat_t>())) >= T(1) - glm::epsilon<T>();
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::identity() noexcept -> affine_t
+{
+    return {};
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::operator*(const affine_t& t) const noexcept -> affine_t
+{
+    affine_t result;
+    result.translation = translation + rotation * (scale * t.translation);
+    result.rotation = rotation * t.rotation;
+    result.scale = scale * t.scale;
+    return result;
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::inverse() const noexcept -> affine_t
+{
+    affine_t result;
+    result.rotation = glm::conjugate(rotation);
+    result.scale = T(1) / scale;
+    result.translation = result.scale * (result.rotation * -translation);
+    return result;
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::transform_coord(const vec3_t& v) const noexcept -> vec3_t
+{
+    return translation + rotation * (scale * v);
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::transform_normal(const vec3_t& v) const noexcept -> vec3_t
+{
+    return rotation * (scale * v);
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::has_uniform_scale() const noexcept -> bool
+{
+    const T epsilon = glm::epsilon<T>();
+    return glm::abs(scale.x - scale.y) < epsilon && glm::abs(scale.y - scale.z) < epsilon;
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::to_mat4() const noexcept -> mat4_t
+{
+    auto m = mat4_t(glm::mat3_cast(rotation));
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    m[3] = vec<4, T, Q>(translation, T(1));
+    return m;
+}
+
+template<typename T, precision Q>
+TRANSFORM_INLINE auto affine_t<T, Q>::to_transform() const noexcept -> transform_type
+{
+    transform_type result;
+    result.set_position(translation);
+    result.set_rotation(rotation);
+    result.set_scale(scale);
+    return result;
+}
+
+/**
+ * @brief Interpolates translation and scale linearly and rotation spherically.
+ */
+template<typename T, precision Q>
+TRANSFORM_INLINE auto interpolate(const affine_t<T, Q>& a, const affine_t<T, Q>& b, T factor) noexcept
+    -> affine_t<T, Q>
+{
+    affine_t<T, Q> result;
+    result.translation = glm::mix(a.translation, b.translation, factor);
+    result.rotation = glm::slerp(a.rotation, b.rotation, factor);
+    result.scale = glm::mix(a.scale, b.scale, factor);
+    return result;
+}
+
+using affine = affine_t<float>;
+
+} // namespace math
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "affine.hpp"
 #include "bbox.h"
 #include "bsphere.h"
 #include "frustum.h"
 #include "math_types.h"
+#include "obb_soa.h"
 #include "plane.h"
 #include "transform.hpp"
 
@@ -0,0 +1,222 @@
+#include "obb_soa.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_OBB_SOA_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace math
+{
+namespace
+{
+
+// A box is outside a plane when its center is further in front of the plane
+// than its projected radius. This is the same as all 8 corners being in front.
+inline auto is_outside(const plane& p, const obb_soa& boxes, size_t i) -> bool
+{
+    const auto& n = p.data;
+    float dist = n.x * boxes.center[0][i] + n.y * boxes.center[1][i] + n.z * boxes.center[2][i] + n.w;
+
+    float radius = 0.0f;
+    for(size_t a = 0; a < 3; ++a)
+    {
+        const auto& u = boxes.half_axis[a];
+        radius += glm::abs(n.x * u[0][i] + n.y * u[1][i] + n.z * u[2][i]);
+    }
+
+    return dist - radius > 0.0f;
+}
+
+void test_scalar(const frustum& f, const obb_soa& boxes, size_t begin, size_t end, uint8_t* results)
+{
+    for(size_t i = begin; i < end; ++i)
+    {
+        bool outside = false;
+        for(const auto& p : f.planes)
+        {
+            if(is_outside(p, boxes, i))
+            {
+                outside = true;
+                break;
+            }
+        }
+
+        results[i - begin] = outside ? 0 : 1;
+    }
+}
+
+#if defined(__AVX__)
+
+constexpr size_t lanes = 8;
+
+auto test_wide(const frustum& f, const obb_soa& boxes, size_t begin, size_t end, uint8_t* results) -> size_t
+{
+    const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    size_t i = begin;
+    for(; i + lanes <= end; i += lanes)
+    {
+        __m256 cx = _mm256_loadu_ps(&boxes.center[0][i]);
+        __m256 cy = _mm256_loadu_ps(&boxes.center[1][i]);
+        __m256 cz = _mm256_loadu_ps(&boxes.center[2][i]);
+
+        __m256 ux[3], uy[3], uz[3];
+        for(size_t a = 0; a < 3; ++a)
+        {
+            ux[a] = _mm256_loadu_ps(&boxes.half_axis[a][0][i]);
+            uy[a] = _mm256_loadu_ps(&boxes.half_axis[a][1][i]);
+            uz[a] = _mm256_loadu_ps(&boxes.half_axis[a][2][i]);
+        }
+
+        __m256 outside = _mm256_setzero_ps();
+        for(const auto& p : f.planes)
+        {
+            __m256 nx = _mm256_set1_ps(p.data.x);
+            __m256 ny = _mm256_set1_ps(p.data.y);
+            __m256 nz = _mm256_set1_ps(p.data.z);
+            __m256 nw = _mm256_set1_ps(p.data.w);
+
+            __m256 dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)),
+                _mm256_add_ps(_mm256_mul_ps(nz, cz), nw));
+
+            __m256 radius = _mm256_setzero_ps();
+            for(size_t a = 0; a < 3; ++a)
+            {
+                __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, ux[a]), _mm256_mul_ps(ny, uy[a])),
+                                         _mm256_mul_ps(nz, uz[a]));
+                radius = _mm256_add_ps(radius, _mm256_and_ps(d, sign_mask));
+            }
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_sub_ps(dist, radius), _mm256_setzero_ps(), _CMP_GT_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(outside);
+        for(size_t l = 0; l < lanes; ++l)
+        {
+            results[i - begin + l] = (mask & (1 << l)) ? 0 : 1;
+        }
+    }
+
+    return i;
+}
+
+#elif defined(MATH_OBB_SOA_SSE)
+
+constexpr size_t lanes = 4;
+
+auto test_wide(const frustum& f, const obb_soa& boxes, size_t begin, size_t end, uint8_t* results) -> size_t
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    size_t i = begin;
+    for(; i + lanes <= end; i += lanes)
+    {
+        __m128 cx = _mm_loadu_ps(&boxes.center[0][i]);
+        __m128 cy = _mm_loadu_ps(&boxes.center[1][i]);
+        __m128 cz = _mm_loadu_ps(&boxes.center[2][i]);
+
+        __m128 ux[3], uy[3], uz[3];
+        for(size_t a = 0; a < 3; ++a)
+        {
+            ux[a] = _mm_loadu_ps(&boxes.half_axis[a][0][i]);
+            uy[a] = _mm_loadu_ps(&boxes.half_axis[a][1][i]);
+            uz[a] = _mm_loadu_ps(&boxes.half_axis[a][2][i]);
+        }
+
+        __m128 outside = _mm_setzero_ps();
+        for(const auto& p : f.planes)
+        {
+            __m128 nx = _mm_set1_ps(p.data.x);
+            __m128 ny = _mm_set1_ps(p.data.y);
+            __m128 nz = _mm_set1_ps(p.data.z);
+            __m128 nw = _mm_set1_ps(p.data.w);
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                     _mm_add_ps(_mm_mul_ps(nz, cz), nw));
+
+            __m128 radius = _mm_setzero_ps();
+            for(size_t a = 0; a < 3; ++a)
+            {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ux[a]), _mm_mul_ps(ny, uy[a])),
+                                      _mm_mul_ps(nz, uz[a]));
+                radius = _mm_add_ps(radius, _mm_and_ps(d, sign_mask));
+            }
+
+            outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(dist, radius), _mm_setzero_ps()));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for(size_t l = 0; l < lanes; ++l)
+        {
+            results[i - begin + l] = (mask & (1 << l)) ? 0 : 1;
+        }
+    }
+
+    return i;
+}
+
+#else
+
+auto test_wide(const frustum&, const obb_soa&, size_t begin, size_t, uint8_t*) -> size_t
+{
+    return begin;
+}
+
+#endif
+
+} // namespace
+
+void obb_soa::resize(size_t count)
+{
+    for(auto& c : center)
+    {
+        c.resize(count);
+    }
+
+    for(auto& axis : half_axis)
+    {
+        for(auto& c : axis)
+        {
+            c.resize(count);
+        }
+    }
+}
+
+auto obb_soa::size() const -> size_t
+{
+    return center[0].size();
+}
+
+void obb_soa::set(size_t index, const bbox& bounds, const transform& t)
+{
+    const auto& m = t.get_matrix();
+
+    const vec3 local_center = bounds.get_center();
+    const vec3 local_extents = bounds.get_extents();
+
+    const vec4 world_center = m * vec4(local_center, 1.0f);
+    for(int c = 0; c < 3; ++c)
+    {
+        center[c][index] = world_center[c];
+    }
+
+    for(int a = 0; a < 3; ++a)
+    {
+        const vec3 axis = vec3(m[a]) * local_extents[a];
+        for(int c = 0; c < 3; ++c)
+        {
+            half_axis[a][c][index] = axis[c];
+        }
+    }
+}
+
+void test_obb_batch(const frustum& f, const obb_soa& boxes, size_t begin, size_t end, uint8_t* results)
+{
+    auto tail = test_wide(f, boxes, begin, end, results);
+    test_scalar(f, boxes, tail, end, results + (tail - begin));
+}
+
+} // namespace math
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "bbox.h"
+#include "frustum.h"
+#include "transform.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace math
+{
+using namespace glm;
+
+/**
+ * @brief Oriented bounding boxes stored as structure of arrays.
+ *
+ * Each box is stored as a world space center and three half axes (the box axes scaled
+ * by the half extents), which is all that is needed to test it against a plane.
+ * The layout allows testing several boxes per plane with SIMD instructions.
+ */
+struct obb_soa
+{
+    /**
+     * @brief Resizes the storage.
+     *
+     * @param count The new number of boxes.
+     */
+    void resize(size_t count);
+
+    /**
+     * @brief Gets the number of boxes.
+     */
+    auto size() const -> size_t;
+
+    /**
+     * @brief Stores a local bounding box transformed by a world transform.
+     *
+     * @param index The index of the box.
+     * @param bounds The local bounding box.
+     * @param t The world transform.
+     */
+    void set(size_t index, const bbox& bounds, const transform& t);
+
+    ///< World space centers.
+    std::array<std::vector<float>, 3> center;
+    ///< Half axes, indexed as [axis][component].
+    std::array<std::array<std::vector<float>, 3>, 3> half_axis;
+};
+
+/**
+ * @brief Tests a range of oriented bounding boxes against a frustum.
+ *
+ * Gives the same answer as frustum::test_obb for every box. Uses AVX when available at
+ * compile time, then SSE, then a scalar fallback.
+ *
+ * @param f The frustum.
+ * @param boxes The boxes.
+ * @param begin Index of the first box to test.
+ * @param end One past the index of the last box to test.
+ * @param results Receives 1 for inside or intersecting and 0 for outside, indexed from begin.
+ */
+void test_obb_batch(const frustum& f, const obb_soa& boxes, size_t begin, size_t end, uint8_t* results);
+
+} // namespace math
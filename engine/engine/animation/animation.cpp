@@ -0,0 +1,424 @@
+#include "animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ace
+{
+
+namespace
+{
+// Sample indices are stored in 16 bits.
+constexpr uint32_t max_frame_count = 65536;
+
+// All but the largest component of a unit quaternion are within this range.
+constexpr float smallest_three_range = 0.70710678f;
+
+/**
+ * @brief Interpolates between keyframes to find the appropriate value at the current time.
+ * @tparam T The type of value being interpolated (e.g., vec3 or quat).
+ * @param keys The list of keyframes.
+ * @param time The current animation time.
+ * @return The interpolated value.
+ */
+template<typename T>
+auto interpolate(const std::vector<animation_channel::key<T>>& keys, animation_clip::seconds_t time) -> T
+{
+    if(keys.empty())
+    {
+        return {}; // Return default value if there are no keys
+    }
+
+    // Do binary search for keyframe
+    int high = (int)keys.size(), low = -1;
+    while(high - low > 1)
+    {
+        int probe = (high + low) / 2;
+        if(keys[probe].time < time)
+        {
+            low = probe;
+        }
+        else
+        {
+            high = probe;
+        }
+    }
+
+    if(low == -1)
+    {
+        // Before first key, return first key
+        return keys.front().value;
+    }
+
+    if(high == (int)keys.size())
+    {
+        // Beyond last key, return last key
+        return keys.back().value;
+    }
+
+    const auto& key1 = keys[low];
+    const auto& key2 = keys[low + 1];
+
+    // Compute the interpolation factor (0.0 to 1.0)
+    float factor = (time.count() - key1.time.count()) / (key2.time.count() - key1.time.count());
+
+    // Perform the interpolation
+    if constexpr(std::is_same_v<T, math::vec3>)
+    {
+        return math::lerp(key1.value, key2.value, factor);
+    }
+    else if constexpr(std::is_same_v<T, math::quat>)
+    {
+        return math::slerp(key1.value, key2.value, factor);
+    }
+
+    return {};
+}
+
+auto blend_values(const math::vec3& lhs, const math::vec3& rhs, float factor) -> math::vec3
+{
+    return math::lerp(lhs, rhs, factor);
+}
+
+auto blend_values(const math::quat& lhs, const math::quat& rhs, float factor) -> math::quat
+{
+    return math::slerp(lhs, rhs, factor);
+}
+
+auto value_error(const math::vec3& lhs, const math::vec3& rhs) -> float
+{
+    return math::length(lhs - rhs);
+}
+
+auto value_error(const math::quat& lhs, const math::quat& rhs) -> float
+{
+    // Angle between the rotations.
+    return 2.0f * std::acos(std::min(1.0f, std::abs(math::dot(lhs, rhs))));
+}
+
+auto quantize(float value, float min, float extent) -> uint16_t
+{
+    if(extent <= 0.0f)
+    {
+        return 0;
+    }
+    return uint16_t(std::lround(std::clamp((value - min) / extent, 0.0f, 1.0f) * 65535.0f));
+}
+
+auto dequantize(uint16_t value, float min, float extent) -> float
+{
+    return min + extent * (float(value) / 65535.0f);
+}
+
+void encode(const math::vec3& value, const compressed_animation::track& track, uint16_t* out)
+{
+    for(int i = 0; i < 3; ++i)
+    {
+        out[i] = quantize(value[i], track.min[i], track.extent[i]);
+    }
+}
+
+void decode(const uint16_t* in, const compressed_animation::track& track, math::vec3& value)
+{
+    for(int i = 0; i < 3; ++i)
+    {
+        value[i] = dequantize(in[i], track.min[i], track.extent[i]);
+    }
+}
+
+// Smallest three, 15 bits per component, the index of the dropped largest one in the top bits of the first two.
+void encode(const math::quat& value, const compressed_animation::track&, uint16_t* out)
+{
+    int largest = 0;
+    for(int i = 1; i < 4; ++i)
+    {
+        if(std::abs(value[i]) > std::abs(value[largest]))
+        {
+            largest = i;
+        }
+    }
+
+    // q and -q are the same rotation, the dropped component is restored as positive.
+    const float sign = value[largest] < 0.0f ? -1.0f : 1.0f;
+
+    int n = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(i != largest)
+        {
+            float normalized = std::clamp(value[i] * sign / smallest_three_range * 0.5f + 0.5f, 0.0f, 1.0f);
+            out[n++] = uint16_t(std::lround(normalized * 32767.0f));
+        }
+    }
+
+    out[0] |= uint16_t((largest & 1) << 15);
+    out[1] |= uint16_t((largest >> 1) << 15);
+}
+
+void decode(const uint16_t* in, const compressed_animation::track&, math::quat& value)
+{
+    const int largest = int(in[0] >> 15) | (int(in[1] >> 15) << 1);
+
+    float sum = 0.0f;
+    int n = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(i != largest)
+        {
+            float component = (float(in[n++] & 0x7fff) / 32767.0f * 2.0f - 1.0f) * smallest_three_range;
+            value[i] = component;
+            sum += component * component;
+        }
+    }
+
+    value[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+}
+
+/**
+ * @brief Resamples, quantizes and reduces the keys of one track and appends it to the set.
+ */
+template<typename T>
+void compress_track(const std::vector<animation_channel::key<T>>& keys,
+                    const std::vector<animation_clip::seconds_t>& times,
+                    float tolerance,
+                    compressed_animation::track_set& set)
+{
+    auto& track = set.tracks.emplace_back();
+    track.first_key = uint32_t(set.frames.size());
+    if(keys.empty())
+    {
+        return;
+    }
+
+    std::vector<T> samples;
+    samples.reserve(times.size());
+    for(const auto& time : times)
+    {
+        samples.emplace_back(interpolate(keys, time));
+    }
+
+    if constexpr(std::is_same_v<T, math::vec3>)
+    {
+        auto min = samples.front();
+        auto max = samples.front();
+        for(const auto& sample : samples)
+        {
+            min = math::min(min, sample);
+            max = math::max(max, sample);
+        }
+        track.min = min;
+        track.extent = max - min;
+    }
+
+    // Keys are chosen from the quantized samples so the tolerance covers the quantization as well.
+    std::vector<uint16_t> encoded(samples.size() * 3);
+    std::vector<T> decoded(samples.size());
+    for(size_t i = 0; i < samples.size(); ++i)
+    {
+        encode(samples[i], track, &encoded[i * 3]);
+        decode(&encoded[i * 3], track, decoded[i]);
+    }
+
+    auto reproduces = [&](size_t first, size_t last)
+    {
+        for(size_t i = first + 1; i < last; ++i)
+        {
+            float factor = float(i - first) / float(last - first);
+            if(value_error(blend_values(decoded[first], decoded[last], factor), samples[i]) > tolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<uint32_t> kept{0};
+
+    bool constant = std::all_of(samples.begin(),
+                                samples.end(),
+                                [&](const T& sample)
+                                {
+                                    return value_error(decoded.front(), sample) <= tolerance;
+                                });
+    if(!constant)
+    {
+        // Greedy, every key reaches as far as linear interpolation stays within the tolerance.
+        const size_t last = samples.size() - 1;
+        size_t first = 0;
+        while(first < last)
+        {
+            size_t next = first + 1;
+            while(next < last && reproduces(first, next + 1))
+            {
+                next++;
+            }
+
+            kept.emplace_back(uint32_t(next));
+            first = next;
+        }
+    }
+
+    track.key_count = uint32_t(kept.size());
+    for(auto frame : kept)
+    {
+        set.frames.emplace_back(uint16_t(frame));
+        set.values.insert(set.values.end(), &encoded[frame * 3], &encoded[frame * 3] + 3);
+    }
+}
+
+/**
+ * @brief Samples one track, stepping its key forward from the last sample.
+ */
+template<typename T>
+auto sample_track(const compressed_animation::track_set& set, size_t index, float frame, uint32_t& key) -> T
+{
+    const auto& track = set.tracks[index];
+    if(track.key_count == 0)
+    {
+        return {};
+    }
+
+    const auto* frames = set.frames.data() + track.first_key;
+    const auto* values = set.values.data() + size_t(track.first_key) * 3;
+    if(key >= track.key_count)
+    {
+        key = 0;
+    }
+    while(key + 1 < track.key_count && float(frames[key + 1]) <= frame)
+    {
+        key++;
+    }
+
+    T lhs{};
+    decode(values + size_t(key) * 3, track, lhs);
+    if(key + 1 >= track.key_count)
+    {
+        return lhs;
+    }
+
+    T rhs{};
+    decode(values + size_t(key + 1) * 3, track, rhs);
+
+    float factor = (frame - float(frames[key])) / float(frames[key + 1] - frames[key]);
+    return blend_values(lhs, rhs, factor);
+}
+
+auto is_skipped(const std::vector<uint8_t>* skipped_nodes, size_t node_index) -> bool
+{
+    return skipped_nodes && node_index < skipped_nodes->size() && (*skipped_nodes)[node_index] != 0;
+}
+
+} // namespace
+
+auto compress(animation_clip& clip, const animation_compression_settings& settings) -> bool
+{
+    if(clip.channels.empty())
+    {
+        return false;
+    }
+
+    const float duration = std::max(0.0f, clip.duration.count());
+    float sample_rate = std::max(1.0f, settings.sample_rate);
+
+    // Very long clips are sampled more coarsely to keep the indices in 16 bits.
+    auto frame_count = uint32_t(std::min(std::ceil(duration * sample_rate), float(max_frame_count - 1))) + 1;
+
+    // The rate is adjusted so the last sample falls exactly on the end of the clip.
+    if(duration > 0.0f)
+    {
+        sample_rate = float(frame_count - 1) / duration;
+    }
+
+    std::vector<animation_clip::seconds_t> times(frame_count);
+    for(uint32_t i = 0; i < frame_count; ++i)
+    {
+        times[i] = animation_clip::seconds_t(std::min(float(i) / sample_rate, duration));
+    }
+
+    compressed_animation out;
+    out.version = compressed_animation::current_version;
+    out.sample_rate = sample_rate;
+    out.frame_count = frame_count;
+
+    for(const auto& channel : clip.channels)
+    {
+        compress_track(channel.position_keys, times, settings.position_tolerance, out.positions);
+        compress_track(channel.rotation_keys, times, settings.rotation_tolerance, out.rotations);
+        compress_track(channel.scaling_keys, times, settings.scaling_tolerance, out.scalings);
+    }
+
+    for(auto& channel : clip.channels)
+    {
+        channel.position_keys = {};
+        channel.rotation_keys = {};
+        channel.scaling_keys = {};
+    }
+    clip.compressed = std::move(out);
+
+    return true;
+}
+
+void sample_animation(const animation_clip& clip,
+                      animation_clip::seconds_t time,
+                      animation_key_cursor& cursor,
+                      animation_pose& pose,
+                      const std::vector<uint8_t>* skipped_nodes)
+{
+    pose.nodes.clear();
+    pose.nodes.reserve(clip.channels.size());
+
+    const auto& anim = clip.compressed;
+    if(anim.version != compressed_animation::current_version)
+    {
+        for(const auto& channel : clip.channels)
+        {
+            if(is_skipped(skipped_nodes, channel.node_index))
+            {
+                continue;
+            }
+
+            math::vec3 position = interpolate(channel.position_keys, time);
+            math::quat rotation = interpolate(channel.rotation_keys, time);
+            math::vec3 scaling = interpolate(channel.scaling_keys, time);
+
+            auto& node = pose.nodes.emplace_back();
+            node.index = channel.node_index;
+            node.transform = math::affine(position, rotation, scaling);
+        }
+        return;
+    }
+
+    const auto channel_count = clip.channels.size();
+    if(anim.frame_count == 0 || anim.positions.tracks.size() != channel_count ||
+       anim.rotations.tracks.size() != channel_count || anim.scalings.tracks.size() != channel_count)
+    {
+        return;
+    }
+
+    const float frame = std::clamp(time.count() * anim.sample_rate, 0.0f, float(anim.frame_count - 1));
+    if(cursor.source != &anim || frame < cursor.frame || cursor.keys.size() != channel_count * 3)
+    {
+        cursor.source = &anim;
+        cursor.keys.assign(channel_count * 3, 0);
+    }
+    cursor.frame = frame;
+
+    for(size_t i = 0; i < channel_count; ++i)
+    {
+        if(is_skipped(skipped_nodes, clip.channels[i].node_index))
+        {
+            continue;
+        }
+
+        auto* keys = &cursor.keys[i * 3];
+        math::vec3 position = sample_track<math::vec3>(anim.positions, i, frame, keys[0]);
+        math::quat rotation = sample_track<math::quat>(anim.rotations, i, frame, keys[1]);
+        math::vec3 scaling = sample_track<math::vec3>(anim.scalings, i, frame, keys[2]);
+
+        auto& node = pose.nodes.emplace_back();
+        node.index = clip.channels[i].node_index;
+        node.transform = math::affine(position, rotation, scaling);
+    }
+}
+
+} // namespace ace
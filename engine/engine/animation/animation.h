@@ -4,12 +4,89 @@
 #include <math/math.h>
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace ace
 {
 
+/**
+ * @brief How much error the asset compiler may introduce when it compresses a clip.
+ */
+struct animation_compression_settings
+{
+    /// Rate the keys are resampled at, in samples per second.
+    float sample_rate{30.0f};
+
+    /// Largest position error a removed key may cause.
+    float position_tolerance{0.001f};
+
+    /// Largest rotation error a removed key may cause, in radians.
+    float rotation_tolerance{0.001f};
+
+    /// Largest scaling error a removed key may cause.
+    float scaling_tolerance{0.001f};
+};
+
+/**
+ * @brief Compressed tracks of a clip, written by the asset compiler.
+ *
+ * The keys are resampled at a uniform rate and every key that linear interpolation of its
+ * neighbours reproduces within the tolerance is removed. Times are stored as sample indices,
+ * positions and scalings are quantized to 16 bits per component within the range of their
+ * track and rotations are stored as their three smallest components. Each kind of track keeps
+ * its times and values in separate arrays. Bump version whenever the layout changes.
+ */
+struct compressed_animation
+{
+    static constexpr uint32_t current_version = 1;
+
+    /**
+     * @brief The keys of one channel for one of position, rotation or scaling.
+     */
+    struct track
+    {
+        /// Index of the first key in the arrays of the track set.
+        uint32_t first_key{};
+
+        /// Number of keys, the first one is at sample 0 and the last one at the last sample.
+        uint32_t key_count{};
+
+        /// Range the values are quantized in, unused by rotations.
+        math::vec3 min{};
+        math::vec3 extent{};
+    };
+
+    /**
+     * @brief The tracks of every channel for one of position, rotation or scaling.
+     */
+    struct track_set
+    {
+        /// One per channel.
+        std::vector<track> tracks;
+
+        /// Sample index of every key.
+        std::vector<uint16_t> frames;
+
+        /// Three quantized components per key.
+        std::vector<uint16_t> values;
+    };
+
+    /// Version the clip was compressed with, 0 if it is not compressed.
+    uint32_t version{};
+
+    /// Samples per second.
+    float sample_rate{};
+
+    /// Number of samples, the last one is at the duration of the clip.
+    uint32_t frame_count{};
+
+    track_set positions;
+    track_set rotations;
+    track_set scalings;
+};
+
 /**
  * @brief Struct representing a node animation.
  *
@@ -66,6 +143,67 @@ struct animation_clip
 
     /// The node animation_clip channels. Each channel affects a single node.
     std::vector<animation_channel> channels;
+
+    /// The tracks of the channels when the clip is compressed, the keys of the channels are empty then.
+    compressed_animation compressed;
+};
+
+/**
+ * @brief The transforms of the nodes a clip affects at one time.
+ */
+struct animation_pose
+{
+    struct node
+    {
+        size_t index{};
+        math::affine transform{};
+    };
+
+    std::vector<node> nodes;
+};
+
+/**
+ * @brief Remembers the last key of every compressed track a player sampled.
+ *
+ * Playback moves forward in time, so the next sample only steps from these keys to the next
+ * ones instead of searching, which makes sampling a track O(1). Sampling backward in time or
+ * another clip starts over from the first keys.
+ */
+struct animation_key_cursor
+{
+    /// The tracks the keys belong to.
+    const compressed_animation* source{};
+
+    /// Sample index of the last sample.
+    float frame{};
+
+    /// Three per channel, position, rotation and scaling, relative to the first key of the track.
+    std::vector<uint32_t> keys;
 };
 
+/**
+ * @brief Compresses the keys of a clip into its compressed tracks and drops the keys.
+ * @param clip The clip with its keys.
+ * @param settings The sample rate and the tolerances.
+ * @return False when the clip has no channels, it is left as it is then.
+ */
+auto compress(animation_clip& clip, const animation_compression_settings& settings) -> bool;
+
+/**
+ * @brief Samples the channels of a clip.
+ *
+ * Uses the compressed tracks when the clip has them, otherwise searches the keys.
+ *
+ * @param clip The clip.
+ * @param time Time since the start of the clip.
+ * @param cursor The keys of the last sample of this clip, updated.
+ * @param pose Receives one node per sampled channel.
+ * @param skipped_nodes Optional, indexed by node index, channels of nonzero nodes are not sampled.
+ */
+void sample_animation(const animation_clip& clip,
+                      animation_clip::seconds_t time,
+                      animation_key_cursor& cursor,
+                      animation_pose& pose,
+                      const std::vector<uint8_t>* skipped_nodes = nullptr);
+
 } // namespace ace
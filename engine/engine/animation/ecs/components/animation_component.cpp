@@ -1,72 +1,10 @@
 #include "animation_component.h"
 #include <hpp/utility/overload.hpp>
-namespace ace
-{
-
-namespace
-{
-/**
- * @brief Interpolates between keyframes to find the appropriate value at the current time.
- *  * @tparam T The type of value being interpolated (e.g., vec3 or quat).
- * @param keys The list of keyframes.
- * @param time The current animation time.
- * @return The interpolated value.
- */
-template<typename T>
-auto interpolate(const std::vector<animation_channel::key<T>>& keys, animation_player::seconds_t time) -> T
-{
-    if(keys.empty())
-    {
-        return {}; // Return default value if there are no keys
-    }
-
-    // Do binary search for keyframe
-    int high = (int)keys.size(), low = -1;
-    while(high - low > 1)
-    {
-        int probe = (high + low) / 2;
-        if(keys[probe].time < time)
-        {
-            low = probe;
-        }
-        else
-        {
-            high = probe;
-        }
-    }
-
-    if(low == -1)
-    {
-        // Before first key, return first key
-        return keys.front().value;
-    }
-
-    if(high == (int)keys.size())
-    {
-        // Beyond last key, return last key
-        return keys.back().value;
-    }
-
-    const auto& key1 = keys[low];
-    const auto& key2 = keys[low + 1];
-
-    // Compute the interpolation factor (0.0 to 1.0)
-    float factor = (time.count() - key1.time.count()) / (key2.time.count() - key1.time.count());
 
-    // Perform the interpolation
-    if constexpr(std::is_same_v<T, math::vec3>)
-    {
-        return math::lerp(key1.value, key2.value, factor);
-    }
-    else if constexpr(std::is_same_v<T, math::quat>)
-    {
-        return math::slerp(key1.value, key2.value, factor);
-    }
-
-    return {};
-}
+#include <algorithm>
 
-} // namespace
+namespace ace
+{
 
 auto blend(const math::transform& lhs, const math::transform& rhs, float factor) -> math::transform
 {
@@ -77,6 +15,11 @@ auto blend(const math::transform& lhs, const math::transform& rhs, float factor)
     return result;
 }
 
+auto blend(const math::affine& lhs, const math::affine& rhs, float factor) -> math::affine
+{
+    return math::interpolate(lhs, rhs, factor);
+}
+
 void blend_poses(const pose_transform& pose1, const pose_transform& pose2, float factor, pose_transform& result_pose)
 {
     // Determine the maximum number of transforms between both poses
@@ -152,7 +95,7 @@ void blend_poses(const std::vector<animation_pose>& poses,
     // Ensure all poses have the same number of nodes
     for(size_t i = 0; i < result_pose.nodes.size(); ++i)
     {
-        math::transform blended_transform;
+        math::affine blended_transform;
         float total_weight = 0.0f;
 
         for(size_t j = 0; j < poses.size(); ++j)
@@ -383,15 +326,15 @@ auto animation_player::update_time(seconds_t delta_time, bool force)
     return false;
 }
 
-void animation_player::update_poses(const update_callback_t& set_transform_callback)
+void animation_player::update_poses(const update_callback_t& set_transform_callback, const pose_options& options)
 {
     // Update current layer
-    update_pose(current_layer_);
+    update_pose(current_layer_, options);
 
     auto final_pose = &current_layer_.pose;
 
     // Update target layer
-    if(update_pose(target_layer_))
+    if(update_pose(target_layer_, options))
     {
         // Compute blend factor
         float blend_progress = get_blend_progress();
@@ -418,7 +361,7 @@ void animation_player::update_poses(const update_callback_t& set_transform_callb
     }
 }
 
-auto animation_player::update_pose(animation_layer& layer) -> bool
+auto animation_player::update_pose(animation_layer& layer, const pose_options& options) -> bool
 {
     auto& state = layer.state;
     auto& pose = layer.pose;
@@ -429,12 +372,30 @@ auto animation_player::update_pose(animation_layer& layer) -> bool
         // Compute blending weights based on current parameters (e.g., speed and direction)
         state.blend_space->compute_blend(parameters, state.blend_clips);
 
+        // The weights are relative when blending, so dropping the lightest clips needs no renormalizing.
+        if(options.max_blend_samples > 0 && state.blend_clips.size() > options.max_blend_samples)
+        {
+            std::partial_sort(state.blend_clips.begin(),
+                              state.blend_clips.begin() + options.max_blend_samples,
+                              state.blend_clips.end(),
+                              [](const auto& lhs, const auto& rhs)
+                              {
+                                  return lhs.second > rhs.second;
+                              });
+            state.blend_clips.resize(options.max_blend_samples);
+        }
+
         // Sample animations and blend poses
         state.blend_poses.resize(state.blend_clips.size());
+        state.blend_cursors.resize(state.blend_clips.size());
         for(size_t i = 0; i < state.blend_clips.size(); ++i)
         {
             const auto& clip_weight_pair = state.blend_clips[i];
-            sample_animation(clip_weight_pair.first.get().get(), state.elapsed, state.blend_poses[i]);
+            sample_animation(clip_weight_pair.first.get().get(),
+                             state.elapsed,
+                             state.blend_cursors[i],
+                             state.blend_poses[i],
+                             options.skipped_nodes);
         }
 
         // Blend all poses based on their weights
@@ -458,7 +419,7 @@ auto animation_player::update_pose(animation_layer& layer) -> bool
     }
     else if(state.clip)
     {
-        sample_animation(state.clip.get().get(), state.elapsed, pose);
+        sample_animation(state.clip.get().get(), state.elapsed, state.cursor, pose, options.skipped_nodes);
         return true;
     }
 
@@ -511,24 +472,11 @@ auto animation_player::compute_blend_factor(float normalized_blend_time) noexcep
 
 void animation_player::sample_animation(const animation_clip* anim_clip,
                                         seconds_t time,
-                                        animation_pose& pose) const noexcept
+                                        animation_key_cursor& cursor,
+                                        animation_pose& pose,
+                                        const std::vector<uint8_t>* skipped_nodes) const noexcept
 {
-    pose.nodes.clear();
-    pose.nodes.reserve(anim_clip->channels.size());
-
-    for(const auto& channel : anim_clip->channels)
-    {
-        math::vec3 position = interpolate(channel.position_keys, time);
-        math::quat rotation = interpolate(channel.rotation_keys, time);
-        math::vec3 scaling = interpolate(channel.scaling_keys, time);
-
-        auto& node = pose.nodes.emplace_back();
-        node.index = channel.node_index;
-
-        node.transform.set_position(position);
-        node.transform.set_rotation(rotation);
-        node.transform.set_scale(scaling);
-    }
+    ace::sample_animation(*anim_clip, time, cursor, pose, skipped_nodes);
 }
 
 auto animation_player::is_playing() const -> bool
@@ -579,4 +527,9 @@ auto animation_component::get_player() -> animation_player&
     return player_;
 }
 
+auto animation_component::get_lod_state() -> animation_lod_state&
+{
+    return lod_state_;
+}
+
 } // namespace ace
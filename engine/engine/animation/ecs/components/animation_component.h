@@ -13,18 +13,8 @@
 namespace ace
 {
 
-struct animation_pose
-{
-    struct node
-    {
-        size_t index{};
-        math::transform transform{};
-    };
-
-    std::vector<node> nodes;
-};
-
 auto blend(const math::transform& lhs, const math::transform& rhs, float factor) -> math::transform;
+auto blend(const math::affine& lhs, const math::affine& rhs, float factor) -> math::affine;
 
 void blend_poses(const pose_transform& pose1, const pose_transform& pose2, float factor, pose_transform& result_pose);
 
@@ -63,11 +53,13 @@ struct animation_state
 {
     asset_handle<animation_clip> clip{};
     animation_clip::seconds_t elapsed{};
+    animation_key_cursor cursor{};
 
     // Add blend space support
     std::shared_ptr<blend_space_def> blend_space{};
     std::vector<std::pair<asset_handle<animation_clip>, float>> blend_clips{};
     std::vector<animation_pose> blend_poses{};
+    std::vector<animation_key_cursor> blend_cursors{};
 };
 
 struct blend_over_time
@@ -100,6 +92,39 @@ struct blend_state
     hpp::variant<hpp::monostate, blend_over_time, blend_over_param> state{};
 };
 
+/**
+ * @brief How much of its animation a character updates, picked by its size on screen.
+ */
+enum class animation_lod : uint8_t
+{
+    full,    ///< Sampled every frame.
+    reduced, ///< Sampled every few frames and interpolated in between.
+    minimal, ///< Sampled every few frames without leaf bones and with a single blend space clip.
+    frozen,  ///< Keeps its last pose.
+    count
+};
+
+/**
+ * @brief Runtime state of the animation LOD of a character, not serialized.
+ */
+struct animation_lod_state
+{
+    animation_lod lod{animation_lod::full};
+
+    /// Frames since the pose was last sampled.
+    uint32_t frames_since_sample{};
+
+    /// Reduced LOD interpolates from the pose shown when sampling to the sampled one.
+    animation_pose from{};
+    animation_pose to{};
+    animation_pose shown{};
+
+    /// Nonzero for armature nodes without children, indexed by node index.
+    std::vector<uint8_t> leaf_nodes{};
+    /// The mesh the leaf nodes were collected from.
+    const void* leaf_source{};
+};
+
 /**
  * @brief Class responsible for playing animations on a skeletal mesh.
  *
@@ -110,7 +135,18 @@ class animation_player
 {
 public:
     using seconds_t = animation_clip::seconds_t;
-    using update_callback_t = std::function<void(/*const std::string&, */ size_t, const math::transform&)>;
+    using update_callback_t = std::function<void(/*const std::string&, */ size_t, const math::affine&)>;
+
+    /**
+     * @brief Limits what update_poses samples.
+     */
+    struct pose_options
+    {
+        /// Nodes left out of the pose, indexed by node index, nonzero to skip.
+        const std::vector<uint8_t>* skipped_nodes{};
+        /// Most blend space clips sampled, the ones with the largest weights are kept. 0 samples all.
+        size_t max_blend_samples{};
+    };
 
     /**
      * @brief Blends to the animation over the specified time with the specified easing
@@ -154,7 +190,7 @@ public:
      * @param set_transform_callback The callback function to set the transform of a node.
      */
     auto update_time(seconds_t delta_time, bool force = false) -> bool;
-    void update_poses(const update_callback_t& set_transform_callback);
+    void update_poses(const update_callback_t& set_transform_callback, const pose_options& options = {});
 
 
     /**
@@ -185,11 +221,15 @@ private:
     };
 
 
-    void sample_animation(const animation_clip* anim_clip, seconds_t time, animation_pose& pose) const noexcept;
+    void sample_animation(const animation_clip* anim_clip,
+                          seconds_t time,
+                          animation_key_cursor& cursor,
+                          animation_pose& pose,
+                          const std::vector<uint8_t>* skipped_nodes) const noexcept;
     auto compute_blend_factor(float normalized_blend_time) noexcept -> float;
     void update_state(seconds_t delta_time, animation_state& state);
     auto get_blend_progress() const -> float;
-    auto update_pose(animation_layer& layer) -> bool;
+    auto update_pose(animation_layer& layer, const pose_options& options) -> bool;
 
 
     animation_layer current_layer_{};
@@ -233,11 +273,15 @@ public:
     auto get_player() const -> const animation_player&;
     auto get_player() -> animation_player&;
 
+    auto get_lod_state() -> animation_lod_state&;
+
 private:
     asset_handle<animation_clip> animation_;
 
     animation_player player_;
 
+    animation_lod_state lod_state_;
+
     culling_mode culling_mode_{culling_mode::always_animate};
     bool auto_play_ = true;
 };
@@ -3,7 +3,9 @@
 #include <engine/animation/ecs/components/animation_component.h>
 #include <engine/ecs/components/transform_component.h>
 #include <engine/events.h>
+#include <engine/rendering/ecs/components/camera_component.h>
 #include <engine/rendering/ecs/components/model_component.h>
+#include <engine/rendering/mesh.h>
 
 #include <engine/ecs/ecs.h>
 #include <engine/engine.h>
@@ -11,11 +13,109 @@
 #include <engine/threading/threader.h>
 #include <logging/logging.h>
 
-#define POOLSTL_STD_SUPPLEMENT 1
-#include <poolstl/poolstl.hpp>
+#include <atomic>
 
 namespace ace
 {
+namespace
+{
+struct viewer
+{
+    math::vec3 position{};
+    float tan_half_fov{};
+    float ortho_size{};
+    bool orthographic{};
+};
+
+// The first camera in the scene stands in for the main camera.
+auto find_viewer(scene& scn, viewer& out) -> bool
+{
+    auto view = scn.registry->view<camera_component>();
+    if(view.begin() == view.end())
+    {
+        return false;
+    }
+
+    const auto& cam = view.get<camera_component>(*view.begin()).get_camera();
+    out.position = cam.get_position();
+    out.tan_half_fov = math::tan(math::radians(cam.get_fov() * 0.5f));
+    out.ortho_size = cam.get_ortho_size();
+    out.orthographic = cam.get_projection_mode() == projection_mode::orthographic;
+    return true;
+}
+
+// Height of the bounding sphere as a fraction of the screen height.
+auto get_screen_size(const viewer& v, const math::bbox& bounds) -> float
+{
+    if(!bounds.is_populated())
+    {
+        return 1.0f;
+    }
+
+    const float radius = math::length(bounds.get_extents());
+    if(v.orthographic)
+    {
+        return v.ortho_size > 0.0f ? radius / v.ortho_size : 1.0f;
+    }
+
+    const float distance = math::distance(v.position, bounds.get_center());
+    if(distance <= radius || v.tan_half_fov <= 0.0f)
+    {
+        return 1.0f;
+    }
+    return radius / (distance * v.tan_half_fov);
+}
+
+auto pick_lod(const animation_system::lod_settings& settings, float screen_size, bool can_freeze) -> animation_lod
+{
+    if(screen_size >= settings.reduced_size)
+    {
+        return animation_lod::full;
+    }
+    if(screen_size >= settings.minimal_size)
+    {
+        return animation_lod::reduced;
+    }
+    if(screen_size >= settings.frozen_size || !can_freeze)
+    {
+        return animation_lod::minimal;
+    }
+    return animation_lod::frozen;
+}
+
+void collect_leaf_nodes(const mesh::armature_node& node, std::vector<uint8_t>& leaves)
+{
+    // Depth first, like animation_channel::node_index.
+    leaves.emplace_back(node.children.empty() ? 1 : 0);
+    for(const auto& child : node.children)
+    {
+        collect_leaf_nodes(*child, leaves);
+    }
+}
+
+auto get_leaf_nodes(const model_component& model_comp, animation_lod_state& state) -> const std::vector<uint8_t>*
+{
+    auto lod = model_comp.get_model().get_lod(0);
+    if(!lod)
+    {
+        return nullptr;
+    }
+
+    const auto& mesh = lod.get();
+    const auto& root = mesh->get_armature();
+    if(state.leaf_source != mesh.get())
+    {
+        state.leaf_source = mesh.get();
+        state.leaf_nodes.clear();
+        if(root)
+        {
+            collect_leaf_nodes(*root, state.leaf_nodes);
+        }
+    }
+
+    return &state.leaf_nodes;
+}
+} // namespace
 
 auto animation_system::init(rtti::context& ctx) -> bool
 {
@@ -112,52 +212,147 @@ void animation_system::on_skip_next_frame(rtti::context& ctx)
 
 void animation_system::on_update(scene& scn, delta_t dt, bool force)
 {
-    APP_SCOPE_PERF("Animation System");
-
     auto& ctx = engine::context();
     auto& th = ctx.get_cached<threader>();
     // Create a view for entities with transform_component and submesh_component
     auto view = scn.registry->view<model_component, animation_component>();
 
+    const auto settings = lod_settings_;
+
+    // Skipping a frame steps every pose so the step is visible.
+    viewer v;
+    const bool use_lod = settings.enabled && !force && find_viewer(scn, v);
+    const auto frame = frame_++;
+
+    std::array<std::atomic<size_t>, size_t(animation_lod::count)> characters{};
+    std::atomic<size_t> sampled{};
+    std::atomic<size_t> interpolated{};
+
+    auto update_animation = [&](entt::entity entity)
+    {
+        auto& animation_comp = view.get<animation_component>(entity);
+        auto& model_comp = view.get<model_component>(entity);
+
+        auto& player = animation_comp.get_player();
+
+        player.blend_to(animation_comp.get_animation());
+
+        bool updated = player.update_time(dt, force);
+        if(!updated)
+        {
+            return;
+        }
+
+        const bool renderer_based =
+            animation_comp.get_culling_mode() == animation_component::culling_mode::renderer_based;
+
+        auto lod = animation_lod::full;
+        if(renderer_based && !model_comp.was_used_last_frame())
+        {
+            lod = animation_lod::frozen;
+        }
+        else if(use_lod)
+        {
+            lod = pick_lod(settings, get_screen_size(v, model_comp.get_world_bounds()), renderer_based);
+        }
+        characters[size_t(lod)]++;
+
+        auto& state = animation_comp.get_lod_state();
+        const bool lod_changed = state.lod != lod;
+        state.lod = lod;
+        state.frames_since_sample++;
+
+        if(lod == animation_lod::frozen)
+        {
+            return;
+        }
+
+        auto apply = [&](/*const std::string& node_id, */ size_t node_index, const math::affine& transform)
+        {
+            if(model_comp.uses_pose_buffer())
+            {
+                model_comp.set_local_pose(node_index, transform);
+            }
+
+            // Bone entities of a pose buffer armature only exist when something asked for them.
+            auto armature = model_comp.get_armature_by_index(node_index);
+            if(armature)
+            {
+                auto& armature_transform_comp = armature.template get<transform_component>();
+                armature_transform_comp.set_transform_local(transform.to_transform());
+            }
+        };
+
+        const uint32_t interval = lod == animation_lod::reduced   ? std::max(settings.reduced_interval, 1u)
+                                  : lod == animation_lod::minimal ? std::max(settings.minimal_interval, 1u)
+                                                                  : 1u;
+
+        // Spread by entity so characters sampled every few frames don't all sample on the same one.
+        const bool due = lod_changed || interval == 1 || (frame + entt::to_entity(entity)) % interval == 0;
+        if(!due)
+        {
+            if(lod == animation_lod::reduced)
+            {
+                float factor = std::min(float(state.frames_since_sample + 1) / float(interval), 1.0f);
+                blend_poses(state.from, state.to, factor, state.shown);
+                for(const auto& node : state.shown.nodes)
+                {
+                    apply(node.index, node.transform);
+                }
+                interpolated++;
+            }
+            return;
+        }
+
+        sampled++;
+        state.frames_since_sample = 0;
+
+        animation_player::pose_options options;
+        if(lod == animation_lod::minimal)
+        {
+            options.skipped_nodes = get_leaf_nodes(model_comp, state);
+            options.max_blend_samples = 1;
+        }
+
+        if(lod != animation_lod::reduced)
+        {
+            player.update_poses(apply, options);
+            return;
+        }
+
+        // The shown pose trails the sampled one by up to an interval and reaches it before the next sample.
+        std::swap(state.from, state.shown);
+        state.to.nodes.clear();
+        player.update_poses(
+            [&](size_t node_index, const math::affine& transform)
+            {
+                state.to.nodes.push_back({node_index, transform});
+            },
+            options);
+
+        if(lod_changed || state.from.nodes.size() != state.to.nodes.size())
+        {
+            state.from = state.to;
+        }
+
+        blend_poses(state.from, state.to, 1.0f / float(interval), state.shown);
+        for(const auto& node : state.shown.nodes)
+        {
+            apply(node.index, node.transform);
+        }
+    };
+
     // this code should be thread safe as each task works with a whole hierarchy and
-    // there is no interleaving between tasks.
-    std::for_each(std::execution::par,
-                  view.begin(),
-                  view.end(),
-                  [&](entt::entity entity)
-                  {
-                      auto& animation_comp = view.get<animation_component>(entity);
-                      auto& model_comp = view.get<model_component>(entity);
-
-                      bool should_update_poses = true;
-                      if(animation_comp.get_culling_mode() == animation_component::culling_mode::renderer_based)
-                      {
-                          if(!model_comp.was_used_last_frame())
-                          {
-                              should_update_poses = false;
-                          }
-                      }
-
-                      auto& player = animation_comp.get_player();
-
-                      player.blend_to(animation_comp.get_animation());
-
-                      bool updated = player.update_time(dt, force);
-
-                      if(updated && should_update_poses)
-                      {
-                          player.update_poses(
-                              [&](/*const std::string& node_id, */ size_t node_index, const math::transform& transform)
-                              {
-                                  auto armature = model_comp.get_armature_by_index(node_index);
-                                  if(armature)
-                                  {
-                                      auto& armature_transform_comp = armature.template get<transform_component>();
-                                      armature_transform_comp.set_transform_local(transform);
-                                  }
-                              });
-                      }
-                  });
+    // there is no interleaving between tasks. The view can't be split in ranges, so its entities are copied out.
+    std::vector<entt::entity> entities(view.begin(), view.end());
+    th.jobs->parallel_for_each(entities.begin(), entities.end(), update_animation);
+
+    for(size_t i = 0; i < characters.size(); ++i)
+    {
+        stats_.characters[i] = characters[i].load();
+    }
+    stats_.sampled = sampled.load();
+    stats_.interpolated = interpolated.load();
 }
 
 void animation_system::on_frame_update(scene& scn, delta_t dt)
@@ -165,4 +360,19 @@ void animation_system::on_frame_update(scene& scn, delta_t dt)
     on_update(scn, dt, false);
 }
 
+void animation_system::set_lod_settings(const lod_settings& settings)
+{
+    lod_settings_ = settings;
+}
+
+auto animation_system::get_lod_settings() const -> const lod_settings&
+{
+    return lod_settings_;
+}
+
+auto animation_system::get_stats() const -> const stats&
+{
+    return stats_;
+}
+
 } // namespace ace
@@ -2,13 +2,45 @@
 
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
+#include <engine/animation/ecs/components/animation_component.h>
 #include <engine/ecs/scene.h>
 
+#include <array>
+
 namespace ace
 {
 class animation_system
 {
 public:
+    /**
+     * @struct lod_settings
+     * @brief Picks the animation LOD of a character by the height of its bounds on screen.
+     *
+     * Sizes are fractions of the screen height as seen from the first camera in the scene.
+     * Characters sampled every few frames are spread over the frames by entity, which keeps
+     * the cost per frame flat.
+     */
+    struct lod_settings
+    {
+        bool enabled{true};
+        float reduced_size{0.2f};     ///< Smaller characters use animation_lod::reduced.
+        float minimal_size{0.05f};    ///< Smaller characters use animation_lod::minimal.
+        float frozen_size{0.01f};     ///< Smaller renderer based characters are frozen.
+        uint32_t reduced_interval{2}; ///< Frames between samples at animation_lod::reduced.
+        uint32_t minimal_interval{4}; ///< Frames between samples at animation_lod::minimal.
+    };
+
+    /**
+     * @struct stats
+     * @brief Counts of the last update.
+     */
+    struct stats
+    {
+        std::array<size_t, size_t(animation_lod::count)> characters{}; ///< Playing characters at each LOD.
+        size_t sampled{};      ///< Characters whose clips were sampled.
+        size_t interpolated{}; ///< Characters that interpolated between samples.
+    };
+
     auto init(rtti::context& ctx) -> bool;
     auto deinit(rtti::context& ctx) -> bool;
 
@@ -33,6 +65,11 @@ public:
      */
     void on_frame_update(scene& scn, delta_t dt);
 
+    void set_lod_settings(const lod_settings& settings);
+    auto get_lod_settings() const -> const lod_settings&;
+
+    auto get_stats() const -> const stats&;
+
 private:
 
 
@@ -70,5 +107,11 @@ private:
 
 
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
+
+    lod_settings lod_settings_;
+    stats stats_;
+
+    /// Frames updated so far, staggers the characters sampled every few frames.
+    uint64_t frame_{};
 };
 } // namespace ace
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace ace
 {
 
@@ -9,4 +11,33 @@ enum class load_flags
     reload,
     do_not_unload
 };
+
+/**
+ * @struct load_priority
+ * @brief Order in which queued asset loads are serviced.
+ */
+struct load_priority
+{
+    enum class level : uint8_t
+    {
+        blocking,  ///< The caller waits for the asset right away.
+        high,      ///< Needed for the current frame or scene.
+        normal,    ///< Default.
+        background ///< Thumbnails, previews and other speculative loads.
+    };
+
+    level band{level::normal};
+    /// Orders loads within a band, lower first, e.g. the distance to the camera.
+    float distance{};
+
+    auto operator<(const load_priority& rhs) const -> bool
+    {
+        if(band != rhs.band)
+        {
+            return band < rhs.band;
+        }
+        return distance < rhs.distance;
+    }
+};
+
 } // namespace ace
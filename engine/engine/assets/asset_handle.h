@@ -9,6 +9,7 @@
 
 
 #include "../threading/threader.h"
+#include "impl/asset_stream.h"
 
 template<typename T>
 using task_future = tpp::job_shared_future<T>;
@@ -32,6 +33,8 @@ struct asset_link
     task_future_t task{};
     /// Weak pointer to the asset.
     weak_asset_t weak_asset{};
+    /// Streaming request of the load, empty for assets created from an instance.
+    std::shared_ptr<asset_request> request{};
 };
 
 /**
@@ -127,6 +130,10 @@ struct asset_handle
         {
             if(!ready)
             {
+                if(link_->request)
+                {
+                    link_->request->set_priority({load_priority::level::blocking});
+                }
                 link_->task.change_priority(tpp::priority::high());
             }
 
@@ -184,6 +191,40 @@ struct asset_handle
         ensure();
         link_->task = future;
         link_->weak_asset = {};
+        link_->request = {};
+    }
+
+    /**
+     * @brief Sets the streaming request backing the internal job.
+     * @param request The request to set.
+     */
+    void set_internal_request(const std::shared_ptr<asset_request>& request)
+    {
+        ensure();
+        link_->request = request;
+    }
+
+    /**
+     * @brief Cancels the load if it has not been read yet.
+     */
+    void cancel() const
+    {
+        if(link_ && link_->request)
+        {
+            link_->request->cancel();
+        }
+    }
+
+    /**
+     * @brief Changes the priority of a load that is still queued, e.g. as the camera moves.
+     * @param priority The new priority.
+     */
+    void set_priority(const load_priority& priority) const
+    {
+        if(link_ && link_->request)
+        {
+            link_->request->set_priority(priority);
+        }
     }
 
     /**
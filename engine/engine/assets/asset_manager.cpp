@@ -32,6 +32,8 @@ auto asset_manager::init(rtti::context& ctx) -> bool
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
     importer::mesh_importer_init();
+    stream_.init();
+
     {
         auto& storage = add_storage<gfx::shader>();
         storage.load_from_file = asset_reader::load_from_file<gfx::shader>;
@@ -98,6 +100,8 @@ auto asset_manager::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
+    stream_.deinit();
+
     return true;
 }
 
@@ -110,11 +114,16 @@ void asset_manager::unload_all()
     }
 
     {
-        std::lock_guard<std::mutex> lock(db_mutex_);
+        std::unique_lock<std::shared_mutex> lock(db_mutex_);
         databases_.clear();
     }
 }
 
+auto asset_manager::get_stream() -> asset_stream&
+{
+    return stream_;
+}
+
 void asset_manager::unload_group(const std::string& group)
 {
     for(auto& pair : storages_)
@@ -134,11 +143,22 @@ auto asset_manager::get_database(const std::string& key) -> asset_database&
     return databases_[protocol.generic_string()];
 }
 
+auto asset_manager::find_database(const std::string& key) -> asset_database*
+{
+    auto protocol = fs::extract_protocol(fs::path(key));
+    auto it = databases_.find(protocol.generic_string());
+    if(it == databases_.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 void asset_manager::remove_database(const std::string& key)
 {
     auto protocol = fs::extract_protocol(fs::path(key));
 
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    std::unique_lock<std::shared_mutex> lock(db_mutex_);
     databases_.erase(protocol.generic_string());
 }
 
@@ -146,14 +166,14 @@ auto asset_manager::load_database(const std::string& protocol) -> bool
 {
     auto assets_pack = fs::resolve_protocol(protocol + "assets.pack");
 
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    std::unique_lock<std::shared_mutex> lock(db_mutex_);
     auto& db = get_database(protocol);
     return load_from_file(assets_pack.string(), db);
 }
 
 void asset_manager::save_database(const std::string& protocol, const fs::path& path)
 {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    std::unique_lock<std::shared_mutex> lock(db_mutex_);
     auto& db = get_database(protocol);
     save_to_file(path.string(), db);
 }
@@ -182,14 +202,23 @@ auto asset_manager::add_asset_info_for_path(const fs::path& path, const asset_me
 
 auto asset_manager::add_asset_info_for_key(const std::string& key, const asset_meta& meta) -> hpp::uuid
 {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    // Databases lock themselves, the manager lock only guards the map of databases.
+    {
+        std::shared_lock<std::shared_mutex> lock(db_mutex_);
+        if(auto db = find_database(key))
+        {
+            return db->add_asset(key, meta);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(db_mutex_);
     auto& db = get_database(key);
     return db.add_asset(key, meta);
 }
 
 auto asset_manager::get_metadata(const hpp::uuid& uid) -> asset_database::meta
 {
-    std::lock_guard<std::mutex> lock(db_mutex_);
+    std::shared_lock<std::shared_mutex> lock(db_mutex_);
     for(auto& kvp : databases_)
     {
         auto& db = kvp.second;
@@ -210,9 +239,11 @@ void asset_manager::remove_asset_info_for_path(const fs::path& path)
 
 void asset_manager::remove_asset_info_for_key(const std::string& key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    auto& db = get_database(key);
-    db.remove_asset(key);
+    std::shared_lock<std::shared_mutex> lock(db_mutex_);
+    if(auto db = find_database(key))
+    {
+        db->remove_asset(key);
+    }
 }
 
 } // namespace ace
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace ace
@@ -60,6 +61,12 @@ public:
      */
     void unload_group(const std::string& group);
 
+    /**
+     * @brief Gets the I/O stage of asset loading, e.g. for its queue depths and latencies.
+     * @return A reference to the stream.
+     */
+    auto get_stream() -> asset_stream&;
+
     /**
      * @brief Loads an asset database from a protocol.
      * @param protocol The protocol to load from.
@@ -130,14 +137,17 @@ public:
      * @tparam T The type of the asset.
      * @param key The key of the asset.
      * @param flags The load flags for the asset.
+     * @param priority The priority of the load if it is not loaded yet.
      * @return The handle to the asset.
      */
     template<typename T>
-    auto get_asset(const std::string& key, load_flags flags = load_flags::standard) -> asset_handle<T>
+    auto get_asset(const std::string& key, load_flags flags = load_flags::standard, load_priority priority = {})
+        -> asset_handle<T>
     {
         auto& storage = get_storage<T>();
         return load_asset_from_file_impl<T>(key,
                                             flags,
+                                            priority,
                                             storage.container_mutex,
                                             storage.container,
                                             storage.load_from_file);
@@ -148,21 +158,23 @@ public:
      * @tparam T The type of the asset.
      * @param uid The UUID of the asset.
      * @param flags The load flags for the asset.
+     * @param priority The priority of the load if it is not loaded yet.
      * @return The handle to the asset.
      */
     template<typename T>
-    auto get_asset(const hpp::uuid& uid, load_flags flags = load_flags::standard) -> asset_handle<T>
+    auto get_asset(const hpp::uuid& uid, load_flags flags = load_flags::standard, load_priority priority = {})
+        -> asset_handle<T>
     {
         auto meta = get_metadata(uid);
         if(!meta.location.empty())
         {
             const auto& key = meta.location;
-            return get_asset<T>(key, flags);
+            return get_asset<T>(key, flags, priority);
         }
 
         if(parent_)
         {
-            return parent_->get_asset<T>(uid, flags);
+            return parent_->get_asset<T>(uid, flags, priority);
         }
         return {};
     }
@@ -207,10 +219,13 @@ public:
     template<typename T>
     void rename_asset(const std::string& key, const std::string& new_key)
     {
-        for(auto& kvp : databases_)
         {
-            auto& db = kvp.second;
-            db.rename_asset(key, new_key);
+            std::shared_lock<std::shared_mutex> lock(db_mutex_);
+            for(auto& kvp : databases_)
+            {
+                auto& db = kvp.second;
+                db.rename_asset(key, new_key);
+            }
         }
 
         auto& storage = get_storage<T>();
@@ -314,6 +329,13 @@ private:
      */
     auto get_database(const std::string& group) -> asset_database&;
 
+    /**
+     * @brief Finds the asset database for a specified group without creating it.
+     * @param group The group to find the database for.
+     * @return A pointer to the asset database or nullptr.
+     */
+    auto find_database(const std::string& group) -> asset_database*;
+
     /**
      * @brief Removes an asset database for a specified group.
      * @param group The group to remove the database for.
@@ -333,6 +355,7 @@ private:
      * @tparam F The function to load the asset.
      * @param key The key of the asset.
      * @param flags The load flags for the asset.
+     * @param priority The priority of the load.
      * @param container_mutex The mutex for the asset container.
      * @param container The container for the assets.
      * @param load_func The function to load the asset.
@@ -341,6 +364,7 @@ private:
     template<typename T, typename F>
     auto load_asset_from_file_impl(const std::string& key,
                                    load_flags flags,
+                                   const load_priority& priority,
                                    std::recursive_mutex& container_mutex,
                                    typename asset_storage<T>::request_container_t& container,
                                    F&& load_func) -> asset_handle<T>
@@ -367,12 +391,13 @@ private:
 
             if(handle.task_id())
             {
+                handle.cancel();
                 pool_.stop(handle.task_id());
                 handle.invalidate();
             }
 
             handle.set_internal_ids(uid, key);
-            load_func(pool_, handle, key);
+            load_func(pool_, stream_, handle, key, priority);
         }
 
         return handle;
@@ -476,10 +501,12 @@ private:
 
     /// Thread pool for asset loading tasks.
     tpp::thread_pool& pool_;
+    /// I/O stage of asset loading.
+    asset_stream stream_;
     /// Different storages for assets.
     std::unordered_map<std::size_t, std::unique_ptr<basic_storage>> storages_{};
     /// Mutex for database operations.
-    std::mutex db_mutex_;
+    std::shared_mutex db_mutex_;
     /// Map of asset databases.
     std::map<std::string, asset_database, std::less<>> databases_{};
     /// Parent asset manager.
@@ -9,6 +9,7 @@
 #include <functional>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace ace
@@ -29,6 +30,9 @@ struct asset_meta
 /**
  * @class asset_database
  * @brief Manages asset metadata and provides functionality for adding, removing, and querying assets.
+ *
+ * Assets are keyed by uuid, with a hashed location index kept in sync for lookups by path.
+ * Queries take a shared lock so loader threads can read concurrently.
  */
 class asset_database
 {
@@ -73,8 +77,15 @@ public:
      */
     void set_database(const database_t& rhs)
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
+        std::unique_lock<std::shared_mutex> lock(asset_mutex_);
         asset_meta_ = rhs;
+
+        location_index_.clear();
+        location_index_.reserve(asset_meta_.size());
+        for(const auto& kvp : asset_meta_)
+        {
+            location_index_.emplace(kvp.second.location, kvp.first);
+        }
     }
 
     /**
@@ -82,8 +93,9 @@ public:
      */
     void remove_all()
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
+        std::unique_lock<std::shared_mutex> lock(asset_mutex_);
         asset_meta_.clear();
+        location_index_.clear();
     }
 
     /**
@@ -94,15 +106,20 @@ public:
      */
     auto add_asset(const std::string& location, const asset_meta& meta) -> hpp::uuid
     {
-        const auto& uid = get_uuid(location);
-        if(uid != hpp::uuid{})
+        std::unique_lock<std::shared_mutex> lock(asset_mutex_);
+
+        auto [it, inserted] = location_index_.emplace(location, meta.uid);
+        if(!inserted)
         {
-            return uid;
+            return it->second;
         }
 
-        std::lock_guard<std::mutex> lock(asset_mutex_);
-
         auto& metainfo = asset_meta_[meta.uid];
+        if(!metainfo.location.empty() && metainfo.location != location)
+        {
+            // The uid moved to a new location.
+            location_index_.erase(metainfo.location);
+        }
         metainfo.location = location;
         APPLOG_TRACE("{} - {} -> {}", __func__, hpp::to_string(meta.uid), location);
 
@@ -112,24 +129,19 @@ public:
     /**
      * @brief Gets the UUID of an asset based on its location.
      * @param location The location of the asset.
-     * @return The UUID of the asset.
+     * @return The UUID of the asset or an empty one.
      */
-    auto get_uuid(const std::string& location) -> const hpp::uuid&
+    auto get_uuid(const std::string& location) const -> hpp::uuid
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
+        std::shared_lock<std::shared_mutex> lock(asset_mutex_);
 
-        for(const auto& kvp : asset_meta_)
+        auto it = location_index_.find(location);
+        if(it == location_index_.end())
         {
-            const auto& uid = kvp.first;
-            const auto& metainfo = kvp.second;
-            if(metainfo.location == location)
-            {
-                return uid;
-            }
+            return {};
         }
 
-        static const hpp::uuid uid;
-        return uid;
+        return it->second;
     }
 
     /**
@@ -137,9 +149,9 @@ public:
      * @param id The UUID of the asset.
      * @return The metadata of the asset.
      */
-    auto get_metadata(const hpp::uuid& id) -> const meta&
+    auto get_metadata(const hpp::uuid& id) const -> const meta&
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
+        std::shared_lock<std::shared_mutex> lock(asset_mutex_);
 
         auto it = asset_meta_.find(id);
         if(it == asset_meta_.end())
@@ -158,18 +170,33 @@ public:
      */
     void rename_asset(const std::string& key, const std::string& new_key)
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
-        for(auto& kvp : asset_meta_)
+        std::unique_lock<std::shared_mutex> lock(asset_mutex_);
+
+        auto it = location_index_.find(key);
+        if(it == location_index_.end())
         {
-            auto& uid = kvp.first;
-            auto& metainfo = kvp.second;
-            if(metainfo.location == key)
-            {
-                APPLOG_TRACE("{}::{} - {} -> {}", __func__, hpp::to_string(uid), key, new_key);
+            return;
+        }
 
-                metainfo.location = new_key;
+        auto uid = it->second;
+        location_index_.erase(it);
+
+        // The renamed asset replaces whatever was at the destination.
+        auto existing = location_index_.find(new_key);
+        if(existing != location_index_.end())
+        {
+            if(existing->second != uid)
+            {
+                APPLOG_TRACE("{}::{} - {} replaced", __func__, hpp::to_string(existing->second), new_key);
+                asset_meta_.erase(existing->second);
             }
+            location_index_.erase(existing);
         }
+
+        location_index_[new_key] = uid;
+
+        APPLOG_TRACE("{}::{} - {} -> {}", __func__, hpp::to_string(uid), key, new_key);
+        asset_meta_[uid].location = new_key;
     }
 
     /**
@@ -178,26 +205,27 @@ public:
      */
     void remove_asset(const std::string& key)
     {
-        std::lock_guard<std::mutex> lock(asset_mutex_);
-        for(auto& kvp : asset_meta_)
-        {
-            auto& uid = kvp.first;
-            auto& metainfo = kvp.second;
-            if(metainfo.location == key)
-            {
-                APPLOG_TRACE("{}::{} - {}", __func__, hpp::to_string(uid), key);
+        std::unique_lock<std::shared_mutex> lock(asset_mutex_);
 
-                asset_meta_.erase(uid);
-                return;
-            }
+        auto it = location_index_.find(key);
+        if(it == location_index_.end())
+        {
+            return;
         }
+
+        APPLOG_TRACE("{}::{} - {}", __func__, hpp::to_string(it->second), key);
+
+        asset_meta_.erase(it->second);
+        location_index_.erase(it);
     }
 
 private:
     /// Mutex for asset database operations.
-    std::mutex asset_mutex_{};
-    /// The asset database.+
+    mutable std::shared_mutex asset_mutex_{};
+    /// The asset database.
     database_t asset_meta_{};
+    /// Location to uuid index of the asset database.
+    std::unordered_map<std::string, hpp::uuid> location_index_{};
 };
 
 /**
@@ -244,7 +272,8 @@ struct asset_storage : public basic_storage
     using callable = std::function<F>;
 
     /// Function type for loading from file.
-    using load_from_file_t = callable<bool(tpp::thread_pool& pool, asset_handle<T>&, const std::string&)>;
+    using load_from_file_t = callable<
+        bool(tpp::thread_pool& pool, asset_stream& stream, asset_handle<T>&, const std::string&, const load_priority&)>;
 
     /// Function type for loading from instance. Predicate function type.
     using predicate_t = callable<bool(const asset_handle<T>&)>;
@@ -259,6 +288,7 @@ struct asset_storage : public basic_storage
      */
     void unload_handle(tpp::thread_pool& pool, asset_handle<T>& handle)
     {
+        handle.cancel();
         pool.stop(handle.task_id());
         handle.invalidate();
     }
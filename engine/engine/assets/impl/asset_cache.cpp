@@ -0,0 +1,347 @@
+#include "asset_cache.h"
+
+#include <logging/logging.h>
+#include <uuid/uuid.h>
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+
+namespace ace
+{
+namespace
+{
+constexpr uint64_t fnv_offset = 14695981039346656037ull;
+constexpr uint64_t fnv_prime = 1099511628211ull;
+
+const char* artifact_name = "artifact";
+const char* extras_name = "extras";
+
+auto hash_file(const fs::path& file, uint64_t& size) -> uint64_t
+{
+    uint64_t hash = fnv_offset;
+    size = 0;
+
+    std::ifstream stream(file, std::ios::binary);
+    std::array<char, 64 * 1024> buffer{};
+    while(stream)
+    {
+        stream.read(buffer.data(), std::streamsize(buffer.size()));
+        auto count = size_t(stream.gcount());
+        for(size_t i = 0; i < count; ++i)
+        {
+            hash ^= uint8_t(buffer[i]);
+            hash *= fnv_prime;
+        }
+        size += count;
+    }
+
+    return hash;
+}
+
+auto to_hex(uint64_t value) -> std::string
+{
+    static const char* digits = "0123456789abcdef";
+
+    std::string result(16, '0');
+    for(int i = 15; i >= 0; --i)
+    {
+        result[size_t(i)] = digits[value & 0xf];
+        value >>= 4;
+    }
+    return result;
+}
+
+auto get_default_directory() -> fs::path
+{
+    if(const char* env = std::getenv("ACE_ASSET_CACHE"))
+    {
+        return env;
+    }
+
+    fs::error_code err;
+    return fs::temp_directory_path(err) / "ace" / "asset_cache";
+}
+
+} // namespace
+
+asset_cache::key_builder::key_builder(const std::string& compiler)
+{
+    hash_ = fnv_offset;
+    add(compiler);
+    add(std::to_string(asset_cache::version));
+}
+
+void asset_cache::key_builder::add_bytes(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash_ ^= bytes[i];
+        hash_ *= fnv_prime;
+    }
+    size_ += size;
+}
+
+auto asset_cache::key_builder::add(const std::string& value) -> key_builder&
+{
+    // Length prefixed so consecutive values can not shift into each other.
+    uint64_t length = value.size();
+    add_bytes(&length, sizeof(length));
+    add_bytes(value.data(), value.size());
+    return *this;
+}
+
+auto asset_cache::key_builder::add_file(const fs::path& file) -> key_builder&
+{
+    // Only the file name, so caches are shared between different checkout locations.
+    add(file.filename().string());
+
+    fs::error_code err;
+    if(!fs::exists(file, err))
+    {
+        return add("<missing>");
+    }
+
+    uint64_t size = 0;
+    uint64_t hash = hash_file(file, size);
+    add_bytes(&hash, sizeof(hash));
+    add_bytes(&size, sizeof(size));
+    return *this;
+}
+
+auto asset_cache::key_builder::add_tool(const fs::path& file) -> key_builder&
+{
+    struct tool_entry
+    {
+        fs::file_time_type time{};
+        uint64_t hash{};
+    };
+
+    static std::mutex tools_mutex;
+    static std::unordered_map<std::string, tool_entry> tools;
+
+    fs::error_code err;
+    auto time = fs::last_write_time(file, err);
+
+    uint64_t hash = 0;
+    {
+        std::lock_guard<std::mutex> lock(tools_mutex);
+        auto it = tools.find(file.string());
+        if(it != tools.end() && it->second.time == time)
+        {
+            hash = it->second.hash;
+        }
+        else
+        {
+            uint64_t size = 0;
+            hash = hash_file(file, size);
+            tools[file.string()] = {time, hash};
+        }
+    }
+
+    add_bytes(&hash, sizeof(hash));
+    return *this;
+}
+
+auto asset_cache::key_builder::str() const -> std::string
+{
+    return to_hex(hash_) + to_hex(size_);
+}
+
+asset_cache::asset_cache() : directory_(get_default_directory())
+{
+}
+
+void asset_cache::set_directory(const fs::path& dir)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = dir;
+}
+
+auto asset_cache::get_directory() const -> fs::path
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directory_;
+}
+
+void asset_cache::set_enabled(bool enabled)
+{
+    enabled_ = enabled;
+}
+
+auto asset_cache::is_enabled() const -> bool
+{
+    return enabled_;
+}
+
+auto asset_cache::get_entry_path(const std::string& key) const -> fs::path
+{
+    return get_directory() / key.substr(0, 2) / key;
+}
+
+auto asset_cache::fetch(const std::string& key, const fs::path& output, const fs::path& extras_dir) -> bool
+{
+    if(!is_enabled())
+    {
+        return false;
+    }
+
+    auto entry = get_entry_path(key);
+
+    fs::error_code err;
+    if(!fs::exists(entry / artifact_name, err))
+    {
+        misses_++;
+        return false;
+    }
+
+    if(!fs::copy_file(entry / artifact_name, output, fs::copy_options::overwrite_existing, err))
+    {
+        APPLOG_WARNING("Failed to restore {} from the asset cache: {}", output.string(), err.message());
+        failures_++;
+        misses_++;
+        return false;
+    }
+
+    auto extras = entry / extras_name;
+    if(!extras_dir.empty() && fs::exists(extras, err))
+    {
+        for(const auto& extra : fs::directory_iterator(extras, err))
+        {
+            fs::copy_file(extra.path(),
+                          extras_dir / extra.path().filename(),
+                          fs::copy_options::overwrite_existing,
+                          err);
+        }
+    }
+
+    hits_++;
+    return true;
+}
+
+void asset_cache::store(const std::string& key, const fs::path& output, const std::vector<fs::path>& extras)
+{
+    if(!is_enabled())
+    {
+        return;
+    }
+
+    auto entry = get_entry_path(key);
+
+    fs::error_code err;
+    if(fs::exists(entry, err))
+    {
+        return;
+    }
+
+    // Assemble the entry aside and publish it in one rename, readers never see a partial entry.
+    auto temp = get_directory() / "tmp" / hpp::to_string(generate_uuid());
+    fs::create_directories(temp / extras_name, err);
+
+    bool ok = fs::copy_file(output, temp / artifact_name, fs::copy_options::overwrite_existing, err);
+    for(const auto& extra : extras)
+    {
+        ok &= fs::copy_file(extra, temp / extras_name / extra.filename(), fs::copy_options::overwrite_existing, err);
+    }
+
+    if(ok)
+    {
+        fs::create_directories(entry.parent_path(), err);
+        fs::rename(temp, entry, err);
+
+        // Another process may have published the same key first, which is just as good.
+        ok = fs::exists(entry / artifact_name);
+    }
+
+    if(ok)
+    {
+        stores_++;
+    }
+    else
+    {
+        APPLOG_WARNING("Failed to store {} in the asset cache", output.string());
+        failures_++;
+    }
+
+    fs::remove_all(temp, err);
+}
+
+auto asset_cache::get_stats() const -> stats
+{
+    stats result;
+    result.hits = hits_;
+    result.misses = misses_;
+    result.stores = stores_;
+    result.failures = failures_;
+    return result;
+}
+
+auto get_asset_cache() -> asset_cache&
+{
+    static asset_cache cache;
+    return cache;
+}
+
+void resolve_includes(const fs::path& file, const std::vector<fs::path>& include_dirs, std::set<fs::path>& processed)
+{
+    if(!processed.insert(file).second)
+    {
+        return;
+    }
+
+    std::ifstream stream(file);
+    if(!stream.is_open())
+    {
+        return;
+    }
+
+    const std::string include_keyword = "#include";
+
+    std::string line;
+    while(std::getline(stream, line))
+    {
+        line.erase(0, line.find_first_not_of(" \t"));
+
+        if(line.compare(0, include_keyword.length(), include_keyword) != 0)
+        {
+            continue;
+        }
+
+        size_t start = line.find_first_of("\"<");
+        size_t end = line.find_last_of("\">");
+        if(start == std::string::npos || end == std::string::npos || start + 1 >= end)
+        {
+            continue;
+        }
+
+        auto include = fs::path(line.substr(start + 1, end - start - 1));
+        bool is_system = line[start] == '<';
+
+        fs::error_code err;
+        fs::path resolved;
+
+        if(!is_system && fs::exists(file.parent_path() / include, err))
+        {
+            resolved = file.parent_path() / include;
+        }
+        else
+        {
+            for(const auto& dir : include_dirs)
+            {
+                if(fs::exists(dir / include, err))
+                {
+                    resolved = dir / include;
+                    break;
+                }
+            }
+        }
+
+        if(!resolved.empty())
+        {
+            resolve_includes(fs::absolute(resolved, err), include_dirs, processed);
+        }
+    }
+}
+
+} // namespace ace
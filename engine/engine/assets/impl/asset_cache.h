@@ -0,0 +1,135 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <filesystem/filesystem.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class asset_cache
+ * @brief Content addressed store of compiled asset artifacts.
+ *
+ * Every entry is keyed by a hash of everything that affects the compiled output: the source
+ * content, the import meta, the compiler binary and the content of all dependencies. A compile
+ * with a known key restores the stored artifacts instead of running the compiler. Entries are
+ * immutable and published with an atomic rename, so the directory can be shared between
+ * processes and machines, e.g. on a network drive or as a CI cache.
+ */
+class asset_cache
+{
+public:
+    ///< Bump when the output of any compiler changes without its inputs changing.
+    static constexpr uint32_t version = 1;
+
+    /**
+     * @struct stats
+     * @brief Counters since startup.
+     */
+    struct stats
+    {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t stores{};
+        uint64_t failures{};
+    };
+
+    /**
+     * @class key_builder
+     * @brief Accumulates the inputs of a compile into a cache key.
+     */
+    class key_builder
+    {
+    public:
+        key_builder(const std::string& compiler);
+
+        /**
+         * @brief Adds a value such as a setting or a command line argument.
+         */
+        auto add(const std::string& value) -> key_builder&;
+
+        /**
+         * @brief Adds the content of a file. A missing file is recorded as missing.
+         */
+        auto add_file(const fs::path& file) -> key_builder&;
+
+        /**
+         * @brief Adds a compiler executable. Its hash is computed once per process.
+         */
+        auto add_tool(const fs::path& file) -> key_builder&;
+
+        /**
+         * @brief Gets the key as a hex string.
+         */
+        auto str() const -> std::string;
+
+    private:
+        void add_bytes(const void* data, size_t size);
+
+        uint64_t hash_{};
+        uint64_t size_{};
+    };
+
+    asset_cache();
+
+    /**
+     * @brief Sets the root directory of the cache. Defaults to the ACE_ASSET_CACHE environment
+     * variable, or a folder in the temp directory.
+     */
+    void set_directory(const fs::path& dir);
+    auto get_directory() const -> fs::path;
+
+    void set_enabled(bool enabled);
+    auto is_enabled() const -> bool;
+
+    /**
+     * @brief Restores a cached compile.
+     * @param key The cache key.
+     * @param output Where to place the main artifact.
+     * @param extras_dir Where to place additional outputs stored with the entry.
+     * @return True on a hit.
+     */
+    auto fetch(const std::string& key, const fs::path& output, const fs::path& extras_dir = {}) -> bool;
+
+    /**
+     * @brief Stores the outputs of a successful compile.
+     * @param key The cache key.
+     * @param output The main artifact.
+     * @param extras Additional outputs, restored by file name.
+     */
+    void store(const std::string& key, const fs::path& output, const std::vector<fs::path>& extras = {});
+
+    auto get_stats() const -> stats;
+
+private:
+    auto get_entry_path(const std::string& key) const -> fs::path;
+
+    mutable std::mutex mutex_;
+    fs::path directory_;
+    std::atomic<bool> enabled_{true};
+
+    std::atomic<uint64_t> hits_{};
+    std::atomic<uint64_t> misses_{};
+    std::atomic<uint64_t> stores_{};
+    std::atomic<uint64_t> failures_{};
+};
+
+auto get_asset_cache() -> asset_cache&;
+
+/**
+ * @brief Collects a shader and all files it includes, recursively.
+ * @param file The shader.
+ * @param include_dirs Directories searched when an include is not relative to the including file.
+ * @param processed Receives the absolute paths of all visited files.
+ */
+void resolve_includes(const fs::path& file, const std::vector<fs::path>& include_dirs, std::set<fs::path>& processed);
+
+} // namespace ace
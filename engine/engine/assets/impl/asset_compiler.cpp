@@ -1,4 +1,5 @@
 #include "asset_compiler.h"
+#include "asset_cache.h"
 #include "importers/mesh_importer.h"
 
 #include <bx/error.h>
@@ -21,12 +22,16 @@
 #include <engine/meta/rendering/mesh.hpp>
 #include <engine/meta/scripting/script.hpp>
 
+#include <engine/scripting/ecs/components/script_component.h>
 #include <engine/scripting/ecs/systems/script_system.h>
 
 #include <fstream>
+#include <mutex>
+#include <set>
 #include <monopp/mono_jit.h>
 #include <regex>
 #include <subprocess/subprocess.hpp>
+#include <threadpp/thread_pool.h>
 
 #include <core/base/platform/config.hpp>
 
@@ -52,6 +57,17 @@ auto resolve_input_file(const fs::path& key) -> fs::path
     return absolute_path;
 }
 
+auto fetch_from_cache(const std::string& cache_key, const fs::path& input, const fs::path& output) -> bool
+{
+    if(!get_asset_cache().fetch(cache_key, output, input.parent_path()))
+    {
+        return false;
+    }
+
+    APPLOG_INFO("Restored {0} -> {1} from the asset cache", input.string(), output.string());
+    return true;
+}
+
 auto escape_str(const std::string& str) -> std::string
 {
     return "\"" + str + "\"";
@@ -83,8 +99,24 @@ auto run_process(const std::string& process,
     return result.retcode == 0;
 }
 
+// Set from the project settings, read by compilations on any thread.
+std::mutex animation_compression_mutex;
+animation_compression_settings animation_compression;
+
 } // namespace
 
+void set_animation_compression(const animation_compression_settings& settings)
+{
+    std::lock_guard<std::mutex> lock(animation_compression_mutex);
+    animation_compression = settings;
+}
+
+auto get_animation_compression() -> animation_compression_settings
+{
+    std::lock_guard<std::mutex> lock(animation_compression_mutex);
+    return animation_compression;
+}
+
 template<>
 auto compile<gfx::shader>(asset_manager& am, const fs::path& key, const fs::path& output, uint32_t flags) -> bool
 {
@@ -211,13 +243,38 @@ auto compile<gfx::shader>(asset_manager& am, const fs::path& key, const fs::path
 
     std::string error;
 
+    auto shaderc = fs::resolve_protocol("binary:/shaderc");
+
+    std::set<fs::path> dependencies;
+    resolve_includes(absolute_path, {include}, dependencies);
+
+    asset_cache::key_builder cache_key("shader");
+    cache_key.add_tool(shaderc).add_file(key).add_file(varying).add(extension.string());
+    for(size_t i = 0; i < args_array.size(); ++i)
+    {
+        // Skip the paths, the content of the files is what matters.
+        bool is_path = i > 0 && (args_array[i - 1] == "-f" || args_array[i - 1] == "-o" || args_array[i - 1] == "-i" ||
+                                 args_array[i - 1] == "--varyingdef");
+        if(!is_path)
+        {
+            cache_key.add(args_array[i]);
+        }
+    }
+    for(const auto& dependency : dependencies)
+    {
+        cache_key.add_file(dependency);
+    }
+
+    if(fetch_from_cache(cache_key.str(), absolute_path, output))
+    {
+        return true;
+    }
+
     {
         std::ofstream output_file(str_output);
         (void)output_file;
     }
 
-    auto shaderc = fs::resolve_protocol("binary:/shaderc");
-
     if(!run_process(shaderc.string(), args_array, true, error))
     {
         APPLOG_ERROR("Failed compilation of {0} with error: {1}", str_input, error);
@@ -227,6 +284,7 @@ auto compile<gfx::shader>(asset_manager& am, const fs::path& key, const fs::path
     {
         APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
         fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
+        get_asset_cache().store(cache_key.str(), output);
     }
     fs::remove(temp, err);
 
@@ -261,11 +319,25 @@ auto compile<gfx::texture>(asset_manager& am, const fs::path& key, const fs::pat
 
     std::string error;
 
+    auto texturec = fs::resolve_protocol("binary:/texturec");
+
+    asset_cache::key_builder cache_key("texture");
+    cache_key.add_tool(texturec).add_file(key).add_file(absolute_path);
+    // Past the input and output paths.
+    for(size_t i = 4; i < args_array.size(); ++i)
+    {
+        cache_key.add(args_array[i]);
+    }
+
+    if(fetch_from_cache(cache_key.str(), absolute_path, output))
+    {
+        return true;
+    }
+
     {
         std::ofstream output_file(str_output);
         (void)output_file;
     }
-    auto texturec = fs::resolve_protocol("binary:/texturec");
 
     if(!run_process(texturec.string(), args_array, false, error))
     {
@@ -279,6 +351,11 @@ auto compile<gfx::texture>(asset_manager& am, const fs::path& key, const fs::pat
     fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
     fs::remove(temp, err);
 
+    if(result)
+    {
+        get_asset_cache().store(cache_key.str(), output);
+    }
+
     return true;
 }
 
@@ -328,10 +405,38 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
     fs::path file = absolute_path.stem();
     fs::path dir = absolute_path.parent_path();
 
+    // Importers may read companion files next to the source, e.g. .mtl or .bin.
+    asset_cache::key_builder cache_key("mesh");
+    cache_key.add_file(key).add_file(absolute_path).add(std::to_string(mesh::baked_data::current_version));
+    {
+        std::set<fs::path> companions;
+        for(const auto& entry : fs::directory_iterator(dir, err))
+        {
+            const auto& path = entry.path();
+            auto extension = path.extension();
+            if(path != absolute_path && path.stem() == file && extension != ".meta" && extension != ".mat" &&
+               extension != ".anim")
+            {
+                companions.insert(path);
+            }
+        }
+
+        for(const auto& companion : companions)
+        {
+            cache_key.add_file(companion);
+        }
+    }
+
+    if(fetch_from_cache(cache_key.str(), absolute_path, output))
+    {
+        return true;
+    }
+
     mesh::load_data data;
     std::vector<animation_clip> animations;
     std::vector<importer::imported_material> materials;
     std::vector<importer::imported_texture> textures;
+    std::vector<fs::path> extra_outputs;
 
     if(!importer::load_mesh_data_from_file(am, absolute_path, data, animations, materials, textures))
     {
@@ -340,7 +445,15 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
     }
     if(!data.vertex_data.empty())
     {
-        save_to_file_bin(str_output, data);
+        // Runs the whole preparation here so loading only uploads the final buffers.
+        mesh::baked_data baked;
+        if(!mesh::bake(std::move(data), baked))
+        {
+            APPLOG_ERROR("Failed compilation of {0}", str_input);
+            return false;
+        }
+
+        save_to_file_bin(str_output, baked);
 
         APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
         fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
@@ -368,6 +481,7 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
 
             fs::copy_file(temp, anim_output, fs::copy_options::overwrite_existing, err);
             fs::remove(temp, err);
+            extra_outputs.emplace_back(anim_output);
 
             // APPLOG_INFO("Successful compilation of animation {0}", animation.name);
         }
@@ -392,11 +506,17 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
 
             fs::copy_file(temp, mat_output, fs::copy_options::overwrite_existing, err);
             fs::remove(temp, err);
+            extra_outputs.emplace_back(mat_output);
 
             // APPLOG_INFO("Successful compilation of material {0}", material.name);
         }
     }
 
+    if(!data.vertex_data.empty())
+    {
+        get_asset_cache().store(cache_key.str(), output, extra_outputs);
+    }
+
     return true;
 }
 
@@ -416,6 +536,9 @@ auto compile<animation_clip>(asset_manager& am, const fs::path& key, const fs::p
     animation_clip anim;
     {
         load_from_file(str_input, anim);
+
+        // Only the compressed tracks are kept, the keys stay in the source.
+        compress(anim, get_animation_compression());
         save_to_file_bin(str_output, anim);
     }
 
@@ -436,8 +559,45 @@ auto compile<prefab>(asset_manager& am, const fs::path& key, const fs::path& out
     auto absolute_path = resolve_input_file(key);
     std::string str_input = absolute_path.string();
 
-    fs::error_code er;
-    fs::copy_file(absolute_path, output, fs::copy_options::overwrite_existing, er);
+    fs::error_code err;
+    fs::path temp = fs::temp_directory_path(err);
+    temp /= hpp::to_string(generate_uuid()) + ".buildtemp";
+
+    std::string str_output = temp.string();
+
+    // Components are instantiated to be written out, which is only safe on the main thread.
+    auto compile_job = tpp::async(tpp::main_thread::get_id(),
+                                  [&]()
+                                  {
+                                      scene scn;
+                                      entt::handle root(*scn.registry, scn.registry->create());
+                                      load_from_file(str_input, root);
+
+                                      // Scripts the loaded assemblies do not know yet would be dropped here,
+                                      // prefabs with scripts stay json and are parsed on first instantiation.
+                                      if(!root || !scn.registry->view<script_component>().empty())
+                                      {
+                                          return false;
+                                      }
+
+                                      prefab_template templ;
+                                      save_to_template(root, templ);
+                                      save_to_file_bin(str_output, templ);
+                                      return true;
+                                  });
+
+    bool compiled = compile_job.get();
+
+    fs::copy_file(compiled ? temp : absolute_path, output, fs::copy_options::overwrite_existing, err);
+    fs::error_code remove_err;
+    fs::remove(temp, remove_err);
+
+    if(err)
+    {
+        APPLOG_ERROR("Failed compilation of {0} -> {1} : {2}", str_input, output.string(), err.message());
+        return false;
+    }
+
     APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
     return true;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <engine/animation/animation.h>
 #include <engine/assets/asset_manager.h>
 #include <filesystem/filesystem.h>
 
@@ -10,5 +11,11 @@ namespace asset_compiler
 template<typename T>
 auto compile(asset_manager& am, const fs::path& key, const fs::path& output_key, uint32_t flags = 0) -> bool;
 
+/**
+ * @brief Sets how much error compiling an animation clip may introduce, clips compiled before keep theirs.
+ */
+void set_animation_compression(const animation_compression_settings& settings);
+auto get_animation_compression() -> animation_compression_settings;
+
 } // namespace asset_compiler
 } // namespace ace
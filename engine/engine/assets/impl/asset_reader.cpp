@@ -10,8 +10,10 @@
 #include <engine/meta/scripting/script.hpp>
 
 #include <engine/assets/asset_manager.h>
+#include <engine/rendering/texture_streamer.h>
 
 #include <cstdint>
+#include <filesystem/archive.h>
 #include <filesystem/filesystem.h>
 #include <graphics/shader.h>
 #include <graphics/texture.h>
@@ -32,11 +34,6 @@ auto resolve_compiled_path(const std::string& key) -> fs::path
     return fs::absolute(fs::resolve_protocol(cache_key));
 }
 
-auto resolve_path(const std::string& key) -> fs::path
-{
-    return fs::absolute(fs::resolve_protocol(key));
-}
-
 void log_missing_compiled_asset_for_key(const std::string& key)
 {
     APPLOG_WARNING("Compiled asset {0} does not exist!"
@@ -62,247 +59,384 @@ auto validate(const std::string& key, const std::string& compiled_ext, std::stri
         return false;
     }
 
-    auto compiled_absolute_path = resolve_compiled_path(key).string() + compiled_ext;
-
-    fs::error_code err;
-    if(!fs::exists(compiled_absolute_path, err))
+    // Mounted archives answer without touching the disk.
+    auto compiled_key = resolve_compiled_key(key) + compiled_ext;
+    if(fs::exists_view(compiled_key))
     {
-        log_missing_compiled_asset_for_key(compiled_absolute_path);
-
-        compiled_absolute_path = resolve_path(key).string();
+        out = compiled_key;
+        return true;
     }
 
-    if(!fs::exists(compiled_absolute_path, err))
+    log_missing_compiled_asset_for_key(compiled_key);
+
+    if(!fs::exists_view(key))
     {
         log_missing_raw_asset_for_key(key);
         return false;
     }
 
-    out = compiled_absolute_path;
+    out = key;
     return true;
 }
 
+template<typename T>
+void load_from_view_bin(const fs::data_view& view, T& obj)
+{
+    auto buffer = view.get_stream_buf();
+    std::istream stream(&buffer);
+    load_from_stream_bin(stream, obj);
+}
+
+/**
+ * @brief Queues the read of a compiled asset on the stream and its decode on the pool.
+ * The decode is skipped when the request is cancelled before the data arrives.
+ */
+template<typename T, typename F>
+void schedule_load(tpp::thread_pool& pool,
+                   asset_stream& stream,
+                   asset_handle<T>& output,
+                   const std::string& compiled_key,
+                   const load_priority& priority,
+                   F&& decode_func)
+{
+    auto request = stream.read(compiled_key, priority);
+
+    auto create_resource_func = [request, decode_func = std::forward<F>(decode_func)]() -> std::shared_ptr<T>
+    {
+        auto view = request->wait();
+        if(view.empty())
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<T> result;
+        try
+        {
+            result = decode_func(view);
+        }
+        catch(...)
+        {
+            // Frees the decode slot, the exception still reaches whoever waits on the handle.
+            request->finish(false);
+            throw;
+        }
+
+        request->finish(result != nullptr);
+        return result;
+    };
+
+    auto job = pool.schedule(create_resource_func).share();
+    if(priority.band == load_priority::level::blocking)
+    {
+        job.change_priority(tpp::priority::high());
+    }
+
+    output.set_internal_job(job);
+    output.set_internal_request(request);
+}
+
 template<>
-auto load_from_file<gfx::texture>(tpp::thread_pool& pool, asset_handle<gfx::texture>& output, const std::string& key)
-    -> bool
+auto load_from_file<gfx::texture>(tpp::thread_pool& pool,
+                                  asset_stream& stream,
+                                  asset_handle<gfx::texture>& output,
+                                  const std::string& key,
+                                  const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    // Decided on the requesting thread, material maps are the only textures with recorded usage.
+    const bool streamed = texture_streamer::material_scope::is_active();
+
+    auto decode_func = [compiled_key, streamed](const fs::data_view& view)
     {
-        return std::make_shared<gfx::texture>(compiled_absolute_path.c_str());
+        auto& streamer = get_texture_streamer();
+
+        // Only the low mips are uploaded now, the streamer brings in the rest once they are seen.
+        gfx::texture_info full_info{};
+        std::uint8_t skip = 0;
+        if(streamed && gfx::parse_texture_info(view.data, std::uint32_t(view.size), full_info))
+        {
+            skip = streamer.get_initial_skip(full_info);
+        }
+
+        auto tex = std::make_shared<gfx::texture>(compiled_key.c_str(),
+                                                  view.data,
+                                                  std::uint32_t(view.size),
+                                                  BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                                  skip);
+        streamer.add(compiled_key, tex, full_info);
+        return tex;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<gfx::shader>(tpp::thread_pool& pool, asset_handle<gfx::shader>& output, const std::string& key)
-    -> bool
+auto load_from_file<gfx::shader>(tpp::thread_pool& pool,
+                                 asset_stream& stream,
+                                 asset_handle<gfx::shader>& output,
+                                 const std::string& key,
+                                 const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, gfx::get_current_renderer_filename_extension(), compiled_absolute_path))
+    if(!validate(key, gfx::get_current_renderer_filename_extension(), compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
-        auto stream = std::ifstream{compiled_absolute_path, std::ios::binary};
-        auto read_memory = fs::read_stream(stream);
-
-        const gfx::memory_view* mem = gfx::copy(read_memory.data(), static_cast<std::uint32_t>(read_memory.size()));
+        const gfx::memory_view* mem = gfx::copy(view.data, static_cast<std::uint32_t>(view.size));
 
         return std::make_shared<gfx::shader>(mem);
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<material>(tpp::thread_pool& pool, asset_handle<material>& output, const std::string& key) -> bool
+auto load_from_file<material>(tpp::thread_pool& pool,
+                              asset_stream& stream,
+                              asset_handle<material>& output,
+                              const std::string& key,
+                              const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
         std::shared_ptr<ace::material> material;
-        load_from_file_bin(compiled_absolute_path, material);
+        load_from_view_bin(view, material);
         return material;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<mesh>(tpp::thread_pool& pool, asset_handle<mesh>& output, const std::string& key) -> bool
+auto load_from_file<mesh>(tpp::thread_pool& pool,
+                          asset_stream& stream,
+                          asset_handle<mesh>& output,
+                          const std::string& key,
+                          const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [compiled_key](const fs::data_view& view) -> std::shared_ptr<mesh>
     {
-        mesh::load_data data;
-        load_from_file_bin(compiled_absolute_path, data);
-
         auto mesh = std::make_shared<ace::mesh>();
+
+        mesh::baked_data baked;
+        load_from_view_bin(view, baked);
+        if(baked.version == mesh::baked_data::current_version)
+        {
+            mesh->load_baked(std::move(baked));
+            return mesh;
+        }
+
+        if(baked.version != 0)
+        {
+            APPLOG_ERROR("Mesh {0} was baked with version {1}, expected {2}. Recompile it.",
+                         compiled_key,
+                         baked.version,
+                         mesh::baked_data::current_version);
+            return nullptr;
+        }
+
+        // Compiled before meshes were baked, prepared here until it is recompiled.
+        mesh::load_data data;
+        load_from_view_bin(view, data);
         mesh->load_mesh(std::move(data));
         return mesh;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<animation_clip>(tpp::thread_pool& pool, asset_handle<animation_clip>& output, const std::string& key) -> bool
+auto load_from_file<animation_clip>(tpp::thread_pool& pool,
+                                    asset_stream& stream,
+                                    asset_handle<animation_clip>& output,
+                                    const std::string& key,
+                                    const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [compiled_key](const fs::data_view& view) -> std::shared_ptr<animation_clip>
     {
         auto anim = std::make_shared<animation_clip>();
-        load_from_file_bin(compiled_absolute_path, *anim);
-
+        load_from_view_bin(view, *anim);
+        if(anim->compressed.version == compressed_animation::current_version)
+        {
+            return anim;
+        }
+
+        if(anim->compressed.version != 0)
+        {
+            APPLOG_ERROR("Animation {0} was compressed with version {1}, expected {2}. Recompile it.",
+                         compiled_key,
+                         anim->compressed.version,
+                         compressed_animation::current_version);
+            return nullptr;
+        }
+
+        // Compiled before clips were compressed, compressed here until it is recompiled.
+        auto buffer = view.get_stream_buf();
+        std::istream stream(&buffer);
+        load_uncompressed_from_stream_bin(stream, *anim);
+        compress(*anim, {});
         return anim;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<prefab>(tpp::thread_pool& pool, asset_handle<prefab>& output, const std::string& key) -> bool
+auto load_from_file<prefab>(tpp::thread_pool& pool,
+                            asset_stream& stream,
+                            asset_handle<prefab>& output,
+                            const std::string& key,
+                            const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [compiled_key](const fs::data_view& view) -> std::shared_ptr<prefab>
     {
         auto pfb = std::make_shared<prefab>();
 
-        auto stream = std::ifstream{compiled_absolute_path};
-        pfb->buffer = fs::read_stream_buffer(stream);
+        auto templ = std::make_shared<prefab_template>();
+        load_from_view_bin(view, *templ);
+        if(is_stale(*templ))
+        {
+            APPLOG_ERROR("Prefab {0} was compiled with version {1} or other components, expected {2}. Recompile it.",
+                         compiled_key,
+                         templ->version,
+                         prefab_template::current_version);
+            return nullptr;
+        }
+
+        if(templ->version != 0)
+        {
+            pfb->parsed = std::move(templ);
+            return pfb;
+        }
+
+        // Json, either compiled before prefabs were or holding scripts. Parsed on first instantiation.
+        pfb->buffer.data.assign(view.data, view.data + view.size);
         return pfb;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<scene_prefab>(tpp::thread_pool& pool, asset_handle<scene_prefab>& output, const std::string& key)
-    -> bool
+auto load_from_file<scene_prefab>(tpp::thread_pool& pool,
+                                  asset_stream& stream,
+                                  asset_handle<scene_prefab>& output,
+                                  const std::string& key,
+                                  const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
         auto pfb = std::make_shared<scene_prefab>();
-
-        auto stream = std::ifstream{compiled_absolute_path};
-        pfb->buffer = fs::read_stream_buffer(stream);
+        pfb->buffer.data.assign(view.data, view.data + view.size);
         return pfb;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
 auto load_from_file<physics_material>(tpp::thread_pool& pool,
+                                      asset_stream& stream,
                                       asset_handle<physics_material>& output,
-                                      const std::string& key) -> bool
+                                      const std::string& key,
+                                      const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
         auto material = std::make_shared<physics_material>();
-        load_from_file_bin(compiled_absolute_path, material);
+        load_from_view_bin(view, material);
         return material;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<audio_clip>(tpp::thread_pool& pool, asset_handle<audio_clip>& output, const std::string& key)
-    -> bool
+auto load_from_file<audio_clip>(tpp::thread_pool& pool,
+                                asset_stream& stream,
+                                asset_handle<audio_clip>& output,
+                                const std::string& key,
+                                const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_load_func = [compiled_absolute_path]()
-    {
-        auto data = std::make_shared<audio::sound_data>();
-        load_from_file_bin(compiled_absolute_path, *data);
-        return data;
-    };
-
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
         audio::sound_data data;
-        load_from_file_bin(compiled_absolute_path, data);
+        load_from_view_bin(view, data);
 
         auto create_job = tpp::async(tpp::main_thread::get_id(),
                                      [data = std::move(data)]() mutable
@@ -314,33 +448,33 @@ auto load_from_file<audio_clip>(tpp::thread_pool& pool, asset_handle<audio_clip>
         return create_job.get();
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
 
 template<>
-auto load_from_file<script>(tpp::thread_pool& pool, asset_handle<script>& output, const std::string& key)
-    -> bool
+auto load_from_file<script>(tpp::thread_pool& pool,
+                            asset_stream& stream,
+                            asset_handle<script>& output,
+                            const std::string& key,
+                            const load_priority& priority) -> bool
 {
-    std::string compiled_absolute_path{};
+    std::string compiled_key{};
 
-    if(!validate(key, {}, compiled_absolute_path))
+    if(!validate(key, {}, compiled_key))
     {
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto decode_func = [](const fs::data_view& view)
     {
         auto scr = std::make_shared<script>();
-        load_from_file_bin(compiled_absolute_path, scr);
+        load_from_view_bin(view, scr);
         return scr;
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-    output.set_internal_job(job);
+    schedule_load(pool, stream, output, compiled_key, priority, decode_func);
 
     return true;
 }
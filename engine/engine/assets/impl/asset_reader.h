@@ -9,7 +9,11 @@ auto resolve_compiled_key(const std::string& key) -> std::string;
 auto resolve_compiled_path(const std::string& key) -> fs::path;
 
 template<typename T>
-auto load_from_file(tpp::thread_pool& pool, asset_handle<T>& output, const std::string& key) -> bool;
+auto load_from_file(tpp::thread_pool& pool,
+                    asset_stream& stream,
+                    asset_handle<T>& output,
+                    const std::string& key,
+                    const load_priority& priority) -> bool;
 
 template<typename T>
 inline auto load_from_instance(tpp::thread_pool& pool, asset_handle<T>& output, std::shared_ptr<T> instance) -> bool
@@ -0,0 +1,426 @@
+#include "asset_stream.h"
+
+#include <base/platform/thread.hpp>
+#include <logging/logging.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ace
+{
+
+struct asset_stream_state
+{
+    using clock_t = asset_stream::clock_t;
+    using status = asset_request::status;
+
+    struct entry
+    {
+        load_priority priority{};
+        uint64_t sequence{};
+        uint64_t generation{};
+        std::shared_ptr<asset_request> request;
+    };
+
+    struct accumulator
+    {
+        void add(clock_t::duration duration)
+        {
+            auto ms = std::chrono::duration<double, std::milli>(duration).count();
+            sum_ms += ms;
+            max_ms = std::max(max_ms, ms);
+            samples++;
+        }
+
+        auto get() const -> asset_stream::latency
+        {
+            asset_stream::latency result;
+            result.avg_ms = samples > 0 ? sum_ms / double(samples) : 0.0;
+            result.max_ms = max_ms;
+            result.samples = samples;
+            return result;
+        }
+
+        double sum_ms{};
+        double max_ms{};
+        uint64_t samples{};
+    };
+
+    // Heap order, the top is the most urgent entry and equal priorities are served first come first served.
+    static auto is_less_urgent(const entry& lhs, const entry& rhs) -> bool
+    {
+        if(rhs.priority < lhs.priority)
+        {
+            return true;
+        }
+        if(lhs.priority < rhs.priority)
+        {
+            return false;
+        }
+        return lhs.sequence > rhs.sequence;
+    }
+
+    void push(const std::shared_ptr<asset_request>& request)
+    {
+        auto priority = request->priority_;
+        if(request->waited_)
+        {
+            priority.band = load_priority::level::blocking;
+        }
+
+        queue.push_back({priority, sequence++, request->generation_, request});
+        std::push_heap(queue.begin(), queue.end(), &is_less_urgent);
+        work.notify_one();
+    }
+
+    // Entries are left in the heap when their request is cancelled or reprioritized and skipped here.
+    auto pop(std::unique_lock<std::mutex>& lock) -> std::shared_ptr<asset_request>
+    {
+        while(running)
+        {
+            while(!queue.empty())
+            {
+                const auto& top = queue.front();
+                if(top.request->status_ == status::queued && top.generation == top.request->generation_)
+                {
+                    break;
+                }
+                std::pop_heap(queue.begin(), queue.end(), &is_less_urgent);
+                queue.pop_back();
+            }
+
+            if(!queue.empty())
+            {
+                const auto& top = queue.front();
+                bool urgent = top.priority.band == load_priority::level::blocking;
+                if(urgent || reading + read_ahead < read_ahead_limit)
+                {
+                    auto request = top.request;
+                    std::pop_heap(queue.begin(), queue.end(), &is_less_urgent);
+                    queue.pop_back();
+                    return request;
+                }
+            }
+
+            work.wait(lock);
+        }
+
+        return nullptr;
+    }
+
+    // Called with the lock held, releases it for the duration of the read.
+    void perform(const std::shared_ptr<asset_request>& request, std::unique_lock<std::mutex>& lock)
+    {
+        request->status_ = status::reading;
+        request->read_start_ = clock_t::now();
+        queue_latency.add(request->read_start_ - request->queued_at_);
+        queued--;
+        reading++;
+
+        lock.unlock();
+        auto view = fs::open_view(request->key_);
+        lock.lock();
+
+        request->read_end_ = clock_t::now();
+        read_latency.add(request->read_end_ - request->read_start_);
+        reading--;
+
+        if(request->status_ == status::cancelled)
+        {
+            work.notify_one();
+        }
+        else if(view.empty())
+        {
+            APPLOG_ERROR("Failed to open {0}", request->key_);
+            request->status_ = status::done;
+            failed++;
+            work.notify_one();
+        }
+        else
+        {
+            request->view_ = std::move(view);
+            request->status_ = status::read;
+            read_ahead++;
+        }
+
+        done.notify_all();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(auto request = pop(lock))
+        {
+            perform(request, lock);
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable done;
+
+    std::vector<entry> queue;
+    std::vector<std::thread> threads;
+    bool running{};
+    uint64_t sequence{};
+    size_t read_ahead_limit{};
+    size_t decode_limit{1};
+
+    size_t queued{};
+    size_t reading{};
+    size_t read_ahead{};
+    size_t decoding{};
+    uint64_t completed{};
+    uint64_t cancelled{};
+    uint64_t failed{};
+
+    accumulator queue_latency;
+    accumulator read_latency;
+    accumulator decode_latency;
+    accumulator total_latency;
+};
+
+auto asset_request::wait() -> fs::data_view
+{
+    auto& state = *state_;
+    std::unique_lock<std::mutex> lock(state.mutex);
+
+    // The priority itself is kept, it decides below whether the decode may skip the limit.
+    if(status_ == status::queued && !waited_)
+    {
+        waited_ = true;
+        generation_++;
+        state.push(shared_from_this());
+    }
+
+    while(status_ == status::queued || status_ == status::reading)
+    {
+        // Without I/O threads, e.g. during shutdown, the waiting decode does the read itself.
+        if(status_ == status::queued && !state.running)
+        {
+            state.perform(shared_from_this(), lock);
+            continue;
+        }
+        state.done.wait(lock);
+    }
+
+    while(status_ == status::read && priority_.band != load_priority::level::blocking &&
+          state.decoding >= state.decode_limit)
+    {
+        state.done.wait(lock);
+    }
+
+    if(status_ != status::read)
+    {
+        return {};
+    }
+
+    status_ = status::decoding;
+    decode_start_ = clock_t::now();
+    state.read_ahead--;
+    state.decoding++;
+    state.work.notify_one();
+
+    return std::move(view_);
+}
+
+void asset_request::finish(bool succeeded)
+{
+    auto& state = *state_;
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    if(status_ != status::decoding)
+    {
+        return;
+    }
+
+    state.decoding--;
+    status_ = status::done;
+
+    if(succeeded)
+    {
+        auto now = clock_t::now();
+        state.decode_latency.add(now - decode_start_);
+        state.total_latency.add(now - queued_at_);
+        state.completed++;
+    }
+    else
+    {
+        state.failed++;
+    }
+
+    // Wakes decodes waiting for a slot.
+    state.done.notify_all();
+}
+
+void asset_request::cancel()
+{
+    auto& state = *state_;
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    switch(status_)
+    {
+        case status::queued:
+            state.queued--;
+            break;
+        case status::reading:
+            // The I/O thread drops the view once the read returns.
+            break;
+        case status::read:
+            view_ = {};
+            state.read_ahead--;
+            state.work.notify_one();
+            break;
+        default:
+            // A running decode can not be interrupted and its result is simply discarded.
+            return;
+    }
+
+    status_ = status::cancelled;
+    state.cancelled++;
+    state.done.notify_all();
+}
+
+auto asset_request::is_cancelled() const -> bool
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return status_ == status::cancelled;
+}
+
+void asset_request::set_priority(const load_priority& priority)
+{
+    auto& state = *state_;
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    priority_ = priority;
+    if(status_ == status::queued)
+    {
+        generation_++;
+        state.push(shared_from_this());
+    }
+    else if(status_ == status::read)
+    {
+        // A decode waiting for a slot may skip the limit now.
+        state.done.notify_all();
+    }
+}
+
+auto asset_request::get_priority() const -> load_priority
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return priority_;
+}
+
+auto asset_request::get_key() const -> const std::string&
+{
+    return key_;
+}
+
+asset_stream::asset_stream() : state_(std::make_shared<asset_stream_state>())
+{
+}
+
+asset_stream::~asset_stream()
+{
+    deinit();
+
+    // Queued requests keep the state alive, drop the references back to them.
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->queue.clear();
+}
+
+void asset_stream::init(size_t io_threads, size_t read_ahead, size_t decodes)
+{
+    deinit();
+
+    if(decodes == 0)
+    {
+        decodes = std::thread::hardware_concurrency() / 2;
+    }
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->running = true;
+    state_->read_ahead_limit = std::max<size_t>(read_ahead, 1);
+    state_->decode_limit = std::max<size_t>(decodes, 1);
+
+    for(size_t i = 0; i < std::max<size_t>(io_threads, 1); ++i)
+    {
+        state_->threads.emplace_back(
+            [state = state_, i]()
+            {
+                platform::set_thread_name(("asset_io_" + std::to_string(i)).c_str());
+                state->run();
+            });
+    }
+}
+
+void asset_stream::deinit()
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->running = false;
+        threads = std::move(state_->threads);
+        state_->threads.clear();
+    }
+
+    state_->work.notify_all();
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Wake decodes waiting on queued reads so they read inline.
+    state_->done.notify_all();
+}
+
+auto asset_stream::read(const std::string& key, const load_priority& priority) -> std::shared_ptr<asset_request>
+{
+    auto request = std::make_shared<asset_request>();
+    request->key_ = key;
+    request->state_ = state_;
+    request->priority_ = priority;
+    request->queued_at_ = clock_t::now();
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->queued++;
+    state_->push(request);
+
+    return request;
+}
+
+auto asset_stream::get_stats() const -> stats
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+
+    stats result;
+    result.queued = state_->queued;
+    result.reading = state_->reading;
+    result.read_ahead = state_->read_ahead;
+    result.decoding = state_->decoding;
+    result.completed = state_->completed;
+    result.cancelled = state_->cancelled;
+    result.failed = state_->failed;
+    result.queue = state_->queue_latency.get();
+    result.read = state_->read_latency.get();
+    result.decode = state_->decode_latency.get();
+    result.total = state_->total_latency.get();
+    return result;
+}
+
+void asset_stream::reset_stats()
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->completed = 0;
+    state_->cancelled = 0;
+    state_->failed = 0;
+    state_->queue_latency = {};
+    state_->read_latency = {};
+    state_->decode_latency = {};
+    state_->total_latency = {};
+}
+
+} // namespace ace
@@ -0,0 +1,165 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include "../asset_flags.h"
+
+#include <filesystem/archive.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ace
+{
+
+struct asset_stream_state;
+
+/**
+ * @class asset_request
+ * @brief One asset load going through the streaming pipeline.
+ *
+ * Created by asset_stream::read and shared between the I/O stage, the decode job on the thread
+ * pool and the asset handle, which uses it to cancel the load and to change its priority.
+ */
+class asset_request : public std::enable_shared_from_this<asset_request>
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /**
+     * @brief Blocks until the file is read. Promotes the read to the front of the I/O queue first,
+     * since a decode worker is now stalled on it. Then waits for a free decode slot, unless the
+     * request has blocking priority.
+     * @return The file contents, empty if the read failed or the request was cancelled.
+     */
+    auto wait() -> fs::data_view;
+
+    /**
+     * @brief Marks the decode as done, frees its slot and records the latencies of the request.
+     * @param succeeded False when the decode threw or produced nothing, counted as failed.
+     */
+    void finish(bool succeeded = true);
+
+    /**
+     * @brief Drops a queued read and makes a waiting decode return empty handed.
+     */
+    void cancel();
+    auto is_cancelled() const -> bool;
+
+    /**
+     * @brief Reorders the read if it is still queued.
+     */
+    void set_priority(const load_priority& priority);
+    auto get_priority() const -> load_priority;
+
+    auto get_key() const -> const std::string&;
+
+private:
+    friend class asset_stream;
+    friend struct asset_stream_state;
+
+    enum class status : uint8_t
+    {
+        queued,
+        reading,
+        read,
+        decoding,
+        done,
+        cancelled
+    };
+
+    std::string key_;
+    std::shared_ptr<asset_stream_state> state_;
+
+    /// Everything below is guarded by the stream mutex.
+    load_priority priority_{};
+    uint64_t generation_{};
+    /// Set once a decode waits on the read, which is then served ahead of everything else.
+    bool waited_{};
+    status status_{status::queued};
+    fs::data_view view_{};
+    clock_t::time_point queued_at_{};
+    clock_t::time_point read_start_{};
+    clock_t::time_point read_end_{};
+    clock_t::time_point decode_start_{};
+};
+
+/**
+ * @class asset_stream
+ * @brief Two stage asset loading pipeline.
+ *
+ * Reads go through a small set of dedicated I/O threads in priority order, so a scene load is
+ * not queued behind thumbnails and disk access is not spread over every pool worker. Decoding
+ * stays on the thread pool. Finished reads wait for their decode in a bounded read ahead
+ * window, which keeps the memory of decompressed entries in check, and only a limited number of
+ * decodes run at once, so loads do not take over every pool worker.
+ */
+class asset_stream
+{
+public:
+    using clock_t = asset_request::clock_t;
+
+    /**
+     * @struct latency
+     * @brief Timings in milliseconds since the last reset.
+     */
+    struct latency
+    {
+        double avg_ms{};
+        double max_ms{};
+        uint64_t samples{};
+    };
+
+    /**
+     * @struct stats
+     * @brief Queue depths and latencies of the pipeline.
+     */
+    struct stats
+    {
+        size_t queued{};     ///< Reads waiting for an I/O thread.
+        size_t reading{};    ///< Reads in progress.
+        size_t read_ahead{}; ///< Reads done and waiting for their decode.
+        size_t decoding{};   ///< Decodes in progress.
+
+        uint64_t completed{};
+        uint64_t cancelled{};
+        uint64_t failed{};
+
+        latency queue;  ///< From the request until an I/O thread picks it up.
+        latency read;   ///< Time spent reading.
+        latency decode; ///< Time spent decoding.
+        latency total;  ///< From the request until the asset is ready.
+    };
+
+    asset_stream();
+    ~asset_stream();
+
+    /**
+     * @brief Starts the I/O threads.
+     * @param io_threads Number of concurrent reads.
+     * @param read_ahead Number of finished reads that may wait for their decode. Reads that a
+     * decode is already waiting on are never held back.
+     * @param decodes Number of decodes that may run at once, 0 for half the hardware threads.
+     * Blocking requests are never held back.
+     */
+    void init(size_t io_threads = 2, size_t read_ahead = 64, size_t decodes = 0);
+
+    /**
+     * @brief Joins the I/O threads. Reads still queued are done by the decodes waiting on them.
+     */
+    void deinit();
+
+    /**
+     * @brief Queues a read of a protocol path.
+     */
+    auto read(const std::string& key, const load_priority& priority) -> std::shared_ptr<asset_request>;
+
+    auto get_stats() const -> stats;
+    void reset_stats();
+
+private:
+    std::shared_ptr<asset_stream_state> state_;
+};
+
+} // namespace ace
@@ -1759,6 +1759,58 @@ auto load_mesh_data_from_file(asset_manager& am,
 
     return true;
 }
+
+auto get_referenced_textures(const fs::path& path) -> std::vector<fs::path>
+{
+    Assimp::Importer importer;
+
+    // Only the materials are read, nothing is post processed.
+    const aiScene* scene = read_file(importer, path, 0);
+    if(scene == nullptr)
+    {
+        return {};
+    }
+
+    const auto dir = path.parent_path();
+
+    std::vector<fs::path> textures;
+    for(unsigned int i = 0; i < scene->mNumMaterials; ++i)
+    {
+        const auto material = scene->mMaterials[i];
+        for(int type = aiTextureType_NONE + 1; type <= AI_TEXTURE_TYPE_MAX; ++type)
+        {
+            const auto count = material->GetTextureCount(aiTextureType(type));
+            for(unsigned int index = 0; index < count; ++index)
+            {
+                aiString texture_path{};
+                if(material->GetTexture(aiTextureType(type), index, &texture_path) != AI_SUCCESS ||
+                   scene->GetEmbeddedTexture(texture_path.C_Str()))
+                {
+                    continue;
+                }
+
+                // Exporters write paths relative to the model, absolute ones usually point to the
+                // machine it was authored on, so fall back to the file name next to the model.
+                fs::path relative = string_utils::replace(texture_path.C_Str(), "\\", "/");
+                for(const auto& candidate : {dir / relative, dir / relative.filename()})
+                {
+                    fs::error_code err;
+                    if(fs::is_regular_file(candidate, err))
+                    {
+                        auto texture = candidate.lexically_normal();
+                        if(std::find(textures.begin(), textures.end(), texture) == textures.end())
+                        {
+                            textures.emplace_back(std::move(texture));
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return textures;
+}
 } // namespace importer
 
 } // namespace ace
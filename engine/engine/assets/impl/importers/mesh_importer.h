@@ -31,6 +31,11 @@ bool load_mesh_data_from_file(asset_manager& am,
                               std::vector<imported_material>& materials,
                               std::vector<imported_texture>& textures);
 
+/**
+ * @brief Lists the texture files next to a model that its materials reference, without importing it.
+ */
+auto get_referenced_textures(const fs::path& path) -> std::vector<fs::path>;
+
 void mesh_importer_init();
 } // namespace importer
 } // namespace ace
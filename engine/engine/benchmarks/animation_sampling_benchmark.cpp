@@ -0,0 +1,155 @@
+#include "benchmarks.h"
+
+#include <engine/animation/animation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+constexpr float clip_duration = 10.0f;
+constexpr float source_rate = 60.0f;
+constexpr size_t players = 256;
+
+// Keys at 60 per second, like an imported clip, swinging bones with a constant scaling.
+auto make_clip(size_t channel_count) -> animation_clip
+{
+    animation_clip clip;
+    clip.duration = animation_clip::seconds_t(clip_duration);
+    clip.channels.resize(channel_count);
+
+    const auto key_count = size_t(clip_duration * source_rate) + 1;
+    for(size_t c = 0; c < channel_count; ++c)
+    {
+        auto& channel = clip.channels[c];
+        channel.node_index = c;
+        for(size_t k = 0; k < key_count; ++k)
+        {
+            auto time = animation_clip::seconds_t(float(k) / source_rate);
+            float phase = time.count() * (1.0f + float(c % 5)) + float(c);
+
+            channel.position_keys.push_back({time, math::vec3(std::sin(phase), float(c) * 0.1f, std::cos(phase))});
+            channel.rotation_keys.push_back({time, math::angleAxis(std::sin(phase), math::vec3(0.0f, 1.0f, 0.0f))});
+            channel.scaling_keys.push_back({time, math::vec3(1.0f)});
+        }
+    }
+
+    return clip;
+}
+
+auto raw_bytes(const animation_clip& clip) -> size_t
+{
+    size_t bytes = 0;
+    for(const auto& channel : clip.channels)
+    {
+        bytes += channel.position_keys.size() * sizeof(animation_channel::key<math::vec3>);
+        bytes += channel.rotation_keys.size() * sizeof(animation_channel::key<math::quat>);
+        bytes += channel.scaling_keys.size() * sizeof(animation_channel::key<math::vec3>);
+    }
+    return bytes;
+}
+
+auto compressed_bytes(const compressed_animation& anim) -> size_t
+{
+    size_t bytes = 0;
+    for(const auto* set : {&anim.positions, &anim.rotations, &anim.scalings})
+    {
+        bytes += set->tracks.size() * sizeof(compressed_animation::track);
+        bytes += set->frames.size() * sizeof(uint16_t);
+        bytes += set->values.size() * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+// Every player is at another time of the clip and advances by one 60 Hz frame per sample.
+auto ns_per_track(const animation_clip& clip, size_t frames) -> double
+{
+    std::vector<animation_key_cursor> cursors(players);
+    std::vector<float> times(players);
+    for(size_t p = 0; p < players; ++p)
+    {
+        times[p] = clip_duration * float(p) / float(players);
+    }
+
+    animation_pose pose;
+    auto frame_ns = measure<std::nano>(frames,
+                                       [&]()
+                                       {
+                                           for(size_t p = 0; p < players; ++p)
+                                           {
+                                               times[p] = std::fmod(times[p] + 1.0f / 60.0f, clip_duration);
+                                               sample_animation(clip,
+                                                                animation_clip::seconds_t(times[p]),
+                                                                cursors[p],
+                                                                pose);
+                                           }
+                                       },
+                                       false);
+
+    return frame_ns / double(players * clip.channels.size() * 3);
+}
+
+// Largest distance of a compressed position from the keys, over every source key time.
+auto max_position_error(const animation_clip& raw, const animation_clip& compressed) -> float
+{
+    animation_key_cursor cursor;
+    animation_pose raw_pose;
+    animation_pose compressed_pose;
+    animation_key_cursor unused;
+
+    float error = 0.0f;
+    for(const auto& key : raw.channels.front().position_keys)
+    {
+        sample_animation(raw, key.time, unused, raw_pose);
+        sample_animation(compressed, key.time, cursor, compressed_pose);
+        for(size_t i = 0; i < raw_pose.nodes.size(); ++i)
+        {
+            auto delta = raw_pose.nodes[i].transform.translation - compressed_pose.nodes[i].transform.translation;
+            error = std::max(error, math::length(delta));
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+void run_animation_sampling_benchmark()
+{
+    std::printf("%-10s %-12s %-12s %-16s %-16s %-10s\n",
+                "channels",
+                "raw (KB)",
+                "packed (KB)",
+                "raw (ns/track)",
+                "packed (ns/track)",
+                "max error");
+
+    for(size_t channel_count : {size_t(16), size_t(64), size_t(128)})
+    {
+        auto raw = make_clip(channel_count);
+
+        auto compressed = raw;
+        compress(compressed, {});
+
+        const size_t frames = 60;
+        auto raw_ns = ns_per_track(raw, frames);
+        auto compressed_ns = ns_per_track(compressed, frames);
+
+        std::printf("%-10zu %-12.1f %-12.1f %-16.2f %-16.2f %-10.5f\n",
+                    channel_count,
+                    double(raw_bytes(raw)) / 1024.0,
+                    double(compressed_bytes(compressed.compressed)) / 1024.0,
+                    raw_ns,
+                    compressed_ns,
+                    max_position_error(raw, compressed));
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,134 @@
+#include "benchmarks.h"
+
+#include <engine/assets/asset_storage.h>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+auto make_location(size_t i) -> std::string
+{
+    return "app:/data/assets/folder_" + std::to_string(i % 97) + "/asset_" + std::to_string(i) + ".png";
+}
+
+} // namespace
+
+void run_asset_database_benchmark()
+{
+    // The database traces every change.
+    if(!spdlog::get(APPLOG))
+    {
+        spdlog::create<spdlog::sinks::null_sink_mt>(APPLOG);
+    }
+
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%-10s %-12s %-12s %-12s %-16s %-10s\n",
+                "assets",
+                "add (ms)",
+                "lookup (ms)",
+                "rename (ms)",
+                "par lookup (ms)",
+                "threads");
+
+    for(size_t count : {size_t(1000), size_t(10000), size_t(80000)})
+    {
+        std::vector<std::string> locations;
+        std::vector<asset_meta> metas;
+        locations.reserve(count);
+        metas.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            locations.emplace_back(make_location(i));
+
+            auto& meta = metas.emplace_back();
+            meta.uid = generate_uuid();
+            meta.type = ".png";
+        }
+
+        asset_database db;
+
+        auto add_ms = measure(1,
+                              [&]()
+                              {
+                                  for(size_t i = 0; i < count; ++i)
+                                  {
+                                      db.add_asset(locations[i], metas[i]);
+                                  }
+                              },
+                              false);
+
+        size_t found = 0;
+        auto lookup_ms = measure(1,
+                                 [&]()
+                                 {
+                                     for(const auto& location : locations)
+                                     {
+                                         found += db.get_uuid(location) != hpp::uuid{};
+                                     }
+                                 },
+                                 false);
+
+        auto rename_ms = measure(1,
+                                 [&]()
+                                 {
+                                     for(auto& location : locations)
+                                     {
+                                         auto new_location = location + ".renamed";
+                                         db.rename_asset(location, new_location);
+                                         location = std::move(new_location);
+                                     }
+                                 },
+                                 false);
+
+        std::atomic<size_t> found_parallel{0};
+        auto parallel_ms = measure(1,
+                                   [&]()
+                                   {
+                                       std::vector<std::thread> workers;
+                                       for(size_t t = 0; t < threads; ++t)
+                                       {
+                                           workers.emplace_back(
+                                               [&, t]()
+                                               {
+                                                   size_t local = 0;
+                                                   for(size_t i = t; i < count; i += threads)
+                                                   {
+                                                       local += db.get_uuid(locations[i]) != hpp::uuid{};
+                                                   }
+                                                   found_parallel += local;
+                                               });
+                                       }
+
+                                       for(auto& worker : workers)
+                                       {
+                                           worker.join();
+                                       }
+                                   },
+                                   false);
+
+        std::printf("%-10zu %-12.2f %-12.2f %-12.2f %-16.2f %-10zu%s\n",
+                    count,
+                    add_ms,
+                    lookup_ms,
+                    rename_ms,
+                    parallel_ms,
+                    threads,
+                    (found == count && found_parallel == count) ? "" : " MISMATCH");
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ratio>
+
+namespace ace
+{
+namespace benchmarks
+{
+
+/**
+ * @brief Runs f iterations times and returns the average time of one run.
+ * @tparam Period Unit of the result, e.g. std::micro.
+ * @param warm_up Whether f runs once more first, to warm up caches and pools. Off when the runs
+ * change what they measure.
+ */
+template<typename Period = std::milli, typename F>
+auto measure(size_t iterations, F&& f, bool warm_up = true) -> double
+{
+    if(warm_up)
+    {
+        f();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, Period>(end - start).count() / double(iterations);
+}
+
+/**
+ * @brief Compares per entity frustum culling against batched SoA culling.
+ */
+void run_culling_benchmark();
+
+/**
+ * @brief Measures bulk add, lookup and rename of asset database entries.
+ */
+void run_asset_database_benchmark();
+
+/**
+ * @brief Compares resolving a transform hierarchy with math::transform against math::affine.
+ */
+void run_transform_benchmark();
+
+/**
+ * @brief Compares loading a mesh through end_prepare against loading its baked buffers.
+ */
+void run_mesh_load_benchmark();
+
+/**
+ * @brief Compares instantiating a prefab from json, from a binary archive and from its parsed template.
+ */
+void run_prefab_instantiate_benchmark();
+
+/**
+ * @brief Compares a play mode checkpoint through json, through a binary archive and through a scene snapshot.
+ */
+void run_scene_snapshot_benchmark();
+
+/**
+ * @brief Compares sampling animation clips by searching their keys against compressed tracks with key cursors.
+ */
+void run_animation_sampling_benchmark();
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,120 @@
+#include "benchmarks.h"
+
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/threading/threader.h>
+
+#include <entt/entity/registry.hpp>
+
+#include <cstdio>
+#include <random>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+struct bench_model
+{
+    math::bbox local_bounds;
+    math::transform world;
+    uint8_t flags{};
+};
+
+} // namespace
+
+void run_culling_benchmark()
+{
+    threader th;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::uniform_real_distribution<float> angle(0.0f, math::two_pi<float>());
+
+    const auto view = math::lookAt(math::vec3(0.0f, 0.0f, -10.0f), math::vec3(0.0f), math::vec3(0.0f, 1.0f, 0.0f));
+    const auto proj = math::perspectiveNO(math::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+    const math::frustum frustum(math::transform(view), math::transform(proj), true);
+
+    const uint8_t required = culling_buffer::is_enabled | culling_buffer::is_shadow_caster;
+
+    std::printf("%-10s %-14s %-14s %-14s %-10s\n", "entities", "each (us)", "batched (us)", "parallel (us)", "visible");
+
+    for(size_t count : {size_t(1000), size_t(10000), size_t(100000)})
+    {
+        entt::registry registry;
+        culling_buffer buffer;
+        buffer.reset(count);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            auto e = registry.create();
+            auto& model = registry.emplace<bench_model>(e);
+
+            auto extents = math::vec3(size(rng), size(rng), size(rng));
+            model.local_bounds = math::bbox(-extents, extents);
+            model.world.set_position(math::vec3(position(rng), position(rng), position(rng)));
+            model.world.set_rotation(math::angleAxis(angle(rng), math::vec3(0.0f, 1.0f, 0.0f)));
+
+            model.flags = culling_buffer::is_enabled | culling_buffer::is_static;
+            model.flags |= (i % 4) != 0 ? culling_buffer::is_shadow_caster : 0;
+
+            buffer.set(i, e, model.flags, model.local_bounds, model.world);
+        }
+
+        const size_t iterations = count >= 100000 ? 20 : 200;
+
+        size_t visible_each = 0;
+        auto each_us = measure<std::micro>(iterations,
+                                           [&]()
+                                           {
+                                               std::vector<entt::entity> result;
+                                               registry.view<bench_model>().each(
+                                                   [&](auto e, const bench_model& model)
+                                                   {
+                                                       if((model.flags & required) != required)
+                                                       {
+                                                           return;
+                                                       }
+
+                                                       if(!frustum.test_obb(model.local_bounds, model.world))
+                                                       {
+                                                           return;
+                                                       }
+
+                                                       result.emplace_back(e);
+                                                   });
+                                               visible_each = result.size();
+                                           });
+
+        size_t visible_batched = 0;
+        auto batched_us = measure<std::micro>(iterations,
+                                              [&]()
+                                              {
+                                                  visible_batched = buffer.cull(frustum, required, nullptr).size();
+                                              });
+
+        size_t visible_parallel = 0;
+        auto parallel_us = measure<std::micro>(iterations,
+                                               [&]()
+                                               {
+                                                   auto visible = buffer.cull(frustum, required, th.jobs.get());
+                                                   visible_parallel = visible.size();
+                                               });
+
+        std::printf("%-10zu %-14.1f %-14.1f %-14.1f %-10zu%s\n",
+                    count,
+                    each_us,
+                    batched_us,
+                    parallel_us,
+                    visible_each,
+                    (visible_each == visible_batched && visible_each == visible_parallel) ? "" : " MISMATCH");
+    }
+
+    rtti::context ctx;
+    th.deinit(ctx);
+}
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,14 @@
+#include "benchmarks.h"
+
+int main(int, char**)
+{
+    ace::benchmarks::run_culling_benchmark();
+    ace::benchmarks::run_asset_database_benchmark();
+    ace::benchmarks::run_transform_benchmark();
+    ace::benchmarks::run_mesh_load_benchmark();
+    ace::benchmarks::run_prefab_instantiate_benchmark();
+    ace::benchmarks::run_scene_snapshot_benchmark();
+    ace::benchmarks::run_animation_sampling_benchmark();
+
+    return 0;
+}
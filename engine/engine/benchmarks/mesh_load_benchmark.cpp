@@ -0,0 +1,182 @@
+#include "benchmarks.h"
+
+#include <engine/meta/rendering/mesh.hpp>
+#include <serialization/binary_archive.h>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+// A grid shaped like imported data, optionally skinned by a few bones along its x axis.
+auto make_grid(uint32_t size, uint32_t bones) -> mesh::load_data
+{
+    mesh::load_data data;
+    data.vertex_format.begin()
+        .add(gfx::attribute::Position, 3, gfx::attribute_type::Float)
+        .add(gfx::attribute::Normal, 4, gfx::attribute_type::Uint8, true, true)
+        .add(gfx::attribute::Tangent, 4, gfx::attribute_type::Uint8, true, true)
+        .add(gfx::attribute::Bitangent, 4, gfx::attribute_type::Uint8, true, true)
+        .add(gfx::attribute::TexCoord0, 2, gfx::attribute_type::Float)
+        .end();
+
+    data.vertex_count = size * size;
+    data.vertex_data.resize(size_t(data.vertex_count) * data.vertex_format.getStride());
+
+    for(uint32_t y = 0; y < size; ++y)
+    {
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            const auto index = y * size + x;
+            float position[4] = {float(x), 0.0f, float(y), 0.0f};
+            float normal[4] = {0.0f, 1.0f, 0.0f, 0.0f};
+            float tangent[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+            float bitangent[4] = {0.0f, 0.0f, 1.0f, 0.0f};
+            float uv[4] = {float(x) / float(size), float(y) / float(size), 0.0f, 0.0f};
+
+            auto* vertices = data.vertex_data.data();
+            gfx::vertex_pack(position, false, gfx::attribute::Position, data.vertex_format, vertices, index);
+            gfx::vertex_pack(normal, true, gfx::attribute::Normal, data.vertex_format, vertices, index);
+            gfx::vertex_pack(tangent, true, gfx::attribute::Tangent, data.vertex_format, vertices, index);
+            gfx::vertex_pack(bitangent, true, gfx::attribute::Bitangent, data.vertex_format, vertices, index);
+            gfx::vertex_pack(uv, false, gfx::attribute::TexCoord0, data.vertex_format, vertices, index);
+        }
+    }
+
+    for(uint32_t y = 0; y + 1 < size; ++y)
+    {
+        for(uint32_t x = 0; x + 1 < size; ++x)
+        {
+            const auto index = y * size + x;
+
+            mesh::triangle first;
+            first.indices = {index, index + size, index + 1};
+            data.triangle_data.emplace_back(first);
+
+            mesh::triangle second;
+            second.indices = {index + 1, index + size, index + size + 1};
+            data.triangle_data.emplace_back(second);
+        }
+    }
+    data.triangle_count = uint32_t(data.triangle_data.size());
+
+    mesh::submesh submesh;
+    submesh.vertex_start = 0;
+    submesh.vertex_count = data.vertex_count;
+    submesh.face_start = 0;
+    submesh.face_count = data.triangle_count;
+    submesh.skinned = bones > 0;
+    data.submeshes.emplace_back(submesh);
+    data.material_count = 1;
+
+    for(uint32_t b = 0; b < bones; ++b)
+    {
+        skin_bind_data::bone_influence bone;
+        bone.bone_id = "bone_" + std::to_string(b);
+        for(uint32_t i = 0; i < data.vertex_count; ++i)
+        {
+            if((i % size) * bones / size == b)
+            {
+                bone.influences.push_back({i, 1.0f});
+            }
+        }
+        data.skin_data.add_bone(bone);
+    }
+
+    data.bbox = math::bbox(math::vec3(0.0f), math::vec3(float(size), 0.0f, float(size)));
+
+    return data;
+}
+
+template<typename T>
+auto to_bytes(const T& obj) -> std::string
+{
+    std::ostringstream stream;
+    {
+        ser20::oarchive_binary_t ar(stream);
+        try_save(ar, ser20::make_nvp("mesh", obj));
+    }
+    return stream.str();
+}
+
+} // namespace
+
+void run_mesh_load_benchmark()
+{
+    // Mesh preparation logs its failures.
+    if(!spdlog::get(APPLOG))
+    {
+        spdlog::create<spdlog::sinks::null_sink_mt>(APPLOG);
+    }
+
+    std::printf("%-10s %-8s %-16s %-16s %-14s %-14s %-10s\n",
+                "vertices",
+                "bones",
+                "prepare (ms)",
+                "baked (ms)",
+                "prepare (KB)",
+                "baked (KB)",
+                "speedup");
+
+    for(uint32_t size : {64u, 256u, 512u})
+    {
+        for(uint32_t bones : {0u, 16u})
+        {
+            const auto legacy_bytes = to_bytes(make_grid(size, bones));
+
+            mesh::baked_data baked;
+            mesh::bake(make_grid(size, bones), baked);
+            const auto baked_bytes = to_bytes(baked);
+
+            const size_t iterations = size >= 512 ? 5 : 20;
+
+            // Both read from memory like the asset reader does from a data view, neither uploads.
+            uint32_t faces = 0;
+            auto prepare_ms = measure(iterations,
+                                      [&]()
+                                      {
+                                          std::istringstream stream(legacy_bytes);
+                                          mesh::load_data data;
+                                          load_from_stream_bin(stream, data);
+
+                                          mesh m;
+                                          m.load_mesh(std::move(data), false);
+                                          faces += m.get_face_count();
+                                      });
+
+            uint32_t baked_faces = 0;
+            auto baked_ms = measure(iterations,
+                                    [&]()
+                                    {
+                                        std::istringstream stream(baked_bytes);
+                                        mesh::baked_data data;
+                                        load_from_stream_bin(stream, data);
+
+                                        mesh m;
+                                        m.load_baked(std::move(data), false);
+                                        baked_faces += m.get_face_count();
+                                    });
+
+            std::printf("%-10u %-8u %-16.3f %-16.3f %-14zu %-14zu %-10.2f%s\n",
+                        size * size,
+                        bones,
+                        prepare_ms,
+                        baked_ms,
+                        legacy_bytes.size() / 1024,
+                        baked_bytes.size() / 1024,
+                        prepare_ms / baked_ms,
+                        faces == baked_faces ? "" : " MISMATCH");
+        }
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
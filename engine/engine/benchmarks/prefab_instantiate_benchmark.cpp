@@ -0,0 +1,117 @@
+#include "benchmarks.h"
+
+#include <engine/ecs/components/id_component.h>
+#include <engine/ecs/components/transform_component.h>
+#include <engine/ecs/scene.h>
+#include <engine/meta/ecs/entity.hpp>
+#include <engine/rendering/ecs/components/model_component.h>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+// A root with children two levels deep, every other entity a bone, like a small skinned enemy.
+auto make_hierarchy(scene& scn, size_t count) -> entt::handle
+{
+    auto root = scn.create_entity("root");
+    root.emplace<id_component>();
+
+    std::vector<entt::handle> entities{root};
+    for(size_t i = 1; i < count; ++i)
+    {
+        auto parent = entities[(i - 1) / 4];
+        auto e = scn.create_entity("node_" + std::to_string(i), parent);
+        e.emplace<id_component>();
+        e.get<transform_component>().set_position_local(math::vec3(float(i), 0.0f, 0.0f));
+        if(i % 2 == 0)
+        {
+            e.emplace<bone_component>().bone_index = uint32_t(i / 2);
+            e.emplace<submesh_component>().submeshes = {0, 1};
+        }
+        entities.emplace_back(e);
+    }
+
+    return root;
+}
+
+} // namespace
+
+void run_prefab_instantiate_benchmark()
+{
+    // Serialization logs what it cannot read.
+    if(!spdlog::get(APPLOG))
+    {
+        spdlog::create<spdlog::sinks::null_sink_mt>(APPLOG);
+    }
+
+    std::printf("%-10s %-16s %-16s %-16s %-10s\n",
+                "entities",
+                "json (1/s)",
+                "binary (1/s)",
+                "template (1/s)",
+                "speedup");
+
+    for(size_t count : {size_t(1), size_t(8), size_t(32)})
+    {
+        scene source;
+        auto root = make_hierarchy(source, count);
+
+        std::stringstream json;
+        save_to_stream(json, root);
+        const auto json_text = json.str();
+
+        std::stringstream bin;
+        save_to_stream_bin(bin, root);
+        const auto bin_bytes = bin.str();
+
+        prefab_template templ;
+        save_to_template(root, templ);
+
+        const size_t iterations = 2000 / count + 100;
+
+        // Every variant instantiates into the same scene, cleared between rows, as spawning does.
+        scene target;
+
+        auto json_rate = 1.0 / measure<std::ratio<1>>(iterations,
+                                                      [&]()
+                                                      {
+                                                          entt::handle obj(*target.registry, entt::null);
+                                                          load_from_view(json_text, obj);
+                                                      });
+        target.unload();
+
+        auto bin_rate = 1.0 / measure<std::ratio<1>>(iterations,
+                                                     [&]()
+                                                     {
+                                                         std::istringstream stream(bin_bytes);
+                                                         entt::handle obj(*target.registry, entt::null);
+                                                         load_from_stream_bin(stream, obj);
+                                                     });
+        target.unload();
+
+        auto template_rate = 1.0 / measure<std::ratio<1>>(iterations,
+                                                          [&]()
+                                                          {
+                                                              load_from_template(templ, *target.registry);
+                                                          });
+
+        std::printf("%-10zu %-16.0f %-16.0f %-16.0f %-10.2f\n",
+                    count,
+                    json_rate,
+                    bin_rate,
+                    template_rate,
+                    template_rate / json_rate);
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,137 @@
+#include "benchmarks.h"
+
+#include <engine/ecs/components/id_component.h>
+#include <engine/ecs/components/transform_component.h>
+#include <engine/ecs/scene.h>
+#include <engine/meta/ecs/entity.hpp>
+#include <engine/rendering/ecs/components/model_component.h>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace ace
+{
+namespace benchmarks
+{
+namespace
+{
+
+// Hierarchies of 16 entities, each with a tag, an id and a transform, every other one a bone.
+void fill_scene(scene& scn, size_t count)
+{
+    entt::handle root;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(i % 16 == 0)
+        {
+            root = scn.create_entity("root_" + std::to_string(i));
+        }
+
+        auto e = i % 16 == 0 ? root : scn.create_entity("node_" + std::to_string(i), root);
+        e.emplace<id_component>();
+        e.get<transform_component>().set_position_local(math::vec3(float(i % 16), 0.0f, float(i / 16)));
+        if(i % 2 == 1)
+        {
+            e.emplace<bone_component>().bone_index = uint32_t(i % 16);
+        }
+    }
+}
+
+} // namespace
+
+void run_scene_snapshot_benchmark()
+{
+    // Serialization logs what it cannot read.
+    if(!spdlog::get(APPLOG))
+    {
+        spdlog::create<spdlog::sinks::null_sink_mt>(APPLOG);
+    }
+
+    // The json and binary columns unload and reload the scene, as the editor did before snapshots.
+    std::printf("%-10s %-20s %-20s %-20s %-14s %-10s\n",
+                "entities",
+                "json save/load (ms)",
+                "bin save/load (ms)",
+                "snapshot save (ms)",
+                "full (ms)",
+                "changed (ms)");
+
+    for(size_t count : {size_t(1000), size_t(10000), size_t(100000)})
+    {
+        const size_t iterations = count >= 100000 ? 1 : 5;
+
+        scene scn;
+        fill_scene(scn, count);
+
+        auto json_ms = measure(iterations,
+                               [&]()
+                               {
+                                   std::stringstream stream;
+                                   save_to_stream(stream, scn);
+                                   scn.unload();
+                                   load_from_stream(stream, scn);
+                               },
+                               false);
+
+        auto bin_ms = measure(iterations,
+                              [&]()
+                              {
+                                  std::stringstream stream;
+                                  save_to_stream_bin(stream, scn);
+                                  scn.unload();
+                                  load_from_stream_bin(stream, scn);
+                              },
+                              false);
+
+        scene_snapshot snapshot;
+        auto save_ms = measure(iterations,
+                               [&]()
+                               {
+                                   save_to_snapshot(scn, snapshot);
+                               },
+                               false);
+
+        auto full_ms = measure(iterations,
+                               [&]()
+                               {
+                                   load_from_snapshot(snapshot, scn, scene_snapshot::restore_mode::full);
+                               },
+                               false);
+
+        // Like leaving play mode, a few entities moved and a few were spawned.
+        auto changed_ms = measure(iterations,
+                                  [&]()
+                                  {
+                                      auto view = scn.registry->view<transform_component>();
+                                      size_t n = 0;
+                                      for(auto e : view)
+                                      {
+                                          if(n++ % 64 == 0)
+                                          {
+                                              view.get<transform_component>(e).set_position_local(math::vec3(1.0f));
+                                          }
+                                      }
+                                      for(size_t i = 0; i < count / 100; ++i)
+                                      {
+                                          scn.create_entity("spawned");
+                                      }
+
+                                      load_from_snapshot(snapshot, scn, scene_snapshot::restore_mode::changed);
+                                  },
+                                  false);
+
+        std::printf("%-10zu %-20.2f %-20.2f %-20.2f %-14.2f %-10.2f\n",
+                    count,
+                    json_ms,
+                    bin_ms,
+                    save_ms,
+                    full_ms,
+                    changed_ms);
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
@@ -0,0 +1,90 @@
+#include "benchmarks.h"
+
+#include <math/math.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace ace
+{
+namespace benchmarks
+{
+void run_transform_benchmark()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> angle(0.0f, math::two_pi<float>());
+
+    std::printf("%-10s %-18s %-18s %-10s\n", "nodes", "transform (us)", "affine (us)", "speedup");
+
+    for(size_t count : {size_t(1000), size_t(10000), size_t(100000)})
+    {
+        // Depth ordered like transform_hierarchy, a few wide levels below a single root.
+        std::vector<uint32_t> parents(count);
+        std::vector<math::transform> locals(count);
+        std::vector<math::affine> locals_affine(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            parents[i] = i == 0 ? uint32_t(-1) : uint32_t((i - 1) / 4);
+
+            auto axis = math::vec3(position(rng), position(rng), position(rng)) + math::vec3(0.0f, 10.0f, 0.0f);
+            axis = math::normalize(axis);
+            auto& local = locals[i];
+            local.set_position(math::vec3(position(rng), position(rng), position(rng)));
+            local.set_rotation(math::angleAxis(angle(rng), axis));
+            local.set_scale(math::vec3(1.0f));
+
+            locals_affine[i] = math::affine(local);
+        }
+
+        std::vector<math::transform> globals(count);
+        std::vector<math::affine> globals_affine(count);
+
+        const size_t iterations = count >= 100000 ? 10 : 100;
+
+        // What the hierarchy did before, consumers then read the components of the result.
+        math::vec3 sink_transform{};
+        auto transform_us = measure<std::micro>(iterations,
+                                                [&]()
+                                                {
+                                                    for(size_t i = 0; i < count; ++i)
+                                                    {
+                                                        const auto parent = parents[i];
+                                                        globals[i] = parent == uint32_t(-1)
+                                                                         ? locals[i]
+                                                                         : globals[parent] * locals[i];
+                                                        sink_transform += globals[i].get_position();
+                                                    }
+                                                });
+
+        math::vec3 sink_affine{};
+        auto affine_us = measure<std::micro>(iterations,
+                                             [&]()
+                                             {
+                                                 for(size_t i = 0; i < count; ++i)
+                                                 {
+                                                     const auto parent = parents[i];
+                                                     globals_affine[i] =
+                                                         parent == uint32_t(-1)
+                                                             ? locals_affine[i]
+                                                             : globals_affine[parent] * locals_affine[i];
+                                                     sink_affine += globals_affine[i].translation;
+                                                 }
+                                             });
+
+        bool match = math::all(math::epsilonEqual(globals.back().get_position(),
+                                                  globals_affine.back().translation,
+                                                  math::vec3(0.01f)));
+
+        std::printf("%-10zu %-18.1f %-18.1f %-10.2f%s\n",
+                    count,
+                    transform_us,
+                    affine_us,
+                    transform_us / affine_us,
+                    match ? "" : " MISMATCH");
+    }
+}
+
+} // namespace benchmarks
+} // namespace ace
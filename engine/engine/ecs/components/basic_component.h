@@ -15,11 +15,31 @@ struct basic_component
     /// Disable empty type optimizations
     bool eto{};
 
+    /// Set by touch, starts set so new components count as changed.
+    bool touched{true};
+
     /**
      * @brief Marks the component as 'touched'.
      */
     void touch()
     {
+        touched = true;
+    }
+
+    /**
+     * @brief Checks if the component was touched since the last clear_touched.
+     */
+    auto is_touched() const -> bool
+    {
+        return touched;
+    }
+
+    /**
+     * @brief Clears the 'touched' flag, called by the system consuming the change.
+     */
+    void clear_touched()
+    {
+        touched = false;
     }
 };
 
@@ -1,4 +1,5 @@
 #include "transform_component.h"
+#include <engine/ecs/transform_hierarchy.h>
 
 #include <cstdint>
 #include <logging/logging.h>
@@ -7,6 +8,17 @@
 
 namespace ace
 {
+namespace
+{
+void invalidate_hierarchy(entt::registry& r)
+{
+    if(auto hierarchy = r.ctx().find<transform_hierarchy>())
+    {
+        hierarchy->invalidate();
+    }
+}
+} // namespace
+
 auto check_parent(entt::handle e, entt::handle parent) -> bool
 {
     if(!parent)
@@ -43,12 +55,16 @@ void transform_component::on_create_component(entt::registry& r, entt::entity e)
 
     auto& component = entity.get<transform_component>();
     component.set_owner(entity);
+
+    invalidate_hierarchy(r);
 }
 
 void transform_component::on_destroy_component(entt::registry& r, entt::entity e)
 {
     entt::handle entity(r, e);
 
+    invalidate_hierarchy(r);
+
     auto& component = entity.get<transform_component>();
 
     if(component.parent_)
@@ -473,6 +489,7 @@ auto transform_component::set_parent(const entt::handle& p, bool global_stays) -
 
     parent_ = new_parent;
     set_dirty(true);
+    invalidate_hierarchy(*get_owner().registry());
 
     if(global_stays)
     {
@@ -564,6 +581,17 @@ void transform_component::apply_transform(const math::transform& tr) noexcept
 {
     if(parent_)
     {
+        const auto& parent_transform = parent_.get<transform_component>().get_transform_global();
+
+        // Avoid the matrix inverse and decomposition when neither side has skew.
+        math::affine parent_affine(parent_transform);
+        if(parent_affine.has_uniform_scale() && math::affine::is_representable(parent_transform) &&
+           math::affine::is_representable(tr))
+        {
+            set_transform_local((parent_affine.inverse() * math::affine(tr)).to_transform());
+            return;
+        }
+
         auto inv_parent_transform = inverse_parent_transform(parent_);
         set_transform_local(inv_parent_transform * tr);
     }
@@ -612,6 +640,11 @@ auto transform_component::get_children() const noexcept -> const std::vector<ent
 void transform_component::set_children(const std::vector<entt::handle>& children)
 {
     children_ = children;
+
+    if(get_owner())
+    {
+        invalidate_hierarchy(*get_owner().registry());
+    }
 }
 
 void transform_component::on_dirty_transform(bool dirty) noexcept
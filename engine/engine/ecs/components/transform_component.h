@@ -442,6 +442,8 @@ public:
     std::shared_ptr<int> sentinel = std::make_shared<int>();
 
 private:
+    friend class transform_hierarchy;
+
     /**
      * @brief Sets the owner of the component.
      * @param owner A handle to the owner entity.
@@ -1,6 +1,7 @@
 #pragma once
 #include <engine/engine_export.h>
 
+#include <cstdint>
 #include <iosfwd>
 #include <istream>
 #include <memory>
@@ -10,6 +11,41 @@
 namespace ace
 {
 
+/**
+ * @struct prefab_template
+ * @brief A prefab hierarchy parsed into component data, instantiated without parsing it again.
+ *
+ * Written by the asset compiler, or built from the json of a prefab the first time it is
+ * instantiated. Bump version whenever the layout changes, changes to the set of component
+ * types are caught by component_types.
+ */
+struct prefab_template
+{
+    static constexpr uint32_t current_version = 3;
+
+    /**
+     * @struct entity_desc
+     * @brief One entity of the hierarchy.
+     */
+    struct entity_desc
+    {
+        uint32_t id{};              ///< Id the components use to refer to this entity.
+        uint32_t first_component{}; ///< Index of its first entry in components.
+        uint32_t component_count{};
+    };
+
+    ///< Version the template was written with, 0 if the data is not a template.
+    uint32_t version = current_version;
+    ///< Hash of the serializable component types known when it was written.
+    uint32_t component_types{};
+    ///< The flattened hierarchy, the root first and parents before their children.
+    std::vector<entity_desc> entities;
+    ///< Component type of every stored component, a hash of its reflected type name.
+    std::vector<uint32_t> components;
+    ///< The stored components in order, as one binary archive.
+    std::vector<uint8_t> data;
+};
+
 /**
  * @struct prefab
  * @brief Represents a generic prefab with a buffer for serialized data.
@@ -20,6 +56,12 @@ struct prefab
      * @brief Buffer to store serialized data of the prefab.
      */
     fs::stream_buffer<std::vector<uint8_t>> buffer{};
+
+    /**
+     * @brief The parsed template instances are created from. Set when loading a compiled prefab,
+     * otherwise built from the buffer on first instantiation.
+     */
+    std::shared_ptr<prefab_template> parsed{};
 };
 
 /**
@@ -1,6 +1,10 @@
 #include "scene.h"
 #include <engine/ecs/components/id_component.h>
 #include <engine/ecs/components/transform_component.h>
+#include <engine/ecs/transform_hierarchy.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
+#include <engine/rendering/culling/scene_bvh.h>
 #include <engine/rendering/ecs/components/model_component.h>
 
 #include <engine/physics/ecs/components/physics_component.h>
@@ -56,6 +60,10 @@ auto clone_entity_impl(entt::registry& r, entt::handle entity) -> entt::handle
 scene::scene()
 {
     registry = std::make_unique<entt::registry>();
+    registry->ctx().emplace<scene_bvh>();
+    registry->ctx().emplace<culling_buffer>();
+    registry->ctx().emplace<dirty_set>();
+    registry->ctx().emplace<transform_hierarchy>();
     unload();
 
     registry->on_construct<transform_component>().connect<&transform_component::on_create_component>();
@@ -82,6 +90,7 @@ scene::~scene()
 void scene::unload()
 {
     registry->clear();
+    registry->ctx().get<dirty_set>().clear();
     auto reserved_entity = registry->create();
     source = {};
 }
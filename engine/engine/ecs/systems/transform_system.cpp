@@ -2,13 +2,13 @@
 
 #include <engine/ecs/components/transform_component.h>
 #include <engine/ecs/ecs.h>
+#include <engine/ecs/transform_hierarchy.h>
+#include <engine/engine.h>
 #include <engine/profiler/profiler.h>
+#include <engine/threading/threader.h>
 
 #include <logging/logging.h>
 
-#define POOLSTL_STD_SUPPLEMENT 1
-#include <poolstl/poolstl.hpp>
-
 namespace ace
 {
 
@@ -28,21 +28,15 @@ auto transform_system::deinit(rtti::context& ctx) -> bool
 
 void transform_system::on_frame_update(scene& scn, delta_t dt)
 {
-    APP_SCOPE_PERF("Transform System");
-
-    // Create a view for entities with transform_component and submesh_component
-    auto view_root = scn.registry->view<transform_component, root_component>();
-
-    // Use std::for_each with the view's iterators
-    std::for_each(std::execution::par,
-                  view_root.begin(),
-                  view_root.end(),
-                  [&view_root](entt::entity entity)
-                  {
-                      auto& transform_comp = view_root.get<transform_component>(entity);
-
-                      transform_comp.resolve_transform_global();
-                  });
+    auto& ctx = scn.registry->ctx();
+    auto hierarchy = ctx.find<transform_hierarchy>();
+    if(!hierarchy)
+    {
+        hierarchy = &ctx.emplace<transform_hierarchy>();
+    }
+
+    auto& th = engine::context().get_cached<threader>();
+    hierarchy->update(*scn.registry, th.jobs.get());
 }
 
 } // namespace ace
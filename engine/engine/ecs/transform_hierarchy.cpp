@@ -0,0 +1,196 @@
+#include "transform_hierarchy.h"
+
+#include <engine/ecs/components/transform_component.h>
+#include <engine/threading/job_system.h>
+
+#include <algorithm>
+
+namespace ace
+{
+namespace
+{
+// Levels smaller than this are resolved on the calling thread.
+constexpr uint32_t chunk_size = 256;
+} // namespace
+
+void transform_hierarchy::invalidate() noexcept
+{
+    needs_rebuild_ = true;
+}
+
+void transform_hierarchy::update(entt::registry& registry, job_system* jobs)
+{
+    bool force = needs_rebuild_.exchange(false);
+    if(force)
+    {
+        rebuild(registry);
+    }
+
+    for(size_t level = 0; level + 1 < levels_.size(); ++level)
+    {
+        const auto begin = levels_[level];
+        const auto end = levels_[level + 1];
+
+        if(!jobs || end - begin <= chunk_size)
+        {
+            resolve_range(begin, end, force);
+            continue;
+        }
+
+        // Parents live in earlier levels, so nodes of the same level are independent.
+        jobs->parallel_for(end - begin,
+                           chunk_size,
+                           [&](size_t first, size_t last)
+                           {
+                               resolve_range(begin + uint32_t(first), begin + uint32_t(last), force);
+                           });
+    }
+}
+
+void transform_hierarchy::rebuild(entt::registry& registry)
+{
+    entities_.clear();
+    parents_.clear();
+    components_.clear();
+    levels_.clear();
+
+    auto push_node = [&](entt::entity e, uint32_t parent, transform_component& component)
+    {
+        entities_.emplace_back(e);
+        parents_.emplace_back(parent);
+        components_.emplace_back(&component);
+    };
+
+    auto view_root = registry.view<transform_component, root_component>();
+    for(auto e : view_root)
+    {
+        push_node(e, invalid_index, view_root.get<transform_component>(e));
+    }
+
+    // Breadth first, one level per pass.
+    levels_.emplace_back(0);
+
+    uint32_t begin = 0;
+    while(begin < uint32_t(entities_.size()))
+    {
+        const auto end = uint32_t(entities_.size());
+        for(uint32_t i = begin; i < end; ++i)
+        {
+            for(const auto& child : components_[i]->get_children())
+            {
+                auto child_component = child ? child.try_get<transform_component>() : nullptr;
+                if(child_component)
+                {
+                    push_node(child.entity(), i, *child_component);
+                }
+            }
+        }
+
+        levels_.emplace_back(end);
+        begin = end;
+    }
+
+    locals_.resize(entities_.size());
+    globals_.resize(entities_.size());
+    exact_.resize(entities_.size());
+
+    indices_.clear();
+    for(uint32_t i = 0; i < uint32_t(entities_.size()); ++i)
+    {
+        auto idx = size_t(entt::to_entity(entities_[i]));
+        if(idx >= indices_.size())
+        {
+            indices_.resize(idx + 1, invalid_index);
+        }
+        indices_[idx] = i;
+    }
+}
+
+void transform_hierarchy::resolve_range(uint32_t begin, uint32_t end, bool force) noexcept
+{
+    for(uint32_t i = begin; i < end; ++i)
+    {
+        auto& component = *components_[i];
+        if(!force && !component.is_dirty(system_id) && !component.is_dirty())
+        {
+            continue;
+        }
+
+        auto& property = component.transform_;
+        const auto& local = property.local;
+        const auto parent = parents_[i];
+
+        locals_[i] = math::affine(local);
+        const bool representable = math::affine::is_representable(local);
+
+        if(parent == invalid_index)
+        {
+            property.global = local;
+            globals_[i] = locals_[i];
+            exact_[i] = representable;
+        }
+        else if(representable && exact_[parent] && math::affine::can_compose_exactly(globals_[parent], locals_[i]))
+        {
+            globals_[i] = globals_[parent] * locals_[i];
+            property.global = globals_[i].to_transform();
+            exact_[i] = true;
+        }
+        else
+        {
+            // The result can have skew or perspective, compose the full matrices.
+            property.global = components_[parent]->transform_.global * local;
+            globals_[i] = math::affine(property.global);
+            exact_[i] = math::affine::is_representable(property.global);
+        }
+        property.dirty = false;
+
+        // Build the matrix here instead of lazily on whichever thread reads it first.
+        property.global.get_matrix();
+
+        component.flags_.get_global_value(&component, false);
+        component.set_dirty(system_id, false);
+    }
+}
+
+auto transform_hierarchy::get_index(entt::entity e) const -> uint32_t
+{
+    auto idx = size_t(entt::to_entity(e));
+    if(idx >= indices_.size())
+    {
+        return invalid_index;
+    }
+
+    auto index = indices_[idx];
+    if(index == invalid_index || entities_[index] != e)
+    {
+        return invalid_index;
+    }
+    return index;
+}
+
+auto transform_hierarchy::get_entities() const noexcept -> const std::vector<entt::entity>&
+{
+    return entities_;
+}
+
+auto transform_hierarchy::get_parents() const noexcept -> const std::vector<uint32_t>&
+{
+    return parents_;
+}
+
+auto transform_hierarchy::get_locals() const noexcept -> const std::vector<math::affine>&
+{
+    return locals_;
+}
+
+auto transform_hierarchy::get_globals() const noexcept -> const std::vector<math::affine>&
+{
+    return globals_;
+}
+
+auto transform_hierarchy::get_levels() const noexcept -> const std::vector<uint32_t>&
+{
+    return levels_;
+}
+
+} // namespace ace
@@ -0,0 +1,83 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <entt/entity/registry.hpp>
+#include <math/math.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace ace
+{
+class transform_component;
+class job_system;
+
+/**
+ * @class transform_hierarchy
+ * @brief Flat, depth ordered view of the transform hierarchy of a scene.
+ *
+ * Nodes are stored breadth first so every parent comes before its children and each depth
+ * level is a contiguous range. Global transforms are resolved one level at a time, with the
+ * nodes of a level split in chunks across the job system. Only nodes whose transform is dirty
+ * are recomputed. The layout is rebuilt lazily whenever a transform is created, destroyed or
+ * reparented.
+ *
+ * Transforms are composed as math::affine while the result stays free of skew, and fall back
+ * to math::transform for the rest.
+ */
+class transform_hierarchy
+{
+public:
+    static constexpr uint32_t invalid_index = uint32_t(-1);
+    ///< Dirty bit of transform_component reserved for the hierarchy.
+    static constexpr uint8_t system_id = 0;
+
+    /**
+     * @brief Marks the layout for a rebuild on the next update.
+     */
+    void invalidate() noexcept;
+
+    /**
+     * @brief Resolves the global transforms of all dirty nodes.
+     * @param registry The registry owning the transforms.
+     * @param jobs Splits large levels across its threads, when null everything runs on the caller.
+     */
+    void update(entt::registry& registry, job_system* jobs = nullptr);
+
+    /**
+     * @brief Gets the index of an entity, invalid_index if it is not part of the layout.
+     */
+    auto get_index(entt::entity e) const -> uint32_t;
+
+    auto get_entities() const noexcept -> const std::vector<entt::entity>&;
+    auto get_parents() const noexcept -> const std::vector<uint32_t>&;
+    auto get_locals() const noexcept -> const std::vector<math::affine>&;
+    auto get_globals() const noexcept -> const std::vector<math::affine>&;
+
+    /**
+     * @brief Gets the start of each depth level, followed by the node count.
+     */
+    auto get_levels() const noexcept -> const std::vector<uint32_t>&;
+
+private:
+    void rebuild(entt::registry& registry);
+    void resolve_range(uint32_t begin, uint32_t end, bool force) noexcept;
+
+    std::vector<entt::entity> entities_;
+    std::vector<uint32_t> parents_;
+    ///< Stable until the next rebuild, any construct or destroy of a transform triggers one.
+    std::vector<transform_component*> components_;
+    std::vector<math::affine> locals_;
+    std::vector<math::affine> globals_;
+    ///< Whether the global of a node is exactly represented by its affine.
+    std::vector<uint8_t> exact_;
+    std::vector<uint32_t> levels_;
+
+    ///< Entity to node index, indexed by the entity index.
+    std::vector<uint32_t> indices_;
+
+    std::atomic<bool> needs_rebuild_{true};
+};
+
+} // namespace ace
@@ -3,6 +3,7 @@
 #include <engine/defaults/defaults.h>
 #include <engine/profiler/profiler.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/shadow_atlas.h>
 #include <engine/scripting/ecs/systems/script_system.h>
 #include <engine/threading/threader.h>
 
@@ -82,6 +83,7 @@ auto engine::create(rtti::context& ctx, cmd_line::parser& parser) -> bool
     ctx.add<events>();
     ctx.add<threader>();
     ctx.add<renderer>(ctx, parser);
+    ctx.add<shadow_atlas>();
     ctx.add<audio_system>();
     ctx.add<asset_manager>(ctx);
     ctx.add<ecs>();
@@ -112,6 +114,11 @@ auto engine::init_core(const cmd_line::parser& parser) -> bool
         return false;
     }
 
+    if(!ctx.get_cached<shadow_atlas>().init(ctx))
+    {
+        return false;
+    }
+
     if(!ctx.get_cached<audio_system>().init(ctx))
     {
         return false;
@@ -256,6 +263,11 @@ auto engine::deinit() -> bool
         return false;
     }
 
+    if(!ctx.get_cached<shadow_atlas>().deinit(ctx))
+    {
+        return false;
+    }
+
     if(!ctx.get_cached<renderer>().deinit(ctx))
     {
         return false;
@@ -287,6 +299,7 @@ auto engine::destroy() -> bool
 
     ctx.remove<asset_manager>();
     ctx.remove<audio_system>();
+    ctx.remove<shadow_atlas>();
     ctx.remove<renderer>();
     ctx.remove<events>();
     ctx.remove<simulation>();
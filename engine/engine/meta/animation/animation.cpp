@@ -2,7 +2,9 @@
 #include <engine/meta/core/math/quaternion.hpp>
 #include <engine/meta/core/math/transform.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <logging/logging.h>
 #include <serialization/associative_archive.h>
 #include <serialization/binary_archive.h>
 
@@ -62,6 +64,96 @@ LOAD(animation_clip)
 LOAD_INSTANTIATE(animation_clip, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(animation_clip, ser20::iarchive_binary_t);
 
+namespace
+{
+// Leads compiled clips so they can be told apart from clips compiled before compression, which start with the name.
+constexpr uint32_t compressed_animation_magic = 0x4d494e41; // "ANIM"
+} // namespace
+
+SAVE(compressed_animation::track)
+{
+    try_save(ar, ser20::make_nvp("first_key", obj.first_key));
+    try_save(ar, ser20::make_nvp("key_count", obj.key_count));
+    try_save(ar, ser20::make_nvp("min", obj.min));
+    try_save(ar, ser20::make_nvp("extent", obj.extent));
+}
+SAVE_INSTANTIATE(compressed_animation::track, ser20::oarchive_binary_t);
+
+LOAD(compressed_animation::track)
+{
+    try_load(ar, ser20::make_nvp("first_key", obj.first_key));
+    try_load(ar, ser20::make_nvp("key_count", obj.key_count));
+    try_load(ar, ser20::make_nvp("min", obj.min));
+    try_load(ar, ser20::make_nvp("extent", obj.extent));
+}
+LOAD_INSTANTIATE(compressed_animation::track, ser20::iarchive_binary_t);
+
+SAVE(compressed_animation::track_set)
+{
+    try_save(ar, ser20::make_nvp("tracks", obj.tracks));
+    try_save(ar, ser20::make_nvp("frames", obj.frames));
+    try_save(ar, ser20::make_nvp("values", obj.values));
+}
+SAVE_INSTANTIATE(compressed_animation::track_set, ser20::oarchive_binary_t);
+
+LOAD(compressed_animation::track_set)
+{
+    try_load(ar, ser20::make_nvp("tracks", obj.tracks));
+    try_load(ar, ser20::make_nvp("frames", obj.frames));
+    try_load(ar, ser20::make_nvp("values", obj.values));
+
+    // Sampling trusts the tables, check them once here.
+    bool valid = obj.values.size() == obj.frames.size() * 3 &&
+                 std::all_of(obj.tracks.begin(),
+                             obj.tracks.end(),
+                             [&](const compressed_animation::track& track)
+                             {
+                                 return size_t(track.first_key) + track.key_count <= obj.frames.size();
+                             });
+    if(!valid)
+    {
+        APPLOG_ERROR("Compressed animation has invalid track tables.");
+        obj = {};
+    }
+}
+LOAD_INSTANTIATE(compressed_animation::track_set, ser20::iarchive_binary_t);
+
+SAVE(compressed_animation)
+{
+    try_save(ar, ser20::make_nvp("magic", compressed_animation_magic));
+    try_save(ar, ser20::make_nvp("version", obj.version));
+    try_save(ar, ser20::make_nvp("sample_rate", obj.sample_rate));
+    try_save(ar, ser20::make_nvp("frame_count", obj.frame_count));
+    try_save(ar, ser20::make_nvp("positions", obj.positions));
+    try_save(ar, ser20::make_nvp("rotations", obj.rotations));
+    try_save(ar, ser20::make_nvp("scalings", obj.scalings));
+}
+SAVE_INSTANTIATE(compressed_animation, ser20::oarchive_binary_t);
+
+LOAD(compressed_animation)
+{
+    uint32_t magic = 0;
+    try_load(ar, ser20::make_nvp("magic", magic));
+    if(magic != compressed_animation_magic)
+    {
+        obj.version = 0;
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("version", obj.version));
+    if(obj.version != compressed_animation::current_version)
+    {
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("sample_rate", obj.sample_rate));
+    try_load(ar, ser20::make_nvp("frame_count", obj.frame_count));
+    try_load(ar, ser20::make_nvp("positions", obj.positions));
+    try_load(ar, ser20::make_nvp("rotations", obj.rotations));
+    try_load(ar, ser20::make_nvp("scalings", obj.scalings));
+}
+LOAD_INSTANTIATE(compressed_animation, ser20::iarchive_binary_t);
+
 void save_to_file(const std::string& absolute_path, const animation_clip& obj)
 {
     std::ofstream stream(absolute_path);
@@ -78,6 +170,7 @@ void save_to_file_bin(const std::string& absolute_path, const animation_clip& ob
     if(stream.good())
     {
         ser20::oarchive_binary_t ar(stream);
+        try_save(ar, ser20::make_nvp("compressed", obj.compressed));
         try_save(ar, ser20::make_nvp("animation", obj));
     }
 }
@@ -97,8 +190,25 @@ void load_from_file_bin(const std::string& absolute_path, animation_clip& obj)
     std::ifstream stream(absolute_path, std::ios::binary);
     if(stream.good())
     {
-        ser20::iarchive_binary_t ar(stream);
-        try_load(ar, ser20::make_nvp("animation", obj));
+        load_from_stream_bin(stream, obj);
     }
 }
+
+void load_from_stream_bin(std::istream& stream, animation_clip& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("compressed", obj.compressed));
+    if(obj.compressed.version != compressed_animation::current_version)
+    {
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("animation", obj));
+}
+
+void load_uncompressed_from_stream_bin(std::istream& stream, animation_clip& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("animation", obj));
+}
 } // namespace ace
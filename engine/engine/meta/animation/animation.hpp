@@ -17,6 +17,15 @@ SAVE_EXTERN(animation_channel);
 LOAD_EXTERN(animation_channel);
 REFLECT_EXTERN(animation_channel);
 
+SAVE_EXTERN(compressed_animation::track);
+LOAD_EXTERN(compressed_animation::track);
+
+SAVE_EXTERN(compressed_animation::track_set);
+LOAD_EXTERN(compressed_animation::track_set);
+
+SAVE_EXTERN(compressed_animation);
+LOAD_EXTERN(compressed_animation);
+
 template<typename Archive, typename T>
 void SERIALIZE_FUNCTION_NAME(Archive& ar, animation_channel::key<T>& obj)
 {
@@ -28,5 +37,11 @@ void save_to_file(const std::string& absolute_path, const animation_clip& obj);
 void save_to_file_bin(const std::string& absolute_path, const animation_clip& obj);
 void load_from_file(const std::string& absolute_path, animation_clip& obj);
 void load_from_file_bin(const std::string& absolute_path, animation_clip& obj);
+void load_from_stream_bin(std::istream& stream, animation_clip& obj);
+
+/**
+ * @brief Loads a clip compiled before clips were compressed, it has its keys and no compressed tracks.
+ */
+void load_uncompressed_from_stream_bin(std::istream& stream, animation_clip& obj);
 
 } // namespace ace
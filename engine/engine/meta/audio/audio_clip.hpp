@@ -15,5 +15,6 @@ void save_to_file(const std::string& absolute_path, const audio::sound_data& obj
 void save_to_file_bin(const std::string& absolute_path, const audio::sound_data& obj);
 auto load_from_file(const std::string& absolute_path, audio::sound_data& obj, std::string& err) -> bool;
 void load_from_file_bin(const std::string& absolute_path, audio::sound_data& obj);
+void load_from_stream_bin(std::istream& stream, audio::sound_data& obj);
 
 } // namespace ace
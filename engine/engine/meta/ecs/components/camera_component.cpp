@@ -35,13 +35,19 @@ REFLECT(camera_component)
             rttr::metadata("min", 0.1f))
         .property("far_clip_distance", &camera_component::get_far_clip, &camera_component::set_far_clip)(
             rttr::metadata("pretty_name", "Far Clip"))
-        .property("hdr", &camera_component::get_hdr, &camera_component::set_hdr)(rttr::metadata("pretty_name", "HDR"));
+        .property("hdr", &camera_component::get_hdr, &camera_component::set_hdr)(rttr::metadata("pretty_name", "HDR"))
+        .property("clustered_lighting",
+                  &camera_component::get_clustered_lighting,
+                  &camera_component::set_clustered_lighting)(
+            rttr::metadata("pretty_name", "Clustered Lighting"),
+            rttr::metadata("tooltip", "Shades unshadowed point and spot lights in one clustered pass."));
 }
 
 SAVE(camera_component)
 {
     try_save(ar, ser20::make_nvp("camera", obj.get_camera()));
     try_save(ar, ser20::make_nvp("hdr", obj.get_hdr()));
+    try_save(ar, ser20::make_nvp("clustered_lighting", obj.get_clustered_lighting()));
 }
 SAVE_INSTANTIATE(camera_component, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(camera_component, ser20::oarchive_binary_t);
@@ -52,6 +58,10 @@ LOAD(camera_component)
     bool hdr{};
     try_load(ar, ser20::make_nvp("hdr", hdr));
     obj.set_hdr(hdr);
+
+    bool clustered_lighting{};
+    try_load(ar, ser20::make_nvp("clustered_lighting", clustered_lighting));
+    obj.set_clustered_lighting(clustered_lighting);
 }
 LOAD_INSTANTIATE(camera_component, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(camera_component, ser20::iarchive_binary_t);
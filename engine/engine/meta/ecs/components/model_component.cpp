@@ -25,6 +25,9 @@ REFLECT(model_component)
             rttr::metadata("pretty_name", "Casts Shadow"))
         .property("casts_reflection", &model_component::casts_reflection, &model_component::set_casts_reflection)(
             rttr::metadata("pretty_name", "Casts Reflection"))
+        .property("pose_buffer", &model_component::uses_pose_buffer, &model_component::set_pose_buffer)(
+            rttr::metadata("pretty_name", "Pose Buffer"),
+            rttr::metadata("tooltip", "Poses the armature without bone entities, they are only created on demand."))
         .property("model", &model_component::get_model, &model_component::set_model)(
             rttr::metadata("pretty_name", "Model"));
 }
@@ -36,6 +39,7 @@ SAVE(model_component)
     try_save(ar, ser20::make_nvp("casts_shadow", obj.casts_shadow()));
     try_save(ar, ser20::make_nvp("casts_reflection", obj.casts_reflection()));
     try_save(ar, ser20::make_nvp("model", obj.get_model()));
+    try_save(ar, ser20::make_nvp("pose_buffer", obj.uses_pose_buffer()));
 }
 SAVE_INSTANTIATE(model_component, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(model_component, ser20::oarchive_binary_t);
@@ -61,6 +65,10 @@ LOAD(model_component)
     model mod;
     try_load(ar, ser20::make_nvp("model", mod));
     obj.set_model(mod);
+
+    bool pose_buffer{};
+    try_load(ar, ser20::make_nvp("pose_buffer", pose_buffer));
+    obj.set_pose_buffer(pose_buffer);
 }
 LOAD_INSTANTIATE(model_component, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(model_component, ser20::iarchive_binary_t);
@@ -7,11 +7,17 @@
 
 #include "components/all_components.h"
 
+#include <engine/ecs/transform_hierarchy.h>
+#include <engine/rendering/culling/dirty_set.h>
+
 #include "entt/entity/fwd.hpp"
 #include "logging/logging.h"
 
 #include <hpp/utility.hpp>
+#include <algorithm>
+#include <array>
 #include <sstream>
+#include <unordered_map>
 
 namespace ace
 {
@@ -498,6 +504,270 @@ void load_from_archive(Archive& ar, entt::registry& reg)
     pop_load_context(pushed);
 }
 
+// Leads compiled prefabs so they can be told apart from json ones.
+constexpr uint32_t prefab_template_magic = 0x42465042; // "BPFB"
+
+using template_loader = void (*)(ser20::iarchive_binary_t& ar, entt::handle obj);
+
+template<typename T>
+void save_template_component(ser20::oarchive_binary_t& ar, const T& component)
+{
+    try_save(ar, ser20::make_nvp("component", component));
+}
+
+template<typename T>
+void load_template_component(ser20::iarchive_binary_t& ar, entt::handle obj)
+{
+    auto& component = obj.emplace_or_replace<T>();
+    try_load(ar, ser20::make_nvp("component", component));
+}
+
+// Script fields are matched by name against the loaded assemblies. Keeping them associative
+// keeps a template valid when the scripts are recompiled.
+template<>
+void save_template_component<script_component>(ser20::oarchive_binary_t& ar, const script_component& component)
+{
+    std::stringstream ss;
+    {
+        auto script_ar = ser20::create_oarchive_associative(ss);
+        try_save(script_ar, ser20::make_nvp("component", component));
+    }
+    try_save(ar, ser20::make_nvp("script", ss.str()));
+}
+
+template<>
+void load_template_component<script_component>(ser20::iarchive_binary_t& ar, entt::handle obj)
+{
+    std::string script;
+    try_load(ar, ser20::make_nvp("script", script));
+
+    auto& component = obj.emplace_or_replace<script_component>();
+    auto script_ar = ser20::create_iarchive_associative(script.data(), script.size());
+    try_load(script_ar, ser20::make_nvp("component", component));
+}
+
+constexpr uint32_t fnv_offset = 2166136261u;
+constexpr uint32_t fnv_prime = 16777619u;
+
+void hash_bytes(uint32_t& hash, std::string_view bytes)
+{
+    for(char c : bytes)
+    {
+        hash ^= uint8_t(c);
+        hash *= fnv_prime;
+    }
+}
+
+// Stays the same across builds and when component types are added or reordered, unlike a tuple index.
+template<typename T>
+auto get_template_component_id() -> uint32_t
+{
+    static const uint32_t id = []()
+    {
+        uint32_t hash = fnv_offset;
+        hash_bytes(hash, rttr::type::get<T>().get_name().to_string());
+        return hash;
+    }();
+
+    return id;
+}
+
+auto get_template_component_types() -> uint32_t
+{
+    static const uint32_t types = []()
+    {
+        uint32_t hash = fnv_offset;
+        hpp::for_each_tuple_type<all_serializeable_components>(
+            [&](auto index)
+            {
+                using ctype = std::tuple_element_t<decltype(index)::value, all_serializeable_components>;
+                hash_bytes(hash, rttr::type::get<ctype>().get_name().to_string());
+                hash_bytes(hash, {"\0", 1});
+            });
+        return hash;
+    }();
+
+    return types;
+}
+
+auto get_template_loaders() -> const std::unordered_map<uint32_t, template_loader>&
+{
+    static const auto loaders = []()
+    {
+        std::unordered_map<uint32_t, template_loader> result;
+        hpp::for_each_tuple_type<all_serializeable_components>(
+            [&](auto index)
+            {
+                using ctype = std::tuple_element_t<decltype(index)::value, all_serializeable_components>;
+                auto id = get_template_component_id<ctype>();
+                if(!result.emplace(id, &load_template_component<ctype>).second)
+                {
+                    APPLOG_ERROR("Component {0} has the template id of another one.",
+                                 rttr::type::get<ctype>().get_name().to_string());
+                }
+            });
+        return result;
+    }();
+
+    return loaders;
+}
+
+// Loads the components of every template entity into the matching entity of the registry.
+void load_template_components(const prefab_template& templ,
+                              entt::registry& registry,
+                              const std::vector<entt::entity>& entities)
+{
+    const auto& loaders = get_template_loaders();
+
+    fs::stream_buffer<std::vector<uint8_t>>::membuf buffer(templ.data.data(), templ.data.size());
+    std::istream stream(&buffer);
+    ser20::iarchive_binary_t ar(stream);
+
+    for(size_t i = 0; i < entities.size(); ++i)
+    {
+        entt::handle obj(registry, entities[i]);
+
+        const auto& desc = templ.entities[i];
+        for(uint32_t c = desc.first_component; c < desc.first_component + desc.component_count; ++c)
+        {
+            loaders.at(templ.components[c])(ar, obj);
+        }
+    }
+}
+
+// Appends the components of an entity that pass the filter to a template being written.
+template<typename Filter>
+void save_template_entity(ser20::oarchive_binary_t& ar,
+                          entt::const_handle entity,
+                          prefab_template& templ,
+                          Filter&& filter)
+{
+    prefab_template::entity_desc desc;
+    desc.id = entt::to_integral(entity.entity());
+    desc.first_component = uint32_t(templ.components.size());
+
+    hpp::for_each_tuple_type<all_serializeable_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, all_serializeable_components>;
+            if(!filter(index))
+            {
+                return;
+            }
+
+            if(auto component = entity.try_get<ctype>())
+            {
+                templ.components.emplace_back(get_template_component_id<ctype>());
+                save_template_component(ar, *component);
+            }
+        });
+
+    desc.component_count = uint32_t(templ.components.size()) - desc.first_component;
+    if(desc.component_count > 0)
+    {
+        templ.entities.emplace_back(desc);
+    }
+}
+
+// Writes a hierarchy with the save context that is already set up.
+void save_hierarchy_to_template(entt::const_handle obj, prefab_template& templ)
+{
+    bool is_root = obj.all_of<root_component>();
+    if(!is_root)
+    {
+        const_handle_cast(obj).emplace<root_component>();
+    }
+
+    std::vector<entity_data<entt::const_handle>> entities;
+    flatten_hierarchy(obj, entities);
+
+    templ = {};
+    templ.component_types = get_template_component_types();
+    templ.entities.reserve(entities.size());
+
+    std::stringstream ss;
+    {
+        ser20::oarchive_binary_t ar(ss);
+        for(const auto& e : entities)
+        {
+            save_template_entity(ar,
+                                 e.components.entity,
+                                 templ,
+                                 [](auto)
+                                 {
+                                     return true;
+                                 });
+        }
+    }
+
+    const auto data = ss.str();
+    templ.data.assign(data.begin(), data.end());
+
+    if(!is_root)
+    {
+        const_handle_cast(obj).erase<root_component>();
+    }
+}
+
+auto load_from_template_impl(const prefab_template& templ,
+                             entt::registry& registry,
+                             const std::function<void(entt::handle)>& on_create) -> entt::handle
+{
+    if(templ.entities.empty())
+    {
+        return {};
+    }
+
+    bool pushed = push_load_context(registry);
+    auto& load_ctx = get_load_context();
+
+    // Every entity exists up front, so links between them resolve through the mapping.
+    std::vector<entt::entity> created(templ.entities.size());
+    registry.create(created.begin(), created.end());
+    for(size_t i = 0; i < created.size(); ++i)
+    {
+        load_ctx.mapping[entt::entity(templ.entities[i].id)] = entt::handle(registry, created[i]);
+    }
+
+    load_template_components(templ, registry, created);
+
+    if(on_create)
+    {
+        for(auto e : created)
+        {
+            on_create(entt::handle(registry, e));
+        }
+    }
+
+    pop_load_context(pushed);
+
+    return entt::handle(registry, created.front());
+}
+
+auto build_template(const prefab& pfb) -> std::shared_ptr<prefab_template>
+{
+    // APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    auto templ = std::make_shared<prefab_template>();
+
+    const auto& buffer = pfb.buffer.data;
+    if(buffer.empty())
+    {
+        return templ;
+    }
+
+    // Loaded once into a scene of its own with the current scripts, then kept as component data.
+    scene scratch;
+    auto ar = ser20::create_iarchive_associative(buffer.data(), buffer.size());
+    auto root = load_from_archive_start(ar, *scratch.registry);
+    if(root)
+    {
+        save_to_template(root, *templ);
+    }
+
+    return templ;
+}
+
 } // namespace
 
 void save_to_stream(std::ostream& stream, entt::const_handle obj)
@@ -601,30 +871,24 @@ void load_from_file_bin(const std::string& absolute_path, entt::handle& obj)
 
 auto load_from_prefab(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle
 {
-    entt::handle obj;
-
     const auto& prefab = pfb.get();
-    const auto& buffer = prefab->buffer.data;
 
-    if(!buffer.empty())
+    // Instantiation happens on the main thread, so is the lazy build.
+    if(!prefab->parsed)
     {
-        // APPLOG_INFO_PERF(std::chrono::microseconds);
-
-        auto ar = ser20::create_iarchive_associative(buffer.data(), buffer.size());
+        prefab->parsed = build_template(*prefab);
+    }
 
-        auto on_create = [&pfb](entt::handle obj)
+    auto on_create = [&pfb](entt::handle obj)
+    {
+        if(obj)
         {
-            if(obj)
-            {
-                auto& pfb_comp = obj.get_or_emplace<prefab_component>();
-                pfb_comp.source = pfb;
-            }
-        };
-
-        obj = load_from_archive_start(ar, registry, on_create);
-    }
+            auto& pfb_comp = obj.get_or_emplace<prefab_component>();
+            pfb_comp.source = pfb;
+        }
+    };
 
-    return obj;
+    return load_from_template_impl(*prefab->parsed, registry, on_create);
 }
 auto load_from_prefab_bin(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle
 {
@@ -654,14 +918,392 @@ auto load_from_prefab_bin(const asset_handle<prefab>& pfb, entt::registry& regis
     return obj;
 }
 
+void save_to_template(entt::const_handle obj, prefab_template& templ)
+{
+    bool pushed = push_save_context();
+    auto& save_ctx = get_save_context();
+    save_ctx.save_source = obj;
+    save_ctx.to_prefab = true;
+
+    save_hierarchy_to_template(obj, templ);
+
+    save_ctx.to_prefab = false;
+    save_ctx.save_source = {};
+    pop_save_context(pushed);
+}
+
+auto load_from_template(const prefab_template& templ, entt::registry& registry) -> entt::handle
+{
+    return load_from_template_impl(templ, registry, {});
+}
+
+SAVE(prefab_template)
+{
+    try_save(ar, ser20::make_nvp("magic", prefab_template_magic));
+    try_save(ar, ser20::make_nvp("version", obj.version));
+    try_save(ar, ser20::make_nvp("component_types", obj.component_types));
+
+    std::vector<uint32_t> entities;
+    entities.reserve(obj.entities.size() * 3);
+    for(const auto& desc : obj.entities)
+    {
+        entities.insert(entities.end(), {desc.id, desc.first_component, desc.component_count});
+    }
+
+    try_save(ar, ser20::make_nvp("entities", entities));
+    try_save(ar, ser20::make_nvp("components", obj.components));
+    try_save(ar, ser20::make_nvp("data", obj.data));
+}
+SAVE_INSTANTIATE(prefab_template, ser20::oarchive_binary_t);
+
+LOAD(prefab_template)
+{
+    uint32_t magic = 0;
+    try_load(ar, ser20::make_nvp("magic", magic));
+    if(magic != prefab_template_magic)
+    {
+        obj.version = 0;
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("version", obj.version));
+    if(obj.version != prefab_template::current_version)
+    {
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("component_types", obj.component_types));
+    if(is_stale(obj))
+    {
+        return;
+    }
+
+    std::vector<uint32_t> entities;
+    try_load(ar, ser20::make_nvp("entities", entities));
+    try_load(ar, ser20::make_nvp("components", obj.components));
+    try_load(ar, ser20::make_nvp("data", obj.data));
+
+    obj.entities.clear();
+    obj.entities.reserve(entities.size() / 3);
+    for(size_t i = 0; i + 2 < entities.size(); i += 3)
+    {
+        obj.entities.push_back({entities[i], entities[i + 1], entities[i + 2]});
+    }
+
+    // Instantiation trusts the tables, check them once here.
+    const auto& loaders = get_template_loaders();
+    bool valid = std::all_of(obj.components.begin(),
+                             obj.components.end(),
+                             [&](uint32_t type)
+                             {
+                                 return loaders.contains(type);
+                             }) &&
+                 std::all_of(obj.entities.begin(),
+                             obj.entities.end(),
+                             [&](const prefab_template::entity_desc& desc)
+                             {
+                                 return size_t(desc.first_component) + desc.component_count <= obj.components.size();
+                             });
+    if(!valid)
+    {
+        APPLOG_ERROR("Prefab template has invalid component tables.");
+        obj.entities.clear();
+        obj.components.clear();
+        obj.data.clear();
+    }
+}
+LOAD_INSTANTIATE(prefab_template, ser20::iarchive_binary_t);
+
+void save_to_file_bin(const std::string& absolute_path, const prefab_template& obj)
+{
+    std::ofstream stream(absolute_path, std::ios::binary);
+    if(stream.good())
+    {
+        ser20::oarchive_binary_t ar(stream);
+        try_save(ar, ser20::make_nvp("prefab", obj));
+    }
+}
+
+void load_from_stream_bin(std::istream& stream, prefab_template& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("prefab", obj));
+}
+
+auto is_stale(const prefab_template& obj) -> bool
+{
+    if(obj.version == 0)
+    {
+        return false;
+    }
+
+    return obj.version != prefab_template::current_version ||
+           obj.component_types != get_template_component_types();
+}
+
+namespace
+{
+
+// Plain data, copied as is. The handles they hold stay valid since entities are restored under the same
+// identifiers. Everything else in all_serializeable_components owns runtime objects and is archived.
+using snapshot_copied_components = std::tuple<id_component,
+                                              tag_component,
+                                              prefab_component,
+                                              root_component,
+                                              transform_component,
+                                              test_component,
+                                              model_component,
+                                              bone_component,
+                                              submesh_component,
+                                              physics_component,
+                                              animation_component>;
+
+template<typename T, typename Tuple>
+struct tuple_contains;
+
+template<typename T, typename... Ts>
+struct tuple_contains<T, std::tuple<Ts...>> : std::bool_constant<(std::is_same_v<T, Ts> || ...)>
+{
+};
+
+template<typename T>
+struct snapshot_storage : scene_snapshot::storage_base
+{
+    std::vector<entt::entity> entities;
+    std::vector<T> values;
+};
+
+template<typename T>
+void restore_full(const snapshot_storage<T>& copy, entt::registry& registry)
+{
+    for(size_t i = 0; i < copy.entities.size(); ++i)
+    {
+        // Construction hooks see a default component, e.g. to set its owner, before it gets its values.
+        registry.emplace<T>(copy.entities[i]) = copy.values[i];
+    }
+}
+
+template<typename T>
+void restore_changed(const snapshot_storage<T>& copy, entt::registry& registry, std::vector<uint8_t>& saved)
+{
+    for(size_t i = 0; i < copy.entities.size(); ++i)
+    {
+        const auto e = copy.entities[i];
+        saved[entt::to_entity(e)] = 1;
+
+        // Assigned in place, components that were there all along do not go through their hooks again.
+        if(auto component = registry.try_get<T>(e))
+        {
+            *component = copy.values[i];
+        }
+        else
+        {
+            registry.emplace<T>(e) = copy.values[i];
+        }
+    }
+
+    std::vector<entt::entity> added;
+    for(auto e : registry.view<T>())
+    {
+        const auto index = size_t(entt::to_entity(e));
+        if(index >= saved.size() || !saved[index])
+        {
+            added.emplace_back(e);
+        }
+    }
+    registry.remove<T>(added.begin(), added.end());
+
+    for(auto e : copy.entities)
+    {
+        saved[entt::to_entity(e)] = 0;
+    }
+}
+
+} // namespace
+
+void save_to_snapshot(const scene& scn, scene_snapshot& snapshot)
+{
+    auto& registry = *scn.registry;
+
+    snapshot.entities.clear();
+    for(auto [e] : registry.storage<entt::entity>().each())
+    {
+        snapshot.entities.emplace_back(e);
+    }
+
+    snapshot.storages.clear();
+    hpp::for_each_tuple_type<snapshot_copied_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, snapshot_copied_components>;
+
+            auto copy = std::make_unique<snapshot_storage<ctype>>();
+            auto view = registry.view<ctype>();
+            copy->entities.reserve(view.size());
+            copy->values.reserve(view.size());
+            view.each(
+                [&](auto e, auto&& comp)
+                {
+                    copy->entities.emplace_back(e);
+                    copy->values.emplace_back(comp);
+                });
+
+            snapshot.storages.emplace_back(std::move(copy));
+        });
+
+    bool pushed = push_save_context();
+    std::stringstream ss;
+    {
+        ser20::oarchive_binary_t ar(ss);
+
+        snapshot.archived = {};
+        for(auto e : snapshot.entities)
+        {
+            save_template_entity(ar,
+                                 entt::const_handle(registry, e),
+                                 snapshot.archived,
+                                 [](auto index)
+                                 {
+                                     using ctype = std::tuple_element_t<decltype(index)::value,
+                                                                        all_serializeable_components>;
+                                     return !tuple_contains<ctype, snapshot_copied_components>::value;
+                                 });
+        }
+    }
+    pop_save_context(pushed);
+
+    const auto data = ss.str();
+    snapshot.archived.data.assign(data.begin(), data.end());
+}
+
+void load_from_snapshot(const scene_snapshot& snapshot, scene& scn, scene_snapshot::restore_mode mode)
+{
+    auto& registry = *scn.registry;
+
+    // Recreated entities get the identifier and version they had, so handles held by components stay valid.
+    size_t max_index = 0;
+    for(auto e : snapshot.entities)
+    {
+        max_index = std::max<size_t>(max_index, entt::to_entity(e) + 1);
+    }
+
+    if(mode == scene_snapshot::restore_mode::full)
+    {
+        registry.clear();
+        registry.ctx().get<dirty_set>().clear();
+        for(auto e : snapshot.entities)
+        {
+            registry.create(e);
+        }
+    }
+    else
+    {
+        std::vector<entt::entity> saved_at(max_index, entt::null);
+        for(auto e : snapshot.entities)
+        {
+            saved_at[entt::to_entity(e)] = e;
+        }
+
+        // Destroyed first, an entity created during play may hold the slot of a saved one.
+        std::vector<entt::entity> added;
+        for(auto [e] : registry.storage<entt::entity>().each())
+        {
+            const auto index = size_t(entt::to_entity(e));
+            if(index >= saved_at.size() || saved_at[index] != e)
+            {
+                added.emplace_back(e);
+            }
+        }
+        registry.destroy(added.begin(), added.end());
+
+        for(auto e : snapshot.entities)
+        {
+            if(!registry.valid(e))
+            {
+                registry.create(e);
+            }
+        }
+    }
+
+    std::vector<uint8_t> saved(max_index, 0);
+    hpp::for_each_tuple_type<snapshot_copied_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, snapshot_copied_components>;
+
+            const auto& copy = static_cast<const snapshot_storage<ctype>&>(*snapshot.storages[decltype(index)::value]);
+            if(mode == scene_snapshot::restore_mode::full)
+            {
+                restore_full(copy, registry);
+            }
+            else
+            {
+                restore_changed(copy, registry, saved);
+            }
+        });
+
+    // Runtime objects are always made again, the previous ones may belong to an unloaded script domain.
+    hpp::for_each_tuple_type<all_serializeable_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, all_serializeable_components>;
+            if constexpr(!tuple_contains<ctype, snapshot_copied_components>::value)
+            {
+                registry.clear<ctype>();
+            }
+        });
+
+    if(!snapshot.archived.entities.empty())
+    {
+        bool pushed = push_load_context(registry);
+        auto& load_ctx = get_load_context();
+
+        // Links between entities resolve to themselves.
+        auto sorted = snapshot.entities;
+        std::sort(sorted.begin(), sorted.end());
+        for(auto e : sorted)
+        {
+            load_ctx.mapping.emplace_hint(load_ctx.mapping.end(), e, entt::handle(registry, e));
+        }
+
+        std::vector<entt::entity> entities;
+        entities.reserve(snapshot.archived.entities.size());
+        for(const auto& desc : snapshot.archived.entities)
+        {
+            entities.emplace_back(entt::entity(desc.id));
+        }
+
+        load_template_components(snapshot.archived, registry, entities);
+
+        pop_load_context(pushed);
+    }
+
+    // Values changed without going through the setters, redraw everything once.
+    registry.view<model_component>().each(
+        [](auto e, auto&& comp)
+        {
+            comp.touch();
+        });
+
+    if(auto hierarchy = registry.ctx().find<transform_hierarchy>())
+    {
+        hierarchy->invalidate();
+    }
+}
+
 void clone_entity_from_stream(entt::const_handle src_obj, entt::handle& dst_obj)
 {
     // APPLOG_INFO_PERF(std::chrono::microseconds);
 
-    std::stringstream ss;
-    save_to_stream(ss, src_obj);
+    // Goes through a binary template, links are resolved as when the hierarchy was cloned through json.
+    bool pushed = push_save_context();
+
+    prefab_template templ;
+    save_hierarchy_to_template(src_obj, templ);
+
+    pop_save_context(pushed);
 
-    load_from(ss, dst_obj);
+    dst_obj = load_from_template(templ, *dst_obj.registry());
 }
 
 void save_to_stream(std::ostream& stream, const scene& scn)
@@ -5,7 +5,9 @@
 #include <reflection/reflection.h>
 #include <serialization/serialization.h>
 
+#include <memory>
 #include <string_view>
+#include <vector>
 
 namespace ace
 {
@@ -33,9 +35,38 @@ void load_from_file(const std::string& absolute_path, entt::handle& obj);
 void load_from_stream_bin(std::istream& stream, entt::handle& obj);
 void load_from_file_bin(const std::string& absolute_path, entt::handle& obj);
 
+/**
+ * @brief Instantiates a prefab from its template, building the template from the buffer first if needed.
+ */
 auto load_from_prefab(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle;
 auto load_from_prefab_bin(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle;
 
+/**
+ * @brief Parses a hierarchy into a template. Links to entities outside of it are dropped, like when saving a prefab.
+ */
+void save_to_template(entt::const_handle obj, prefab_template& templ);
+
+/**
+ * @brief Creates the entities of a template in bulk and loads their components.
+ * @return The root entity, or an empty handle if the template is empty.
+ */
+auto load_from_template(const prefab_template& templ, entt::registry& registry) -> entt::handle;
+
+SAVE_EXTERN(prefab_template);
+LOAD_EXTERN(prefab_template);
+
+void save_to_file_bin(const std::string& absolute_path, const prefab_template& obj);
+/**
+ * @brief Loads a template. obj.version is 0 when the stream holds something else, e.g. a json prefab
+ * compiled before prefabs were, and only the header is read when the template is stale.
+ */
+void load_from_stream_bin(std::istream& stream, prefab_template& obj);
+/**
+ * @brief Whether a template was written with another version or another set of component types
+ * and has to be compiled again. Json prefabs are not templates and are never stale.
+ */
+auto is_stale(const prefab_template& obj) -> bool;
+
 void clone_entity_from_stream(entt::const_handle src_obj, entt::handle& dst_obj);
 
 void save_to_stream(std::ostream& stream, const scene& scn);
@@ -56,6 +87,42 @@ auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, scene& scn) ->
 
 void clone_scene_from_stream(const scene& src_scene, scene& dst_scene);
 
+/**
+ * @struct scene_snapshot
+ * @brief A copy of the entities of a scene that is put back without a json round trip, e.g. around play mode.
+ *
+ * Plain data components are copied storage by storage and come back under the same entity
+ * identifiers, so the handles they hold stay valid. Components that own runtime objects, such
+ * as scripts, audio, cameras and lights, are kept as a binary template and loaded again.
+ */
+struct scene_snapshot
+{
+    enum class restore_mode
+    {
+        full,    ///< Clears the registry and recreates every entity and component.
+        changed, ///< Assigns copied components in place, only what was added or removed since the save is redone.
+    };
+
+    /**
+     * @struct storage_base
+     * @brief The copy of one component storage.
+     */
+    struct storage_base
+    {
+        virtual ~storage_base() = default;
+    };
+
+    /// Entities alive at save time, with their versions.
+    std::vector<entt::entity> entities;
+    /// One per copied component type.
+    std::vector<std::unique_ptr<storage_base>> storages;
+    /// The components that are not copied.
+    prefab_template archived;
+};
+
+void save_to_snapshot(const scene& scn, scene_snapshot& snapshot);
+void load_from_snapshot(const scene_snapshot& snapshot, scene& scn, scene_snapshot::restore_mode mode);
+
 
 template<typename Stream, typename T>
 void load_from(Stream& stream, T& scn)
@@ -119,8 +119,13 @@ void load_from_file_bin(const std::string& absolute_path, physics_material::sptr
     std::ifstream stream(absolute_path, std::ios::binary);
     if(stream.good())
     {
-        ser20::iarchive_binary_t ar(stream);
-        try_load(ar, ser20::make_nvp("physics_material", *obj));
+        load_from_stream_bin(stream, obj);
     }
 }
+
+void load_from_stream_bin(std::istream& stream, physics_material::sptr& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("physics_material", *obj));
+}
 } // namespace ace
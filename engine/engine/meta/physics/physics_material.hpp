@@ -15,5 +15,6 @@ void save_to_file(const std::string& absolute_path, const physics_material::sptr
 void save_to_file_bin(const std::string& absolute_path, const physics_material::sptr& obj);
 void load_from_file(const std::string& absolute_path, physics_material::sptr& obj);
 void load_from_file_bin(const std::string& absolute_path, physics_material::sptr& obj);
+void load_from_stream_bin(std::istream& stream, physics_material::sptr& obj);
 
 } // namespace ace
@@ -68,9 +68,14 @@ void load_from_file_bin(const std::string& absolute_path, std::shared_ptr<materi
     std::ifstream stream(absolute_path, std::ios::binary);
     if(stream.good())
     {
-        ser20::iarchive_binary_t ar(stream);
-        try_load(ar, ser20::make_nvp("material", obj));
+        load_from_stream_bin(stream, obj);
     }
 }
 
+void load_from_stream_bin(std::istream& stream, std::shared_ptr<material>& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("material", obj));
+}
+
 } // namespace ace
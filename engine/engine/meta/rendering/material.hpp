@@ -14,5 +14,6 @@ void save_to_file(const std::string& absolute_path, const std::shared_ptr<materi
 void save_to_file_bin(const std::string& absolute_path, const std::shared_ptr<material>& obj);
 void load_from_file(const std::string& absolute_path, std::shared_ptr<material>& obj);
 void load_from_file_bin(const std::string& absolute_path, std::shared_ptr<material>& obj);
+void load_from_stream_bin(std::istream& stream, std::shared_ptr<material>& obj);
 
 } // namespace ace
@@ -201,6 +201,89 @@ LOAD(mesh::load_data)
 LOAD_INSTANTIATE(mesh::load_data, ser20::iarchive_binary_t);
 LOAD_INSTANTIATE(mesh::load_data, ser20::iarchive_associative_t);
 
+SAVE(bone_palette)
+{
+    try_save(ar, ser20::make_nvp("maximum_size", obj.get_maximum_size()));
+    try_save(ar, ser20::make_nvp("maximum_blend_index", obj.get_maximum_blend_index()));
+    try_save(ar, ser20::make_nvp("data_group", obj.get_data_group()));
+    try_save(ar, ser20::make_nvp("bones", obj.get_bones()));
+}
+SAVE_INSTANTIATE(bone_palette, ser20::oarchive_binary_t);
+SAVE_INSTANTIATE(bone_palette, ser20::oarchive_associative_t);
+
+LOAD(bone_palette)
+{
+    uint32_t maximum_size = 0;
+    int32_t maximum_blend_index = -1;
+    uint32_t data_group = 0;
+    std::vector<uint32_t> bones;
+    try_load(ar, ser20::make_nvp("maximum_size", maximum_size));
+    try_load(ar, ser20::make_nvp("maximum_blend_index", maximum_blend_index));
+    try_load(ar, ser20::make_nvp("data_group", data_group));
+    try_load(ar, ser20::make_nvp("bones", bones));
+
+    obj = bone_palette(maximum_size);
+    obj.set_maximum_blend_index(maximum_blend_index);
+    obj.set_data_group(data_group);
+    obj.assign_bones(bones);
+}
+LOAD_INSTANTIATE(bone_palette, ser20::iarchive_binary_t);
+LOAD_INSTANTIATE(bone_palette, ser20::iarchive_associative_t);
+
+namespace
+{
+// Leads baked files so they can be told apart from load_data, which starts with a vertex layout hash.
+constexpr uint32_t baked_mesh_magic = 0x48534d42; // "BMSH"
+} // namespace
+
+SAVE(mesh::baked_data)
+{
+    try_save(ar, ser20::make_nvp("magic", baked_mesh_magic));
+    try_save(ar, ser20::make_nvp("version", obj.version));
+    try_save(ar, ser20::make_nvp("vertex_format", obj.vertex_format));
+    try_save(ar, ser20::make_nvp("vertex_count", obj.vertex_count));
+    try_save(ar, ser20::make_nvp("vertex_data", obj.vertex_data));
+    try_save(ar, ser20::make_nvp("face_count", obj.face_count));
+    try_save(ar, ser20::make_nvp("index_data", obj.index_data));
+    try_save(ar, ser20::make_nvp("submeshes", obj.submeshes));
+    try_save(ar, ser20::make_nvp("bone_palettes", obj.bone_palettes));
+    try_save(ar, ser20::make_nvp("skin_data", obj.skin_data));
+    try_save(ar, ser20::make_nvp("root_node", obj.root_node));
+    try_save(ar, ser20::make_nvp("bbox", obj.bbox));
+}
+SAVE_INSTANTIATE(mesh::baked_data, ser20::oarchive_binary_t);
+SAVE_INSTANTIATE(mesh::baked_data, ser20::oarchive_associative_t);
+
+LOAD(mesh::baked_data)
+{
+    uint32_t magic = 0;
+    try_load(ar, ser20::make_nvp("magic", magic));
+    if(magic != baked_mesh_magic)
+    {
+        obj.version = 0;
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("version", obj.version));
+    if(obj.version != mesh::baked_data::current_version)
+    {
+        return;
+    }
+
+    try_load(ar, ser20::make_nvp("vertex_format", obj.vertex_format));
+    try_load(ar, ser20::make_nvp("vertex_count", obj.vertex_count));
+    try_load(ar, ser20::make_nvp("vertex_data", obj.vertex_data));
+    try_load(ar, ser20::make_nvp("face_count", obj.face_count));
+    try_load(ar, ser20::make_nvp("index_data", obj.index_data));
+    try_load(ar, ser20::make_nvp("submeshes", obj.submeshes));
+    try_load(ar, ser20::make_nvp("bone_palettes", obj.bone_palettes));
+    try_load(ar, ser20::make_nvp("skin_data", obj.skin_data));
+    try_load(ar, ser20::make_nvp("root_node", obj.root_node));
+    try_load(ar, ser20::make_nvp("bbox", obj.bbox));
+}
+LOAD_INSTANTIATE(mesh::baked_data, ser20::iarchive_binary_t);
+LOAD_INSTANTIATE(mesh::baked_data, ser20::iarchive_associative_t);
+
 void save_to_file(const std::string& absolute_path, const mesh::load_data& obj)
 {
     std::ofstream stream(absolute_path);
@@ -236,9 +319,30 @@ void load_from_file_bin(const std::string& absolute_path, mesh::load_data& obj)
     std::ifstream stream(absolute_path, std::ios::binary);
     if(stream.good())
     {
-        ser20::iarchive_binary_t ar(stream);
-        try_load(ar, ser20::make_nvp("mesh", obj));
+        load_from_stream_bin(stream, obj);
+    }
+}
+
+void load_from_stream_bin(std::istream& stream, mesh::load_data& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("mesh", obj));
+}
+
+void save_to_file_bin(const std::string& absolute_path, const mesh::baked_data& obj)
+{
+    std::ofstream stream(absolute_path, std::ios::binary);
+    if(stream.good())
+    {
+        ser20::oarchive_binary_t ar(stream);
+        try_save(ar, ser20::make_nvp("mesh", obj));
     }
 }
 
+void load_from_stream_bin(std::istream& stream, mesh::baked_data& obj)
+{
+    ser20::iarchive_binary_t ar(stream);
+    try_load(ar, ser20::make_nvp("mesh", obj));
+}
+
 } // namespace ace
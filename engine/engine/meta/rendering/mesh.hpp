@@ -28,10 +28,24 @@ LOAD_EXTERN(mesh::armature_node);
 SAVE_EXTERN(mesh::load_data);
 LOAD_EXTERN(mesh::load_data);
 
+SAVE_EXTERN(bone_palette);
+LOAD_EXTERN(bone_palette);
+
+SAVE_EXTERN(mesh::baked_data);
+LOAD_EXTERN(mesh::baked_data);
+
 void save_to_file(const std::string& absolute_path, const mesh::load_data& obj);
 void save_to_file_bin(const std::string& absolute_path, const mesh::load_data& obj);
 void load_from_file(const std::string& absolute_path, mesh::load_data& obj);
 void load_from_file_bin(const std::string& absolute_path, mesh::load_data& obj);
+void load_from_stream_bin(std::istream& stream, mesh::load_data& obj);
+
+void save_to_file_bin(const std::string& absolute_path, const mesh::baked_data& obj);
+/**
+ * @brief Loads baked mesh data. obj.version is 0 when the stream holds something else, e.g. load_data
+ * compiled before meshes were baked, and only the header is read when the version does not match.
+ */
+void load_from_stream_bin(std::istream& stream, mesh::baked_data& obj);
 
 } // namespace ace
 
@@ -3,6 +3,7 @@
 
 #include <engine/meta/assets/asset_handle.hpp>
 #include <engine/meta/core/math/vector.hpp>
+#include <engine/rendering/texture_streamer.h>
 
 #include <serialization/types/string.hpp>
 #include <serialization/types/unordered_map.hpp>
@@ -98,6 +99,8 @@ LOAD(pbr_material)
     try_load(ar, ser20::make_nvp("tiling", obj.tiling_));
     try_load(ar, ser20::make_nvp("dither_threshold", obj.dither_threshold_));
 
+    // The G-buffer pass records how large these end up on screen, so they can be streamed.
+    texture_streamer::material_scope streamed;
     try_load(ar, ser20::make_nvp("color_map", obj.color_map_));
     try_load(ar, ser20::make_nvp("normal_map", obj.normal_map_));
     try_load(ar, ser20::make_nvp("roughness_map", obj.roughness_map_));
@@ -15,5 +15,6 @@ void save_to_file(const std::string& absolute_path, const script::sptr& obj);
 void save_to_file_bin(const std::string& absolute_path, const script::sptr& obj);
 void load_from_file(const std::string& absolute_path, script::sptr& obj);
 void load_from_file_bin(const std::string& absolute_path, script::sptr& obj);
+void load_from_stream_bin(std::istream& stream, script::sptr& obj);
 
 } // namespace ace
@@ -40,21 +40,110 @@ REFLECT_INLINE(settings::graphics_settings)
 {
     rttr::registration::class_<settings::graphics_settings>("graphics_settings")(
         rttr::metadata("pretty_name", "Graphics"))
-        .constructor<>()();
+        .constructor<>()()
+        .property("texture_streaming_budget", &settings::graphics_settings::texture_streaming_budget)(
+            rttr::metadata("pretty_name", "Texture Streaming Budget (MB)"),
+            rttr::metadata("tooltip", "Texture memory streamed textures may use. Least recently seen give up mips first."))
+        .property("texture_streaming_initial_size", &settings::graphics_settings::texture_streaming_initial_size)(
+            rttr::metadata("pretty_name", "Texture Streaming Initial Size"),
+            rttr::metadata("tooltip", "Largest dimension of the mip textures are first loaded with."))
+        .property("batched_culling", &settings::graphics_settings::batched_culling)(
+            rttr::metadata("pretty_name", "Batched Culling"),
+            rttr::metadata("tooltip", "Cull models in batches on the job system instead of the scene hierarchy."))
+        .property("shadow_atlas_budget", &settings::graphics_settings::shadow_atlas_budget)(
+            rttr::metadata("pretty_name", "Shadow Atlas Budget (MB)"),
+            rttr::metadata("tooltip", "Memory shadow maps may use. Least recently used ones are evicted first."))
+        .property("shadow_map_min_size", &settings::graphics_settings::shadow_map_min_size)(
+            rttr::metadata("pretty_name", "Shadow Map Min Size"),
+            rttr::metadata("tooltip", "Smallest size shadow maps are shrunk to when the budget runs out."))
+        .property("shadow_map_max_size", &settings::graphics_settings::shadow_map_max_size)(
+            rttr::metadata("pretty_name", "Shadow Map Max Size"),
+            rttr::metadata("tooltip", "Largest size a light may use for its shadow map."));
 }
 
 SAVE_INLINE(settings::graphics_settings)
 {
-    // try_save(ar, ser20::make_nvp("company", obj.company));
-    // try_save(ar, ser20::make_nvp("product", obj.product));
-    // try_save(ar, ser20::make_nvp("version", obj.version));
+    try_save(ar, ser20::make_nvp("texture_streaming_budget", obj.texture_streaming_budget));
+    try_save(ar, ser20::make_nvp("texture_streaming_initial_size", obj.texture_streaming_initial_size));
+    try_save(ar, ser20::make_nvp("batched_culling", obj.batched_culling));
+    try_save(ar, ser20::make_nvp("shadow_atlas_budget", obj.shadow_atlas_budget));
+    try_save(ar, ser20::make_nvp("shadow_map_min_size", obj.shadow_map_min_size));
+    try_save(ar, ser20::make_nvp("shadow_map_max_size", obj.shadow_map_max_size));
 }
 
 LOAD_INLINE(settings::graphics_settings)
 {
-    // try_load(ar, ser20::make_nvp("company", obj.company));
-    // try_load(ar, ser20::make_nvp("product", obj.product));
-    // try_load(ar, ser20::make_nvp("version", obj.version));
+    try_load(ar, ser20::make_nvp("texture_streaming_budget", obj.texture_streaming_budget));
+    try_load(ar, ser20::make_nvp("texture_streaming_initial_size", obj.texture_streaming_initial_size));
+    try_load(ar, ser20::make_nvp("batched_culling", obj.batched_culling));
+    try_load(ar, ser20::make_nvp("shadow_atlas_budget", obj.shadow_atlas_budget));
+    try_load(ar, ser20::make_nvp("shadow_map_min_size", obj.shadow_map_min_size));
+    try_load(ar, ser20::make_nvp("shadow_map_max_size", obj.shadow_map_max_size));
+}
+
+REFLECT_INLINE(settings::animation_settings)
+{
+    rttr::registration::class_<settings::animation_settings>("animation_settings")(
+        rttr::metadata("pretty_name", "Animation"))
+        .constructor<>()()
+        .property("compression_sample_rate", &settings::animation_settings::compression_sample_rate)(
+            rttr::metadata("pretty_name", "Compression Sample Rate"),
+            rttr::metadata("tooltip", "Samples per second clips are resampled at when compiled."))
+        .property("compression_position_tolerance", &settings::animation_settings::compression_position_tolerance)(
+            rttr::metadata("pretty_name", "Compression Position Tolerance"),
+            rttr::metadata("tooltip", "Largest position error compressing a clip may introduce."))
+        .property("compression_rotation_tolerance", &settings::animation_settings::compression_rotation_tolerance)(
+            rttr::metadata("pretty_name", "Compression Rotation Tolerance"),
+            rttr::metadata("tooltip", "Largest rotation error compressing a clip may introduce, in radians."))
+        .property("compression_scaling_tolerance", &settings::animation_settings::compression_scaling_tolerance)(
+            rttr::metadata("pretty_name", "Compression Scaling Tolerance"),
+            rttr::metadata("tooltip", "Largest scaling error compressing a clip may introduce."))
+        .property("lod_enabled", &settings::animation_settings::lod_enabled)(
+            rttr::metadata("pretty_name", "LOD"),
+            rttr::metadata("tooltip", "Characters small on screen update their animation less."))
+        .property("lod_reduced_size", &settings::animation_settings::lod_reduced_size)(
+            rttr::metadata("pretty_name", "LOD Reduced Size"),
+            rttr::metadata("tooltip", "Screen height fraction below which poses are sampled every few frames."))
+        .property("lod_minimal_size", &settings::animation_settings::lod_minimal_size)(
+            rttr::metadata("pretty_name", "LOD Minimal Size"),
+            rttr::metadata("tooltip", "Screen height fraction below which leaf bones and blend clips are dropped."))
+        .property("lod_frozen_size", &settings::animation_settings::lod_frozen_size)(
+            rttr::metadata("pretty_name", "LOD Frozen Size"),
+            rttr::metadata("tooltip", "Screen height fraction below which renderer based characters stop updating."))
+        .property("lod_reduced_interval", &settings::animation_settings::lod_reduced_interval)(
+            rttr::metadata("pretty_name", "LOD Reduced Interval"),
+            rttr::metadata("tooltip", "Frames between samples of the reduced LOD, interpolated in between."))
+        .property("lod_minimal_interval", &settings::animation_settings::lod_minimal_interval)(
+            rttr::metadata("pretty_name", "LOD Minimal Interval"),
+            rttr::metadata("tooltip", "Frames between samples of the minimal LOD."));
+}
+
+SAVE_INLINE(settings::animation_settings)
+{
+    try_save(ar, ser20::make_nvp("compression_sample_rate", obj.compression_sample_rate));
+    try_save(ar, ser20::make_nvp("compression_position_tolerance", obj.compression_position_tolerance));
+    try_save(ar, ser20::make_nvp("compression_rotation_tolerance", obj.compression_rotation_tolerance));
+    try_save(ar, ser20::make_nvp("compression_scaling_tolerance", obj.compression_scaling_tolerance));
+    try_save(ar, ser20::make_nvp("lod_enabled", obj.lod_enabled));
+    try_save(ar, ser20::make_nvp("lod_reduced_size", obj.lod_reduced_size));
+    try_save(ar, ser20::make_nvp("lod_minimal_size", obj.lod_minimal_size));
+    try_save(ar, ser20::make_nvp("lod_frozen_size", obj.lod_frozen_size));
+    try_save(ar, ser20::make_nvp("lod_reduced_interval", obj.lod_reduced_interval));
+    try_save(ar, ser20::make_nvp("lod_minimal_interval", obj.lod_minimal_interval));
+}
+
+LOAD_INLINE(settings::animation_settings)
+{
+    try_load(ar, ser20::make_nvp("compression_sample_rate", obj.compression_sample_rate));
+    try_load(ar, ser20::make_nvp("compression_position_tolerance", obj.compression_position_tolerance));
+    try_load(ar, ser20::make_nvp("compression_rotation_tolerance", obj.compression_rotation_tolerance));
+    try_load(ar, ser20::make_nvp("compression_scaling_tolerance", obj.compression_scaling_tolerance));
+    try_load(ar, ser20::make_nvp("lod_enabled", obj.lod_enabled));
+    try_load(ar, ser20::make_nvp("lod_reduced_size", obj.lod_reduced_size));
+    try_load(ar, ser20::make_nvp("lod_minimal_size", obj.lod_minimal_size));
+    try_load(ar, ser20::make_nvp("lod_frozen_size", obj.lod_frozen_size));
+    try_load(ar, ser20::make_nvp("lod_reduced_interval", obj.lod_reduced_interval));
+    try_load(ar, ser20::make_nvp("lod_minimal_interval", obj.lod_minimal_interval));
 }
 
 REFLECT_INLINE(settings::standalone_settings)
@@ -85,6 +174,8 @@ REFLECT(settings)
                                          rttr::metadata("tooltip", "Missing..."))
         .property("graphics", &settings::graphics)(rttr::metadata("pretty_name", "Graphics"),
                                                    rttr::metadata("tooltip", "Missing..."))
+        .property("animation", &settings::animation)(rttr::metadata("pretty_name", "Animation"),
+                                                     rttr::metadata("tooltip", "Missing..."))
         .property("standalone", &settings::standalone)(rttr::metadata("pretty_name", "Standalone"),
                                                        rttr::metadata("tooltip", "Missing..."));
 }
@@ -93,6 +184,7 @@ SAVE(settings)
 {
     try_save(ar, ser20::make_nvp("app", obj.app));
     try_save(ar, ser20::make_nvp("graphics", obj.graphics));
+    try_save(ar, ser20::make_nvp("animation", obj.animation));
     try_save(ar, ser20::make_nvp("standalone", obj.standalone));
 }
 SAVE_INSTANTIATE(settings, ser20::oarchive_associative_t);
@@ -102,6 +194,7 @@ LOAD(settings)
 {
     try_load(ar, ser20::make_nvp("app", obj.app));
     try_load(ar, ser20::make_nvp("graphics", obj.graphics));
+    try_load(ar, ser20::make_nvp("animation", obj.animation));
     try_load(ar, ser20::make_nvp("standalone", obj.standalone));
 }
 LOAD_INSTANTIATE(settings, ser20::iarchive_associative_t);
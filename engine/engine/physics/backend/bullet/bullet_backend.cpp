@@ -10,6 +10,7 @@
 #include <engine/engine.h>
 #include <engine/scripting/ecs/components/script_component.h>
 #include <engine/scripting/ecs/systems/script_system.h>
+#include <engine/threading/threader.h>
 
 #define BT_USE_SSE_IN_API
 #include "LinearMath/btThreads.h"
@@ -184,13 +185,83 @@ public:
     }
 };
 
+#ifdef BULLET_MT
+/**
+ * @class job_task_scheduler
+ * @brief Runs the parallel loops of bullet on the engine job system instead of a thread pool of its own.
+ */
+class job_task_scheduler : public btITaskScheduler
+{
+public:
+    job_task_scheduler(ace::job_system& jobs) : btITaskScheduler("ace_jobs"), jobs_(jobs)
+    {
+    }
+
+    auto getMaxNumThreads() const -> int override
+    {
+        return std::min(int(jobs_.get_thread_count()), BT_MAX_THREAD_COUNT);
+    }
+
+    auto getNumThreads() const -> int override
+    {
+        return getMaxNumThreads();
+    }
+
+    void setNumThreads(int num_threads) override
+    {
+        // The job system is sized by the engine.
+    }
+
+    void parallelFor(int begin, int end, int grain_size, const btIParallelForBody& body) override
+    {
+        jobs_.parallel_for(size_t(end - begin),
+                           size_t(std::max(grain_size, 1)),
+                           [&](size_t first, size_t last)
+                           {
+                               body.forLoop(begin + int(first), begin + int(last));
+                           });
+    }
+
+    auto parallelSum(int begin, int end, int grain_size, const btIParallelSumBody& body) -> btScalar override
+    {
+        const auto grain = size_t(std::max(grain_size, 1));
+        const auto count = size_t(end - begin);
+
+        // One partial sum per range, added up in order so the result does not depend on scheduling.
+        std::vector<btScalar> sums((count + grain - 1) / grain, btScalar(0));
+        jobs_.parallel_for(count,
+                           grain,
+                           [&](size_t first, size_t last)
+                           {
+                               sums[first / grain] = body.sumLoop(begin + int(first), begin + int(last));
+                           });
+
+        btScalar sum(0);
+        for(auto partial : sums)
+        {
+            sum += partial;
+        }
+        return sum;
+    }
+
+private:
+    ace::job_system& jobs_;
+};
+#endif
+
 void setup_task_scheduler()
 {
 #ifdef BULLET_MT
     // Select and initialize a task scheduler
     btITaskScheduler* scheduler = btGetTaskScheduler();
     if(!scheduler)
-        scheduler = btCreateDefaultTaskScheduler(); // Use Intel TBB if available
+    {
+        auto& th = ace::engine::context().get_cached<ace::threader>();
+        if(th.jobs)
+        {
+            scheduler = new job_task_scheduler(*th.jobs);
+        }
+    }
 
     if(!scheduler)
         scheduler = btGetSequentialTaskScheduler(); // Fallback to single-threaded
@@ -636,7 +707,7 @@ auto create_dynamics_world() -> bullet::world
 
 #ifdef BULLET_MT
     auto dispatcher = std::make_shared<btCollisionDispatcherMt>(collision_config.get());
-    auto solver_pool = std::make_shared<btConstraintSolverPoolMt>(std::thread::hardware_concurrency());
+    auto solver_pool = std::make_shared<btConstraintSolverPoolMt>(btGetTaskScheduler()->getNumThreads());
     auto solver = std::make_shared<btSequentialImpulseConstraintSolverMt>();
     world.dynamics_world = std::make_shared<btDiscreteDynamicsWorldMt>(dispatcher.get(),
                                                                        broadphase.get(),
@@ -986,7 +1057,7 @@ void sync_transforms(bullet::world& world, physics_component& comp, const math::
     wake_up(body);
 }
 
-auto sync_transforms(physics_component& comp, math::transform& transform) -> bool
+auto sync_transforms(physics_component& comp, math::affine& transform) -> bool
 {
     auto owner = comp.get_owner();
     auto body = owner.try_get<bullet::rigidbody>();
@@ -1000,8 +1071,8 @@ auto sync_transforms(physics_component& comp, math::transform& transform) -> boo
     auto p = bullet::from_bullet(bt_trans.getOrigin());
     auto q = bullet::from_bullet(bt_trans.getRotation());
 
-    transform.set_position(p);
-    transform.set_rotation(q);
+    transform.translation = p;
+    transform.rotation = q;
 
     return true;
 }
@@ -1024,10 +1095,10 @@ void to_physics(bullet::world& world, transform_component& transform, physics_co
 
 void from_physics(bullet::world& world, transform_component& transform, physics_component& comp)
 {
-    auto transform_global = transform.get_transform_global();
+    math::affine transform_global(transform.get_transform_global());
     if(sync_transforms(comp, transform_global))
     {
-        transform.set_transform_global(transform_global);
+        transform.set_transform_global(transform_global.to_transform());
 
         transform.set_dirty(system_id, false);
         comp.set_dirty(system_id, false);
@@ -1,8 +1,268 @@
 #include "profiler.h"
 
+#include <logging/logging.h>
+
+#include <fstream>
+
 namespace ace
 {
 
+struct performance_profiler::thread_buffer
+{
+    std::vector<event> events = std::vector<event>(events_per_thread);
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    ///< Only touched by the owning thread.
+    uint32_t depth{};
+    uint32_t id{};
+};
+
+namespace
+{
+static_assert((performance_profiler::events_per_thread & (performance_profiler::events_per_thread - 1)) == 0,
+              "events_per_thread must be a power of two");
+
+struct thread_slot
+{
+    const performance_profiler* owner{};
+    void* buffer{};
+};
+
+thread_local thread_slot tls_slot;
+
+void write_json_string(std::ofstream& out, const char* str)
+{
+    out << '"';
+    for(const char* c = str; c && *c; ++c)
+    {
+        if(*c == '"' || *c == '\\')
+        {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+performance_profiler::performance_profiler() = default;
+
+performance_profiler::~performance_profiler() = default;
+
+auto performance_profiler::now() const -> uint64_t
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - origin_).count());
+}
+
+auto performance_profiler::get_thread_buffer() -> thread_buffer&
+{
+    if(tls_slot.owner == this)
+    {
+        return *static_cast<thread_buffer*>(tls_slot.buffer);
+    }
+
+    // First event of this thread, the only time recording takes a lock.
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    auto& buffer = threads_.emplace_back(std::make_unique<thread_buffer>());
+    buffer->id = uint32_t(threads_.size());
+
+    tls_slot.owner = this;
+    tls_slot.buffer = buffer.get();
+    return *buffer;
+}
+
+auto performance_profiler::begin_scope() -> uint32_t
+{
+    auto& buffer = get_thread_buffer();
+    return buffer.depth++;
+}
+
+void performance_profiler::end_scope(const char* name, uint64_t begin, uint32_t depth)
+{
+    auto end = now();
+
+    auto& buffer = get_thread_buffer();
+    buffer.depth = depth;
+
+    const auto head = buffer.head.load(std::memory_order_relaxed);
+    const auto tail = buffer.tail.load(std::memory_order_acquire);
+    if(head - tail >= events_per_thread)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[head & (events_per_thread - 1)] = {name, begin, end, depth};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void performance_profiler::drain(thread_buffer& buffer)
+{
+    auto& per_frame = get_per_frame_data_write();
+
+    auto tail = buffer.tail.load(std::memory_order_relaxed);
+    const auto head = buffer.head.load(std::memory_order_acquire);
+
+    for(; tail != head; ++tail)
+    {
+        const auto& ev = buffer.events[tail & (events_per_thread - 1)];
+
+        auto& data = per_frame[ev.name];
+        data.time += float(double(ev.end - ev.begin) / 1000000.0);
+        data.samples++;
+
+        if(capture_frames_left_ > 0)
+        {
+            capture_.push_back({ev, buffer.id});
+        }
+    }
+
+    buffer.tail.store(tail, std::memory_order_release);
+}
+
+void performance_profiler::swap()
+{
+    main_thread_ = get_thread_buffer().id;
+
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        for(auto& buffer : threads_)
+        {
+            drain(*buffer);
+        }
+    }
+
+    if(capture_frames_left_ > 0)
+    {
+        capture_frames_.push_back(now());
+
+        if(--capture_frames_left_ == 0)
+        {
+            write_capture();
+        }
+    }
+
+    current_ = get_next_index();
+    get_per_frame_data_write().clear();
+}
+
+void performance_profiler::start_capture(uint32_t frames, const std::string& path)
+{
+    capture_.clear();
+    capture_frames_.clear();
+    capture_path_ = path;
+    capture_frames_left_ = frames;
+
+    if(frames > 0)
+    {
+        capture_frames_.push_back(now());
+    }
+}
+
+auto performance_profiler::is_capturing() const -> bool
+{
+    return capture_frames_left_ > 0;
+}
+
+auto performance_profiler::get_dropped_events() const -> uint64_t
+{
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+
+    uint64_t dropped = 0;
+    for(const auto& buffer : threads_)
+    {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void performance_profiler::write_capture()
+{
+    std::ofstream out(capture_path_, std::ios::out | std::ios::trunc);
+    if(!out.is_open())
+    {
+        APPLOG_ERROR("Failed to write profiler capture to {}", capture_path_);
+        return;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separator = [&]()
+    {
+        if(!first)
+        {
+            out << ",\n";
+        }
+        first = false;
+    };
+
+    uint32_t thread_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        thread_count = uint32_t(threads_.size());
+    }
+
+    for(uint32_t id = 1; id <= thread_count; ++id)
+    {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << id << ",\"args\":{\"name\":\"";
+        if(id == main_thread_)
+        {
+            out << "Main";
+        }
+        else
+        {
+            out << "Thread " << id;
+        }
+        out << "\"}}";
+    }
+
+    // Timestamps are in microseconds.
+    for(size_t i = 0; i < capture_frames_.size(); ++i)
+    {
+        separator();
+        out << "{\"name\":\"Frame " << i << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":" << main_thread_
+            << ",\"ts\":" << double(capture_frames_[i]) / 1000.0 << "}";
+    }
+
+    for(const auto& captured : capture_)
+    {
+        const auto& ev = captured.ev;
+
+        separator();
+        out << "{\"name\":";
+        write_json_string(out, ev.name);
+        out << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":0,\"tid\":" << captured.thread
+            << ",\"ts\":" << double(ev.begin) / 1000.0 << ",\"dur\":" << double(ev.end - ev.begin) / 1000.0
+            << ",\"args\":{\"depth\":" << ev.depth << "}}";
+    }
+
+    out << "]}\n";
+
+    APPLOG_INFO("Profiler capture of {} events written to {}", capture_.size(), capture_path_);
+
+    capture_.clear();
+    capture_frames_.clear();
+}
+
+auto performance_profiler::get_per_frame_data_read() const -> const record_data_t&
+{
+    return per_frame_data_[get_next_index()];
+}
+
+auto performance_profiler::get_per_frame_data_write() -> record_data_t&
+{
+    return per_frame_data_[current_];
+}
+
+auto performance_profiler::get_next_index() const -> int
+{
+    return (current_ + 1) % int(per_frame_data_.size());
+}
+
 auto get_app_profiler() -> performance_profiler*
 {
     static performance_profiler profiler;
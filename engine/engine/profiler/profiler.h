@@ -1,14 +1,28 @@
 #pragma once
 #include <engine/engine_export.h>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <map>
-#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace ace
 {
 
+/**
+ * @class performance_profiler
+ * @brief Collects timed scopes from any thread.
+ *
+ * Every thread records finished scopes into its own single producer ring buffer, so recording
+ * never takes a lock. Once per frame swap() drains all buffers on the main thread into the
+ * per frame aggregates and, while a capture is running, into a trace that is written as
+ * Chrome trace event json, which chrome://tracing and Perfetto can open.
+ */
 class performance_profiler
 {
 public:
@@ -35,66 +49,115 @@ public:
 
     using record_data_t = std::map<const char*, per_frame_data>;
 
-    void add_record(const char* name, float time)
+    /**
+     * @struct event
+     * @brief A finished scope.
+     */
+    struct event
     {
-        auto& per_frame = get_per_frame_data_write();
-        if(per_frame.find(name) == per_frame.end())
-            per_frame[name] = 0.0f;
+        const char* name{};
+        ///< Nanoseconds since the profiler was created.
+        uint64_t begin{};
+        uint64_t end{};
+        ///< Nesting depth on the recording thread.
+        uint32_t depth{};
+    };
 
-        auto& data = per_frame[name];
-        data.time += time;
-        data.samples++;
-    }
+    ///< Ring buffer capacity per thread, a power of two.
+    static constexpr size_t events_per_thread = 1 << 13;
+
+    performance_profiler();
+    ~performance_profiler();
+
+    /**
+     * @brief Gets the current time in nanoseconds since the profiler was created.
+     */
+    auto now() const -> uint64_t;
+
+    /**
+     * @brief Opens a scope on the calling thread.
+     * @return The depth of the scope, to be passed to end_scope.
+     */
+    auto begin_scope() -> uint32_t;
+
+    /**
+     * @brief Closes a scope on the calling thread and records it. When the thread's buffer
+     * is full the event is dropped and counted.
+     */
+    void end_scope(const char* name, uint64_t begin, uint32_t depth);
+
+    /**
+     * @brief Drains the thread buffers and starts a new frame. Call once per frame from the main thread.
+     */
+    void swap();
+
+    /**
+     * @brief Records the next frames into a trace and writes it once they are done.
+     * @param frames Number of frames to capture.
+     * @param path Output file for the Chrome trace json.
+     */
+    void start_capture(uint32_t frames, const std::string& path);
+    auto is_capturing() const -> bool;
+
+    /**
+     * @brief Gets the number of events dropped because a thread buffer was full.
+     */
+    auto get_dropped_events() const -> uint64_t;
+
+    auto get_per_frame_data_read() const -> const record_data_t&;
+    auto get_per_frame_data_write() -> record_data_t&;
 
-    void swap()
-    {
-        current_ = get_next_index();
-        get_per_frame_data_write().clear();
-    }
+private:
+    struct thread_buffer;
 
-    auto get_per_frame_data_read() const -> const record_data_t&
+    struct captured_event
     {
-        return per_frame_data_[get_next_index()];
-    }
+        event ev;
+        uint32_t thread{};
+    };
 
-    auto get_per_frame_data_write() -> record_data_t&
-    {
-        return per_frame_data_[current_];
-    }
+    auto get_next_index() const -> int;
+    auto get_thread_buffer() -> thread_buffer&;
+    void drain(thread_buffer& buffer);
+    void write_capture();
 
-private:
-    auto get_next_index() const -> int
-    {
-        return (current_ + 1) / per_frame_data_.size();
-    }
+    using clock_t = std::chrono::steady_clock;
+    clock_t::time_point origin_ = clock_t::now();
+
+    mutable std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<thread_buffer>> threads_;
 
     std::array<record_data_t, 2> per_frame_data_;
     int current_{0};
+
+    std::vector<captured_event> capture_;
+    std::vector<uint64_t> capture_frames_;
+    std::string capture_path_;
+    uint32_t capture_frames_left_{};
+    uint32_t main_thread_{};
 };
 
 class scope_perf_timer
 {
 public:
-    using clock_t = std::chrono::high_resolution_clock;
-    using timepoint_t = clock_t::time_point;
-    using duration_t = std::chrono::duration<float, std::milli>;
-
-    scope_perf_timer(const char* name, performance_profiler* profiler) : name_(name), profiler_(profiler)
+    scope_perf_timer(const char* name, performance_profiler* profiler)
+        : name_(name)
+        , profiler_(profiler)
+        , depth_(profiler->begin_scope())
+        , start_(profiler->now())
     {
     }
 
     ~scope_perf_timer()
     {
-        auto end = clock_t::now();
-        auto time = std::chrono::duration_cast<duration_t>(end - start_);
-
-        profiler_->add_record(name_, time.count());
+        profiler_->end_scope(name_, start_, depth_);
     }
 
 private:
     const char* name_;
     performance_profiler* profiler_{};
-    timepoint_t start_ = clock_t::now();
+    uint32_t depth_{};
+    uint64_t start_{};
 };
 
 auto get_app_profiler() -> performance_profiler*;
@@ -0,0 +1,97 @@
+#include "culling_buffer.h"
+
+#include <engine/threading/job_system.h>
+
+#include <algorithm>
+#include <array>
+
+namespace ace
+{
+
+void culling_buffer::reset(size_t count)
+{
+    entities_.assign(count, entt::null);
+    flags_.assign(count, 0);
+    boxes_.resize(count);
+}
+
+void culling_buffer::set(size_t index,
+                         entt::entity e,
+                         uint8_t entity_flags,
+                         const math::bbox& local_bounds,
+                         const math::transform& world)
+{
+    entities_[index] = e;
+    flags_[index] = entity_flags;
+    boxes_.set(index, local_bounds, world);
+}
+
+void culling_buffer::cull_range(const math::frustum& frustum,
+                                uint8_t required_flags,
+                                size_t begin,
+                                size_t end,
+                                std::vector<entt::entity>& out) const
+{
+    std::array<uint8_t, chunk_size> results;
+
+    for(size_t first = begin; first < end; first += chunk_size)
+    {
+        auto last = std::min(end, first + chunk_size);
+
+        math::test_obb_batch(frustum, boxes_, first, last, results.data());
+
+        for(size_t i = first; i < last; ++i)
+        {
+            if(results[i - first] && (flags_[i] & required_flags) == required_flags)
+            {
+                out.emplace_back(entities_[i]);
+            }
+        }
+    }
+}
+
+auto culling_buffer::cull(const math::frustum& frustum, uint8_t required_flags, job_system* jobs) const
+    -> std::vector<entt::entity>
+{
+    // Slots of destroyed or disabled entities never have the enabled flag.
+    required_flags |= flags::is_enabled;
+
+    const auto count = size();
+    const auto chunks = (count + chunk_size - 1) / chunk_size;
+
+    std::vector<entt::entity> result;
+    if(chunks <= 1 || !jobs)
+    {
+        cull_range(frustum, required_flags, 0, count, result);
+        return result;
+    }
+
+    std::vector<std::vector<entt::entity>> chunk_results(chunks);
+    jobs->parallel_for(count,
+                       chunk_size,
+                       [&](size_t begin, size_t end)
+                       {
+                           cull_range(frustum, required_flags, begin, end, chunk_results[begin / chunk_size]);
+                       });
+
+    size_t total = 0;
+    for(const auto& chunk : chunk_results)
+    {
+        total += chunk.size();
+    }
+
+    result.reserve(total);
+    for(const auto& chunk : chunk_results)
+    {
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    }
+
+    return result;
+}
+
+auto culling_buffer::size() const -> size_t
+{
+    return entities_.size();
+}
+
+} // namespace ace
@@ -0,0 +1,86 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <entt/entity/entity.hpp>
+#include <math/math.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ace
+{
+class job_system;
+
+/**
+ * @class culling_buffer
+ * @brief Structure of arrays copy of the data needed to frustum cull renderable entities.
+ *
+ * The model system fills one slot per model component every frame, then culling tests the
+ * boxes in SIMD batches and splits the work into chunks scheduled on the job system.
+ */
+class culling_buffer
+{
+public:
+    /**
+     * @enum flags
+     * @brief Per slot flags used for filtering.
+     */
+    enum flags : uint8_t
+    {
+        is_enabled = 1 << 0,
+        is_static = 1 << 1,
+        is_shadow_caster = 1 << 2,
+        is_reflection_caster = 1 << 3,
+    };
+
+    ///< Number of boxes tested by one job.
+    static constexpr size_t chunk_size = 4096;
+
+    /**
+     * @brief Resizes the buffer and clears all slots. Not thread safe.
+     * @param count The number of slots.
+     */
+    void reset(size_t count);
+
+    /**
+     * @brief Fills a slot. Slots can be filled concurrently from multiple threads.
+     * @param index The slot index.
+     * @param e The entity.
+     * @param entity_flags The entity flags.
+     * @param local_bounds The local bounding box.
+     * @param world The world transform.
+     */
+    void set(size_t index,
+             entt::entity e,
+             uint8_t entity_flags,
+             const math::bbox& local_bounds,
+             const math::transform& world);
+
+    /**
+     * @brief Gathers all entities that have the required flags and are inside or intersect the frustum.
+     * @param frustum The frustum to test against.
+     * @param required_flags Flags that an entity must have.
+     * @param jobs Job system to split the work on. When null the work runs on the calling thread.
+     * @return The visible entities, in slot order.
+     */
+    auto cull(const math::frustum& frustum, uint8_t required_flags, job_system* jobs) const
+        -> std::vector<entt::entity>;
+
+    /**
+     * @brief Gets the number of slots.
+     */
+    auto size() const -> size_t;
+
+private:
+    void cull_range(const math::frustum& frustum,
+                    uint8_t required_flags,
+                    size_t begin,
+                    size_t end,
+                    std::vector<entt::entity>& out) const;
+
+    std::vector<entt::entity> entities_;
+    std::vector<uint8_t> flags_;
+    math::obb_soa boxes_;
+};
+
+} // namespace ace
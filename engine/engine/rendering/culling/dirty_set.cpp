@@ -0,0 +1,69 @@
+#include "dirty_set.h"
+
+#include <algorithm>
+
+namespace ace
+{
+
+void dirty_set::add(entt::entity e, const math::bbox& bounds, uint8_t flags)
+{
+    if(!bounds.is_populated())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back({bounds, flags});
+    pending_entities_.push_back(e);
+}
+
+void dirty_set::commit(uint64_t frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if(frame != frame_)
+    {
+        entries_.clear();
+        entities_.clear();
+        frame_ = frame;
+    }
+
+    entries_.insert(entries_.end(), pending_.begin(), pending_.end());
+    entities_.insert(entities_.end(), pending_entities_.begin(), pending_entities_.end());
+    pending_.clear();
+    pending_entities_.clear();
+
+    std::sort(entities_.begin(), entities_.end());
+    entities_.erase(std::unique(entities_.begin(), entities_.end()), entities_.end());
+}
+
+auto dirty_set::intersects(const math::bbox& volume, uint8_t required_flags) const -> bool
+{
+    return std::any_of(entries_.begin(),
+                       entries_.end(),
+                       [&](const entry& it)
+                       {
+                           return (it.flags & required_flags) == required_flags && volume.intersect(it.bounds);
+                       });
+}
+
+auto dirty_set::contains(entt::entity e) const -> bool
+{
+    return std::binary_search(entities_.begin(), entities_.end(), e);
+}
+
+auto dirty_set::size() const -> size_t
+{
+    return entries_.size();
+}
+
+void dirty_set::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+    pending_entities_.clear();
+    entries_.clear();
+    entities_.clear();
+}
+
+} // namespace ace
@@ -0,0 +1,85 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <entt/entity/entity.hpp>
+#include <math/math.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class dirty_set
+ * @brief The renderable entities that changed during a frame and the world bounds they touched.
+ *
+ * The model system records an entity whenever its transform, its component settings or its
+ * skinning changed, together with its bounds before and after the change. Components that
+ * get destroyed record their last bounds. Cached renders such as shadow maps and reflection
+ * probes test their volume against the set to decide if they need to be redrawn.
+ */
+class dirty_set
+{
+public:
+    ///< Query flags matching every entry.
+    static constexpr uint8_t any = 0;
+    ///< Entry flags matching every query, for changes that affect all kinds of renders.
+    static constexpr uint8_t all = 0xff;
+
+    /**
+     * @brief Records a change. Safe to call from multiple threads.
+     * @param e The entity.
+     * @param bounds World bounds affected by the change. Unpopulated bounds are ignored.
+     * @param flags culling_buffer flags of the entity.
+     */
+    void add(entt::entity e, const math::bbox& bounds, uint8_t flags);
+
+    /**
+     * @brief Publishes the recorded changes as the set of the given frame. Changes
+     * committed several times during the same frame are merged.
+     * @param frame The frame.
+     */
+    void commit(uint64_t frame);
+
+    /**
+     * @brief Checks if any committed change with all of the required flags intersects a volume.
+     * @param volume World space volume.
+     * @param required_flags Flags an entry must have, any for all entries.
+     */
+    auto intersects(const math::bbox& volume, uint8_t required_flags = any) const -> bool;
+
+    /**
+     * @brief Checks if an entity changed in the committed frame.
+     */
+    auto contains(entt::entity e) const -> bool;
+
+    /**
+     * @brief Gets the number of committed entries.
+     */
+    auto size() const -> size_t;
+
+    /**
+     * @brief Drops all pending and committed changes.
+     */
+    void clear();
+
+private:
+    struct entry
+    {
+        math::bbox bounds;
+        uint8_t flags{};
+    };
+
+    std::mutex mutex_;
+    std::vector<entry> pending_;
+    std::vector<entt::entity> pending_entities_;
+
+    std::vector<entry> entries_;
+    ///< Sorted for lookups.
+    std::vector<entt::entity> entities_;
+    uint64_t frame_{uint64_t(-1)};
+};
+
+} // namespace ace
@@ -0,0 +1,508 @@
+#include "scene_bvh.h"
+
+#include <algorithm>
+
+namespace ace
+{
+namespace
+{
+auto merge(const math::bbox& a, const math::bbox& b) -> math::bbox
+{
+    return {math::min(a.min, b.min), math::max(a.max, b.max)};
+}
+
+auto surface_area(const math::bbox& b) -> float
+{
+    const auto d = b.max - b.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+auto encloses(const math::bbox& outer, const math::bbox& inner) -> bool
+{
+    return math::all(math::lessThanEqual(outer.min, inner.min)) &&
+           math::all(math::greaterThanEqual(outer.max, inner.max));
+}
+
+} // namespace
+
+scene_bvh::scene_bvh()
+{
+    nodes_.reserve(1024);
+}
+
+void scene_bvh::update(entt::entity e, const math::bbox& bounds)
+{
+    if(!bounds.is_populated())
+    {
+        return;
+    }
+
+    // The tree is not mutated while updates are being queued so reading it here is safe.
+    auto it = leaves_.find(e);
+    if(it != leaves_.end() && encloses(nodes_[it->second].bounds, bounds))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_.emplace_back(e, bounds);
+}
+
+void scene_bvh::commit()
+{
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    for(const auto& [e, bounds] : pending_)
+    {
+        set_bounds(e, bounds);
+    }
+    pending_.clear();
+}
+
+void scene_bvh::remove(entt::entity e)
+{
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        std::erase_if(pending_,
+                      [e](const auto& entry)
+                      {
+                          return entry.first == e;
+                      });
+    }
+
+    auto it = leaves_.find(e);
+    if(it == leaves_.end())
+    {
+        return;
+    }
+
+    auto leaf = it->second;
+    leaves_.erase(it);
+
+    remove_leaf(leaf);
+    free_node(leaf);
+}
+
+void scene_bvh::clear()
+{
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_.clear();
+    nodes_.clear();
+    leaves_.clear();
+    root_ = null_node;
+    free_list_ = null_node;
+}
+
+void scene_bvh::set_bounds(entt::entity e, const math::bbox& bounds)
+{
+    auto it = leaves_.find(e);
+    if(it != leaves_.end())
+    {
+        auto leaf = it->second;
+        if(encloses(nodes_[leaf].bounds, bounds))
+        {
+            return;
+        }
+
+        remove_leaf(leaf);
+
+        nodes_[leaf].bounds = bounds;
+        nodes_[leaf].bounds.inflate(margin_);
+        insert_leaf(leaf);
+        return;
+    }
+
+    auto leaf = allocate_node();
+    auto& n = nodes_[leaf];
+    n.bounds = bounds;
+    n.bounds.inflate(margin_);
+    n.entity = e;
+    n.height = 0;
+
+    leaves_.emplace(e, leaf);
+    insert_leaf(leaf);
+}
+
+auto scene_bvh::allocate_node() -> int32_t
+{
+    if(free_list_ == null_node)
+    {
+        nodes_.emplace_back();
+        return int32_t(nodes_.size() - 1);
+    }
+
+    auto id = free_list_;
+    free_list_ = nodes_[id].parent;
+    nodes_[id] = node{};
+    return id;
+}
+
+void scene_bvh::free_node(int32_t id)
+{
+    auto& n = nodes_[id];
+    n = node{};
+    n.parent = free_list_;
+    free_list_ = id;
+}
+
+void scene_bvh::insert_leaf(int32_t leaf)
+{
+    if(root_ == null_node)
+    {
+        root_ = leaf;
+        nodes_[root_].parent = null_node;
+        return;
+    }
+
+    // Find the best sibling using the surface area heuristic.
+    const auto leaf_bounds = nodes_[leaf].bounds;
+    auto index = root_;
+    while(!nodes_[index].is_leaf())
+    {
+        const auto& current = nodes_[index];
+        auto child1 = current.child1;
+        auto child2 = current.child2;
+
+        float area = surface_area(current.bounds);
+        float combined_area = surface_area(merge(current.bounds, leaf_bounds));
+
+        // Cost of creating a new parent for this node and the new leaf.
+        float cost = 2.0f * combined_area;
+
+        // Minimum cost of pushing the leaf further down the tree.
+        float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto descend_cost = [&](int32_t child)
+        {
+            const auto& c = nodes_[child];
+            float new_area = surface_area(merge(leaf_bounds, c.bounds));
+            if(c.is_leaf())
+            {
+                return new_area + inheritance_cost;
+            }
+            return (new_area - surface_area(c.bounds)) + inheritance_cost;
+        };
+
+        float cost1 = descend_cost(child1);
+        float cost2 = descend_cost(child2);
+
+        if(cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    auto sibling = index;
+
+    // Create a new parent.
+    auto old_parent = nodes_[sibling].parent;
+    auto new_parent = allocate_node();
+    {
+        auto& p = nodes_[new_parent];
+        p.parent = old_parent;
+        p.bounds = merge(leaf_bounds, nodes_[sibling].bounds);
+        p.height = nodes_[sibling].height + 1;
+        p.child1 = sibling;
+        p.child2 = leaf;
+    }
+
+    if(old_parent != null_node)
+    {
+        auto& op = nodes_[old_parent];
+        if(op.child1 == sibling)
+        {
+            op.child1 = new_parent;
+        }
+        else
+        {
+            op.child2 = new_parent;
+        }
+    }
+    else
+    {
+        root_ = new_parent;
+    }
+
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+
+    refit(nodes_[leaf].parent);
+}
+
+void scene_bvh::remove_leaf(int32_t leaf)
+{
+    if(leaf == root_)
+    {
+        root_ = null_node;
+        return;
+    }
+
+    auto parent = nodes_[leaf].parent;
+    auto grand_parent = nodes_[parent].parent;
+    auto sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+    if(grand_parent != null_node)
+    {
+        // Destroy parent and connect sibling to grand parent.
+        auto& gp = nodes_[grand_parent];
+        if(gp.child1 == parent)
+        {
+            gp.child1 = sibling;
+        }
+        else
+        {
+            gp.child2 = sibling;
+        }
+        nodes_[sibling].parent = grand_parent;
+        free_node(parent);
+
+        refit(grand_parent);
+    }
+    else
+    {
+        root_ = sibling;
+        nodes_[sibling].parent = null_node;
+        free_node(parent);
+    }
+
+    nodes_[leaf].parent = null_node;
+}
+
+void scene_bvh::refit(int32_t id)
+{
+    while(id != null_node)
+    {
+        id = balance(id);
+
+        auto& n = nodes_[id];
+        const auto& c1 = nodes_[n.child1];
+        const auto& c2 = nodes_[n.child2];
+
+        n.height = 1 + std::max(c1.height, c2.height);
+        n.bounds = merge(c1.bounds, c2.bounds);
+
+        id = n.parent;
+    }
+}
+
+// Performs a left or right rotation if node A is imbalanced.
+// Returns the new root index of the subtree.
+auto scene_bvh::balance(int32_t ia) -> int32_t
+{
+    auto& a = nodes_[ia];
+    if(a.is_leaf() || a.height < 2)
+    {
+        return ia;
+    }
+
+    auto ib = a.child1;
+    auto ic = a.child2;
+
+    auto& b = nodes_[ib];
+    auto& c = nodes_[ic];
+
+    auto balance_factor = c.height - b.height;
+
+    auto rotate = [&](int32_t iup, int32_t iother)
+    {
+        // Rotate iup up, it takes the place of A.
+        auto& up = nodes_[iup];
+        auto& other = nodes_[iother];
+
+        auto i1 = up.child1;
+        auto i2 = up.child2;
+        auto& n1 = nodes_[i1];
+        auto& n2 = nodes_[i2];
+
+        up.child1 = ia;
+        up.parent = a.parent;
+        a.parent = iup;
+
+        if(up.parent != null_node)
+        {
+            auto& p = nodes_[up.parent];
+            if(p.child1 == ia)
+            {
+                p.child1 = iup;
+            }
+            else
+            {
+                p.child2 = iup;
+            }
+        }
+        else
+        {
+            root_ = iup;
+        }
+
+        auto& replaced = a.child1 == iup ? a.child1 : a.child2;
+
+        // Keep the taller grandchild on the rotated node.
+        if(n1.height > n2.height)
+        {
+            up.child2 = i1;
+            replaced = i2;
+            n2.parent = ia;
+            a.bounds = merge(other.bounds, n2.bounds);
+            up.bounds = merge(a.bounds, n1.bounds);
+            a.height = 1 + std::max(other.height, n2.height);
+            up.height = 1 + std::max(a.height, n1.height);
+        }
+        else
+        {
+            up.child2 = i2;
+            replaced = i1;
+            n1.parent = ia;
+            a.bounds = merge(other.bounds, n1.bounds);
+            up.bounds = merge(a.bounds, n2.bounds);
+            a.height = 1 + std::max(other.height, n1.height);
+            up.height = 1 + std::max(a.height, n2.height);
+        }
+    };
+
+    // Rotate C up
+    if(balance_factor > 1)
+    {
+        rotate(ic, ib);
+        return ic;
+    }
+
+    // Rotate B up
+    if(balance_factor < -1)
+    {
+        rotate(ib, ic);
+        return ib;
+    }
+
+    return ia;
+}
+
+void scene_bvh::visit_subtree(int32_t id, const query_callback_t& callback, std::vector<int32_t>& stack) const
+{
+    auto base = stack.size();
+    stack.push_back(id);
+    while(stack.size() > base)
+    {
+        auto current = stack.back();
+        stack.pop_back();
+
+        const auto& n = nodes_[current];
+        if(n.is_leaf())
+        {
+            callback(n.entity, true);
+            continue;
+        }
+
+        stack.push_back(n.child1);
+        stack.push_back(n.child2);
+    }
+}
+
+void scene_bvh::query(const math::frustum& frustum, const query_callback_t& callback) const
+{
+    if(root_ == null_node)
+    {
+        return;
+    }
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root_);
+
+    while(!stack.empty())
+    {
+        auto id = stack.back();
+        stack.pop_back();
+
+        const auto& n = nodes_[id];
+
+        auto result = frustum.classify_aabb(n.bounds);
+        if(result == math::volume_query::outside)
+        {
+            continue;
+        }
+
+        if(result == math::volume_query::inside)
+        {
+            visit_subtree(id, callback, stack);
+            continue;
+        }
+
+        if(n.is_leaf())
+        {
+            callback(n.entity, false);
+            continue;
+        }
+
+        stack.push_back(n.child1);
+        stack.push_back(n.child2);
+    }
+}
+
+void scene_bvh::query(const math::bbox& volume, const query_callback_t& callback) const
+{
+    if(root_ == null_node)
+    {
+        return;
+    }
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root_);
+
+    while(!stack.empty())
+    {
+        auto id = stack.back();
+        stack.pop_back();
+
+        const auto& n = nodes_[id];
+
+        if(!volume.intersect(n.bounds))
+        {
+            continue;
+        }
+
+        if(encloses(volume, n.bounds))
+        {
+            visit_subtree(id, callback, stack);
+            continue;
+        }
+
+        if(n.is_leaf())
+        {
+            callback(n.entity, false);
+            continue;
+        }
+
+        stack.push_back(n.child1);
+        stack.push_back(n.child2);
+    }
+}
+
+auto scene_bvh::contains(entt::entity e) const -> bool
+{
+    return leaves_.find(e) != leaves_.end();
+}
+
+auto scene_bvh::size() const -> size_t
+{
+    return leaves_.size();
+}
+
+auto scene_bvh::get_height() const -> int32_t
+{
+    if(root_ == null_node)
+    {
+        return 0;
+    }
+
+    return nodes_[root_].height + 1;
+}
+
+void scene_bvh::set_margin(float margin)
+{
+    margin_ = margin;
+}
+
+} // namespace ace
@@ -0,0 +1,143 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <entt/entity/entity.hpp>
+#include <math/math.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class scene_bvh
+ * @brief Dynamic bounding volume hierarchy over the world bounds of renderable entities.
+ *
+ * Leaves store enlarged ("fat") world bounds so that small movements do not require
+ * restructuring the tree. The tree is persistent and is updated incrementally by the
+ * model system, while culling queries walk it and reject whole subtrees at once.
+ */
+class scene_bvh
+{
+public:
+    /**
+     * @brief Callback invoked for every entity that passes a query.
+     * @param e The entity.
+     * @param fully_inside True when the entity's leaf is fully contained by the query volume.
+     */
+    using query_callback_t = std::function<void(entt::entity e, bool fully_inside)>;
+
+    static constexpr int32_t null_node = -1;
+
+    scene_bvh();
+
+    /**
+     * @brief Queues a bounds update for an entity. Safe to call from multiple threads.
+     *
+     * If the new bounds are still contained by the entity's fat bounds nothing is queued.
+     * Queued updates are applied by commit().
+     * @param e The entity.
+     * @param bounds The new world bounds.
+     */
+    void update(entt::entity e, const math::bbox& bounds);
+
+    /**
+     * @brief Applies all updates queued by update(). Must not run concurrently with queries.
+     */
+    void commit();
+
+    /**
+     * @brief Removes an entity from the hierarchy.
+     * @param e The entity.
+     */
+    void remove(entt::entity e);
+
+    /**
+     * @brief Removes all entities.
+     */
+    void clear();
+
+    /**
+     * @brief Visits all entities whose fat bounds are not outside the frustum.
+     * @param frustum The frustum to test against.
+     * @param callback The callback to invoke for each entity.
+     */
+    void query(const math::frustum& frustum, const query_callback_t& callback) const;
+
+    /**
+     * @brief Visits all entities whose fat bounds intersect the volume.
+     * @param volume The world space volume to test against.
+     * @param callback The callback to invoke for each entity.
+     */
+    void query(const math::bbox& volume, const query_callback_t& callback) const;
+
+    /**
+     * @brief Checks if the entity is present in the hierarchy.
+     * @param e The entity.
+     * @return True if the entity is present.
+     */
+    auto contains(entt::entity e) const -> bool;
+
+    /**
+     * @brief Gets the number of entities in the hierarchy.
+     */
+    auto size() const -> size_t;
+
+    /**
+     * @brief Gets the height of the tree. An empty tree has height 0.
+     */
+    auto get_height() const -> int32_t;
+
+    /**
+     * @brief Sets the margin used to enlarge leaf bounds.
+     * @param margin The margin in world units.
+     */
+    void set_margin(float margin);
+
+private:
+    struct node
+    {
+        auto is_leaf() const -> bool
+        {
+            return child1 == null_node;
+        }
+
+        ///< Fat bounds for leaves, union of children for branches.
+        math::bbox bounds;
+        ///< The entity stored in a leaf.
+        entt::entity entity{entt::null};
+        ///< Parent index, or next free node when in the free list.
+        int32_t parent{null_node};
+        int32_t child1{null_node};
+        int32_t child2{null_node};
+        ///< Leaf = 0, free node = -1.
+        int32_t height{-1};
+    };
+
+    auto allocate_node() -> int32_t;
+    void free_node(int32_t id);
+
+    void insert_leaf(int32_t leaf);
+    void remove_leaf(int32_t leaf);
+    auto balance(int32_t id) -> int32_t;
+    void refit(int32_t id);
+
+    void set_bounds(entt::entity e, const math::bbox& bounds);
+    void visit_subtree(int32_t id, const query_callback_t& callback, std::vector<int32_t>& stack) const;
+
+    std::vector<node> nodes_;
+    std::unordered_map<entt::entity, int32_t> leaves_;
+    int32_t root_{null_node};
+    int32_t free_list_{null_node};
+
+    float margin_{0.1f};
+
+    std::mutex pending_mutex_;
+    std::vector<std::pair<entt::entity, math::bbox>> pending_;
+};
+
+} // namespace ace
@@ -24,6 +24,16 @@ void camera_component::set_hdr(bool hdr)
     hdr_ = hdr;
 }
 
+auto camera_component::get_clustered_lighting() const -> bool
+{
+    return clustered_lighting_;
+}
+
+void camera_component::set_clustered_lighting(bool clustered)
+{
+    clustered_lighting_ = clustered;
+}
+
 void camera_component::set_viewport_size(const usize32_t& size)
 {
     pipeline_camera_.get_camera().set_viewport_size(size);
@@ -99,6 +99,18 @@ public:
      */
     void set_hdr(bool hdr);
 
+    /**
+     * @brief Gets whether unshadowed point and spot lights are shaded in one clustered pass.
+     * @return True if clustered lighting is enabled, otherwise false.
+     */
+    auto get_clustered_lighting() const -> bool;
+
+    /**
+     * @brief Sets whether unshadowed point and spot lights are shaded in one clustered pass.
+     * @param[in] clustered True to enable clustered lighting.
+     */
+    void set_clustered_lighting(bool clustered);
+
     /**
      * @brief Sets the viewport size.
      * @param[in] size The size of the viewport.
@@ -154,6 +166,9 @@ private:
     /// @brief Is the camera HDR?
     bool hdr_ = true;
 
+    /// @brief Are unshadowed point and spot lights shaded in one clustered pass?
+    bool clustered_lighting_ = false;
+
     /// @brief The camera storage
     camera_storage storage_;
 };
@@ -1,9 +1,8 @@
 #include "model_component.h"
 #include <engine/ecs/components/id_component.h>
 #include <engine/ecs/components/transform_component.h>
-
-#define POOLSTL_STD_SUPPLEMENT 1
-#include <poolstl/poolstl.hpp>
+#include <engine/rendering/culling/dirty_set.h>
+#include <engine/rendering/culling/scene_bvh.h>
 
 namespace ace
 {
@@ -172,6 +171,98 @@ auto model_component::create_armature() -> bool
     return false;
 }
 
+auto model_component::create_armature_pose() -> bool
+{
+    auto lod = model_.get_lod(0);
+    if(!lod)
+    {
+        return false;
+    }
+    const auto& mesh = lod.get();
+    const auto& root = mesh->get_armature();
+    if(!root)
+    {
+        return false;
+    }
+
+    const auto& skin_data = mesh->get_skin_bind_data();
+
+    auto& pose = armature_pose_;
+    pose = {};
+
+    // Same depth first order as the bone entities, which animation_channel::node_index refers to.
+    std::vector<std::pair<decltype(root.get()), int32_t>> stack{{root.get(), -1}};
+    while(!stack.empty())
+    {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+
+        auto index = int32_t(pose.parents.size());
+        auto query = skin_data.find_bone_by_id(node->name);
+
+        pose.parents.emplace_back(parent);
+        pose.bones.emplace_back(query.bone && query.index >= 0 ? query.index : -1);
+        pose.has_submeshes.emplace_back(node->submeshes.empty() ? 0 : 1);
+        pose.local.emplace_back(node->local_transform);
+
+        for(auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+        {
+            stack.emplace_back(it->get(), index);
+        }
+    }
+    pose.model.resize(pose.parents.size());
+
+    if(skin_data.has_bones())
+    {
+        set_static(false);
+    }
+
+    // Bone entities saved with the scene keep following the pose.
+    auto owner = get_owner();
+    const auto& children = owner.get<transform_component>().get_children();
+    if(get_bone_entity(root->name, children))
+    {
+        create_armature();
+    }
+
+    return true;
+}
+
+void model_component::update_armature_pose(size_t bones_count)
+{
+    auto& pose = armature_pose_;
+    const auto world = get_owner().get<transform_component>().get_transform_global().get_matrix();
+
+    submesh_pose_.transforms.clear();
+    bone_pose_.transforms.resize(bones_count);
+
+    // Parents come first so one pass resolves the hierarchy, the matrix products use the glm intrinsics.
+    const auto count = pose.parents.size();
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto parent = pose.parents[i];
+        const auto local = pose.local[i].to_mat4();
+        pose.model[i] = parent < 0 ? local : pose.model[parent] * local;
+
+        const auto bone = pose.bones[i];
+        if(!pose.has_submeshes[i] && bone < 0)
+        {
+            continue;
+        }
+
+        const auto global = world * pose.model[i];
+        if(pose.has_submeshes[i])
+        {
+            submesh_pose_.transforms.emplace_back(global);
+        }
+
+        if(bone >= 0 && size_t(bone) < bones_count)
+        {
+            bone_pose_.transforms[bone] = global;
+        }
+    }
+}
+
 auto model_component::update_armature() -> bool
 {
     auto lod = model_.get_lod(0);
@@ -188,7 +279,14 @@ auto model_component::update_armature() -> bool
     auto bones_count = skin_data.get_bones().size();
     auto submeshes_count = mesh->get_submeshes_count();
 
-    get_transforms_for_entities(armature_entities, submeshes_count, submesh_pose_, bones_count, bone_pose_);
+    if(pose_buffer_)
+    {
+        update_armature_pose(bones_count);
+    }
+    else
+    {
+        get_transforms_for_entities(armature_entities, submeshes_count, submesh_pose_, bones_count, bone_pose_);
+    }
 
     // Has skinning data?
     if(skin_data.has_bones())
@@ -217,6 +315,16 @@ auto model_component::init_armature() -> bool
     const auto& mesh = lod.get();
     const auto& skin_data = mesh->get_skin_bind_data();
     const auto& armature = mesh->get_armature();
+    if(pose_buffer_)
+    {
+        if(armature && armature_pose_.parents.empty() && create_armature_pose())
+        {
+            return update_armature();
+        }
+
+        return false;
+    }
+
     if(armature && submesh_pose_.transforms.empty())
     {
         if(create_armature())
@@ -320,6 +428,20 @@ void model_component::on_create_component(entt::registry& r, entt::entity e)
 void model_component::on_destroy_component(entt::registry& r, entt::entity e)
 {
     entt::handle entity(r, e);
+
+    if(auto bvh = r.ctx().find<scene_bvh>())
+    {
+        bvh->remove(e);
+    }
+
+    if(auto dirty = r.ctx().find<dirty_set>())
+    {
+        const auto& component = entity.get<model_component>();
+        if(component.is_enabled())
+        {
+            dirty->add(e, component.get_world_bounds(), dirty_set::all);
+        }
+    }
 }
 
 void model_component::set_enabled(bool enabled)
@@ -358,6 +480,23 @@ void model_component::set_static(bool is_static)
     static_ = is_static;
 }
 
+void model_component::set_pose_buffer(bool pose_buffer)
+{
+    if(pose_buffer_ == pose_buffer)
+    {
+        return;
+    }
+
+    touch();
+
+    pose_buffer_ = pose_buffer;
+
+    // The armature is set up again for the new mode by the next init_armature.
+    armature_pose_ = {};
+    submesh_pose_.transforms.clear();
+    skinning_pose_.clear();
+}
+
 void model_component::set_casts_reflection(bool casts_reflection)
 {
     if(casts_reflection_ == casts_reflection)
@@ -385,6 +524,11 @@ auto model_component::is_static() const -> bool
     return static_;
 }
 
+auto model_component::uses_pose_buffer() const -> bool
+{
+    return pose_buffer_;
+}
+
 auto model_component::get_model() const -> const model&
 {
     return model_;
@@ -443,6 +587,29 @@ auto model_component::get_armature_by_id(const std::string& node_id) const -> en
     return {};
 }
 
+auto model_component::create_armature_entities() -> bool
+{
+    return create_armature();
+}
+
+void model_component::set_local_pose(size_t node_index, const math::affine& transform)
+{
+    if(node_index >= armature_pose_.local.size())
+    {
+        return;
+    }
+
+    armature_pose_.local[node_index] = transform;
+    pose_changed_ = true;
+}
+
+auto model_component::consume_pose_changes() -> bool
+{
+    bool changed = pose_changed_;
+    pose_changed_ = false;
+    return changed;
+}
+
 auto model_component::get_armature_by_index(size_t bone_index) const -> entt::handle
 {
     if(bone_index >= armature_entities_.size())
@@ -50,6 +50,17 @@ public:
      */
     void set_static(bool is_static);
 
+    /**
+     * @brief Sets whether the armature is posed through a flat pose buffer instead of bone entities.
+     *
+     * The animation system samples into the local pose and update_armature resolves it in one
+     * pass over the nodes, parents first. Bone entities are only created on demand, see
+     * create_armature_entities, or adopted when the scene already has them.
+     *
+     * @param pose_buffer True to use the pose buffer, false to pose bone entities.
+     */
+    void set_pose_buffer(bool pose_buffer);
+
     /**
      * @brief Checks if the model is enabled.
      * @return True if the model is enabled, false otherwise.
@@ -74,6 +85,12 @@ public:
      */
     auto is_static() const -> bool;
 
+    /**
+     * @brief Checks if the armature is posed through a flat pose buffer.
+     * @return True if it uses the pose buffer, false if it poses bone entities.
+     */
+    auto uses_pose_buffer() const -> bool;
+
     /**
      * @brief Gets the model.
      * @return A constant reference to the model.
@@ -114,6 +131,25 @@ public:
     auto init_armature() -> bool;
     auto update_armature() -> bool;
 
+    /**
+     * @brief Creates the bone entities of a pose buffer armature, e.g. to attach objects to bones.
+     * The animation system keeps them following the pose from then on.
+     * @return True if the entities were created.
+     */
+    auto create_armature_entities() -> bool;
+
+    /**
+     * @brief Sets the local transform of an armature node in the pose buffer.
+     * @param node_index Depth first index of the node, see animation_channel::node_index.
+     * @param transform The transform relative to its parent node.
+     */
+    void set_local_pose(size_t node_index, const math::affine& transform);
+
+    /**
+     * @brief Returns whether the pose buffer changed since the last call and clears the flag.
+     */
+    auto consume_pose_changes() -> bool;
+
     /**
      * @brief Sets the armature entities.
      * @param submesh_entities A vector of handles to the armature entities.
@@ -136,7 +172,26 @@ public:
 
     auto is_skinned() const -> bool;
 private:
+    /**
+     * @brief The armature as flat arrays, nodes in depth first order so parents come before children.
+     */
+    struct armature_pose
+    {
+        ///< Index of the parent node, -1 for the root.
+        std::vector<int32_t> parents;
+        ///< Index of the skin bone, -1 if the node is not a bone.
+        std::vector<int32_t> bones;
+        ///< Whether submeshes are attached to the node.
+        std::vector<uint8_t> has_submeshes;
+        ///< Relative to the parent, starts as the bind pose.
+        std::vector<math::affine> local;
+        ///< Relative to the model.
+        std::vector<math::mat4> model;
+    };
+
     auto create_armature() -> bool;
+    auto create_armature_pose() -> bool;
+    void update_armature_pose(size_t bones_count);
 
     /**
      * @brief Indicates if the model is enabled.
@@ -158,6 +213,16 @@ private:
      */
     bool casts_reflection_ = true;
 
+    /**
+     * @brief Indicates if the armature is posed through armature_pose_ instead of bone entities.
+     */
+    bool pose_buffer_ = false;
+
+    /**
+     * @brief Indicates if the pose buffer changed since it was last consumed.
+     */
+    bool pose_changed_ = false;
+
     /**
      * @brief The model object.
      */
@@ -183,6 +248,11 @@ private:
      */
     std::vector<pose_mat4> skinning_pose_;
 
+    /**
+     * @brief The pose buffer, empty unless pose_buffer_ is set.
+     */
+    armature_pose armature_pose_;
+
     /**
      * @brief World bounds
      */
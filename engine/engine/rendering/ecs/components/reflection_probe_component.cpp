@@ -126,10 +126,29 @@ void reflection_probe_component::update()
     if(fully_generated)
     {
         first_generation_ = false;
+        cycle_in_progress_ = false;
     }
+
+    // Changes made while a cycle was running start another one once it completes.
+    if(!cycle_in_progress_ && invalidated_)
+    {
+        cycle_in_progress_ = true;
+        invalidated_ = false;
+    }
+
     generated_faces_count_ = 0; // Reset the count of generated faces
 }
 
+void reflection_probe_component::invalidate()
+{
+    invalidated_ = true;
+}
+
+auto reflection_probe_component::needs_generation() const -> bool
+{
+    return cycle_in_progress_;
+}
+
 auto reflection_probe_component::get_probe() const -> const reflection_probe&
 {
     return probe_;
@@ -143,6 +162,7 @@ void reflection_probe_component::set_probe(const reflection_probe& probe)
     }
 
     touch();
+    invalidate();
 
     probe_ = probe;
 }
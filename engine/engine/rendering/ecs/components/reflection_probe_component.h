@@ -92,6 +92,16 @@ public:
      */
     void set_generation_frame(size_t face, uint64_t frame);
 
+    /**
+     * @brief Requests the cubemap to be regenerated, e.g. because something inside the probe volume changed.
+     */
+    void invalidate();
+
+    /**
+     * @brief Checks if the cubemap is out of date or a regeneration cycle is still running.
+     */
+    auto needs_generation() const -> bool;
+
 private:
     /**
      * @brief The reflection probe object this component represents.
@@ -113,6 +123,8 @@ private:
     size_t faces_per_frame_ = 1;       // Number of faces to generate per frame
     size_t generated_faces_count_ = 0; // Number of faces generated in the current cycle
     bool first_generation_{true};
+    bool invalidated_{true};   // A change was requested since the current cycle started
+    bool cycle_in_progress_{}; // Faces are being regenerated
 };
 
 } // namespace ace
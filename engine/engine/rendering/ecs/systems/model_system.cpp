@@ -1,17 +1,48 @@
 #include "model_system.h"
 #include <engine/ecs/components/transform_component.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
+#include <engine/rendering/culling/scene_bvh.h>
 #include <engine/rendering/ecs/components/model_component.h>
+#include <engine/rendering/ecs/systems/rendering_system.h>
 
 #include <engine/ecs/ecs.h>
+#include <engine/engine.h>
 #include <engine/profiler/profiler.h>
+#include <engine/threading/threader.h>
+#include <graphics/graphics.h>
 
 #include <logging/logging.h>
 
-#define POOLSTL_STD_SUPPLEMENT 1
-#include <poolstl/poolstl.hpp>
-
 namespace ace
 {
+namespace
+{
+// Transform dirty bit owned by this system.
+const uint8_t system_id = 2;
+
+auto consume_armature_changes(model_component& model_comp) -> bool
+{
+    // A pose buffer changes without touching the bone entities.
+    bool changed = model_comp.consume_pose_changes();
+    for(const auto& armature_entity : model_comp.get_armature_entities())
+    {
+        if(!armature_entity)
+        {
+            continue;
+        }
+
+        auto transform_comp = armature_entity.try_get<transform_component>();
+        if(transform_comp && transform_comp->is_dirty(system_id))
+        {
+            transform_comp->set_dirty(system_id, false);
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+} // namespace
 
 auto model_system::init(rtti::context& ctx) -> bool
 {
@@ -29,30 +60,79 @@ auto model_system::deinit(rtti::context& ctx) -> bool
 
 void model_system::on_frame_update(scene& scn, delta_t dt)
 {
-    APP_SCOPE_PERF("Model System");
-
+    auto& ctx = engine::context();
+    auto& th = ctx.get_cached<threader>();
     auto view = scn.registry->view<transform_component, model_component>();
+    auto& bvh = scn.registry->ctx().get<scene_bvh>();
+    auto& culling = scn.registry->ctx().get<culling_buffer>();
+    auto& dirty = scn.registry->ctx().get<dirty_set>();
+
+    // One culling slot per model component, indexed by its position in the storage. Only batched
+    // culling reads them, the hierarchy is kept up to date either way.
+    const bool fill_culling =
+        ctx.get_cached<rendering_system>().get_culling_method() == rendering::pipeline::culling_method::batched;
+    auto& storage = scn.registry->storage<model_component>();
+    culling.reset(fill_culling ? storage.size() : 0);
+
+    auto update_model = [&](entt::entity entity)
+    {
+        auto& transform_comp = view.get<transform_component>(entity);
+        auto& model_comp = view.get<model_component>(entity);
+
+        // init
+        bool just_initted = model_comp.init_armature();
+
+        if(model_comp.was_used_last_frame() && !just_initted)
+        {
+            model_comp.update_armature();
+        }
+
+        // Setting changes such as casting shadows on or off affect every kind of cached render.
+        const bool touched = just_initted || model_comp.is_touched();
+
+        bool changed = touched || transform_comp.is_dirty(system_id);
+        changed |= consume_armature_changes(model_comp);
+
+        transform_comp.set_dirty(system_id, false);
+        model_comp.clear_touched();
+
+        const auto old_bounds = model_comp.get_world_bounds();
+        model_comp.update_world_bounds(transform_comp.get_transform_global());
+
+        // Only queues work when the bounds escaped their fat bounds in the hierarchy.
+        bvh.update(entity, model_comp.get_world_bounds());
+
+        uint8_t flags = 0;
+        flags |= model_comp.is_enabled() ? culling_buffer::is_enabled : 0;
+        flags |= model_comp.is_static() ? culling_buffer::is_static : 0;
+        flags |= model_comp.casts_shadow() ? culling_buffer::is_shadow_caster : 0;
+        flags |= model_comp.casts_reflection() ? culling_buffer::is_reflection_caster : 0;
+
+        if(fill_culling)
+        {
+            culling.set(storage.index(entity),
+                        entity,
+                        flags,
+                        model_comp.get_local_bounds(),
+                        transform_comp.get_transform_global());
+        }
+
+        if(changed && (touched || model_comp.is_enabled()))
+        {
+            // Both where it was and where it is now need to be redrawn.
+            const uint8_t dirty_flags = touched ? dirty_set::all : flags;
+            dirty.add(entity, old_bounds, dirty_flags);
+            dirty.add(entity, model_comp.get_world_bounds(), dirty_flags);
+        }
+    };
 
     // this code should be thread safe as each task works with a whole hierarchy and
-    // there is no interleaving between tasks.
-    std::for_each(std::execution::par,
-                  view.begin(),
-                  view.end(),
-                  [&](entt::entity entity)
-                  {
-                      auto& transform_comp = view.get<transform_component>(entity);
-                      auto& model_comp = view.get<model_component>(entity);
-
-                      // init
-                      bool just_initted = model_comp.init_armature();
-
-                      if(model_comp.was_used_last_frame() && !just_initted)
-                      {
-                          model_comp.update_armature();
-                      }
-
-                      model_comp.update_world_bounds(transform_comp.get_transform_global());
-                  });
+    // there is no interleaving between tasks. The view can't be split in ranges, so its entities are copied out.
+    std::vector<entt::entity> entities(view.begin(), view.end());
+    th.jobs->parallel_for_each(entities.begin(), entities.end(), update_model);
+
+    bvh.commit();
+    dirty.commit(gfx::get_render_frame());
 }
 
 } // namespace ace
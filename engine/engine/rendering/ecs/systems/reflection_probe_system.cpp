@@ -3,12 +3,19 @@
 
 #include <engine/rendering/ecs/components/reflection_probe_component.h>
 #include <engine/ecs/components/transform_component.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
 #include <engine/ecs/ecs.h>
 
 #include <logging/logging.h>
 
 namespace ace
 {
+namespace
+{
+// Transform dirty bit owned by this system.
+const uint8_t system_id = 3;
+} // namespace
 
 auto reflection_probe_system::init(rtti::context& ctx) -> bool
 {
@@ -26,9 +33,29 @@ auto reflection_probe_system::deinit(rtti::context& ctx) -> bool
 
 void reflection_probe_system::on_frame_update(scene& scn, delta_t dt)
 {
+    auto dirty = scn.registry->ctx().find<dirty_set>();
+
     scn.registry->view<transform_component, reflection_probe_component>().each(
         [&](auto e, auto&& transform, auto&& probe)
         {
+            const auto& probe_data = probe.get_probe();
+
+            bool changed = transform.is_dirty(system_id) || probe_data.method == reflect_method::environment;
+            transform.set_dirty(system_id, false);
+
+            if(!changed && dirty)
+            {
+                // Only static reflection casters are baked into probes.
+                auto world_bounds = math::bbox::mul(probe.get_bounds(), transform.get_transform_global());
+                changed = dirty->intersects(world_bounds,
+                                            uint8_t(culling_buffer::is_static | culling_buffer::is_reflection_caster));
+            }
+
+            if(changed)
+            {
+                probe.invalidate();
+            }
+
             probe.update();
         });
 }
@@ -3,23 +3,99 @@
 #include <engine/rendering/mesh.h>
 #include <engine/rendering/model.h>
 
+#include <engine/animation/ecs/components/animation_component.h>
 #include <engine/animation/ecs/systems/animation_system.h>
 #include <engine/ecs/components/transform_component.h>
 #include <engine/ecs/systems/transform_system.h>
 #include <engine/engine.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
+#include <engine/rendering/culling/scene_bvh.h>
 #include <engine/rendering/ecs/components/camera_component.h>
 #include <engine/rendering/ecs/components/model_component.h>
-#include <engine/rendering/ecs/systems/model_system.h>
+#include <engine/rendering/ecs/components/reflection_probe_component.h>
 #include <engine/rendering/ecs/systems/camera_system.h>
+#include <engine/rendering/ecs/systems/model_system.h>
 #include <engine/rendering/ecs/systems/reflection_probe_system.h>
+#include <engine/rendering/pipeline/deferred/pipeline.h>
+#include <engine/threading/threader.h>
 
 namespace ace
 {
+namespace
+{
+// The steps a camera component renders with, 0 lets the pipeline pick its defaults.
+auto get_pipeline_flags(const camera_component& camera_comp) -> rendering::pipeline::pipeline_flags
+{
+    if(camera_comp.get_clustered_lighting())
+    {
+        return rendering::deferred::pipeline_steps::full | rendering::deferred::pipeline_steps::clustered_lighting;
+    }
+
+    return 0;
+}
+
+// The per system dirty bits of a transform share one bitset, so the systems that clear their own
+// bit can not do so side by side.
+struct transform_dirty_bits
+{
+};
+} // namespace
 
 auto rendering_system::init(rtti::context& ctx) -> bool
 {
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
+    // Declared in the order they used to run, conflicting systems keep that order. Transforms are
+    // resolved by the transform system, the camera and model systems only read them afterwards
+    // and run side by side.
+    prepare_graph_
+        .add("Transform System",
+             [this](rtti::context& ctx, delta_t dt)
+             {
+                 ctx.get_cached<transform_system>().on_frame_update(*prepare_scene_, dt);
+             })
+        .writes<transform_component>();
+
+    prepare_graph_
+        .add("Camera System",
+             [this](rtti::context& ctx, delta_t dt)
+             {
+                 ctx.get_cached<camera_system>().on_frame_update(*prepare_scene_, dt);
+             })
+        .reads<transform_component>()
+        .writes<camera_component>();
+
+    // Creates missing armature entities and clears its dirty bit of the transforms.
+    prepare_graph_
+        .add("Model System",
+             [this](rtti::context& ctx, delta_t dt)
+             {
+                 ctx.get_cached<model_system>().on_frame_update(*prepare_scene_, dt);
+             })
+        .reads<transform_component>()
+        .writes<transform_dirty_bits, model_component, scene_bvh, culling_buffer, dirty_set>();
+
+    // Writes the bone transforms, or the pose buffer of the model component.
+    prepare_graph_
+        .add("Animation System",
+             [this](rtti::context& ctx, delta_t dt)
+             {
+                 ctx.get_cached<animation_system>().on_frame_update(*prepare_scene_, dt);
+             })
+        .reads<camera_component>()
+        .writes<model_component, animation_component, transform_component, transform_dirty_bits>();
+
+    // Clears its dirty bit of the transforms.
+    prepare_graph_
+        .add("Reflection Probe System",
+             [this](rtti::context& ctx, delta_t dt)
+             {
+                 ctx.get_cached<reflection_probe_system>().on_frame_update(*prepare_scene_, dt);
+             })
+        .reads<transform_component, dirty_set>()
+        .writes<transform_dirty_bits, reflection_probe_component>();
+
     return true;
 }
 
@@ -27,17 +103,24 @@ auto rendering_system::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
+    prepare_graph_.clear();
+
     return true;
 }
 
 void rendering_system::prepare_scene(scene& scn, delta_t dt)
 {
     auto& ctx = engine::context();
-    ctx.get_cached<transform_system>().on_frame_update(scn, dt);
-    ctx.get_cached<camera_system>().on_frame_update(scn, dt);
-    ctx.get_cached<model_system>().on_frame_update(scn, dt);
-    ctx.get_cached<animation_system>().on_frame_update(scn, dt);
-    ctx.get_cached<reflection_probe_system>().on_frame_update(scn, dt);
+    auto& th = ctx.get_cached<threader>();
+
+    prepare_scene_ = &scn;
+    prepare_graph_.run(ctx, dt, th.jobs.get());
+    prepare_scene_ = nullptr;
+}
+
+auto rendering_system::get_prepare_graph() const -> const frame_graph&
+{
+    return prepare_graph_;
 }
 
 auto rendering_system::render_scene(camera_component& camera_comp, scene& scn, delta_t dt) -> gfx::frame_buffer::ptr
@@ -47,7 +130,13 @@ auto rendering_system::render_scene(camera_component& camera_comp, scene& scn, d
     auto& pipeline = pipeline_data.get_pipeline();
     auto& rview = camera_comp.get_render_view();
 
-    return pipeline->run_pipeline(scn, camera, rview, dt);
+    pipeline->set_culling_method(culling_method_);
+    return pipeline->run_pipeline(scn,
+                                  camera,
+                                  rview,
+                                  dt,
+                                  rendering::pipeline::visibility_query::not_specified,
+                                  get_pipeline_flags(camera_comp));
 }
 
 auto rendering_system::render_scene(scene& scn, delta_t dt) -> gfx::frame_buffer::ptr
@@ -73,7 +162,14 @@ void rendering_system::render_scene(const gfx::frame_buffer::ptr& output,
     auto& pipeline = pipeline_data.get_pipeline();
     auto& rview = camera_comp.get_render_view();
 
-    pipeline->run_pipeline(output, scn, camera, rview, dt);
+    pipeline->set_culling_method(culling_method_);
+    pipeline->run_pipeline(output,
+                           scn,
+                           camera,
+                           rview,
+                           dt,
+                           rendering::pipeline::visibility_query::not_specified,
+                           get_pipeline_flags(camera_comp));
 }
 
 void rendering_system::render_scene(const gfx::frame_buffer::ptr& output, scene& scn, delta_t dt)
@@ -85,4 +181,14 @@ void rendering_system::render_scene(const gfx::frame_buffer::ptr& output, scene&
         });
 }
 
+void rendering_system::set_culling_method(rendering::pipeline::culling_method method)
+{
+    culling_method_ = method;
+}
+
+auto rendering_system::get_culling_method() const -> rendering::pipeline::culling_method
+{
+    return culling_method_;
+}
+
 } // namespace ace
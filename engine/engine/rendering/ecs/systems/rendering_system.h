@@ -2,6 +2,7 @@
 
 #include <engine/ecs/ecs.h>
 #include <engine/rendering/ecs/components/camera_component.h>
+#include <engine/threading/frame_graph.h>
 #include <graphics/frame_buffer.h>
 #include <graphics/render_view.h>
 
@@ -40,12 +41,17 @@ public:
     auto deinit(rtti::context& ctx) -> bool;
 
     /**
-     * @brief Prepares the scene for rendering.
+     * @brief Prepares the scene for rendering. The scene systems run as a frame graph on the job system.
      * @param scn The scene to prepare.
      * @param dt The delta time.
      */
     void prepare_scene(scene& scn, delta_t dt);
 
+    /**
+     * @brief Gets the scene preparation graph, for the schedule of its last run.
+     */
+    auto get_prepare_graph() const -> const frame_graph&;
+
     /**
      * @brief Renders the scene and returns the frame buffer.
      * @param scn The scene to render.
@@ -77,6 +83,27 @@ public:
      * @param dt The delta time.
      */
     void render_scene(const gfx::frame_buffer::ptr& output, camera_component& comp, scene& scn, delta_t dt);
+
+    /**
+     * @brief Sets the method the cameras use for frustum queries. The model system only fills the
+     * flat bounds buffer when batched culling is selected.
+     * @param method The culling method.
+     */
+    void set_culling_method(rendering::pipeline::culling_method method);
+
+    /**
+     * @brief Gets the method the cameras use for frustum queries.
+     */
+    auto get_culling_method() const -> rendering::pipeline::culling_method;
+
+private:
+    ///< Built once in init, the tasks run on the scene passed to prepare_scene.
+    frame_graph prepare_graph_{"Prepare Scene"};
+    ///< The scene being prepared, only set while the graph runs.
+    scene* prepare_scene_{};
+
+    ///< The method the cameras use for frustum queries.
+    rendering::pipeline::culling_method culling_method_{rendering::pipeline::culling_method::hierarchical};
 };
 
 } // namespace ace
@@ -720,7 +720,7 @@ auto mesh::bind_armature(std::unique_ptr<armature_node>& root) -> bool
     return true;
 }
 
-auto mesh::load_mesh(load_data&& data) -> bool
+auto mesh::load_mesh(load_data&& data, bool hardware_copy) -> bool
 {
     // APPLOG_TRACE_PERF(std::chrono::milliseconds);
 
@@ -732,11 +732,84 @@ auto mesh::load_mesh(load_data&& data) -> bool
     result &= set_submeshes(data.submeshes);
     result &= bind_skin(data.skin_data);
     result &= bind_armature(data.root_node);
-    result &= end_prepare();
+    result &= end_prepare(hardware_copy);
 
     return result;
 }
 
+auto mesh::load_baked(baked_data&& data, bool hardware_copy) -> bool
+{
+    // APPLOG_TRACE_PERF(std::chrono::milliseconds);
+
+    const auto vertex_size = size_t(data.vertex_count) * data.vertex_format.getStride();
+    const auto index_count = size_t(data.face_count) * 3;
+    if(data.version != baked_data::current_version || data.vertex_data.size() != vertex_size ||
+       data.index_data.size() != index_count)
+    {
+        APPLOG_ERROR("Baked mesh data is invalid or of an older version.");
+        return false;
+    }
+
+    // Clear out anything which is currently loaded in the mesh.
+    dispose();
+
+    vertex_format_ = data.vertex_format;
+    vertex_count_ = data.vertex_count;
+    system_vb_ = new uint8_t[vertex_size];
+    std::memcpy(system_vb_, data.vertex_data.data(), vertex_size);
+
+    face_count_ = data.face_count;
+    system_ib_ = new uint32_t[index_count];
+    std::memcpy(system_ib_, data.index_data.data(), index_count * sizeof(uint32_t));
+
+    bbox_ = data.bbox;
+    skin_bind_data_ = std::move(data.skin_data);
+    bone_palettes_ = std::move(data.bone_palettes);
+    root_ = std::move(data.root_node);
+
+    build_submesh_tables(data.submeshes);
+
+    build_vb(hardware_copy);
+    build_ib(hardware_copy);
+
+    prepare_status_ = mesh_status::prepared;
+    hardware_mesh_ = hardware_copy;
+
+    return true;
+}
+
+auto mesh::bake(load_data&& data, baked_data& out) -> bool
+{
+    mesh prepared;
+    if(!prepared.load_mesh(std::move(data), false))
+    {
+        return false;
+    }
+
+    const auto vertex_size = size_t(prepared.vertex_count_) * prepared.vertex_format_.getStride();
+    const auto index_count = size_t(prepared.face_count_) * 3;
+
+    out = {};
+    out.vertex_format = prepared.vertex_format_;
+    out.vertex_count = prepared.vertex_count_;
+    out.vertex_data.assign(prepared.system_vb_, prepared.system_vb_ + vertex_size);
+    out.face_count = prepared.face_count_;
+    out.index_data.assign(prepared.system_ib_, prepared.system_ib_ + index_count);
+
+    out.submeshes.reserve(prepared.mesh_submeshes_.size());
+    for(const auto* submesh : prepared.mesh_submeshes_)
+    {
+        out.submeshes.emplace_back(*submesh);
+    }
+
+    out.bone_palettes = prepared.bone_palettes_;
+    out.skin_data = prepared.skin_bind_data_;
+    out.root_node = std::move(prepared.root_);
+    out.bbox = prepared.bbox_;
+
+    return true;
+}
+
 auto mesh::create_plane(const gfx::vertex_layout& format,
                         float width,
                         float height,
@@ -2742,6 +2815,15 @@ auto mesh::sort_mesh_data() -> bool
     preparation_data_.triangle_count = 0;
     preparation_data_.triangle_data.clear();
 
+    build_submesh_tables(preparation_data_.submeshes);
+
+    preparation_data_.submeshes.clear();
+
+    return true;
+}
+
+void mesh::build_submesh_tables(const std::vector<submesh>& submeshes)
+{
     // Clear out any old data EXCEPT the old submesh index
     // We'll need this in order to understand how to update
     // the material reference counting later on.
@@ -2759,9 +2841,9 @@ auto mesh::sort_mesh_data() -> bool
     non_skinned_submesh_indices_.clear();
     non_skinned_submesh_count_ = {};
 
-    for(size_t i = 0; i < preparation_data_.submeshes.size(); ++i)
+    for(size_t i = 0; i < submeshes.size(); ++i)
     {
-        const auto& s = preparation_data_.submeshes[i];
+        const auto& s = submeshes[i];
         auto* sub = new submesh(s);
 
         if(sub->skinned)
@@ -2778,10 +2860,6 @@ auto mesh::sort_mesh_data() -> bool
         mesh_submeshes_.emplace_back(sub);
         data_groups_[sub->data_group_id].emplace_back(sub);
     }
-
-    preparation_data_.submeshes.clear();
-
-    return true;
 }
 
 void mesh::bind_render_buffers_for_submesh(const submesh* submesh)
@@ -179,7 +179,7 @@ public:
      *
      * @param paletteSize The maximum size of the palette.
      */
-    bone_palette(uint32_t paletteSize);
+    bone_palette(uint32_t paletteSize = 0);
 
     /**
      * @brief Gathers the bone/palette information and matrices ready for drawing the skinned mesh.
@@ -406,6 +406,40 @@ public:
         math::bbox bbox{};
     };
 
+    /**
+     * @brief Final buffers and tables of a prepared mesh.
+     *
+     * Written by the asset compiler so that loading only uploads the buffers and skips
+     * end_prepare. Bump version whenever the preparation or the layout changes.
+     */
+    struct baked_data
+    {
+        static constexpr uint32_t current_version = 1;
+
+        ///< Version the data was baked with, 0 if it is not baked data.
+        uint32_t version = current_version;
+        ///< The final interleaved vertex format.
+        gfx::vertex_layout vertex_format;
+        ///< Final vertex buffer.
+        std::vector<uint8_t> vertex_data;
+        ///< Total number of vertices.
+        uint32_t vertex_count = 0;
+        ///< Final index buffer, three indices per face.
+        std::vector<uint32_t> index_data;
+        ///< Total number of faces.
+        uint32_t face_count = 0;
+        ///< Final submesh table.
+        std::vector<mesh::submesh> submeshes;
+        ///< Bone palettes, one per submesh of a skinned mesh.
+        bone_palette_array_t bone_palettes;
+        ///< Skin data without the per vertex influences.
+        skin_bind_data skin_data;
+        ///< Root node of the armature.
+        std::unique_ptr<armature_node> root_node = nullptr;
+
+        math::bbox bbox{};
+    };
+
     /**
      * @brief Constructs a mesh object.
      */
@@ -484,7 +518,32 @@ public:
      */
     auto bind_armature(std::unique_ptr<armature_node>& root) -> bool;
 
-    auto load_mesh(load_data&& data) -> bool;
+    /**
+     * @brief Prepares the mesh from imported data.
+     *
+     * @param data The imported data.
+     * @param hardware_copy Whether to create the render buffers.
+     * @return true If the mesh was successfully prepared.
+     */
+    auto load_mesh(load_data&& data, bool hardware_copy = true) -> bool;
+
+    /**
+     * @brief Loads a mesh prepared by bake. Only copies and uploads the buffers.
+     *
+     * @param data The baked data, see baked_data::version.
+     * @param hardware_copy Whether to create the render buffers.
+     * @return true If the mesh was successfully loaded.
+     */
+    auto load_baked(baked_data&& data, bool hardware_copy = true) -> bool;
+
+    /**
+     * @brief Runs the full preparation on imported data without creating render buffers.
+     *
+     * @param data The imported data.
+     * @param out The final buffers and tables.
+     * @return true If the mesh was successfully prepared.
+     */
+    static auto bake(load_data&& data, baked_data& out) -> bool;
 
     /**
      * @brief Creates a plane geometry.
@@ -992,6 +1051,13 @@ protected:
      */
     auto sort_mesh_data() -> bool;
 
+    /**
+     * @brief Rebuilds the submesh list and the data group lookups from a submesh table.
+     *
+     * @param submeshes The submesh table.
+     */
+    void build_submesh_tables(const std::vector<submesh>& submeshes);
+
     /**
      * @brief Calculates the best order for triangle data, optimizing for efficient use of the hardware vertex cache.
      *
@@ -1,6 +1,8 @@
 #include "pipeline.h"
 #include <engine/assets/asset_manager.h>
 #include <engine/ecs/components/transform_component.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
 #include <engine/rendering/ecs/components/camera_component.h>
 #include <engine/rendering/ecs/components/light_component.h>
 #include <engine/rendering/ecs/components/model_component.h>
@@ -11,7 +13,10 @@
 #include <engine/rendering/material.h>
 #include <engine/rendering/mesh.h>
 #include <engine/rendering/model.h>
+#include <engine/rendering/render_queue.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/texture_streamer.h>
+#include <engine/threading/threader.h>
 
 #include <engine/profiler/profiler.h>
 
@@ -158,21 +163,28 @@ auto create_or_resize_o_buffer(gfx::render_view& rview, const usize32_t& viewpor
 auto update_lod_data(lod_data& data,
                      const std::vector<urange32_t>& lod_limits,
                      std::size_t total_lods,
-                     float transition_time,
+                     const lod_settings& settings,
                      float dt,
                      const asset_handle<mesh>& mesh,
                      const math::transform& world,
-                     const camera& cam) -> bool
+                     const camera& cam,
+                     irect32_t* screen_rect = nullptr) -> bool
 {
     if(!mesh)
         return false;
 
-    if(total_lods <= 1)
+    if(total_lods <= 1 && !screen_rect)
         return true;
 
     const auto& viewport = cam.get_viewport_size();
     auto rect = mesh.get()->calculate_screen_rect(world, cam);
 
+    if(screen_rect)
+        *screen_rect = rect;
+
+    if(total_lods <= 1)
+        return true;
+
     float percent = math::clamp((float(rect.height()) / float(viewport.height)) * 100.0f, 0.0f, 100.0f);
 
     std::size_t lod = 0;
@@ -186,13 +198,26 @@ auto update_lod_data(lod_data& data,
     }
 
     lod = math::clamp<std::size_t>(lod, 0, total_lods - 1);
+
+    // Stay on the current lod while the size is within its widened range to avoid popping back and forth.
+    if(lod != data.target_lod_index && data.target_lod_index < lod_limits.size())
+    {
+        const auto& range = lod_limits[data.target_lod_index];
+        const auto lower = float(range.min) * (1.0f - settings.hysteresis);
+        const auto upper = float(range.max) * (1.0f + settings.hysteresis);
+        if(percent >= lower && percent <= upper)
+        {
+            lod = data.target_lod_index;
+        }
+    }
+
     if(data.target_lod_index != lod && data.target_lod_index == data.current_lod_index)
         data.target_lod_index = static_cast<std::uint32_t>(lod);
 
     if(data.current_lod_index != data.target_lod_index)
         data.current_time += dt;
 
-    if(data.current_time >= transition_time)
+    if(data.current_time >= settings.transition_time)
     {
         data.current_lod_index = data.target_lod_index;
         data.current_time = 0.0f;
@@ -204,55 +229,60 @@ auto update_lod_data(lod_data& data,
     return true;
 }
 
-auto should_rebuild_reflections(const visibility_set_models_t& visibility_set, const reflection_probe& probe) -> bool
+void record_texture_usage(const render_queue& queue)
 {
-    if(probe.method == reflect_method::environment)
-        return true;
+    auto& streamer = get_texture_streamer();
 
-    for(const auto& element : visibility_set)
-    {
-        const auto& transform_comp_ref = element.get<transform_component>();
-        const auto& model_comp_ref = element.get<model_component>();
+    // Items of a material are mostly adjacent after sorting, record each run once with its largest draw.
+    const material* mat = nullptr;
+    float screen_size = 0.0f;
 
-        const auto& world_transform = transform_comp_ref.get_transform_global();
-        const auto& world_bounds = model_comp_ref.get_world_bounds();
-        const auto& local_bounds = model_comp_ref.get_local_bounds();
+    auto flush = [&]()
+    {
+        if(!mat || screen_size <= 0.0f || rttr::type::get(*mat) != rttr::type::get<pbr_material>())
+        {
+            return;
+        }
 
-        bool result = false;
+        const auto& pbr = static_cast<const pbr_material&>(*mat);
+        const auto& tiling = pbr.get_tiling();
+        const auto texels = screen_size * std::max(std::abs(tiling.x), std::abs(tiling.y));
 
-        for(std::uint32_t i = 0; i < 6; ++i)
+        for(const auto* map : {&pbr.get_color_map(),
+                               &pbr.get_normal_map(),
+                               &pbr.get_roughness_map(),
+                               &pbr.get_metalness_map(),
+                               &pbr.get_ao_map(),
+                               &pbr.get_emissive_map()})
         {
-            const auto& camera = camera::get_face_camera(i, world_transform);
-            // result |= camera.test_obb(local_bounds, world_transform);
-            result |= camera.test_aabb(world_bounds);
+            if(map->is_ready())
+            {
+                streamer.record_usage(map->get(false).get(), texels);
+            }
         }
+    };
 
-        if(result)
-            return true;
+    for(const auto& it : queue.get_items())
+    {
+        if(it.mat != mat)
+        {
+            flush();
+            mat = it.mat;
+            screen_size = 0.0f;
+        }
+        screen_size = std::max(screen_size, it.screen_size);
     }
-
-    return false;
+    flush();
 }
 
-auto should_rebuild_shadows(const visibility_set_models_t& visibility_set,
-                            const light& light,
-                            const math::bbox& light_bounds,
-                            const math::transform& light_transform) -> bool
+auto should_rebuild_shadows(const dirty_set* dirty, const math::bbox& light_world_bounds) -> bool
 {
-    auto light_world_bounds = math::bbox::mul(light_bounds, light_transform);
-    for(const auto& element : visibility_set)
+    if(!dirty)
     {
-        const auto& transform_comp_ref = element.get<transform_component>();
-        const auto& model_comp_ref = element.get<model_component>();
-        const auto& model_world_bounds = model_comp_ref.get_world_bounds();
-
-        bool result = light_world_bounds.intersect(model_world_bounds);
-
-        if(result)
-            return true;
+        return true;
     }
 
-    return false;
+    return dirty->intersects(light_world_bounds, culling_buffer::is_shadow_caster);
 }
 } // namespace
 
@@ -314,13 +344,11 @@ void deferred::build_reflections(scene& scn, const camera& camera, delta_t dt)
 {
     APP_SCOPE_PERF("Reflection Generation Pass");
 
-    auto query = visibility_query::is_dirty | visibility_query::is_static | visibility_query::is_reflection_caster;
-
-    auto dirty_models = gather_visible_models(scn, nullptr, query);
     scn.registry->view<transform_component, reflection_probe_component>().each(
         [&](auto e, auto&& transform_comp, auto&& reflection_probe_comp)
         {
-            if(reflection_probe_comp.already_generated())
+            // The reflection probe system invalidates probes when something inside them changed.
+            if(!reflection_probe_comp.needs_generation() || reflection_probe_comp.already_generated())
             {
                 return;
             }
@@ -337,12 +365,6 @@ void deferred::build_reflections(scene& scn, const camera& camera, delta_t dt)
 
             const auto& probe = reflection_probe_comp.get_probe();
 
-            bool should_rebuild = should_rebuild_reflections(dirty_models, probe);
-
-            // If reflections shouldn't be rebuilt - continue.
-            if(!should_rebuild)
-                return;
-
             {
                 // iterate trough each cube face
                 for(std::uint32_t face = 0; face < 6; ++face)
@@ -374,7 +396,9 @@ void deferred::build_reflections(scene& scn, const camera& camera, delta_t dt)
                     }
 
                     gfx::render_pass::push_scope("build.reflecitons");
+                    rendering_probes_ = true;
                     run_pipeline(cubemap_fbo, scn, camera, rview, dt, vis_flags, pflags);
+                    rendering_probes_ = false;
                     gfx::render_pass::pop_scope();
                 }
             }
@@ -385,10 +409,9 @@ void deferred::build_shadows(scene& scn, const camera& camera, visibility_flags
 {
     APP_SCOPE_PERF("Shadow Generation Pass");
 
-    query |= visibility_query::is_dirty | visibility_query::is_shadow_caster;
+    query |= visibility_query::is_shadow_caster;
 
-    bool queried = false;
-    visibility_set_models_t dirty_models;
+    auto dirty = scn.registry->ctx().find<dirty_set>();
 
     const auto& view = camera.get_view();
     const auto& proj = camera.get_projection();
@@ -412,9 +435,32 @@ void deferred::build_shadows(scene& scn, const camera& camera, visibility_flags
             auto world_transform = transform_comp.get_transform_global();
             world_transform.reset_scale();
             const auto& light_direction = world_transform.z_unit_axis();
+            const auto& light_position = world_transform.get_position();
+
+            // Size local light maps by how much of the screen they cover.
+            uint32_t coverage = 0;
+            if(!camera_dependant)
+            {
+                const auto& viewport = camera.get_viewport_size();
+                irect32_t rect(0, 0, irect32_t::value_type(viewport.width), irect32_t::value_type(viewport.height));
+                auto result = light_comp.compute_projected_sphere_rect(rect,
+                                                                       light_position,
+                                                                       light_direction,
+                                                                       camera_pos,
+                                                                       view,
+                                                                       proj);
+                if(result == 0)
+                {
+                    coverage = 1;
+                }
+                else if(result == 1)
+                {
+                    coverage = uint32_t(std::max(rect.width(), rect.height()));
+                }
+            }
 
             const auto& bounds = light_comp.get_bounds_precise(light_direction);
-            generator.update(camera, light, world_transform);
+            generator.update(camera, light, world_transform, coverage);
 
             if(!camera.test_obb(bounds, world_transform))
             {
@@ -426,21 +472,27 @@ void deferred::build_shadows(scene& scn, const camera& camera, visibility_flags
                 return;
             }
 
-            if(!queried)
+            // Only casters inside the light volume can affect its shadow maps. The sphere is already
+            // offset along the world direction, so it only needs moving to the light.
+            const auto light_sphere = light_comp.get_bounds_sphere_precise(light_direction);
+            math::bbox light_world_bounds;
+            light_world_bounds.from_sphere(light_position + light_sphere.position, light_sphere.radius);
+
+            // Cached maps only need a new render when a caster inside the volume changed. Culled
+            // frames skip this check, is_cached then fails and the maps are redrawn.
+            if(generator.is_cached() && !should_rebuild_shadows(dirty, light_world_bounds))
             {
-                dirty_models = gather_visible_models(scn, nullptr, query);
-                queried = true;
+                generator.mark_validated();
+                return;
             }
 
-            bool should_rebuild = should_rebuild_shadows(dirty_models, light, bounds, world_transform);
-
-            // If shadows shouldn't be rebuilt - continue.
-            if(!should_rebuild)
-                return;
+            auto casters = gather_visible_models(scn, light_world_bounds, query);
 
             APP_SCOPE_PERF("Shadow Generation Pass Per Light After Cull");
 
-            generator.generate_shadowmaps(dirty_models);
+            generator.generate_shadowmaps(casters);
+
+            pass_stats_["Shadow"] += generator.get_stats();
         });
 }
 
@@ -500,6 +552,9 @@ void deferred::run_pipeline_impl(pipeline_flags pipeline,
         build_reflections(scn, camera, dt);
     }
 
+    // Probe faces run their own nested pipelines above, only count the passes of this camera.
+    pass_stats_.clear();
+
     if(apply_shadows)
     {
         build_shadows(scn, camera);
@@ -515,7 +570,7 @@ void deferred::run_pipeline_impl(pipeline_flags pipeline,
     {
         visibility_set = gather_visible_models(scn, &camera.get_frustum(), query);
     }
-    run_g_buffer_pass(visibility_set, camera, rview, dt);
+    run_g_buffer_pass(scn, visibility_set, camera, rview, dt);
 
     if(pipeline & pipeline_steps::assao)
     {
@@ -524,19 +579,21 @@ void deferred::run_pipeline_impl(pipeline_flags pipeline,
 
     run_reflection_probe_pass(scn, camera, rview, dt);
 
-    target = run_lighting_pass(scn, camera, rview, apply_shadows, dt);
+    bool clustered = pipeline & pipeline_steps::clustered_lighting;
+    target = run_lighting_pass(scn, camera, rview, apply_shadows, clustered, dt);
 
     run_atmospherics_pass(target, scn, camera, rview, dt);
 
     run_tonemapping_pass(target, output);
 
-    if(debug_pass_ >= 0 && (pipeline == pipeline_steps::full))
+    if(debug_pass_ >= 0 && (pipeline & pipeline_steps::full) == pipeline_steps::full)
     {
         run_debug_visualization_pass(camera, rview, output);
     }
 }
 
-void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
+void deferred::run_g_buffer_pass(scene& scn,
+                                 const visibility_set_models_t& visibility_set,
                                  const camera& camera,
                                  gfx::render_view& rview,
                                  delta_t dt)
@@ -554,115 +611,204 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
     pass.set_view_proj(view, proj);
     pass.bind(gbuffer.get());
 
-    for(const auto& e : visibility_set)
+    const auto clip_planes = math::vec2(camera.get_near_clip(), camera.get_far_clip());
+    const auto camera_pos = camera.get_position();
+
     {
-        const auto& transform_comp = e.get<transform_component>();
-        auto& model_comp = e.get<model_component>();
+        APP_SCOPE_PERF("G-Buffer Pass Build Queue");
 
-        const auto& model = model_comp.get_model();
-        if(!model.is_valid())
-            continue;
+        // Probe faces render from temporary cameras, only the owning camera keeps lod state.
+        auto* camera_lods = rendering_probes_ ? nullptr : &camera_data_.entity_lods;
+        const auto frame = gfx::get_render_frame();
 
-        const auto& world_transform = transform_comp.get_transform_global();
-        const auto clip_planes = math::vec2(camera.get_near_clip(), camera.get_far_clip());
+        lod_indices_.resize(visibility_set.size());
+        if(camera_lods)
+        {
+            camera_lods->collect_garbage(*scn.registry, frame, lod_settings_.eviction_frames);
+            for(size_t i = 0; i < visibility_set.size(); ++i)
+            {
+                lod_indices_[i] = camera_lods->acquire(visibility_set[i].entity());
+            }
+        }
 
-        lod_data lod_runtime_data{}; // camera_lods[e];
-        const auto transition_time = 0.0f;
-        const auto lod_count = model.get_lods().size();
-        const auto& lod_limits = model.get_lod_limits();
+        auto settings = lod_settings_;
+        if(!camera_lods)
+        {
+            settings.transition_time = 0.0f;
+        }
 
-        const auto base_mesh = model.get_lod(0);
-        if(!base_mesh)
-            continue;
+        auto& th = engine::context().get_cached<threader>();
 
-        if(false == update_lod_data(lod_runtime_data,
-                                    lod_limits,
-                                    lod_count,
-                                    transition_time,
-                                    dt.count(),
-                                    base_mesh,
-                                    world_transform,
-                                    camera))
-            continue;
+        g_buffer_queue_.clear();
+        g_buffer_queue_.build(
+            th.jobs.get(),
+            visibility_set.size(),
+            [&](size_t index, std::vector<render_queue::item>& out)
+            {
+                const auto& e = visibility_set[index];
+                const auto& transform_comp = e.get<transform_component>();
+                auto& model_comp = e.get<model_component>();
+
+                const auto& model = model_comp.get_model();
+                if(!model.is_valid())
+                    return;
+
+                const auto& world_transform = transform_comp.get_transform_global();
+
+                lod_data transient_lod_data{};
+                auto& lod_runtime_data = camera_lods ? camera_lods->get(lod_indices_[index]) : transient_lod_data;
+                lod_runtime_data.last_frame = frame;
+
+                const auto transition_time = settings.transition_time;
+                const auto lod_count = model.get_lods().size();
+                const auto& lod_limits = model.get_lod_limits();
+
+                const auto base_mesh = model.get_lod(0);
+                if(!base_mesh)
+                    return;
+
+                // Probe faces are low resolution and would only ever ask for less texture detail.
+                irect32_t screen_rect{};
+                if(false == update_lod_data(lod_runtime_data,
+                                            lod_limits,
+                                            lod_count,
+                                            settings,
+                                            dt.count(),
+                                            base_mesh,
+                                            world_transform,
+                                            camera,
+                                            rendering_probes_ ? nullptr : &screen_rect))
+                    return;
 
-        const auto current_time = lod_runtime_data.current_time;
-        const auto current_lod_index = lod_runtime_data.current_lod_index;
-        const auto target_lod_index = lod_runtime_data.target_lod_index;
+                const auto current_time = lod_runtime_data.current_time;
+                const auto current_lod_index = lod_runtime_data.current_lod_index;
+                const auto target_lod_index = lod_runtime_data.target_lod_index;
 
-        const auto params = math::vec3{0.0f, -1.0f, (transition_time - current_time) / transition_time};
+                // Fully visible when not fading, which keeps the items instanceable.
+                const auto fade = transition_time > 0.0f ? current_time / transition_time : 0.0f;
 
-        const auto params_inv = math::vec3{1.0f, 1.0f, current_time / transition_time};
+                const auto params = math::vec3{0.0f, -1.0f, 1.0f - fade};
 
-        const auto& submesh_transforms = model_comp.get_submesh_transforms();
-        const auto& bone_transforms = model_comp.get_bone_transforms();
-        const auto& skinning_matrices = model_comp.get_skinning_transforms();
+                const auto params_inv = math::vec3{1.0f, 1.0f, fade};
 
-        auto camera_pos = camera.get_position();
+                const auto& submesh_transforms = model_comp.get_submesh_transforms();
+                const auto& skinning_matrices = model_comp.get_skinning_transforms();
 
-        model::submit_callbacks callbacks;
-        callbacks.setup_begin = [&](const model::submit_callbacks::params& submit_params)
+                const auto depth = math::distance(camera_pos, world_transform.get_position()) / clip_planes.y;
+
+                model_comp.set_last_render_frame(frame);
+
+                const auto first_item = out.size();
+
+                render_queue::emit_model(model,
+                                         current_lod_index,
+                                         world_transform.get_matrix(),
+                                         submesh_transforms,
+                                         skinning_matrices,
+                                         params,
+                                         0,
+                                         depth,
+                                         out);
+
+                if(math::epsilonNotEqual(current_time, 0.0f, math::epsilon<float>()))
+                {
+                    render_queue::emit_model(model,
+                                             target_lod_index,
+                                             world_transform.get_matrix(),
+                                             submesh_transforms,
+                                             skinning_matrices,
+                                             params_inv,
+                                             0,
+                                             depth,
+                                             out);
+                }
+
+                if(!rendering_probes_)
+                {
+                    const auto screen_size = float(std::max(screen_rect.width(), screen_rect.height()));
+                    for(auto i = first_item; i < out.size(); ++i)
+                    {
+                        out[i].screen_size = screen_size;
+                    }
+                }
+            });
+
+        g_buffer_queue_.sort(th.jobs.get());
+
+        if(!rendering_probes_)
         {
-            geom_program& prog = submit_params.skinned ? geom_program_skinned_ : geom_program_;
+            record_texture_usage(g_buffer_queue_);
+        }
+    }
+
+    APP_SCOPE_PERF("G-Buffer Pass Submit");
 
-            prog.program->begin();
+    const bool use_instancing = (gfx::get_caps()->supported & BGFX_CAPS_INSTANCING) != 0;
 
-            gfx::set_uniform(prog.u_camera_wpos, camera_pos);
-            gfx::set_uniform(prog.u_camera_clip_planes, clip_planes);
-        };
-        callbacks.setup_params_per_instance = [&](const model::submit_callbacks::params& submit_params)
+    geom_program* bound = nullptr;
+    auto get_program = [&](uint8_t program, bool instanced) -> geom_program&
+    {
+        if(instanced)
         {
-            geom_program& prog = submit_params.skinned ? geom_program_skinned_ : geom_program_;
+            return geom_program_instanced_;
+        }
+        return program == render_queue::program_skinned ? geom_program_skinned_ : geom_program_;
+    };
 
-            gfx::set_uniform(prog.u_lod_params, params);
-        };
-        callbacks.setup_params_per_submesh =
-            [&](const model::submit_callbacks::params& submit_params, const material& mat)
+    render_queue::submit_callbacks callbacks;
+    callbacks.bind_program = [&](uint8_t program, bool instanced)
+    {
+        if(bound)
         {
-            geom_program& prog = submit_params.skinned ? geom_program_skinned_ : geom_program_;
+            bound->program->end();
+        }
 
-            if(rttr::type::get(mat) == rttr::type::get<pbr_material>())
-            {
-                const auto& pbr = static_cast<const pbr_material&>(mat);
-                submit_material(prog, pbr);
-            }
-            else
-            {
-                mat.submit(prog.program.get());
-            }
+        bound = &get_program(program, instanced);
+        if(!bound->program->begin())
+        {
+            return false;
+        }
+
+        gfx::set_uniform(bound->u_camera_wpos, camera_pos);
+        gfx::set_uniform(bound->u_camera_clip_planes, clip_planes);
+        return true;
+    };
+    callbacks.bind_material = [&](uint8_t program, bool instanced, const material& mat)
+    {
+        auto& prog = get_program(program, instanced);
 
-            gfx::submit(pass.id, prog.program->native_handle(), 0, submit_params.preserve_state);
-        };
-        callbacks.setup_end = [&](const model::submit_callbacks::params& submit_params)
+        // Only evaluated when the material changes, not per submesh.
+        if(rttr::type::get(mat) == rttr::type::get<pbr_material>())
         {
-            geom_program& prog = submit_params.skinned ? geom_program_skinned_ : geom_program_;
-
-            prog.program->end();
-        };
-
-        model_comp.set_last_render_frame(gfx::get_render_frame());
-        model.submit(world_transform,
-                     submesh_transforms,
-                     bone_transforms,
-                     skinning_matrices,
-                     current_lod_index,
-                     callbacks);
-        if(math::epsilonNotEqual(current_time, 0.0f, math::epsilon<float>()))
+            const auto& pbr = static_cast<const pbr_material&>(mat);
+            submit_material(prog, pbr);
+        }
+        else
         {
-            callbacks.setup_params_per_instance = [&](const model::submit_callbacks::params& submit_params)
-            {
-                geom_program& prog = submit_params.skinned ? geom_program_skinned_ : geom_program_;
+            mat.submit(prog.program.get());
+        }
+    };
+    callbacks.bind_item = [&](uint8_t program, bool instanced, const render_queue::item& it)
+    {
+        auto& prog = get_program(program, instanced);
 
-                gfx::set_uniform(prog.u_lod_params, params);
-            };
+        gfx::set_uniform(prog.u_lod_params, it.lod_params);
+    };
+    callbacks.submit = [&](uint8_t program, bool instanced, uint8_t discard)
+    {
+        auto& prog = get_program(program, instanced);
 
-            model.submit(world_transform,
-                         submesh_transforms,
-                         bone_transforms,
-                         skinning_matrices,
-                         target_lod_index,
-                         callbacks);
-        }
+        bgfx::submit(pass.id, prog.program->native_handle(), 0, discard);
+    };
+
+    const auto& stats = g_buffer_queue_.submit(callbacks, use_instancing && geom_program_instanced_.program->begin());
+    pass_stats_["G-Buffer"] += stats;
+
+    if(bound)
+    {
+        bound->program->end();
     }
+
     gfx::discard();
 }
 
@@ -691,6 +837,7 @@ auto deferred::run_lighting_pass(scene& scn,
                                  const camera& camera,
                                  gfx::render_view& rview,
                                  bool apply_shadows,
+                                 bool clustered,
                                  delta_t dt) -> gfx::frame_buffer::ptr
 {
     APP_SCOPE_PERF("Lighting Pass");
@@ -712,6 +859,8 @@ auto deferred::run_lighting_pass(scene& scn,
     pass.set_view_proj(view, proj);
     pass.clear(BGFX_CLEAR_COLOR, 0, 0.0f, 0);
 
+    clustered_lights_.clear();
+
     scn.registry->view<transform_component, light_component>().each(
         [&](auto e, auto&& transform_comp_ref, auto&& light_comp_ref)
         {
@@ -733,10 +882,17 @@ auto deferred::run_lighting_pass(scene& scn,
                    .compute_projected_sphere_rect(rect, light_position, light_direction, camera_pos, view, proj) == 0)
                 return;
 
-            APP_SCOPE_PERF("Lighting Pass Per Light");
-
             bool has_shadows = light.casts_shadows && apply_shadows;
 
+            // Shadowed and directional lights keep their own full screen pass.
+            if(clustered && !has_shadows && light.type != light_type::directional)
+            {
+                clustered_lights_.push_back({light_position, light_direction, light});
+                return;
+            }
+
+            APP_SCOPE_PERF("Lighting Pass Per Light");
+
             const auto& lprogram = has_shadows ? get_light_program(light) : get_light_program_no_shadows(light);
 
             lprogram.program->begin();
@@ -798,6 +954,24 @@ auto deferred::run_lighting_pass(scene& scn,
 
     gfx::discard();
 
+    if(!clustered_lights_.empty())
+    {
+        APP_SCOPE_PERF("Lighting Pass Clustered");
+
+        auto& th = engine::context().get_cached<threader>();
+
+        clustered_lighting_pass::run_params params;
+        params.gbuffer = gbuffer;
+        params.rbuffer = rbuffer;
+        params.ibl_brdf_lut = ibl_brdf_lut_.get();
+        params.output = lbuffer;
+        params.cam = &camera;
+        params.lights = &clustered_lights_;
+        params.jobs = th.jobs.get();
+
+        clustered_lighting_pass_.run(params);
+    }
+
     return lbuffer;
 }
 
@@ -1079,6 +1253,9 @@ auto deferred::init(rtti::context& ctx) -> bool
     geom_program_skinned_.program = loadProgram("vs_deferred_geom_skinned", "fs_deferred_geom");
     geom_program_skinned_.cache_uniforms();
 
+    geom_program_instanced_.program = loadProgram("vs_deferred_geom_instanced", "fs_deferred_geom");
+    geom_program_instanced_.cache_uniforms();
+
     sphere_ref_probe_program_.program = loadProgram("vs_clip_quad_ex", "reflection_probe/fs_sphere_reflection_probe");
     sphere_ref_probe_program_.cache_uniforms();
 
@@ -1158,6 +1335,7 @@ auto deferred::init(rtti::context& ctx) -> bool
     atmospheric_pass_perez_.init(ctx);
     tonemapping_pass_.init(ctx);
     assao_pass_.init(ctx);
+    clustered_lighting_pass_.init(ctx);
     return true;
 }
 
@@ -5,11 +5,13 @@
 #include <engine/ecs/ecs.h>
 #include <engine/rendering/ecs/components/model_component.h>
 #include <engine/rendering/gpu_program.h>
+#include <engine/rendering/render_queue.h>
 #include <engine/rendering/light.h>
 
 #include <engine/rendering/pipeline/passes/assao_pass.h>
 #include <engine/rendering/pipeline/passes/atmospheric_pass.h>
 #include <engine/rendering/pipeline/passes/atmospheric_pass_perez.h>
+#include <engine/rendering/pipeline/passes/clustered_lighting_pass.h>
 #include <engine/rendering/pipeline/passes/tonemapping_pass.h>
 
 namespace ace
@@ -51,6 +53,7 @@ public:
         atmospheric = 1 << 5,
         assao = 1 << 6,
         tonemapping = 1 << 7,
+        clustered_lighting = 1 << 8, ///< Shade unshadowed point and spot lights in one clustered pass.
 
         full = geometry_pass | shadow_pass | reflection_probe | lighting | atmospheric | assao,
         probe = lighting | atmospheric,
@@ -64,7 +67,8 @@ public:
                            delta_t dt,
                            visibility_flags query);
 
-    void run_g_buffer_pass(const visibility_set_models_t& visibility_set,
+    void run_g_buffer_pass(scene& scn,
+                           const visibility_set_models_t& visibility_set,
                            const camera& camera,
                            gfx::render_view& rview,
                            delta_t dt);
@@ -74,8 +78,12 @@ public:
                         gfx::render_view& rview,
                         delta_t dt);
 
-    auto run_lighting_pass(scene& scn, const camera& camera, gfx::render_view& rview, bool apply_shadows, delta_t dt)
-        -> gfx::frame_buffer::ptr;
+    auto run_lighting_pass(scene& scn,
+                           const camera& camera,
+                           gfx::render_view& rview,
+                           bool apply_shadows,
+                           bool clustered,
+                           delta_t dt) -> gfx::frame_buffer::ptr;
 
     void run_reflection_probe_pass(scene& scn, const camera& camera, gfx::render_view& rview, delta_t dt);
 
@@ -184,6 +192,15 @@ private:
 
     geom_program geom_program_;
     geom_program geom_program_skinned_;
+    geom_program geom_program_instanced_;
+
+    render_queue g_buffer_queue_;
+
+    ///< Lod table entry per element of the visibility set, reused between frames.
+    std::vector<size_t> lod_indices_;
+
+    ///< Set while reflection probe faces are rendered with temporary cameras.
+    bool rendering_probes_{};
 
     struct color_lighting : uniforms_cache
     {
@@ -246,6 +263,10 @@ private:
     atmospheric_pass_perez atmospheric_pass_perez_{};
     tonemapping_pass tonemapping_pass_{};
     assao_pass assao_pass_{};
+    clustered_lighting_pass clustered_lighting_pass_{};
+
+    ///< Lights gathered for the clustered pass, reused between frames.
+    std::vector<clustered_lighting_pass::light_entry> clustered_lights_;
 
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
     int debug_pass_{-1};
@@ -0,0 +1,364 @@
+#include "clustered_lighting_pass.h"
+#include <engine/assets/asset_manager.h>
+#include <engine/threading/job_system.h>
+#include <graphics/render_pass.h>
+#include <graphics/texture.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ace
+{
+namespace
+{
+constexpr uint32_t tiles_count = clustered_lighting_pass::clusters_x * clustered_lighting_pass::clusters_y;
+
+auto point_at_depth(const math::vec3& near_point, const math::vec3& far_point, float depth) -> math::vec3
+{
+    const auto t = (depth - near_point.z) / (far_point.z - near_point.z);
+    return near_point + (far_point - near_point) * t;
+}
+
+auto sphere_intersects_box(const math::vec4& sphere, const math::vec3& min, const math::vec3& max) -> bool
+{
+    const auto center = math::vec3(sphere);
+    const auto closest = math::clamp(center, min, max);
+    const auto delta = closest - center;
+    return math::dot(delta, delta) <= sphere.w * sphere.w;
+}
+
+} // namespace
+
+auto clustered_lighting_pass::init(rtti::context& ctx) -> bool
+{
+    auto& am = ctx.get_cached<asset_manager>();
+
+    auto vs_clip_quad = am.get_asset<gfx::shader>("engine:/data/shaders/vs_clip_quad.sc");
+    auto fs_clustered = am.get_asset<gfx::shader>("engine:/data/shaders/fs_deferred_clustered_lights.sc");
+
+    clustered_program_.program = std::make_unique<gpu_program>(vs_clip_quad, fs_clustered);
+    clustered_program_.cache_uniforms();
+
+    const auto flags = BGFX_SAMPLER_POINT | BGFX_SAMPLER_UVW_CLAMP;
+    light_data_tex_ =
+        std::make_shared<gfx::texture>(uint16_t(4), uint16_t(max_lights), false, 1, gfx::texture_format::RGBA32F, flags);
+    light_grid_tex_ = std::make_shared<gfx::texture>(uint16_t(tiles_count),
+                                                     uint16_t(clusters_z),
+                                                     false,
+                                                     1,
+                                                     gfx::texture_format::RG32F,
+                                                     flags);
+    light_indices_tex_ = std::make_shared<gfx::texture>(uint16_t(index_texture_width),
+                                                        uint16_t(max_light_indices / index_texture_width),
+                                                        false,
+                                                        1,
+                                                        gfx::texture_format::R32F,
+                                                        flags);
+
+    return true;
+}
+
+void clustered_lighting_pass::build(const camera& cam, const std::vector<light_entry>& lights, job_system* jobs)
+{
+    near_clip_ = cam.get_near_clip();
+    far_clip_ = cam.get_far_clip();
+
+    slice_depths_.resize(clusters_z + 1);
+    for(uint32_t z = 0; z <= clusters_z; ++z)
+    {
+        slice_depths_[z] = near_clip_ * std::pow(far_clip_ / near_clip_, float(z) / float(clusters_z));
+    }
+
+    // View space points of the tile corners on the near and far plane.
+    const auto inv_proj = math::inverse(cam.get_projection().get_matrix());
+    const float ndc_near = gfx::is_homogeneous_depth() ? -1.0f : 0.0f;
+
+    math::vec3 near_corners[clusters_x + 1][clusters_y + 1];
+    math::vec3 far_corners[clusters_x + 1][clusters_y + 1];
+    for(uint32_t x = 0; x <= clusters_x; ++x)
+    {
+        for(uint32_t y = 0; y <= clusters_y; ++y)
+        {
+            const auto ndc_x = float(x) / float(clusters_x) * 2.0f - 1.0f;
+            const auto ndc_y = float(y) / float(clusters_y) * 2.0f - 1.0f;
+
+            auto n = inv_proj * math::vec4(ndc_x, ndc_y, ndc_near, 1.0f);
+            auto f = inv_proj * math::vec4(ndc_x, ndc_y, 1.0f, 1.0f);
+            near_corners[x][y] = math::vec3(n) / n.w;
+            far_corners[x][y] = math::vec3(f) / f.w;
+        }
+    }
+
+    const auto view = cam.get_view().get_matrix();
+
+    std::vector<math::vec4> view_spheres;
+    view_spheres.reserve(lights.size());
+    for(const auto& l : lights)
+    {
+        // Spot lights use the sphere around their whole range, it bounds the cone.
+        const auto range = l.data.type == light_type::spot ? l.data.spot_data.get_range() : l.data.point_data.range;
+        const auto center = view * math::vec4(l.position, 1.0f);
+        view_spheres.emplace_back(math::vec3(center), range);
+    }
+
+    slice_grid_.resize(clusters_z);
+    slice_indices_.resize(clusters_z);
+
+    auto build_slices = [&](size_t begin, size_t end)
+    {
+        for(auto z = begin; z < end; ++z)
+        {
+            build_slice(uint32_t(z), view_spheres, near_corners, far_corners);
+        }
+    };
+
+    if(!jobs)
+    {
+        build_slices(0, clusters_z);
+    }
+    else
+    {
+        jobs->parallel_for(clusters_z, 1, build_slices);
+    }
+
+    // Concatenate the slice lists and make the offsets global, dropping what does not fit the texture.
+    grid_.resize(size_t(tiles_count) * clusters_z * 2);
+    indices_.clear();
+    for(uint32_t z = 0; z < clusters_z; ++z)
+    {
+        const auto base = indices_.size();
+        const auto& slice_grid = slice_grid_[z];
+        const auto& slice_indices = slice_indices_[z];
+
+        for(uint32_t tile = 0; tile < tiles_count; ++tile)
+        {
+            const auto offset = base + size_t(slice_grid[tile * 2]);
+            const auto available = max_light_indices - std::min<size_t>(offset, max_light_indices);
+            const auto count = std::min(size_t(slice_grid[tile * 2 + 1]), available);
+
+            const auto cell = (size_t(z) * tiles_count + tile) * 2;
+            grid_[cell] = float(offset);
+            grid_[cell + 1] = float(count);
+        }
+
+        const auto available = max_light_indices - std::min<size_t>(base, max_light_indices);
+        const auto copy_count = std::min(slice_indices.size(), available);
+        indices_.insert(indices_.end(), slice_indices.begin(), slice_indices.begin() + copy_count);
+    }
+
+    indices_count_ = indices_.size();
+}
+
+void clustered_lighting_pass::build_slice(uint32_t z,
+                                          const std::vector<math::vec4>& view_spheres,
+                                          const math::vec3 (&near_corners)[clusters_x + 1][clusters_y + 1],
+                                          const math::vec3 (&far_corners)[clusters_x + 1][clusters_y + 1])
+{
+    const auto z0 = slice_depths_[z];
+    const auto z1 = slice_depths_[z + 1];
+
+    math::vec3 corners0[clusters_x + 1][clusters_y + 1];
+    math::vec3 corners1[clusters_x + 1][clusters_y + 1];
+    for(uint32_t x = 0; x <= clusters_x; ++x)
+    {
+        for(uint32_t y = 0; y <= clusters_y; ++y)
+        {
+            corners0[x][y] = point_at_depth(near_corners[x][y], far_corners[x][y], z0);
+            corners1[x][y] = point_at_depth(near_corners[x][y], far_corners[x][y], z1);
+        }
+    }
+
+    auto& grid = slice_grid_[z];
+    auto& indices = slice_indices_[z];
+    grid.assign(size_t(tiles_count) * 2, 0.0f);
+    indices.clear();
+
+    // Lights overlapping this slice, they are tested against every tile.
+    thread_local std::vector<uint32_t> slice_lights;
+    slice_lights.clear();
+    for(uint32_t i = 0; i < uint32_t(view_spheres.size()); ++i)
+    {
+        const auto& sphere = view_spheres[i];
+        if(sphere.z + sphere.w >= z0 && sphere.z - sphere.w <= z1)
+        {
+            slice_lights.emplace_back(i);
+        }
+    }
+
+    for(uint32_t y = 0; y < clusters_y; ++y)
+    {
+        for(uint32_t x = 0; x < clusters_x; ++x)
+        {
+            auto min = corners0[x][y];
+            auto max = corners0[x][y];
+            for(const auto& corners : {&corners0, &corners1})
+            {
+                for(uint32_t cx = x; cx <= x + 1; ++cx)
+                {
+                    for(uint32_t cy = y; cy <= y + 1; ++cy)
+                    {
+                        min = math::min(min, (*corners)[cx][cy]);
+                        max = math::max(max, (*corners)[cx][cy]);
+                    }
+                }
+            }
+
+            const auto tile = y * clusters_x + x;
+            grid[tile * 2] = float(indices.size());
+
+            for(auto i : slice_lights)
+            {
+                if(sphere_intersects_box(view_spheres[i], min, max))
+                {
+                    indices.emplace_back(float(i));
+                }
+            }
+
+            grid[tile * 2 + 1] = float(indices.size()) - grid[tile * 2];
+        }
+    }
+}
+
+void clustered_lighting_pass::upload(const std::vector<light_entry>& lights)
+{
+    const auto count = std::min<size_t>(lights.size(), max_lights);
+
+    light_data_.resize(count * 4);
+    for(size_t i = 0; i < count; ++i)
+    {
+        const auto& l = lights[i];
+        auto* texels = &light_data_[i * 4];
+
+        const auto& color = l.data.color.value;
+        texels[1] = math::vec4(color.r, color.g, color.b, l.data.intensity);
+
+        if(l.data.type == light_type::spot)
+        {
+            const auto& spot = l.data.spot_data;
+            texels[0] = math::vec4(l.position, spot.get_range());
+            texels[2] = math::vec4(l.direction, 1.0f);
+            texels[3] = math::vec4(math::cos(math::radians(spot.get_inner_angle() * 0.5f)),
+                                   math::cos(math::radians(spot.get_outer_angle() * 0.5f)),
+                                   0.0f,
+                                   0.0f);
+        }
+        else
+        {
+            const auto& point = l.data.point_data;
+            texels[0] = math::vec4(l.position, point.range);
+            texels[2] = math::vec4(l.direction, 0.0f);
+            texels[3] = math::vec4(point.exponent_falloff, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    if(count > 0)
+    {
+        gfx::update_texture_2d(light_data_tex_->native_handle(),
+                               0,
+                               0,
+                               0,
+                               0,
+                               4,
+                               uint16_t(count),
+                               gfx::copy(light_data_.data(), uint32_t(light_data_.size() * sizeof(math::vec4))));
+    }
+
+    gfx::update_texture_2d(light_grid_tex_->native_handle(),
+                           0,
+                           0,
+                           0,
+                           0,
+                           uint16_t(tiles_count),
+                           uint16_t(clusters_z),
+                           gfx::copy(grid_.data(), uint32_t(grid_.size() * sizeof(float))));
+
+    if(!indices_.empty())
+    {
+        const auto rows = (indices_.size() + index_texture_width - 1) / index_texture_width;
+        indices_.resize(rows * index_texture_width, 0.0f);
+
+        gfx::update_texture_2d(light_indices_tex_->native_handle(),
+                               0,
+                               0,
+                               0,
+                               0,
+                               uint16_t(index_texture_width),
+                               uint16_t(rows),
+                               gfx::copy(indices_.data(), uint32_t(indices_.size() * sizeof(float))));
+    }
+}
+
+void clustered_lighting_pass::run(const run_params& params)
+{
+    const auto& lights = *params.lights;
+    if(lights.empty() || !clustered_program_.program->begin())
+    {
+        return;
+    }
+
+    const auto& cam = *params.cam;
+
+    // The light data texture has one row per light.
+    auto count = std::min<size_t>(lights.size(), max_lights);
+    if(count < lights.size())
+    {
+        std::vector<light_entry> clamped(lights.begin(), lights.begin() + count);
+        build(cam, clamped, params.jobs);
+        upload(clamped);
+    }
+    else
+    {
+        build(cam, lights, params.jobs);
+        upload(lights);
+    }
+
+    gfx::render_pass pass("clustered_light_buffer_fill");
+    pass.bind(params.output.get());
+    pass.set_view_proj(cam.get_view(), cam.get_projection());
+
+    float cluster_params[4] = {float(clusters_x), float(clusters_y), float(clusters_z), float(index_texture_width)};
+    float cluster_depth[4] = {near_clip_, float(clusters_z) / std::log(far_clip_ / near_clip_), 0.0f, 0.0f};
+
+    gfx::set_uniform(clustered_program_.u_camera_position, cam.get_position());
+    gfx::set_uniform(clustered_program_.u_cluster_params, cluster_params);
+    gfx::set_uniform(clustered_program_.u_cluster_depth, cluster_depth);
+
+    uint8_t i = 0;
+    for(; i < params.gbuffer->get_attachment_count(); ++i)
+    {
+        gfx::set_texture(clustered_program_.s_tex[i], i, params.gbuffer->get_texture(i));
+    }
+    gfx::set_texture(clustered_program_.s_tex[i], i, params.rbuffer);
+    i++;
+    gfx::set_texture(clustered_program_.s_tex[i], i, params.ibl_brdf_lut);
+    i++;
+
+    gfx::set_texture(clustered_program_.s_light_data, i++, light_data_tex_);
+    gfx::set_texture(clustered_program_.s_light_grid, i++, light_grid_tex_);
+    gfx::set_texture(clustered_program_.s_light_indices, i++, light_indices_tex_);
+
+    const auto output_size = params.output->get_size();
+    irect32_t rect(0, 0, irect32_t::value_type(output_size.width), irect32_t::value_type(output_size.height));
+    gfx::set_scissor(rect.left, rect.top, rect.width(), rect.height());
+    auto topology = gfx::clip_quad(1.0f);
+    gfx::set_state(topology | BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_BLEND_ADD);
+    gfx::submit(pass.id, clustered_program_.program->native_handle());
+    gfx::set_state(BGFX_STATE_DEFAULT);
+
+    clustered_program_.program->end();
+
+    gfx::discard();
+}
+
+auto clustered_lighting_pass::get_cluster_light_count(uint32_t x, uint32_t y, uint32_t z) const -> uint32_t
+{
+    const auto cell = (size_t(z) * tiles_count + y * clusters_x + x) * 2;
+    return cell + 1 < grid_.size() ? uint32_t(grid_[cell + 1]) : 0;
+}
+
+auto clustered_lighting_pass::get_light_indices_count() const -> size_t
+{
+    return indices_count_;
+}
+
+} // namespace ace
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <engine/rendering/camera.h>
+#include <engine/rendering/gpu_program.h>
+#include <engine/rendering/light.h>
+
+#include <graphics/texture.h>
+
+#include <vector>
+
+namespace ace
+{
+class job_system;
+
+/**
+ * @class clustered_lighting_pass
+ * @brief Shades many unshadowed point and spot lights in a single full screen pass.
+ *
+ * The view frustum is split into froxels, screen tiles with exponential depth slices.
+ * Light lists per froxel are built on the cpu, one job per depth slice, uploaded as
+ * textures and read back by the lighting shader.
+ */
+class clustered_lighting_pass
+{
+public:
+    static constexpr uint32_t clusters_x = 16;
+    static constexpr uint32_t clusters_y = 9;
+    static constexpr uint32_t clusters_z = 24;
+    static constexpr uint32_t max_lights = 1024;
+    static constexpr uint32_t index_texture_width = 1024;
+    static constexpr uint32_t max_light_indices = index_texture_width * 256;
+
+    /**
+     * @struct light_entry
+     * @brief A light to be shaded by the pass, in world space.
+     */
+    struct light_entry
+    {
+        math::vec3 position;
+        math::vec3 direction;
+        light data;
+    };
+
+    struct run_params
+    {
+        gfx::frame_buffer::ptr gbuffer;
+        gfx::frame_buffer::ptr rbuffer;
+        gfx::texture::ptr ibl_brdf_lut;
+        gfx::frame_buffer::ptr output;
+        const camera* cam{};
+        const std::vector<light_entry>* lights{};
+        job_system* jobs{};
+    };
+
+    auto init(rtti::context& ctx) -> bool;
+    void run(const run_params& params);
+
+    /**
+     * @brief Builds the light lists of all clusters.
+     * @param cam The camera.
+     * @param lights The lights.
+     * @param jobs Job system to split the work on. When null the work runs on the calling thread.
+     */
+    void build(const camera& cam, const std::vector<light_entry>& lights, job_system* jobs);
+
+    /**
+     * @brief Gets the number of lights affecting a cluster, valid after build.
+     */
+    auto get_cluster_light_count(uint32_t x, uint32_t y, uint32_t z) const -> uint32_t;
+
+    /**
+     * @brief Gets the total number of light indices, valid after build.
+     */
+    auto get_light_indices_count() const -> size_t;
+
+private:
+    void build_slice(uint32_t z,
+                     const std::vector<math::vec4>& view_spheres,
+                     const math::vec3 (&near_corners)[clusters_x + 1][clusters_y + 1],
+                     const math::vec3 (&far_corners)[clusters_x + 1][clusters_y + 1]);
+
+    void upload(const std::vector<light_entry>& lights);
+
+    ///< Depth of the near and far plane of each slice.
+    std::vector<float> slice_depths_;
+    ///< Offset into the slice's index list and light count, two floats per tile.
+    std::vector<std::vector<float>> slice_grid_;
+    std::vector<std::vector<float>> slice_indices_;
+
+    std::vector<float> grid_;
+    std::vector<float> indices_;
+    size_t indices_count_{};
+    std::vector<math::vec4> light_data_;
+
+    float near_clip_{};
+    float far_clip_{};
+
+    gfx::texture::ptr light_data_tex_;
+    gfx::texture::ptr light_grid_tex_;
+    gfx::texture::ptr light_indices_tex_;
+
+    struct clustered_program : uniforms_cache
+    {
+        void cache_uniforms()
+        {
+            cache_uniform(program.get(), u_camera_position, "u_camera_position");
+            cache_uniform(program.get(), u_cluster_params, "u_cluster_params");
+            cache_uniform(program.get(), u_cluster_depth, "u_cluster_depth");
+
+            cache_uniform(program.get(), s_tex[0], "s_tex0");
+            cache_uniform(program.get(), s_tex[1], "s_tex1");
+            cache_uniform(program.get(), s_tex[2], "s_tex2");
+            cache_uniform(program.get(), s_tex[3], "s_tex3");
+            cache_uniform(program.get(), s_tex[4], "s_tex4");
+            cache_uniform(program.get(), s_tex[5], "s_tex5");
+            cache_uniform(program.get(), s_tex[6], "s_tex6");
+
+            cache_uniform(program.get(), s_light_data, "s_light_data");
+            cache_uniform(program.get(), s_light_grid, "s_light_grid");
+            cache_uniform(program.get(), s_light_indices, "s_light_indices");
+        }
+
+        gfx::program::uniform_ptr u_camera_position;
+        gfx::program::uniform_ptr u_cluster_params;
+        gfx::program::uniform_ptr u_cluster_depth;
+        std::array<gfx::program::uniform_ptr, 7> s_tex;
+        gfx::program::uniform_ptr s_light_data;
+        gfx::program::uniform_ptr s_light_grid;
+        gfx::program::uniform_ptr s_light_indices;
+
+        std::unique_ptr<gpu_program> program;
+
+    } clustered_program_;
+};
+} // namespace ace
@@ -1,37 +1,147 @@
 #include "pipeline.h"
 #include <engine/ecs/components/transform_component.h>
+#include <engine/engine.h>
+#include <engine/rendering/culling/culling_buffer.h>
+#include <engine/rendering/culling/dirty_set.h>
+#include <engine/rendering/culling/scene_bvh.h>
 #include <engine/rendering/ecs/components/camera_component.h>
 #include <engine/rendering/ecs/components/model_component.h>
+#include <engine/threading/threader.h>
 
 namespace ace
 {
 namespace rendering
 {
+namespace
+{
+auto passes_query(const model_component& model_comp,
+                  entt::entity e,
+                  const dirty_set* dirty,
+                  pipeline::visibility_flags query) -> bool
+{
+    if(!model_comp.is_enabled())
+    {
+        return false;
+    }
+
+    if((query & pipeline::visibility_query::is_static) && !model_comp.is_static())
+    {
+        return false;
+    }
+
+    if((query & pipeline::visibility_query::is_reflection_caster) && !model_comp.casts_reflection())
+    {
+        return false;
+    }
+
+    if((query & pipeline::visibility_query::is_shadow_caster) && !model_comp.casts_shadow())
+    {
+        return false;
+    }
+
+    if((query & pipeline::visibility_query::is_dirty) && dirty && !dirty->contains(e))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+auto to_culling_flags(pipeline::visibility_flags query) -> uint8_t
+{
+    uint8_t flags = culling_buffer::is_enabled;
+
+    if(query & pipeline::visibility_query::is_static)
+    {
+        flags |= culling_buffer::is_static;
+    }
+
+    if(query & pipeline::visibility_query::is_reflection_caster)
+    {
+        flags |= culling_buffer::is_reflection_caster;
+    }
+
+    if(query & pipeline::visibility_query::is_shadow_caster)
+    {
+        flags |= culling_buffer::is_shadow_caster;
+    }
+
+    return flags;
+}
+} // namespace
+
 auto pipeline::gather_visible_models(scene& scn, const math::frustum* frustum, visibility_flags query)
     -> visibility_set_models_t
 {
     visibility_set_models_t result;
 
-    scn.registry->view<transform_component, model_component>().each(
-        [&](auto e, auto&& transform_comp, auto&& model_comp)
+    auto dirty = scn.registry->ctx().find<dirty_set>();
+    auto culling = scn.registry->ctx().find<culling_buffer>();
+    if(frustum && culling && culling_method_ == culling_method::batched)
+    {
+        auto& th = engine::context().get_cached<threader>();
+        auto visible = culling->cull(*frustum, to_culling_flags(query), th.jobs.get());
+
+        result.reserve(visible.size());
+        for(auto e : visible)
         {
-            if(!model_comp.is_enabled())
+            // The buffer is filled by the model system, skip anything destroyed since then.
+            if(!scn.registry->valid(e) || !scn.registry->all_of<transform_component, model_component>(e))
             {
-                return;
+                continue;
             }
-            auto entity = scn.create_entity(e);
 
-            if((query & visibility_query::is_static) && !model_comp.is_static())
+            if((query & visibility_query::is_dirty) && dirty && !dirty->contains(e))
             {
-                return;
+                continue;
             }
 
-            if((query & visibility_query::is_reflection_caster) && !model_comp.casts_reflection())
-            {
-                return;
-            }
+            result.emplace_back(scn.create_entity(e));
+        }
+
+        return result;
+    }
 
-            if((query & visibility_query::is_shadow_caster) && !model_comp.casts_shadow())
+    auto bvh = scn.registry->ctx().find<scene_bvh>();
+    if(frustum && bvh)
+    {
+        // Walk the hierarchy and only do the precise test on leaves that straddle the frustum.
+        bvh->query(*frustum,
+                   [&](entt::entity e, bool fully_inside)
+                   {
+                       auto entity = scn.create_entity(e);
+                       auto&& [transform_comp, model_comp] = entity.try_get<transform_component, model_component>();
+                       if(!transform_comp || !model_comp)
+                       {
+                           return;
+                       }
+
+                       if(!passes_query(*model_comp, e, dirty, query))
+                       {
+                           return;
+                       }
+
+                       if(!fully_inside)
+                       {
+                           const auto& world_transform = transform_comp->get_transform_global();
+                           const auto& local_bounds = model_comp->get_local_bounds();
+
+                           if(!frustum->test_obb(local_bounds, world_transform))
+                           {
+                               return;
+                           }
+                       }
+
+                       result.emplace_back(entity);
+                   });
+
+        return result;
+    }
+
+    scn.registry->view<transform_component, model_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& model_comp)
+        {
+            if(!passes_query(model_comp, e, dirty, query))
             {
                 return;
             }
@@ -39,47 +149,176 @@ auto pipeline::gather_visible_models(scene& scn, const math::frustum* frustum, v
             if(frustum)
             {
                 const auto& world_transform = transform_comp.get_transform_global();
-                const auto& world_bounds = model_comp.get_world_bounds();
                 const auto& local_bounds = model_comp.get_local_bounds();
 
                 // Test the bounding box of the mesh
-                if(frustum->test_obb(local_bounds, world_transform))
-                // if(frustum->test_aabb(world_bounds))
+                if(!frustum->test_obb(local_bounds, world_transform))
                 {
-                    // Only dirty mesh components.
-                    if(query & visibility_query::is_dirty)
-                    {
-                        //                        if(transform_comp.is_touched() || model_comp.is_touched())
-                        {
-                            result.emplace_back(entity);
-                        }
-                    } // End if dirty_only
-                    else
-                    {
-                        result.emplace_back(entity);
-                    }
-
-                } // Enf if visble
+                    return;
+                }
             }
-            else
+
+            result.emplace_back(scn.create_entity(e));
+        });
+
+    return result;
+}
+
+auto pipeline::gather_visible_models(scene& scn, const math::bbox& volume, visibility_flags query)
+    -> visibility_set_models_t
+{
+    visibility_set_models_t result;
+
+    auto dirty = scn.registry->ctx().find<dirty_set>();
+    auto bvh = scn.registry->ctx().find<scene_bvh>();
+    if(bvh)
+    {
+        bvh->query(volume,
+                   [&](entt::entity e, bool fully_inside)
+                   {
+                       auto entity = scn.create_entity(e);
+                       auto model_comp = entity.try_get<model_component>();
+                       if(!model_comp || !entity.all_of<transform_component>())
+                       {
+                           return;
+                       }
+
+                       if(!passes_query(*model_comp, e, dirty, query))
+                       {
+                           return;
+                       }
+
+                       if(!fully_inside && !volume.intersect(model_comp->get_world_bounds()))
+                       {
+                           return;
+                       }
+
+                       result.emplace_back(entity);
+                   });
+
+        return result;
+    }
+
+    scn.registry->view<transform_component, model_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& model_comp)
+        {
+            if(!passes_query(model_comp, e, dirty, query))
             {
-                // Only dirty mesh components.
-                if(query & visibility_query::is_dirty)
-                {
-                    //                    if(transform_comp.is_touched() || model_comp.is_touched())
-                    {
-                        result.emplace_back(entity);
-                    }
-                } // End if dirty_only
-                else
-                {
-                    result.emplace_back(entity);
-                }
+                return;
             }
+
+            if(!volume.intersect(model_comp.get_world_bounds()))
+            {
+                return;
+            }
+
+            result.emplace_back(scn.create_entity(e));
         });
 
     return result;
 }
 
+void pipeline::set_culling_method(culling_method method)
+{
+    culling_method_ = method;
+}
+
+auto pipeline::get_culling_method() const -> culling_method
+{
+    return culling_method_;
+}
+
+auto pipeline::get_pass_stats() const -> const pass_stats_t&
+{
+    return pass_stats_;
+}
+
+void pipeline::set_lod_settings(const lod_settings& settings)
+{
+    lod_settings_ = settings;
+}
+
+auto pipeline::get_lod_settings() const -> const lod_settings&
+{
+    return lod_settings_;
+}
+
+auto lod_data_container::acquire(entt::entity e) -> size_t
+{
+    const auto id = size_t(entt::to_entity(e));
+    if(id >= sparse_.size())
+    {
+        sparse_.resize(id + 1, invalid_index);
+    }
+
+    auto& index = sparse_[id];
+    if(index != invalid_index)
+    {
+        // Same id but a different version means the entity was recycled.
+        if(entities_[index] != e)
+        {
+            entities_[index] = e;
+            data_[index] = {};
+        }
+        return index;
+    }
+
+    index = uint32_t(entities_.size());
+    entities_.emplace_back(e);
+    data_.emplace_back();
+    return index;
+}
+
+auto lod_data_container::get(size_t index) -> lod_data&
+{
+    return data_[index];
+}
+
+void lod_data_container::collect_garbage(const entt::registry& registry, uint64_t frame, uint64_t max_age)
+{
+    if(registry_ != &registry)
+    {
+        clear();
+        registry_ = &registry;
+        return;
+    }
+
+    size_t i = 0;
+    while(i < entities_.size())
+    {
+        const auto e = entities_[i];
+        const auto& data = data_[i];
+        if(registry.valid(e) && frame - data.last_frame <= max_age)
+        {
+            ++i;
+            continue;
+        }
+
+        // Swap with the last entry and patch its sparse slot.
+        const auto last = entities_.size() - 1;
+        sparse_[size_t(entt::to_entity(e))] = invalid_index;
+        if(i != last)
+        {
+            entities_[i] = entities_[last];
+            data_[i] = data_[last];
+            sparse_[size_t(entt::to_entity(entities_[i]))] = uint32_t(i);
+        }
+        entities_.pop_back();
+        data_.pop_back();
+    }
+}
+
+void lod_data_container::clear()
+{
+    sparse_.clear();
+    entities_.clear();
+    data_.clear();
+}
+
+auto lod_data_container::size() const -> size_t
+{
+    return entities_.size();
+}
+
 } // namespace rendering
 } // namespace ace
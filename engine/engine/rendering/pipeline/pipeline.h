@@ -2,6 +2,7 @@
 
 #include <engine/ecs/ecs.h>
 #include <engine/rendering/camera.h>
+#include <engine/rendering/render_queue.h>
 #include <graphics/frame_buffer.h>
 #include <graphics/render_view.h>
 
@@ -10,6 +11,7 @@
 
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace ace
@@ -25,9 +27,70 @@ struct lod_data
     std::uint32_t current_lod_index = 0; ///< Current LOD index.
     std::uint32_t target_lod_index = 0;  ///< Target LOD index.
     float current_time = 0.0f;           ///< Current time for LOD transition.
+    uint64_t last_frame = 0;             ///< Last frame the entity was visible.
+};
+
+/**
+ * @struct lod_settings
+ * @brief Controls how LODs are selected and blended.
+ */
+struct lod_settings
+{
+    float transition_time = 0.25f; ///< Duration of a LOD cross-fade in seconds. Zero switches instantly.
+    float hysteresis = 0.1f;       ///< Fraction by which a LOD range is widened before leaving it.
+    uint64_t eviction_frames = 120; ///< Frames an entity can stay invisible before its state is dropped.
+};
+
+/**
+ * @class lod_data_container
+ * @brief Compact table of LOD data keyed by entity.
+ *
+ * Dense arrays with a sparse index by entity id. Entries of destroyed entities and
+ * entities that were not visible for a while are dropped by collect_garbage.
+ */
+class lod_data_container
+{
+public:
+    /**
+     * @brief Finds or creates the entry of an entity. Not thread safe.
+     * @param e The entity.
+     * @return The index of the entry, stable until the next collect_garbage.
+     */
+    auto acquire(entt::entity e) -> size_t;
+
+    /**
+     * @brief Gets an entry. Different entries can be accessed concurrently.
+     * @param index The index returned by acquire.
+     */
+    auto get(size_t index) -> lod_data&;
+
+    /**
+     * @brief Removes entries of destroyed entities and entries not used since max_age frames.
+     * @param registry The registry the entities belong to. Switching registries clears the table.
+     * @param frame The current frame.
+     * @param max_age The number of frames an entry is kept without being used.
+     */
+    void collect_garbage(const entt::registry& registry, uint64_t frame, uint64_t max_age);
+
+    /**
+     * @brief Removes all entries.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of entries.
+     */
+    auto size() const -> size_t;
+
+private:
+    static constexpr uint32_t invalid_index = uint32_t(-1);
+
+    std::vector<uint32_t> sparse_;
+    std::vector<entt::entity> entities_;
+    std::vector<lod_data> data_;
+    const entt::registry* registry_{};
 };
 
-using lod_data_container = std::map<entt::handle, lod_data>;
 using visibility_set_models_t = std::vector<entt::handle>;
 
 /**
@@ -63,6 +126,16 @@ public:
         is_reflection_caster = 1 << 4, ///< Query for reflection casting entities.
     };
 
+    /**
+     * @enum culling_method
+     * @brief How frustum queries are resolved.
+     */
+    enum class culling_method : uint8_t
+    {
+        hierarchical, ///< Walk the scene bounding volume hierarchy.
+        batched,      ///< Test the flat bounds buffer in SIMD batches across the thread pool.
+    };
+
     using visibility_flags = uint32_t; ///< Type alias for visibility flags.
     using pipeline_flags = uint32_t;
 
@@ -84,6 +157,17 @@ public:
                                        const math::frustum* frustum,
                                        visibility_flags query = visibility_query::is_static) -> visibility_set_models_t;
 
+    /**
+     * @brief Gathers models whose world bounds intersect the given volume.
+     * @param scn The scene to gather models from.
+     * @param volume The world space volume, e.g the bounds of a light.
+     * @param query The visibility query flags.
+     * @return A vector of handles to the models inside the volume.
+     */
+    virtual auto gather_visible_models(scene& scn,
+                                       const math::bbox& volume,
+                                       visibility_flags query = visibility_query::is_static) -> visibility_set_models_t;
+
     /**
      * @brief Renders the entire scene from the camera's perspective.
      * @param scn The scene to render.
@@ -121,6 +205,49 @@ public:
 
 
     virtual void set_debug_pass(int pass) = 0;
+
+    /**
+     * @brief Sets the method used for frustum queries.
+     * @param method The culling method.
+     */
+    void set_culling_method(culling_method method);
+
+    /**
+     * @brief Gets the method used for frustum queries.
+     */
+    auto get_culling_method() const -> culling_method;
+
+    using pass_stats_t = std::map<std::string, render_queue::stats>;
+
+    /**
+     * @brief Gets the draw counters of each pass from the last run.
+     */
+    auto get_pass_stats() const -> const pass_stats_t&;
+
+    /**
+     * @brief Sets the LOD selection settings.
+     * @param settings The settings.
+     */
+    void set_lod_settings(const lod_settings& settings);
+
+    /**
+     * @brief Gets the LOD selection settings.
+     */
+    auto get_lod_settings() const -> const lod_settings&;
+
+protected:
+    ///< Draw counters per pass, filled by the passes every run.
+    pass_stats_t pass_stats_;
+
+    ///< State kept between frames for the camera owning this pipeline.
+    per_camera_data camera_data_;
+
+    ///< LOD selection settings.
+    lod_settings lod_settings_;
+
+private:
+    ///< The method used for frustum queries.
+    culling_method culling_method_{culling_method::hierarchical};
 };
 } // namespace rendering
 } // namespace ace
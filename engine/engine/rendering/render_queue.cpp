@@ -0,0 +1,337 @@
+#include "render_queue.h"
+
+#include <engine/threading/job_system.h>
+#include <graphics/graphics.h>
+
+#include <algorithm>
+
+namespace ace
+{
+namespace
+{
+
+constexpr size_t build_chunk_size = 64;
+
+// Keep textures and render state when the next draw uses the same program and material.
+constexpr uint8_t discard_keep_material = BGFX_DISCARD_ALL & ~(BGFX_DISCARD_BINDINGS | BGFX_DISCARD_STATE);
+
+auto hash_bits(const void* ptr, uint32_t bits) -> uint64_t
+{
+    auto value = uint64_t(reinterpret_cast<uintptr_t>(ptr));
+    // Fibonacci hashing, keeps the top bits well distributed.
+    value *= 0x9e3779b97f4a7c15ull;
+    return value >> (64 - bits);
+}
+
+} // namespace
+
+auto render_queue::stats::operator+=(const stats& rhs) -> stats&
+{
+    items += rhs.items;
+    draws += rhs.draws;
+    instanced_draws += rhs.instanced_draws;
+    program_binds += rhs.program_binds;
+    program_binds_skipped += rhs.program_binds_skipped;
+    material_binds += rhs.material_binds;
+    material_binds_skipped += rhs.material_binds_skipped;
+    return *this;
+}
+
+auto render_queue::make_key(uint8_t pass,
+                            uint8_t program,
+                            const material* mat,
+                            const ace::mesh::submesh* submesh,
+                            float depth) -> uint64_t
+{
+    constexpr uint64_t depth_max = (1ull << 20) - 1;
+
+    auto quantized_depth = uint64_t(math::clamp(depth, 0.0f, 1.0f) * float(depth_max));
+
+    uint64_t key = 0;
+    key |= (uint64_t(pass) & 0xf) << 60;
+    key |= uint64_t(program) << 52;
+    key |= hash_bits(mat, 16) << 36;
+    key |= hash_bits(submesh, 16) << 20;
+    key |= quantized_depth & depth_max;
+    return key;
+}
+
+void render_queue::emit_model(const model& mdl,
+                              uint32_t lod,
+                              const math::mat4& world_transform,
+                              const pose_mat4& submesh_transforms,
+                              const std::vector<pose_mat4>& skinning_matrices,
+                              const math::vec3& lod_params,
+                              uint8_t pass,
+                              float depth,
+                              std::vector<item>& out)
+{
+    const auto lod_mesh = mdl.get_lod(lod);
+    if(!lod_mesh)
+    {
+        return;
+    }
+
+    const auto& mesh = lod_mesh.get();
+    const auto& submeshes = mesh->get_submeshes();
+
+    for(uint32_t group_id = 0; group_id < mesh->get_data_groups_count(); ++group_id)
+    {
+        auto asset = mdl.get_material_for_group(group_id);
+        if(!asset)
+        {
+            continue;
+        }
+
+        const auto mat = asset.get().get();
+
+        item it;
+        it.mat = mat;
+        it.mesh = mesh.get();
+        it.lod_params = lod_params;
+
+        it.program = program_static;
+        for(const auto& index : mesh->get_non_skinned_submeshes_indices(group_id))
+        {
+            it.submesh = submeshes[index];
+            it.world = index < submesh_transforms.transforms.size() ? submesh_transforms.transforms[index]
+                                                                     : world_transform;
+            it.key = make_key(pass, it.program, mat, it.submesh, depth);
+            out.emplace_back(it);
+        }
+
+        it.program = program_skinned;
+        for(const auto& index : mesh->get_skinned_submeshes_indices(group_id))
+        {
+            it.submesh = submeshes[index];
+            it.skinning = &skinning_matrices[index];
+            it.key = make_key(pass, it.program, mat, it.submesh, depth);
+            out.emplace_back(it);
+        }
+    }
+}
+
+void render_queue::clear()
+{
+    items_.clear();
+}
+
+void render_queue::push(const item& it)
+{
+    items_.emplace_back(it);
+}
+
+void render_queue::build(job_system* jobs,
+                         size_t count,
+                         const std::function<void(size_t index, std::vector<item>& out)>& emit)
+{
+    const auto chunks = (count + build_chunk_size - 1) / build_chunk_size;
+    chunks_.resize(std::max(chunks_.size(), chunks));
+
+    auto build_range = [&](size_t begin, size_t end)
+    {
+        auto& out = chunks_[begin / build_chunk_size];
+        out.clear();
+
+        for(auto i = begin; i < end; ++i)
+        {
+            emit(i, out);
+        }
+    };
+
+    if(jobs)
+    {
+        jobs->parallel_for(count, build_chunk_size, build_range);
+    }
+    else
+    {
+        for(size_t begin = 0; begin < count; begin += build_chunk_size)
+        {
+            build_range(begin, std::min(count, begin + build_chunk_size));
+        }
+    }
+
+    for(size_t c = 0; c < chunks; ++c)
+    {
+        items_.insert(items_.end(), chunks_[c].begin(), chunks_[c].end());
+    }
+}
+
+void render_queue::sort(job_system* jobs)
+{
+    auto by_key = [](const item& lhs, const item& rhs)
+    {
+        return lhs.key < rhs.key;
+    };
+
+    if(jobs)
+    {
+        jobs->parallel_sort(items_.begin(), items_.end(), by_key);
+    }
+    else
+    {
+        std::sort(items_.begin(), items_.end(), by_key);
+    }
+}
+
+auto render_queue::is_same_draw(const item& lhs, const item& rhs) const -> bool
+{
+    return lhs.program == rhs.program && lhs.mat == rhs.mat && lhs.submesh == rhs.submesh &&
+           lhs.mesh == rhs.mesh && !rhs.skinning && lhs.lod_params == rhs.lod_params;
+}
+
+auto render_queue::submit(const submit_callbacks& callbacks, bool allow_instancing) -> const stats&
+{
+    constexpr uint16_t stride = sizeof(math::mat4);
+
+    stats_ = {};
+    stats_.items = uint32_t(items_.size());
+
+    int32_t current_program = -1;
+    bool program_valid = false;
+    const material* current_material = nullptr;
+
+    const auto count = items_.size();
+
+    auto run_length = [&](size_t begin)
+    {
+        size_t end = begin + 1;
+        if(allow_instancing && !items_[begin].skinning)
+        {
+            while(end < count && is_same_draw(items_[begin], items_[end]))
+            {
+                ++end;
+            }
+        }
+        return end - begin;
+    };
+
+    auto program_id = [](const item& it, bool instanced)
+    {
+        return int32_t(it.program) * 2 + (instanced ? 1 : 0);
+    };
+
+    size_t begin = 0;
+    size_t run = count > 0 ? run_length(0) : 0;
+
+    while(begin < count)
+    {
+        const auto& it = items_[begin];
+        const bool instanced = run > 1;
+
+        const size_t next_begin = begin + run;
+        const size_t next_run = next_begin < count ? run_length(next_begin) : 0;
+
+        const auto id = program_id(it, instanced);
+        if(id != current_program)
+        {
+            program_valid = callbacks.bind_program(it.program, instanced);
+            current_program = id;
+            current_material = nullptr;
+            stats_.program_binds++;
+        }
+        else
+        {
+            stats_.program_binds_skipped++;
+        }
+
+        if(!program_valid || !it.mat)
+        {
+            begin = next_begin;
+            run = next_run;
+            continue;
+        }
+
+        // Instanced runs may need several instance buffers, each is a draw call.
+        size_t offset = 0;
+        while(offset < run)
+        {
+            uint32_t instances = 1;
+
+            it.mesh->bind_render_buffers_for_submesh(it.submesh);
+
+            if(instanced)
+            {
+                instances = gfx::get_avail_instance_data_buffer(uint32_t(run - offset), stride);
+                if(instances == 0)
+                {
+                    // Out of transient instance memory for this frame.
+                    return stats_;
+                }
+
+                gfx::instance_data_buffer idb;
+                gfx::alloc_instance_data_buffer(&idb, instances, stride);
+
+                auto data = reinterpret_cast<math::mat4*>(idb.data);
+                for(uint32_t i = 0; i < instances; ++i)
+                {
+                    data[i] = items_[begin + offset + i].world;
+                }
+
+                gfx::set_instance_data_buffer(&idb, 0, instances);
+            }
+            else if(it.skinning)
+            {
+                gfx::set_world_transform(it.skinning->transforms);
+            }
+            else
+            {
+                gfx::set_world_transform(it.world);
+            }
+
+            if(it.mat != current_material)
+            {
+                callbacks.bind_material(it.program, instanced, *it.mat);
+                current_material = it.mat;
+                stats_.material_binds++;
+            }
+            else
+            {
+                stats_.material_binds_skipped++;
+            }
+
+            if(callbacks.bind_item)
+            {
+                callbacks.bind_item(it.program, instanced, it);
+            }
+
+            offset += instances;
+
+            bool keep_material = false;
+            if(offset < run)
+            {
+                keep_material = true;
+            }
+            else if(next_begin < count)
+            {
+                const auto& next = items_[next_begin];
+                keep_material = program_id(next, next_run > 1) == id && next.mat == it.mat;
+            }
+
+            callbacks.submit(it.program, instanced, keep_material ? discard_keep_material : uint8_t(BGFX_DISCARD_ALL));
+
+            stats_.draws++;
+            if(instanced)
+            {
+                stats_.instanced_draws++;
+            }
+        }
+
+        begin = next_begin;
+        run = next_run;
+    }
+
+    return stats_;
+}
+
+auto render_queue::get_items() const -> const std::vector<item>&
+{
+    return items_;
+}
+
+auto render_queue::get_stats() const -> const stats&
+{
+    return stats_;
+}
+
+} // namespace ace
@@ -0,0 +1,190 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include "material.h"
+#include "mesh.h"
+#include "model.h"
+
+#include <math/math.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ace
+{
+class job_system;
+
+/**
+ * @class render_queue
+ * @brief Collects draw items for a pass, sorts them by a 64 bit key and submits them while
+ * skipping program and material binds that did not change since the previous draw.
+ *
+ * Key layout, from the most significant bit:
+ * | pass (4) | program (8) | material (16) | submesh (16) | depth (20) |
+ *
+ * Runs of items that share program, material, submesh and lod params are drawn with a
+ * single instanced draw call when an instanced program is available.
+ */
+class render_queue
+{
+public:
+    /**
+     * @struct item
+     * @brief A single submesh draw.
+     */
+    struct item
+    {
+        ///< Sort key, see make_key.
+        uint64_t key{};
+        ///< Pass local program index.
+        uint8_t program{};
+        const material* mat{};
+        ace::mesh* mesh{};
+        const ace::mesh::submesh* submesh{};
+        ///< World transform for non skinned submeshes.
+        math::mat4 world{1.0f};
+        ///< Bone palette for skinned submeshes.
+        const pose_mat4* skinning{};
+        ///< Lod fade parameters.
+        math::vec3 lod_params{0.0f, -1.0f, 1.0f};
+        ///< Larger screen extent of the model in pixels, drives texture streaming. 0 if unknown.
+        float screen_size{};
+    };
+
+    /**
+     * @struct stats
+     * @brief Counters for the last submission.
+     */
+    struct stats
+    {
+        uint32_t items{};
+        uint32_t draws{};
+        uint32_t instanced_draws{};
+        uint32_t program_binds{};
+        uint32_t program_binds_skipped{};
+        uint32_t material_binds{};
+        uint32_t material_binds_skipped{};
+
+        auto operator+=(const stats& rhs) -> stats&;
+    };
+
+    /**
+     * @struct submit_callbacks
+     * @brief Callbacks invoked by submit. Only submit is called once per draw, the rest
+     * are called when the respective state changes.
+     */
+    struct submit_callbacks
+    {
+        /// Binds a program and sets its per pass uniforms. Returns false if the program is not usable.
+        std::function<bool(uint8_t program, bool instanced)> bind_program;
+        /// Sets the textures, uniforms and render state of a material.
+        std::function<void(uint8_t program, bool instanced, const material& mat)> bind_material;
+        /// Sets per draw parameters such as the lod fade.
+        std::function<void(uint8_t program, bool instanced, const item& it)> bind_item;
+        /// Submits the draw with the given bgfx discard flags.
+        std::function<void(uint8_t program, bool instanced, uint8_t discard)> submit;
+    };
+
+    /**
+     * @enum model_program
+     * @brief Program indices used by emit_model.
+     */
+    enum model_program : uint8_t
+    {
+        program_static,
+        program_skinned,
+    };
+
+    /**
+     * @brief Builds a sort key.
+     * @param pass The pass index, 4 bits.
+     * @param program The program index.
+     * @param mat The material.
+     * @param submesh The submesh.
+     * @param depth Normalized depth in the [0, 1] range, smaller draws first.
+     */
+    static auto make_key(uint8_t pass,
+                         uint8_t program,
+                         const material* mat,
+                         const ace::mesh::submesh* submesh,
+                         float depth) -> uint64_t;
+
+    /**
+     * @brief Appends one item per submesh of a model lod. Non skinned submeshes use
+     * program_static, skinned ones use program_skinned.
+     * @param mdl The model.
+     * @param lod The level of detail.
+     * @param world_transform The world transform of the model.
+     * @param submesh_transforms Per submesh world transforms, if any.
+     * @param skinning_matrices Per submesh bone palettes.
+     * @param lod_params Lod fade parameters.
+     * @param pass The pass index used for the keys.
+     * @param depth Normalized depth used for the keys.
+     * @param out The output items.
+     */
+    static void emit_model(const model& mdl,
+                           uint32_t lod,
+                           const math::mat4& world_transform,
+                           const pose_mat4& submesh_transforms,
+                           const std::vector<pose_mat4>& skinning_matrices,
+                           const math::vec3& lod_params,
+                           uint8_t pass,
+                           float depth,
+                           std::vector<item>& out);
+
+    /**
+     * @brief Removes all items.
+     */
+    void clear();
+
+    /**
+     * @brief Adds an item. Not thread safe.
+     * @param it The item.
+     */
+    void push(const item& it);
+
+    /**
+     * @brief Fills the queue in parallel.
+     * @param jobs Job system to split the work on. When null the work runs on the calling thread.
+     * @param count Number of elements to process.
+     * @param emit Called once per element index, appends the element's items to the output.
+     * Must be safe to call concurrently for different indices.
+     */
+    void build(job_system* jobs,
+               size_t count,
+               const std::function<void(size_t index, std::vector<item>& out)>& emit);
+
+    /**
+     * @brief Sorts the items by key.
+     * @param jobs Job system to split the work on. When null the work runs on the calling thread.
+     */
+    void sort(job_system* jobs);
+
+    /**
+     * @brief Submits all items in order.
+     * @param callbacks The submit callbacks.
+     * @param allow_instancing Merge identical consecutive items into instanced draws.
+     * @return The counters for this submission.
+     */
+    auto submit(const submit_callbacks& callbacks, bool allow_instancing) -> const stats&;
+
+    /**
+     * @brief Gets the items.
+     */
+    auto get_items() const -> const std::vector<item>&;
+
+    /**
+     * @brief Gets the counters of the last submission.
+     */
+    auto get_stats() const -> const stats&;
+
+private:
+    auto is_same_draw(const item& lhs, const item& rhs) const -> bool;
+
+    std::vector<item> items_;
+    std::vector<std::vector<item>> chunks_;
+    stats stats_;
+};
+
+} // namespace ace
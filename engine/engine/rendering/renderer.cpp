@@ -1,5 +1,7 @@
 #include "renderer.h"
 #include "../events.h"
+#include "texture_streamer.h"
+#include "../threading/threader.h"
 #include "spdlog/common.h"
 
 #include <base/assert.hpp>
@@ -259,11 +261,14 @@ void renderer::frame_begin(rtti::context& /*ctx*/, delta_t /*dt*/)
     pass.clear();
 }
 
-void renderer::frame_end(rtti::context& /*ctx*/, delta_t /*dt*/)
+void renderer::frame_end(rtti::context& ctx, delta_t /*dt*/)
 {
     gfx::render_pass pass(gfx::render_pass::get_max_pass_id(), "backbuffer_update");
     pass.bind();
 
+    // Usage of this frame is recorded, swap in the mips the next frame needs.
+    get_texture_streamer().update(gfx::get_render_frame(), *ctx.get_cached<threader>().pool);
+
     gfx::frame();
 
     // if(!request_screenshot_.empty())
@@ -12,6 +12,10 @@
 #include <engine/rendering/mesh.h>
 #include <engine/rendering/model.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/shadow_atlas.h>
+#include <engine/threading/threader.h>
+
+#include <base/hash.hpp>
 
 #include <graphics/index_buffer.h>
 #include <graphics/render_pass.h>
@@ -357,21 +361,29 @@ void shadowmap_generator::deinit_textures()
     }
 
     valid_ = false;
+    cached_ = false;
 
-    for(int i = 0; i < ShadowMapRenderTargets::Count; ++i)
+    release_atlas();
+}
+
+void shadowmap_generator::release_atlas()
+{
+    if(atlas_handle_ != shadow_atlas::invalid_handle)
     {
-        if(bgfx::isValid(rt_shadow_map_[i]))
+        // Generators can outlive the engine services when scenes are torn down late.
+        auto& ctx = engine::context();
+        if(ctx.has<shadow_atlas>())
         {
-            bgfx::destroy(rt_shadow_map_[i]);
-            rt_shadow_map_[i] = {bgfx::kInvalidHandle};
+            ctx.get<shadow_atlas>().release(atlas_handle_);
         }
+        atlas_handle_ = shadow_atlas::invalid_handle;
     }
 
-    if(bgfx::isValid(rt_blur_))
+    for(int i = 0; i < ShadowMapRenderTargets::Count; ++i)
     {
-        bgfx::destroy(rt_blur_);
-        rt_blur_ = {bgfx::kInvalidHandle};
+        rt_shadow_map_[i] = {bgfx::kInvalidHandle};
     }
+    rt_blur_ = {bgfx::kInvalidHandle};
 }
 
 void shadowmap_generator::deinit_uniforms()
@@ -1018,7 +1030,7 @@ auto shadowmap_generator::get_depth_type() const -> PackDepth::Enum
 
 auto shadowmap_generator::get_rt_texture(uint8_t split) const -> bgfx::TextureHandle
 {
-    if(!bgfx::isValid(shadow_map_[split]))
+    if(!bgfx::isValid(shadow_map_[split]) || !bgfx::isValid(rt_shadow_map_[split]))
     {
         return {bgfx::kInvalidHandle};
     }
@@ -1040,14 +1052,17 @@ void shadowmap_generator::submit_uniforms(uint8_t stage) const
     uniforms_.submitPerFrameUniforms();
     uniforms_.submitPerDrawUniforms();
 
+    if(!bgfx::isValid(rt_shadow_map_[0]))
+    {
+        return;
+    }
+
     for(uint8_t ii = 0; ii < ShadowMapRenderTargets::Count; ++ii)
     {
-        if(!bgfx::isValid(rt_shadow_map_[ii]))
-        {
-            continue;
-        }
+        // The atlas only hands out as many maps as the light uses, keep the rest bound to something valid.
+        auto rt = bgfx::isValid(rt_shadow_map_[ii]) ? rt_shadow_map_[ii] : rt_shadow_map_[0];
 
-        bgfx::setTexture(stage + ii, shadow_map_[ii], bgfx::getTexture(rt_shadow_map_[ii]));
+        bgfx::setTexture(stage + ii, shadow_map_[ii], bgfx::getTexture(rt));
     }
 }
 
@@ -1056,7 +1071,18 @@ auto shadowmap_generator::already_updated() const -> bool
     return last_update_ == gfx::get_render_frame();
 }
 
-void shadowmap_generator::update(const camera& cam, const light& l, const math::transform& ltrans)
+auto shadowmap_generator::is_cached() const -> bool
+{
+    const auto frame = gfx::get_render_frame();
+    return cached_ && (last_validated_ == frame || last_validated_ + 1 == frame);
+}
+
+void shadowmap_generator::mark_validated()
+{
+    last_validated_ = gfx::get_render_frame();
+}
+
+void shadowmap_generator::update(const camera& cam, const light& l, const math::transform& ltrans, uint32_t coverage)
 {
     last_update_ = gfx::get_render_frame();
 
@@ -1154,70 +1180,59 @@ void shadowmap_generator::update(const camera& cam, const light& l, const math::
 
     // Update render target size.
     uint16_t shadowMapSize = 1 << uint32_t(currentSmSettings->m_sizePwrTwo);
-    recreateTextures |= current_shadow_map_size_ != shadowMapSize;
 
-    if(recreateTextures)
-    {
-        current_shadow_map_size_ = shadowMapSize;
+    auto& atlas = engine::context().get_cached<shadow_atlas>();
+    const auto& atlas_settings = atlas.get_settings();
 
-        if(bgfx::isValid(rt_shadow_map_[0]))
+    if(LightType::DirectionalLight != settings_.m_lightType && coverage > 0)
+    {
+        // Local lights only need as many texels as they cover on screen.
+        uint32_t wanted = atlas_settings.min_size;
+        while(wanted < coverage && wanted < shadowMapSize)
         {
-            bgfx::destroy(rt_shadow_map_[0]);
+            wanted <<= 1;
         }
 
+        // Shrink one step late so lights near a size boundary do not reallocate every frame.
+        if(wanted < requested_shadow_map_size_ && wanted * 4 > requested_shadow_map_size_)
         {
-            bgfx::TextureHandle fbtextures[] = {
-                bgfx::createTexture2D(current_shadow_map_size_,
-                                      current_shadow_map_size_,
-                                      false,
-                                      1,
-                                      bgfx::TextureFormat::BGRA8,
-                                      BGFX_TEXTURE_RT),
-                bgfx::createTexture2D(current_shadow_map_size_,
-                                      current_shadow_map_size_,
-                                      false,
-                                      1,
-                                      bgfx::TextureFormat::D24S8,
-                                      BGFX_TEXTURE_RT),
-            };
-            rt_shadow_map_[0] = bgfx::createFrameBuffer(BX_COUNTOF(fbtextures), fbtextures, true);
+            wanted = requested_shadow_map_size_;
         }
 
-        // if(LightType::DirectionalLight == settings_.m_lightType)
-        {
-            for(uint8_t ii = 1; ii < ShadowMapRenderTargets::Count; ++ii)
-            {
-                if(bgfx::isValid(rt_shadow_map_[ii]))
-                {
-                    bgfx::destroy(rt_shadow_map_[ii]);
-                }
+        shadowMapSize = uint16_t(std::min<uint32_t>(wanted, shadowMapSize));
+    }
 
-                {
-                    bgfx::TextureHandle fbtextures[] = {
-                        bgfx::createTexture2D(current_shadow_map_size_,
-                                              current_shadow_map_size_,
-                                              false,
-                                              1,
-                                              bgfx::TextureFormat::BGRA8,
-                                              BGFX_TEXTURE_RT),
-                        bgfx::createTexture2D(current_shadow_map_size_,
-                                              current_shadow_map_size_,
-                                              false,
-                                              1,
-                                              bgfx::TextureFormat::D24S8,
-                                              BGFX_TEXTURE_RT),
-                    };
-                    rt_shadow_map_[ii] = bgfx::createFrameBuffer(BX_COUNTOF(fbtextures), fbtextures, true);
-                }
-            }
-        }
+    const uint64_t frame = gfx::get_render_frame();
+    const uint8_t mapCount =
+        (LightType::DirectionalLight == settings_.m_lightType) ? uint8_t(settings_.m_numSplits) : uint8_t(1);
 
-        if(bgfx::isValid(rt_blur_))
+    const auto* allocation = atlas.touch(atlas_handle_, frame);
+    recreateTextures |= allocation == nullptr;
+    recreateTextures |= allocation && allocation->count != mapCount;
+    recreateTextures |= requested_shadow_map_size_ != shadowMapSize;
+
+    if(recreateTextures)
+    {
+        release_atlas();
+
+        atlas_handle_ = atlas.acquire(shadowMapSize, mapCount, frame);
+        allocation = atlas.touch(atlas_handle_, frame);
+        requested_shadow_map_size_ = shadowMapSize;
+        cached_ = false;
+    }
+
+    if(allocation)
+    {
+        for(uint8_t ii = 0; ii < ShadowMapRenderTargets::Count; ++ii)
         {
-            bgfx::destroy(rt_blur_);
+            rt_shadow_map_[ii] = allocation->maps[ii];
         }
-        rt_blur_ =
-            bgfx::createFrameBuffer(current_shadow_map_size_, current_shadow_map_size_, bgfx::TextureFormat::BGRA8);
+        rt_blur_ = allocation->blur;
+        current_shadow_map_size_ = allocation->size;
+    }
+    else
+    {
+        current_shadow_map_size_ = shadowMapSize;
     }
 
     float currentShadowMapSizef = float(int16_t(current_shadow_map_size_));
@@ -1649,10 +1664,47 @@ void shadowmap_generator::update(const camera& cam, const light& l, const math::
             bx::mtxMul(light_mtx_, tmp, mtxShadow);
         }
     }
+
+    // Anything that changes what ends up in the maps invalidates the cached render.
+    const auto hash = compute_cache_hash();
+    if(hash != cache_hash_ || LightType::DirectionalLight == settings_.m_lightType)
+    {
+        cached_ = false;
+    }
+    cache_hash_ = hash;
+}
+
+auto shadowmap_generator::compute_cache_hash() const -> size_t
+{
+    size_t seed = 0;
+    utils::hash_combine(seed, int(settings_.m_lightType));
+    utils::hash_combine(seed, int(settings_.m_depthImpl));
+    utils::hash_combine(seed, int(settings_.m_smImpl));
+    utils::hash_combine(seed, settings_.m_stencilPack);
+    utils::hash_combine(seed, current_shadow_map_size_);
+
+    for(uint8_t ii = 0; ii < ShadowMapRenderTargets::Count; ++ii)
+    {
+        for(uint8_t jj = 0; jj < 16; ++jj)
+        {
+            utils::hash_combine(seed, light_view_[ii][jj]);
+            utils::hash_combine(seed, light_proj_[ii][jj]);
+        }
+    }
+
+    return seed;
 }
 
 void shadowmap_generator::generate_shadowmaps(const shadow_map_models_t& models)
 {
+    stats_ = {};
+
+    // The atlas had no room for this light.
+    if(!bgfx::isValid(rt_shadow_map_[0]))
+    {
+        return;
+    }
+
     auto& lightView = light_view_;
     auto& lightProj = light_proj_;
     auto& lightFrustums = light_frustums_;
@@ -1982,6 +2034,9 @@ void shadowmap_generator::generate_shadowmaps(const shadow_map_models_t& models)
             }
         }
     }
+
+    cached_ = LightType::DirectionalLight != settings_.m_lightType;
+    last_validated_ = gfx::get_render_frame();
 }
 
 auto shadowmap_generator::render_scene_into_shadowmap(uint8_t shadowmap_1_id,
@@ -1989,6 +2044,8 @@ auto shadowmap_generator::render_scene_into_shadowmap(uint8_t shadowmap_1_id,
                                                       const math::frustum lightFrustums[ShadowMapRenderTargets::Count],
                                                       ShadowMapSettings* currentSmSettings) -> bool
 {
+    auto& th = engine::context().get_cached<threader>();
+
     bool any_rendered = false;
     // Draw scene into shadowmap.
     uint8_t drawNum;
@@ -2005,89 +2062,142 @@ auto shadowmap_generator::render_scene_into_shadowmap(uint8_t shadowmap_1_id,
         drawNum = uint8_t(settings_.m_numSplits);
     }
 
-    for(const auto& e : models)
+    auto prog_instanced = get_instanced_pack_program(currentSmSettings->m_progPack);
+    const bool use_instancing = prog_instanced && (gfx::get_caps()->supported & BGFX_CAPS_INSTANCING) != 0 &&
+                                prog_instanced->begin();
+
+    auto get_program = [&](uint8_t program, bool instanced) -> gpu_program*
     {
-        const auto& transform_comp = e.get<transform_component>();
-        auto& model_comp = e.get<model_component>();
+        if(instanced)
+        {
+            return prog_instanced;
+        }
+        return program == render_queue::program_skinned ? currentSmSettings->m_progPackSkinned
+                                                        : currentSmSettings->m_progPack;
+    };
 
-        const auto& model = model_comp.get_model();
-        if(!model.is_valid())
-            continue;
+    for(uint8_t ii = 0; ii < drawNum; ++ii)
+    {
+        const uint8_t viewId = shadowmap_1_id + ii;
 
-        const auto& world_transform = transform_comp.get_transform_global();
+        uint8_t renderStateIndex = RenderState::ShadowMap_PackDepth;
+        if(LightType::PointLight == settings_.m_lightType && settings_.m_stencilPack)
+        {
+            renderStateIndex =
+                uint8_t((ii < 2) ? RenderState::ShadowMap_PackDepthHoriz : RenderState::ShadowMap_PackDepthVert);
+        }
 
-        const auto& world_bounds = model_comp.get_world_bounds();
-        const auto& local_bounds = model_comp.get_local_bounds();
+        const auto& _renderState = render_states[renderStateIndex];
+
+        queue_.clear();
+        queue_.build(th.jobs.get(),
+                     models.size(),
+                     [&](size_t index, std::vector<render_queue::item>& out)
+                     {
+                         const auto& e = models[index];
+                         const auto& transform_comp = e.get<transform_component>();
+                         auto& model_comp = e.get<model_component>();
+
+                         const auto& model = model_comp.get_model();
+                         if(!model.is_valid())
+                             return;
+
+                         const auto& world_transform = transform_comp.get_transform_global();
+                         const auto& local_bounds = model_comp.get_local_bounds();
+
+                         if(!lightFrustums[ii].test_obb(local_bounds, world_transform))
+                         {
+                             return;
+                         }
+
+                         const auto& submesh_transforms = model_comp.get_submesh_transforms();
+                         const auto& skinning_matrices = model_comp.get_skinning_transforms();
+
+                         const auto current_lod_index = 0;
+
+                         model_comp.set_last_render_frame(gfx::get_render_frame());
+
+                         // Depth does not matter for depth only draws, keep identical meshes together.
+                         render_queue::emit_model(model,
+                                                  current_lod_index,
+                                                  world_transform.get_matrix(),
+                                                  submesh_transforms,
+                                                  skinning_matrices,
+                                                  math::vec3{0.0f, -1.0f, 1.0f},
+                                                  0,
+                                                  0.0f,
+                                                  out);
+                     });
+
+        if(queue_.get_items().empty())
+        {
+            continue;
+        }
+
+        any_rendered = true;
+        queue_.sort(th.jobs.get());
 
-        const auto& submesh_transforms = model_comp.get_submesh_transforms();
-        const auto& bone_transforms = model_comp.get_bone_transforms();
-        const auto& skinning_matrices = model_comp.get_skinning_transforms();
+        gpu_program* bound = nullptr;
 
-        const auto current_lod_index = 0;
-        for(uint8_t ii = 0; ii < drawNum; ++ii)
+        render_queue::submit_callbacks callbacks;
+        callbacks.bind_program = [&](uint8_t program, bool instanced)
         {
-            if(!lightFrustums[ii].test_obb(local_bounds, world_transform))
-            // if(!lightFrustums[ii].test_aabb(world_bounds))
+            if(bound)
             {
-                continue;
+                bound->end();
             }
 
-            const uint8_t viewId = shadowmap_1_id + ii;
-
-            uint8_t renderStateIndex = RenderState::ShadowMap_PackDepth;
-            if(LightType::PointLight == settings_.m_lightType && settings_.m_stencilPack)
+            bound = get_program(program, instanced);
+            if(!bound->begin())
             {
-                renderStateIndex =
-                    uint8_t((ii < 2) ? RenderState::ShadowMap_PackDepthHoriz : RenderState::ShadowMap_PackDepthVert);
+                return false;
             }
 
-            const auto& _renderState = render_states[renderStateIndex];
-
-            model::submit_callbacks callbacks;
-            callbacks.setup_begin = [&](const model::submit_callbacks::params& submit_params)
-            {
-                auto& prog =
-                    submit_params.skinned ? currentSmSettings->m_progPackSkinned : currentSmSettings->m_progPack;
-                prog->begin();
-            };
-            callbacks.setup_params_per_instance = [&](const model::submit_callbacks::params& submit_params)
-            {
-                // Set uniforms.
-                uniforms_.submitPerDrawUniforms();
+            // Set uniforms.
+            uniforms_.submitPerDrawUniforms();
+            return true;
+        };
+        callbacks.bind_material = [&](uint8_t program, bool instanced, const material& mat)
+        {
+            // Apply render state.
+            gfx::set_stencil(_renderState.m_fstencil, _renderState.m_bstencil);
+            gfx::set_state(_renderState.m_state, _renderState.m_blendFactorRgba);
+        };
+        callbacks.submit = [&](uint8_t program, bool instanced, uint8_t discard)
+        {
+            bgfx::submit(viewId, get_program(program, instanced)->native_handle(), 0, discard);
+        };
 
-                // Apply render state.
-                gfx::set_stencil(_renderState.m_fstencil, _renderState.m_bstencil);
-                gfx::set_state(_renderState.m_state, _renderState.m_blendFactorRgba);
-            };
-            callbacks.setup_params_per_submesh =
-                [&](const model::submit_callbacks::params& submit_params, const material& mat)
-            {
-                auto& prog =
-                    submit_params.skinned ? currentSmSettings->m_progPackSkinned : currentSmSettings->m_progPack;
+        stats_ += queue_.submit(callbacks, use_instancing);
 
-                gfx::submit(viewId, prog->native_handle(), 0, submit_params.preserve_state);
-            };
-            callbacks.setup_end = [&](const model::submit_callbacks::params& submit_params)
-            {
-                auto& prog =
-                    submit_params.skinned ? currentSmSettings->m_progPackSkinned : currentSmSettings->m_progPack;
+        if(bound)
+        {
+            bound->end();
+        }
+    }
 
-                prog->end();
-            };
+    return any_rendered;
+}
 
-            model_comp.set_last_render_frame(gfx::get_render_frame());
-            model.submit(world_transform,
-                         submesh_transforms,
-                         bone_transforms,
-                         skinning_matrices,
-                         current_lod_index,
-                         callbacks);
+auto shadowmap_generator::get_stats() const -> const render_queue::stats&
+{
+    return stats_;
+}
 
-            any_rendered = true;
+auto shadowmap_generator::get_instanced_pack_program(const gpu_program* pack) const -> gpu_program*
+{
+    for(uint8_t ii = 0; ii < DepthImpl::Count; ++ii)
+    {
+        for(uint8_t jj = 0; jj < PackDepth::Count; ++jj)
+        {
+            if(programs_.m_packDepth[ii][jj].get() == pack)
+            {
+                return programs_.m_packDepthInstanced[ii][jj].get();
+            }
         }
     }
 
-    return any_rendered;
+    return nullptr;
 }
 
 void Programs::init(rtti::context& ctx)
@@ -2131,6 +2241,12 @@ void Programs::init(rtti::context& ctx)
     m_packDepthSkinned[DepthImpl::Linear][PackDepth::RGBA] = loadProgram("vs_shadowmaps_packdepth_linear_skinned", "fs_shadowmaps_packdepth_linear");
     m_packDepthSkinned[DepthImpl::Linear][PackDepth::VSM]  = loadProgram("vs_shadowmaps_packdepth_linear_skinned", "fs_shadowmaps_packdepth_vsm_linear");
 
+    m_packDepthInstanced[DepthImpl::InvZ][PackDepth::RGBA] = loadProgram("vs_shadowmaps_packdepth_instanced", "fs_shadowmaps_packdepth");
+    m_packDepthInstanced[DepthImpl::InvZ][PackDepth::VSM]  = loadProgram("vs_shadowmaps_packdepth_instanced", "fs_shadowmaps_packdepth_vsm");
+
+    m_packDepthInstanced[DepthImpl::Linear][PackDepth::RGBA] = loadProgram("vs_shadowmaps_packdepth_linear_instanced", "fs_shadowmaps_packdepth_linear");
+    m_packDepthInstanced[DepthImpl::Linear][PackDepth::VSM]  = loadProgram("vs_shadowmaps_packdepth_linear_instanced", "fs_shadowmaps_packdepth_vsm_linear");
+
 }
 
 }
@@ -10,6 +10,8 @@
 
 #include <engine/ecs/ecs.h>
 #include <engine/rendering/gpu_program.h>
+#include <engine/rendering/render_queue.h>
+#include <engine/rendering/shadow_atlas.h>
 #include <graphics/graphics.h>
 
 namespace ace
@@ -437,6 +439,8 @@ struct Programs
             for(uint8_t jj = 0; jj < PackDepth::Count; ++jj)
             {
                 m_packDepth[ii][jj].reset();
+                m_packDepthSkinned[ii][jj].reset();
+                m_packDepthInstanced[ii][jj].reset();
             }
         }
 
@@ -468,6 +472,7 @@ struct Programs
     gpu_program::ptr m_drawDepth[PackDepth::Count];
     gpu_program::ptr m_packDepth[DepthImpl::Count][PackDepth::Count];
     gpu_program::ptr m_packDepthSkinned[DepthImpl::Count][PackDepth::Count];
+    gpu_program::ptr m_packDepthInstanced[DepthImpl::Count][PackDepth::Count];
 };
 
 struct ShadowMapSettings
@@ -541,11 +546,37 @@ public:
     void deinit_textures();
     void deinit_uniforms();
 
-    void update(const camera& cam, const light& l, const math::transform& ltrans);
+    /**
+     * @brief Updates the light matrices and acquires the render targets from the shadow atlas.
+     * @param cam The camera.
+     * @param l The light.
+     * @param ltrans The light transform.
+     * @param coverage Screen size of the light in pixels, local lights get a map no larger
+     * than needed. Zero uses the resolution from the light settings.
+     */
+    void update(const camera& cam, const light& l, const math::transform& ltrans, uint32_t coverage = 0);
     auto already_updated() const -> bool;
 
+    /**
+     * @brief Whether the shadow maps still hold a valid render for the current light state.
+     * Only local lights are cached, directional maps follow the camera. Changed casters are only
+     * kept for one frame, so a render that was not checked against them on every frame since it
+     * was made may have missed a change and is not cached anymore.
+     */
+    auto is_cached() const -> bool;
+
+    /**
+     * @brief Records that the cached render was checked against the changed casters of this frame.
+     */
+    void mark_validated();
+
     void generate_shadowmaps(const shadow_map_models_t& model);
 
+    /**
+     * @brief Gets the draw counters of the last generate_shadowmaps call.
+     */
+    auto get_stats() const -> const render_queue::stats&;
+
     auto get_depth_type() const -> PackDepth::Enum;
     auto get_rt_texture(uint8_t split) const -> bgfx::TextureHandle;
     auto get_depth_render_program(PackDepth::Enum depth) const -> gpu_program::ptr;
@@ -557,6 +588,10 @@ private:
                                      const math::frustum frustums[ShadowMapRenderTargets::Count],
                                      ShadowMapSettings* currentSmSettings) -> bool;
 
+    auto get_instanced_pack_program(const gpu_program* pack) const -> gpu_program*;
+    auto compute_cache_hash() const -> size_t;
+    void release_atlas();
+
     ClearValues clear_values_;
 
     float color_[4];
@@ -570,9 +605,12 @@ private:
     SceneSettings settings_;
 
     uint16_t current_shadow_map_size_{};
+    uint16_t requested_shadow_map_size_{};
 
     Uniforms uniforms_;
     Programs programs_;
+    render_queue queue_;
+    render_queue::stats stats_;
 
     float light_view_[ShadowMapRenderTargets::Count][16];
     float light_proj_[ShadowMapRenderTargets::Count][16];
@@ -581,12 +619,17 @@ private:
 
     bgfx::UniformHandle tex_color_{bgfx::kInvalidHandle};
     bgfx::UniformHandle shadow_map_[ShadowMapRenderTargets::Count];
+    ///< Borrowed from the shadow atlas, valid while the allocation is resident.
     bgfx::FrameBufferHandle rt_shadow_map_[ShadowMapRenderTargets::Count];
     bgfx::FrameBufferHandle rt_blur_{bgfx::kInvalidHandle};
+    shadow_atlas::handle_t atlas_handle_{shadow_atlas::invalid_handle};
 
+    size_t cache_hash_{};
+    bool cached_{};
     bool valid_{};
 
     uint64_t last_update_ = -1;
+    uint64_t last_validated_ = -1;
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 };
 
@@ -0,0 +1,399 @@
+#include "shadow_atlas.h"
+
+#include <logging/logging.h>
+
+#include <algorithm>
+
+namespace ace
+{
+namespace
+{
+
+auto round_up_pow2(uint32_t value) -> uint32_t
+{
+    uint32_t result = 1;
+    while(result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+auto create_map(uint16_t size) -> bgfx::FrameBufferHandle
+{
+    bgfx::TextureHandle fbtextures[] = {
+        bgfx::createTexture2D(size, size, false, 1, bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_RT),
+        bgfx::createTexture2D(size, size, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT),
+    };
+    return bgfx::createFrameBuffer(BX_COUNTOF(fbtextures), fbtextures, true);
+}
+
+} // namespace
+
+shadow_atlas::shadow_atlas() = default;
+
+shadow_atlas::~shadow_atlas() = default;
+
+auto shadow_atlas::init(rtti::context& ctx) -> bool
+{
+    APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
+
+    stats_ = {};
+    stats_.budget_bytes = settings_.budget_bytes;
+    return true;
+}
+
+auto shadow_atlas::deinit(rtti::context& ctx) -> bool
+{
+    APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
+
+    destroy_all();
+    return true;
+}
+
+auto shadow_atlas::map_bytes(uint16_t size) -> uint64_t
+{
+    // BGRA8 color and D24S8 depth.
+    return uint64_t(size) * uint64_t(size) * 8;
+}
+
+auto shadow_atlas::blur_bytes(uint16_t size) -> uint64_t
+{
+    return uint64_t(size) * uint64_t(size) * 4;
+}
+
+auto shadow_atlas::acquire(uint16_t size, uint8_t count, uint64_t frame) -> handle_t
+{
+    if(count == 0)
+    {
+        return invalid_handle;
+    }
+
+    count = std::min(count, max_maps);
+
+    auto clamped = round_up_pow2(std::max<uint32_t>(size, 1));
+    clamped = std::clamp<uint32_t>(clamped, settings_.min_size, settings_.max_size);
+
+    if(++next_handle_ == invalid_handle)
+    {
+        ++next_handle_;
+    }
+    const auto handle = next_handle_;
+
+    for(auto current = clamped; current >= settings_.min_size && current > 0; current /= 2)
+    {
+        record rec;
+        if(try_acquire(uint16_t(current), count, frame, handle, rec))
+        {
+            records_[handle] = rec;
+            exhausted_ = false;
+            update_stats();
+            return handle;
+        }
+    }
+
+    if(!exhausted_)
+    {
+        APPLOG_WARNING("Shadow atlas budget of {} MB exhausted, lights will not cast shadows until it frees up.",
+                       settings_.budget_bytes >> 20);
+        exhausted_ = true;
+    }
+
+    stats_.failed_acquires++;
+    update_stats();
+    return invalid_handle;
+}
+
+auto shadow_atlas::try_acquire(uint16_t size, uint8_t count, uint64_t frame, handle_t owner, record& rec) -> bool
+{
+    uint8_t found = 0;
+    while(true)
+    {
+        // Reuse pooled targets of the same size first, they cost nothing.
+        found = 0;
+        for(uint32_t i = 0; i < entries_.size() && found < count; ++i)
+        {
+            const auto& entry = entries_[i];
+            if(entry.owner == invalid_handle && bgfx::isValid(entry.fb) && entry.size == size)
+            {
+                rec.entries[found++] = i;
+            }
+        }
+
+        uint64_t needed = uint64_t(count - found) * map_bytes(size);
+        if(blur_.find(size) == blur_.end())
+        {
+            needed += blur_bytes(size);
+        }
+
+        if(stats_.used_bytes + needed <= settings_.budget_bytes)
+        {
+            break;
+        }
+
+        if(!reclaim(frame, size))
+        {
+            return false;
+        }
+    }
+
+    for(uint8_t i = 0; i < found; ++i)
+    {
+        entries_[rec.entries[i]].owner = owner;
+    }
+
+    for(uint8_t i = found; i < count; ++i)
+    {
+        auto it = std::find_if(entries_.begin(),
+                               entries_.end(),
+                               [](const map_entry& entry)
+                               {
+                                   return !bgfx::isValid(entry.fb);
+                               });
+        if(it == entries_.end())
+        {
+            it = entries_.emplace(entries_.end());
+        }
+
+        it->fb = create_map(size);
+        it->size = size;
+        it->owner = owner;
+        stats_.used_bytes += map_bytes(size);
+
+        rec.entries[i] = uint32_t(std::distance(entries_.begin(), it));
+    }
+
+    rec.alloc.size = size;
+    rec.alloc.count = count;
+    rec.alloc.blur = get_blur(size);
+    for(uint8_t i = 0; i < count; ++i)
+    {
+        rec.alloc.maps[i] = entries_[rec.entries[i]].fb;
+    }
+    for(uint8_t i = count; i < max_maps; ++i)
+    {
+        rec.alloc.maps[i] = {bgfx::kInvalidHandle};
+    }
+
+    rec.last_used = frame;
+    rec.resident = true;
+    return true;
+}
+
+auto shadow_atlas::reclaim(uint64_t frame, uint16_t keep_size) -> bool
+{
+    // Unused pooled targets of another size go first.
+    for(auto& entry : entries_)
+    {
+        if(entry.owner == invalid_handle && bgfx::isValid(entry.fb) && entry.size != keep_size)
+        {
+            destroy_entry(entry);
+            return true;
+        }
+    }
+
+    // Then blur targets no live target needs anymore.
+    for(auto it = blur_.begin(); it != blur_.end(); ++it)
+    {
+        const auto size = it->first;
+        if(size == keep_size)
+        {
+            continue;
+        }
+
+        bool used = std::any_of(entries_.begin(),
+                                entries_.end(),
+                                [&](const map_entry& entry)
+                                {
+                                    return bgfx::isValid(entry.fb) && entry.size == size;
+                                });
+        if(!used)
+        {
+            bgfx::destroy(it->second);
+            stats_.used_bytes -= blur_bytes(size);
+            blur_.erase(it);
+            return true;
+        }
+    }
+
+    // Finally evict the least recently used allocation that was not used this frame.
+    record* lru = nullptr;
+    for(auto& kvp : records_)
+    {
+        auto& rec = kvp.second;
+        if(!rec.resident || rec.last_used >= frame)
+        {
+            continue;
+        }
+
+        if(!lru || rec.last_used < lru->last_used)
+        {
+            lru = &rec;
+        }
+    }
+
+    if(!lru)
+    {
+        return false;
+    }
+
+    evict(*lru);
+    return true;
+}
+
+auto shadow_atlas::get_blur(uint16_t size) -> bgfx::FrameBufferHandle
+{
+    auto it = blur_.find(size);
+    if(it != blur_.end())
+    {
+        return it->second;
+    }
+
+    auto fb = bgfx::createFrameBuffer(size, size, bgfx::TextureFormat::BGRA8);
+    stats_.used_bytes += blur_bytes(size);
+    blur_.emplace(size, fb);
+    return fb;
+}
+
+void shadow_atlas::evict(record& rec)
+{
+    for(uint8_t i = 0; i < rec.alloc.count; ++i)
+    {
+        entries_[rec.entries[i]].owner = invalid_handle;
+    }
+
+    rec.resident = false;
+    stats_.evictions++;
+}
+
+auto shadow_atlas::touch(handle_t handle, uint64_t frame) -> const allocation*
+{
+    auto it = records_.find(handle);
+    if(it == records_.end() || !it->second.resident)
+    {
+        return nullptr;
+    }
+
+    it->second.last_used = frame;
+    return &it->second.alloc;
+}
+
+void shadow_atlas::release(handle_t handle)
+{
+    auto it = records_.find(handle);
+    if(it == records_.end())
+    {
+        return;
+    }
+
+    auto& rec = it->second;
+    if(rec.resident)
+    {
+        // Keep the targets pooled, the next light of the same size reuses them.
+        for(uint8_t i = 0; i < rec.alloc.count; ++i)
+        {
+            entries_[rec.entries[i]].owner = invalid_handle;
+        }
+    }
+
+    records_.erase(it);
+    update_stats();
+}
+
+void shadow_atlas::set_settings(const settings& s)
+{
+    settings_ = s;
+    settings_.min_size = uint16_t(round_up_pow2(std::max<uint16_t>(settings_.min_size, 1)));
+    settings_.max_size = std::max(settings_.min_size, uint16_t(round_up_pow2(settings_.max_size)));
+    exhausted_ = false;
+
+    // Drop pooled targets that no longer fit, live ones are evicted on the next acquire.
+    for(auto& entry : entries_)
+    {
+        if(stats_.used_bytes <= settings_.budget_bytes)
+        {
+            break;
+        }
+
+        if(entry.owner == invalid_handle && bgfx::isValid(entry.fb))
+        {
+            destroy_entry(entry);
+        }
+    }
+
+    update_stats();
+}
+
+auto shadow_atlas::get_settings() const -> const settings&
+{
+    return settings_;
+}
+
+auto shadow_atlas::get_stats() const -> const stats&
+{
+    return stats_;
+}
+
+void shadow_atlas::update_stats()
+{
+    stats_.budget_bytes = settings_.budget_bytes;
+    stats_.allocations = 0;
+    stats_.resident_maps = 0;
+    stats_.free_maps = 0;
+
+    for(const auto& kvp : records_)
+    {
+        if(kvp.second.resident)
+        {
+            stats_.allocations++;
+        }
+    }
+
+    for(const auto& entry : entries_)
+    {
+        if(!bgfx::isValid(entry.fb))
+        {
+            continue;
+        }
+
+        if(entry.owner == invalid_handle)
+        {
+            stats_.free_maps++;
+        }
+        else
+        {
+            stats_.resident_maps++;
+        }
+    }
+}
+
+void shadow_atlas::destroy_entry(map_entry& entry)
+{
+    bgfx::destroy(entry.fb);
+    stats_.used_bytes -= map_bytes(entry.size);
+    entry = {};
+}
+
+void shadow_atlas::destroy_all()
+{
+    for(auto& entry : entries_)
+    {
+        if(bgfx::isValid(entry.fb))
+        {
+            destroy_entry(entry);
+        }
+    }
+    entries_.clear();
+
+    for(auto& kvp : blur_)
+    {
+        bgfx::destroy(kvp.second);
+    }
+    blur_.clear();
+
+    records_.clear();
+    stats_ = {};
+    stats_.budget_bytes = settings_.budget_bytes;
+}
+
+} // namespace ace
@@ -0,0 +1,144 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <base/basetypes.hpp>
+#include <context/context.hpp>
+#include <graphics/graphics.h>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class shadow_atlas
+ * @brief Shared pool of shadow map render targets for all shadow casting lights.
+ *
+ * Lights acquire power of two sized targets instead of owning them. Targets are kept
+ * resident across frames so unchanged lights can skip re-rendering, and the least
+ * recently used ones are evicted when a new request does not fit in the memory budget.
+ * Blur targets are scratch memory and are shared by every light of the same size.
+ */
+class shadow_atlas
+{
+public:
+    using handle_t = uint32_t;
+    static constexpr handle_t invalid_handle = 0;
+    static constexpr uint8_t max_maps = 4;
+
+    /**
+     * @struct settings
+     * @brief Budget and size limits.
+     */
+    struct settings
+    {
+        ///< Upper bound of gpu memory used by shadow and blur targets.
+        uint64_t budget_bytes = uint64_t(768) << 20;
+        ///< Smallest size a request can be shrunk to.
+        uint16_t min_size = 256;
+        ///< Largest size that can be requested.
+        uint16_t max_size = 4096;
+    };
+
+    /**
+     * @struct allocation
+     * @brief The render targets handed out for one acquire call.
+     */
+    struct allocation
+    {
+        std::array<bgfx::FrameBufferHandle, max_maps> maps{};
+        bgfx::FrameBufferHandle blur{bgfx::kInvalidHandle};
+        uint16_t size{};
+        uint8_t count{};
+    };
+
+    /**
+     * @struct stats
+     * @brief Counters describing the current state of the pool.
+     */
+    struct stats
+    {
+        uint64_t used_bytes{};
+        uint64_t budget_bytes{};
+        uint32_t allocations{};
+        uint32_t resident_maps{};
+        uint32_t free_maps{};
+        uint32_t evictions{};
+        uint32_t failed_acquires{};
+    };
+
+    shadow_atlas();
+    ~shadow_atlas();
+
+    auto init(rtti::context& ctx) -> bool;
+    auto deinit(rtti::context& ctx) -> bool;
+
+    /**
+     * @brief Acquires render targets. When the budget does not allow the requested size
+     * the least recently used allocations not used this frame are evicted, and if that
+     * is not enough the size is halved down to settings::min_size. Running out of budget is
+     * warned about once, until an acquire succeeds again or the settings change.
+     * @param size Requested size, rounded up to a power of two.
+     * @param count Number of maps, at most max_maps.
+     * @param frame The current frame.
+     * @return The allocation handle or invalid_handle.
+     */
+    auto acquire(uint16_t size, uint8_t count, uint64_t frame) -> handle_t;
+
+    /**
+     * @brief Marks an allocation as used this frame.
+     * @return The allocation or nullptr if it was evicted or released.
+     */
+    auto touch(handle_t handle, uint64_t frame) -> const allocation*;
+
+    /**
+     * @brief Returns the render targets of an allocation to the pool.
+     */
+    void release(handle_t handle);
+
+    void set_settings(const settings& s);
+    auto get_settings() const -> const settings&;
+    auto get_stats() const -> const stats&;
+
+private:
+    struct map_entry
+    {
+        bgfx::FrameBufferHandle fb{bgfx::kInvalidHandle};
+        uint16_t size{};
+        handle_t owner{invalid_handle};
+    };
+
+    struct record
+    {
+        allocation alloc;
+        std::array<uint32_t, max_maps> entries{};
+        uint64_t last_used{};
+        bool resident{};
+    };
+
+    auto try_acquire(uint16_t size, uint8_t count, uint64_t frame, handle_t owner, record& rec) -> bool;
+    auto reclaim(uint64_t frame, uint16_t keep_size) -> bool;
+    auto get_blur(uint16_t size) -> bgfx::FrameBufferHandle;
+    void evict(record& rec);
+    void update_stats();
+    void destroy_entry(map_entry& entry);
+    void destroy_all();
+
+    static auto map_bytes(uint16_t size) -> uint64_t;
+    static auto blur_bytes(uint16_t size) -> uint64_t;
+
+    settings settings_;
+    stats stats_;
+
+    std::vector<map_entry> entries_;
+    std::unordered_map<uint16_t, bgfx::FrameBufferHandle> blur_;
+    std::unordered_map<handle_t, record> records_;
+    handle_t next_handle_{invalid_handle};
+    ///< Set while acquires fail, lights retry every frame and should not warn every time.
+    bool exhausted_{};
+};
+
+} // namespace ace
@@ -0,0 +1,341 @@
+#include "texture_streamer.h"
+
+#include <filesystem/archive.h>
+#include <logging/logging.h>
+#include <threadpp/thread_pool.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace ace
+{
+namespace
+{
+thread_local int material_scope_depth = 0;
+} // namespace
+
+texture_streamer::material_scope::material_scope()
+{
+    material_scope_depth++;
+}
+
+texture_streamer::material_scope::~material_scope()
+{
+    material_scope_depth--;
+}
+
+auto texture_streamer::material_scope::is_active() -> bool
+{
+    return material_scope_depth > 0;
+}
+
+void texture_streamer::set_settings(const settings& s)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_ = s;
+}
+
+auto texture_streamer::get_settings() const -> settings
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return settings_;
+}
+
+auto texture_streamer::get_initial_skip(const gfx::texture_info& info) const -> uint8_t
+{
+    // Volumes lose depth with every mip as well, they are not worth streaming.
+    if(info.depth > 1 || info.numMips <= 1)
+    {
+        return 0;
+    }
+
+    const uint32_t initial_size = std::max<uint32_t>(get_settings().initial_size, 1);
+
+    uint8_t skip = 0;
+    uint32_t size = std::max<uint32_t>(info.width, info.height);
+    while(size > initial_size && skip + 1 < info.numMips)
+    {
+        size >>= 1;
+        skip++;
+    }
+
+    return skip;
+}
+
+auto texture_streamer::get_storage_size(const gfx::texture_info& full, uint8_t skip) -> uint64_t
+{
+    gfx::texture_info info{};
+    gfx::calc_texture_size(info,
+                           uint16_t(std::max<uint32_t>(full.width >> skip, 1)),
+                           uint16_t(std::max<uint32_t>(full.height >> skip, 1)),
+                           full.depth,
+                           full.cubeMap,
+                           full.numMips - skip > 1,
+                           full.numLayers,
+                           full.format);
+    return info.storageSize;
+}
+
+auto texture_streamer::get_skip_for(const entry& e, float texels) -> uint8_t
+{
+    // The smallest mip that still has at least as many texels as the draw needs.
+    uint8_t skip = 0;
+    uint32_t size = std::max<uint32_t>(e.full.width, e.full.height);
+    while(skip < e.min_skip && float(size >> 1) >= texels)
+    {
+        size >>= 1;
+        skip++;
+    }
+
+    return skip;
+}
+
+void texture_streamer::add(const std::string& key,
+                           const std::shared_ptr<gfx::texture>& tex,
+                           const gfx::texture_info& full_info)
+{
+    if(!tex || !tex->is_valid() || tex->skipped_mips == 0)
+    {
+        return;
+    }
+
+    entry e;
+    e.key = key;
+    e.texture = tex;
+    e.full = full_info;
+    e.min_skip = tex->skipped_mips;
+    e.skip = tex->skipped_mips;
+    e.wanted = tex->skipped_mips;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[tex.get()] = std::move(e);
+}
+
+void texture_streamer::record_usage(const gfx::texture* tex, float texels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(tex);
+    if(it != entries_.end())
+    {
+        it->second.texels = std::max(it->second.texels, texels);
+    }
+}
+
+void texture_streamer::update(uint32_t frame, tpp::thread_pool& pool)
+{
+    struct reload_request
+    {
+        std::weak_ptr<gfx::texture> texture;
+        std::string key;
+        uint64_t flags{};
+        uint8_t skip{};
+    };
+
+    std::vector<reload_result> completed;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex_);
+        completed.swap(completed_);
+    }
+
+    std::vector<reload_request> reloads;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Finished reloads swap in first, holders see the new mips from this frame on.
+        for(auto& result : completed)
+        {
+            auto tex = result.texture.lock();
+            if(!tex)
+            {
+                continue;
+            }
+
+            auto it = entries_.find(tex.get());
+            if(it == entries_.end())
+            {
+                continue;
+            }
+
+            auto& e = it->second;
+            e.loading = false;
+            if(result.loaded && result.loaded->is_valid())
+            {
+                tex->replace(*result.loaded);
+                e.skip = result.skip;
+            }
+            else
+            {
+                // Not retried until the wanted mip changes again.
+                APPLOG_WARNING("Failed to stream {} at mip {}", result.key, result.skip);
+                e.wanted = e.skip;
+            }
+        }
+
+        std::vector<entry*> alive;
+        alive.reserve(entries_.size());
+
+        size_t in_flight = 0;
+        uint64_t wanted_bytes = 0;
+        for(auto it = entries_.begin(); it != entries_.end();)
+        {
+            auto& e = it->second;
+            if(e.texture.expired())
+            {
+                it = entries_.erase(it);
+                continue;
+            }
+
+            if(e.texels > 0.0f)
+            {
+                e.last_used = frame;
+
+                // Grow right away, shrink only when two mips are too large to avoid flip flopping.
+                auto needed = get_skip_for(e, e.texels);
+                e.wanted = (needed < e.skip || needed > e.skip + 1) ? needed : e.skip;
+            }
+            else if(frame - e.last_used > settings_.eviction_frames)
+            {
+                e.wanted = e.min_skip;
+            }
+            else
+            {
+                e.wanted = e.skip;
+            }
+
+            in_flight += e.loading ? 1 : 0;
+            e.texels = 0.0f;
+            e.evicted = false;
+            wanted_bytes += get_storage_size(e.full, e.wanted);
+            alive.emplace_back(&e);
+            ++it;
+        }
+
+        // Over budget the least recently drawn textures give up their mips first.
+        if(wanted_bytes > settings_.budget)
+        {
+            std::sort(alive.begin(),
+                      alive.end(),
+                      [](const entry* lhs, const entry* rhs)
+                      {
+                          // A fixed order among equally old textures keeps the same ones evicted every frame.
+                          if(lhs->last_used != rhs->last_used)
+                          {
+                              return lhs->last_used < rhs->last_used;
+                          }
+                          return lhs->key < rhs->key;
+                      });
+
+            for(auto* e : alive)
+            {
+                while(wanted_bytes > settings_.budget && e->wanted < e->min_skip)
+                {
+                    wanted_bytes -= get_storage_size(e->full, e->wanted) - get_storage_size(e->full, e->wanted + 1);
+                    e->wanted++;
+                    e->evicted = true;
+                }
+
+                if(wanted_bytes <= settings_.budget)
+                {
+                    break;
+                }
+            }
+        }
+
+        // Downgrades first so their memory is free before anything grows, then the most recently drawn.
+        std::sort(alive.begin(),
+                  alive.end(),
+                  [](const entry* lhs, const entry* rhs)
+                  {
+                      bool lhs_down = lhs->wanted > lhs->skip;
+                      bool rhs_down = rhs->wanted > rhs->skip;
+                      if(lhs_down != rhs_down)
+                      {
+                          return lhs_down;
+                      }
+                      return lhs->last_used > rhs->last_used;
+                  });
+
+        stats_.textures = alive.size();
+        stats_.fully_resident = 0;
+        stats_.pending = 0;
+        stats_.resident_bytes = 0;
+        stats_.wanted_bytes = wanted_bytes;
+        stats_.full_bytes = 0;
+        stats_.budget = settings_.budget;
+
+        for(auto* e : alive)
+        {
+            if(e->loading)
+            {
+                stats_.pending++;
+            }
+            else if(e->wanted != e->skip)
+            {
+                if(in_flight < settings_.max_reloads_in_flight)
+                {
+                    auto tex = e->texture.lock();
+                    reloads.push_back({tex, e->key, tex->flags, e->wanted});
+                    e->loading = true;
+                    in_flight++;
+
+                    if(e->wanted > e->skip)
+                    {
+                        stats_.downgrades++;
+                        stats_.evictions += e->evicted ? 1 : 0;
+                    }
+                    else
+                    {
+                        stats_.upgrades++;
+                    }
+                }
+                stats_.pending++;
+            }
+
+            stats_.fully_resident += e->skip == 0 ? 1 : 0;
+            stats_.resident_bytes += get_storage_size(e->full, e->skip);
+            stats_.full_bytes += get_storage_size(e->full, 0);
+        }
+    }
+
+    // Reads and decodes happen on the pool, the result waits for the next update to be swapped in.
+    for(auto& request : reloads)
+    {
+        pool.schedule(
+            [this, request = std::move(request)]()
+            {
+                reload_result result;
+                result.texture = request.texture;
+                result.key = request.key;
+                result.skip = request.skip;
+
+                auto view = fs::open_view(request.key);
+                if(!view.empty())
+                {
+                    result.loaded = std::make_shared<gfx::texture>(request.key.c_str(),
+                                                                   view.data,
+                                                                   uint32_t(view.size),
+                                                                   request.flags,
+                                                                   request.skip);
+                }
+
+                std::lock_guard<std::mutex> lock(completed_mutex_);
+                completed_.emplace_back(std::move(result));
+            });
+    }
+}
+
+auto texture_streamer::get_stats() const -> stats
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+auto get_texture_streamer() -> texture_streamer&
+{
+    static texture_streamer streamer;
+    return streamer;
+}
+
+} // namespace ace
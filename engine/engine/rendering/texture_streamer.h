@@ -0,0 +1,162 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <graphics/texture.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tpp
+{
+class thread_pool;
+}
+
+namespace ace
+{
+
+/**
+ * @class texture_streamer
+ * @brief Keeps only the mips of streamed textures resident that are actually visible.
+ *
+ * Only material textures are streamed, see material_scope. They are first loaded with their
+ * top mips skipped, so the largest resident mip is at most settings::initial_size. The G-buffer
+ * pass records how many texels of each texture end up on screen and once per frame the streamer
+ * picks the mip that matches. Textures that were not drawn for a while fall back to their initial
+ * mips, and while the resident size is over budget the least recently drawn textures give up mips
+ * first. Reloads are read and decoded on the thread pool, only the handle swap happens in update.
+ */
+class texture_streamer
+{
+public:
+    /**
+     * @struct settings
+     * @brief Streaming limits.
+     */
+    struct settings
+    {
+        uint64_t budget{512ull << 20};     ///< Bytes of texture memory streamed textures may use.
+        uint32_t initial_size{128};        ///< Largest dimension of the top mip loaded up front.
+        uint32_t eviction_frames{300};     ///< Frames without a draw before a texture drops to its initial mips.
+        uint32_t max_reloads_in_flight{4}; ///< Reloads read and decoded on the thread pool at the same time.
+    };
+
+    /**
+     * @class material_scope
+     * @brief Textures first requested on this thread while a scope is alive are streamed.
+     *
+     * Materials load their maps inside a scope. Any other texture, e.g. lookup tables, icons or
+     * UI images, is loaded with all of its mips since nothing records its usage.
+     */
+    class material_scope
+    {
+    public:
+        material_scope();
+        ~material_scope();
+
+        material_scope(const material_scope&) = delete;
+        auto operator=(const material_scope&) -> material_scope& = delete;
+
+        static auto is_active() -> bool;
+    };
+
+    /**
+     * @struct stats
+     * @brief Residency at the last update and counters since startup.
+     */
+    struct stats
+    {
+        size_t textures{};         ///< Streamed textures alive.
+        size_t fully_resident{};   ///< Textures with all of their mips resident.
+        size_t pending{};          ///< Textures waiting for a reload.
+        uint64_t resident_bytes{}; ///< Memory of the resident mips.
+        uint64_t wanted_bytes{};   ///< Memory once the pending reloads are done.
+        uint64_t full_bytes{};     ///< Memory if every texture had all of its mips resident.
+        uint64_t budget{};
+
+        uint64_t upgrades{};
+        uint64_t downgrades{};
+        uint64_t evictions{}; ///< Downgrades forced by the budget.
+    };
+
+    void set_settings(const settings& s);
+    auto get_settings() const -> settings;
+
+    /**
+     * @brief Gets how many top mips to skip when first loading a texture.
+     * @param info The info of the full mip chain, see gfx::parse_texture_info.
+     * @return 0 for textures that are not streamed.
+     */
+    auto get_initial_skip(const gfx::texture_info& info) const -> uint8_t;
+
+    /**
+     * @brief Starts streaming a texture. Thread safe.
+     * @param key The protocol path the mips are reloaded from.
+     * @param tex The texture, loaded with get_initial_skip mips skipped.
+     * @param full_info The info of the full mip chain.
+     */
+    void add(const std::string& key, const std::shared_ptr<gfx::texture>& tex, const gfx::texture_info& full_info);
+
+    /**
+     * @brief Records a draw of a texture. Textures that are not streamed are ignored.
+     * @param tex The texture.
+     * @param texels Roughly how many texels the draw needs along the larger axis of the texture.
+     */
+    void record_usage(const gfx::texture* tex, float texels);
+
+    /**
+     * @brief Swaps in the reloads finished since the last call, picks the wanted mips of every
+     * texture, applies the budget and queues a bounded number of reloads. Main thread only, once
+     * per frame.
+     * @param frame The current render frame.
+     * @param pool Reads and decodes the reloads.
+     */
+    void update(uint32_t frame, tpp::thread_pool& pool);
+
+    auto get_stats() const -> stats;
+
+private:
+    struct entry
+    {
+        std::string key;
+        std::weak_ptr<gfx::texture> texture;
+        gfx::texture_info full{};
+        uint8_t min_skip{}; ///< Skip of the initial load, the least that stays resident.
+        uint8_t skip{};     ///< Skip of the resident mips.
+        uint8_t wanted{};
+        bool evicted{};
+        float texels{}; ///< Largest usage since the last update.
+        uint32_t last_used{};
+        bool loading{}; ///< A reload is being decoded.
+    };
+
+    struct reload_result
+    {
+        std::weak_ptr<gfx::texture> texture;
+        std::shared_ptr<gfx::texture> loaded; ///< Empty if the reload failed.
+        std::string key;
+        uint8_t skip{};
+    };
+
+    static auto get_storage_size(const gfx::texture_info& full, uint8_t skip) -> uint64_t;
+    static auto get_skip_for(const entry& e, float texels) -> uint8_t;
+
+    mutable std::mutex mutex_;
+    settings settings_;
+    std::unordered_map<const gfx::texture*, entry> entries_;
+    stats stats_;
+
+    /// Reloads decoded on the thread pool, waiting for the next update.
+    std::mutex completed_mutex_;
+    std::vector<reload_result> completed_;
+};
+
+/**
+ * @brief Gets the texture streamer shared by the asset loaders and the renderer.
+ */
+auto get_texture_streamer() -> texture_streamer&;
+
+} // namespace ace
@@ -6,6 +6,7 @@
 #include <engine/meta/ecs/entity.hpp>
 #include <engine/scripting/ecs/components/script_component.h>
 #include <engine/scripting/script.h>
+#include <engine/threading/threader.h>
 
 #include <monopp/mono_exception.h>
 #include <monopp/mono_field_invoker.h>
@@ -21,8 +21,42 @@ struct settings
 
     struct graphics_settings
     {
+        /// Texture memory in megabytes that streamed textures may use.
+        uint32_t texture_streaming_budget{512};
+        /// Largest dimension of the top mip textures are first loaded with.
+        uint32_t texture_streaming_initial_size{128};
+        /// Whether cameras cull models in batches against a flat bounds buffer instead of walking the scene hierarchy.
+        bool batched_culling{false};
+        /// Memory in megabytes that shadow maps of all lights may use together.
+        uint32_t shadow_atlas_budget{768};
+        /// Smallest size a shadow map is shrunk to when the budget runs out.
+        uint32_t shadow_map_min_size{256};
+        /// Largest size a light may request for its shadow map.
+        uint32_t shadow_map_max_size{4096};
     } graphics;
 
+    struct animation_settings
+    {
+        /// Rate clips are resampled at when they are compiled, in samples per second.
+        float compression_sample_rate{30.0f};
+        /// Largest position error compressing a clip may introduce.
+        float compression_position_tolerance{0.001f};
+        /// Largest rotation error compressing a clip may introduce, in radians.
+        float compression_rotation_tolerance{0.001f};
+        /// Largest scaling error compressing a clip may introduce.
+        float compression_scaling_tolerance{0.001f};
+        /// Whether characters small on screen update their animation less.
+        bool lod_enabled{true};
+        /// Screen height fraction below which characters are sampled every lod_reduced_interval frames.
+        float lod_reduced_size{0.2f};
+        /// Screen height fraction below which characters are sampled every lod_minimal_interval frames.
+        float lod_minimal_size{0.05f};
+        /// Screen height fraction below which renderer based characters stop updating.
+        float lod_frozen_size{0.01f};
+        uint32_t lod_reduced_interval{2};
+        uint32_t lod_minimal_interval{4};
+    } animation;
+
     struct standalone_settings
     {
         asset_handle<scene_prefab> startup_scene;
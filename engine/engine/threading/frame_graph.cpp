@@ -0,0 +1,456 @@
+#include "frame_graph.h"
+#include "job_system.h"
+
+#include <engine/profiler/profiler.h>
+#include <logging/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace ace
+{
+namespace
+{
+auto contains_any(const std::vector<entt::id_type>& lhs, const std::vector<entt::id_type>& rhs) -> bool
+{
+    for(auto type : lhs)
+    {
+        if(std::find(rhs.begin(), rhs.end(), type) != rhs.end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto elapsed_ms(std::chrono::steady_clock::time_point since) -> double
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+} // namespace
+
+frame_graph::task_builder::task_builder(frame_graph& graph, size_t index) : graph_(graph), index_(index)
+{
+}
+
+auto frame_graph::task_builder::after(const char* name) -> task_builder&
+{
+    graph_.tasks_[index_].after.emplace_back(name);
+    return *this;
+}
+
+auto frame_graph::task_builder::exclusive() -> task_builder&
+{
+    graph_.tasks_[index_].exclusive = true;
+    return *this;
+}
+
+auto frame_graph::task_builder::on_main_thread() -> task_builder&
+{
+    graph_.tasks_[index_].main_thread = true;
+    return *this;
+}
+
+frame_graph::frame_graph(const char* name) : name_(name)
+{
+}
+
+auto frame_graph::add(const char* name, task_func func) -> task_builder
+{
+    task t;
+    t.name = name;
+    t.func = std::move(func);
+    tasks_.emplace_back(std::move(t));
+
+    compiled_ = false;
+    return task_builder(*this, tasks_.size() - 1);
+}
+
+void frame_graph::remove(const char* name)
+{
+    tasks_.erase(std::remove_if(tasks_.begin(),
+                                tasks_.end(),
+                                [&](const task& t)
+                                {
+                                    return std::strcmp(t.name, name) == 0;
+                                }),
+                 tasks_.end());
+
+    compiled_ = false;
+}
+
+void frame_graph::clear()
+{
+    tasks_.clear();
+    compiled_ = false;
+}
+
+void frame_graph::add_access(size_t index, entt::id_type type, bool write)
+{
+    auto& t = tasks_[index];
+    auto& types = write ? t.writes : t.reads;
+    if(std::find(types.begin(), types.end(), type) == types.end())
+    {
+        types.emplace_back(type);
+    }
+
+    compiled_ = false;
+}
+
+auto frame_graph::conflicts(const task& lhs, const task& rhs) -> bool
+{
+    if(lhs.exclusive || rhs.exclusive)
+    {
+        return true;
+    }
+
+    return contains_any(lhs.writes, rhs.writes) || contains_any(lhs.writes, rhs.reads) ||
+           contains_any(lhs.reads, rhs.writes);
+}
+
+void frame_graph::compile()
+{
+    if(compiled_)
+    {
+        return;
+    }
+    compiled_ = true;
+
+    const auto count = tasks_.size();
+    successors_.assign(count, {});
+    predecessors_.assign(count, {});
+
+    std::vector<uint8_t> edges(count * count, 0);
+    auto add_edge = [&](size_t from, size_t to)
+    {
+        if(from != to && !edges[from * count + to])
+        {
+            edges[from * count + to] = 1;
+            successors_[from].emplace_back(to);
+            predecessors_[to].emplace_back(from);
+        }
+    };
+
+    for(size_t to = 0; to < count; ++to)
+    {
+        for(size_t from = 0; from < to; ++from)
+        {
+            if(conflicts(tasks_[from], tasks_[to]))
+            {
+                add_edge(from, to);
+            }
+        }
+
+        for(const auto* name : tasks_[to].after)
+        {
+            auto it = std::find_if(tasks_.begin(),
+                                   tasks_.end(),
+                                   [&](const task& t)
+                                   {
+                                       return std::strcmp(t.name, name) == 0;
+                                   });
+            if(it == tasks_.end())
+            {
+                APPLOG_WARNING("{}: {} runs after unknown task {}", name_, tasks_[to].name, name);
+                continue;
+            }
+            add_edge(size_t(it - tasks_.begin()), to);
+        }
+    }
+
+    // Kahn's algorithm, picking the earliest added task first keeps the order stable.
+    order_.clear();
+    order_.reserve(count);
+    std::vector<size_t> pending(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        pending[i] = predecessors_[i].size();
+    }
+
+    std::vector<bool> done(count, false);
+    while(order_.size() < count)
+    {
+        size_t next = count;
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(!done[i] && pending[i] == 0)
+            {
+                next = i;
+                break;
+            }
+        }
+
+        if(next == count)
+        {
+            break;
+        }
+
+        done[next] = true;
+        order_.emplace_back(next);
+        for(auto succ : successors_[next])
+        {
+            pending[succ]--;
+        }
+    }
+
+    serial_ = order_.size() < count;
+    if(serial_)
+    {
+        APPLOG_ERROR("{}: the task ordering has a cycle, running the tasks in the order they were added", name_);
+
+        order_.clear();
+        for(size_t i = 0; i < count; ++i)
+        {
+            order_.emplace_back(i);
+        }
+    }
+}
+
+void frame_graph::run_task(rtti::context& ctx, delta_t dt, size_t index, job_system* jobs)
+{
+    auto& t = tasks_[index];
+
+    // Every task writes only its own timing, no lock needed.
+    auto& timing = schedule_.tasks[index];
+    timing.thread = jobs ? jobs->get_thread_index() : 0;
+    timing.start_ms = elapsed_ms(start_);
+    {
+        const scope_perf_timer timer(t.name, get_app_profiler());
+        t.func(ctx, dt);
+    }
+    timing.end_ms = elapsed_ms(start_);
+}
+
+void frame_graph::run(rtti::context& ctx, delta_t dt, job_system* jobs)
+{
+    compile();
+
+    const auto count = tasks_.size();
+
+    start_ = std::chrono::steady_clock::now();
+    schedule_.tasks.resize(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto& timing = schedule_.tasks[i];
+        timing = {};
+        timing.name = tasks_[i].name;
+        timing.on_main_thread = tasks_[i].main_thread;
+        timing.after = predecessors_[i];
+    }
+    schedule_.threads = jobs ? jobs->get_thread_count() : 1;
+
+    if(!jobs || !jobs->is_running() || jobs->get_thread_count() <= 1 || serial_)
+    {
+        for(auto index : order_)
+        {
+            run_task(ctx, dt, index, jobs);
+        }
+
+        finish_schedule();
+        return;
+    }
+
+    auto pending = std::make_unique<std::atomic<size_t>[]>(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        pending[i] = predecessors_[i].size();
+    }
+
+    std::atomic<size_t> remaining{count};
+    std::mutex main_mutex;
+    std::vector<size_t> main_ready;
+    job_system::counter done;
+
+    std::function<void(size_t)> launch;
+    auto complete = [&](size_t index)
+    {
+        for(auto succ : successors_[index])
+        {
+            if(pending[succ].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                launch(succ);
+            }
+        }
+        remaining.fetch_sub(1, std::memory_order_release);
+    };
+
+    launch = [&](size_t index)
+    {
+        if(tasks_[index].main_thread)
+        {
+            std::lock_guard<std::mutex> lock(main_mutex);
+            main_ready.emplace_back(index);
+            return;
+        }
+
+        jobs->schedule(done,
+                       [&, index]()
+                       {
+                           run_task(ctx, dt, index, jobs);
+                           complete(index);
+                       });
+    };
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(predecessors_[i].empty())
+        {
+            launch(i);
+        }
+    }
+
+    // The calling thread runs its own tasks and helps with the others until everything is done.
+    while(remaining.load(std::memory_order_acquire) > 0)
+    {
+        size_t index = count;
+        {
+            std::lock_guard<std::mutex> lock(main_mutex);
+            if(!main_ready.empty())
+            {
+                index = main_ready.back();
+                main_ready.pop_back();
+            }
+        }
+
+        if(index < count)
+        {
+            run_task(ctx, dt, index, jobs);
+            complete(index);
+        }
+        else if(!jobs->run_pending())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last jobs may still be returning from complete.
+    jobs->wait(done);
+
+    finish_schedule();
+}
+
+void frame_graph::finish_schedule()
+{
+    schedule_.total_ms = elapsed_ms(start_);
+
+    const auto count = tasks_.size();
+    if(count == 0)
+    {
+        schedule_.critical_ms = 0.0;
+        return;
+    }
+
+    // Longest chain of dependent tasks by measured time, walked in topological order.
+    std::vector<double> finish(count, 0.0);
+    std::vector<size_t> previous(count, count);
+    for(auto index : order_)
+    {
+        double ready = 0.0;
+        if(!serial_)
+        {
+            for(auto pred : predecessors_[index])
+            {
+                if(finish[pred] > ready)
+                {
+                    ready = finish[pred];
+                    previous[index] = pred;
+                }
+            }
+        }
+        else if(index > 0)
+        {
+            ready = finish[index - 1];
+            previous[index] = index - 1;
+        }
+
+        const auto& timing = schedule_.tasks[index];
+        finish[index] = ready + (timing.end_ms - timing.start_ms);
+    }
+
+    auto last = size_t(std::max_element(finish.begin(), finish.end()) - finish.begin());
+    schedule_.critical_ms = finish[last];
+    for(auto index = last; index < count; index = previous[index])
+    {
+        schedule_.tasks[index].critical = true;
+    }
+}
+
+auto frame_graph::get_name() const -> const char*
+{
+    return name_;
+}
+
+auto frame_graph::get_schedule() const -> const schedule&
+{
+    return schedule_;
+}
+
+auto frame_graph::save_trace(const std::string& path) const -> bool
+{
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if(!out.is_open())
+    {
+        APPLOG_ERROR("Failed to write {} schedule to {}", name_, path);
+        return false;
+    }
+
+    // Thread rows use the job system indices, the critical path gets a row after them.
+    const auto critical_row = schedule_.threads;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for(size_t thread = 0; thread <= critical_row; ++thread)
+    {
+        out << (thread == 0 ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+            << ",\"args\":{\"name\":\"";
+        if(thread == critical_row)
+        {
+            out << "Critical path";
+        }
+        else if(thread + 1 == schedule_.threads)
+        {
+            out << "Main";
+        }
+        else
+        {
+            out << "Worker " << thread;
+        }
+        out << "\"}}";
+    }
+
+    auto write_event = [&](const task_timing& timing, size_t row)
+    {
+        // Timestamps are in microseconds.
+        out << ",\n{\"name\":\"" << timing.name << "\",\"cat\":\"" << name_ << "\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+            << row << ",\"ts\":" << timing.start_ms * 1000.0
+            << ",\"dur\":" << (timing.end_ms - timing.start_ms) * 1000.0;
+        if(timing.critical)
+        {
+            out << ",\"cname\":\"terrible\"";
+        }
+        out << ",\"args\":{\"after\":\"";
+        for(size_t i = 0; i < timing.after.size(); ++i)
+        {
+            out << (i == 0 ? "" : ", ") << schedule_.tasks[timing.after[i]].name;
+        }
+        out << "\"}}";
+    };
+
+    for(const auto& timing : schedule_.tasks)
+    {
+        write_event(timing, timing.thread);
+        if(timing.critical)
+        {
+            write_event(timing, critical_row);
+        }
+    }
+
+    out << "]}\n";
+
+    APPLOG_INFO("{} schedule of {} tasks written to {}", name_, schedule_.tasks.size(), path);
+    return true;
+}
+
+} // namespace ace
@@ -0,0 +1,180 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <base/basetypes.hpp>
+#include <context/context.hpp>
+#include <entt/core/type_info.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ace
+{
+class job_system;
+
+/**
+ * @class frame_graph
+ * @brief Runs the systems of a frame as a dependency graph instead of one after another.
+ *
+ * Tasks declare the components and resources they read and write. A task depends on every
+ * task added before it that it conflicts with, two writers or a reader and a writer of the
+ * same type, so the results match running them in the order they were added. Explicit
+ * ordering is added with after(). Independent tasks run concurrently on the job system,
+ * tasks that must stay on the calling thread are marked with on_main_thread().
+ *
+ * Every run records when and where each task ran and the longest chain of dependent tasks,
+ * the critical path, which can be written as a Chrome trace.
+ */
+class frame_graph
+{
+public:
+    using task_func = std::function<void(rtti::context& ctx, delta_t dt)>;
+
+    /**
+     * @struct task_timing
+     * @brief When and where a task ran during the last run.
+     */
+    struct task_timing
+    {
+        const char* name{};
+        size_t thread{};           ///< Job system thread index, see job_system::get_thread_index.
+        double start_ms{};         ///< Since the start of the run.
+        double end_ms{};           ///< Since the start of the run.
+        bool on_main_thread{};
+        bool critical{};           ///< Part of the critical path.
+        std::vector<size_t> after; ///< Indices of the tasks it waited for.
+    };
+
+    /**
+     * @struct schedule
+     * @brief The last run of the graph.
+     */
+    struct schedule
+    {
+        std::vector<task_timing> tasks; ///< In the order they were added.
+        double total_ms{};
+        double critical_ms{}; ///< Time of the critical path, the least the run could take with enough threads.
+        size_t threads{};
+    };
+
+    /**
+     * @class task_builder
+     * @brief Declares what a task accesses, returned by add.
+     */
+    class task_builder
+    {
+    public:
+        template<typename... Ts>
+        auto reads() -> task_builder&
+        {
+            (graph_.add_access(index_, entt::type_hash<Ts>::value(), false), ...);
+            return *this;
+        }
+
+        template<typename... Ts>
+        auto writes() -> task_builder&
+        {
+            (graph_.add_access(index_, entt::type_hash<Ts>::value(), true), ...);
+            return *this;
+        }
+
+        /**
+         * @brief Runs the task after another one, even if they do not conflict.
+         */
+        auto after(const char* name) -> task_builder&;
+
+        /**
+         * @brief Conflicts with every other task, for tasks that can touch anything, such as scripts.
+         */
+        auto exclusive() -> task_builder&;
+
+        /**
+         * @brief Runs the task on the thread that runs the graph.
+         */
+        auto on_main_thread() -> task_builder&;
+
+    private:
+        friend class frame_graph;
+        task_builder(frame_graph& graph, size_t index);
+
+        frame_graph& graph_;
+        size_t index_{};
+    };
+
+    /**
+     * @brief Constructs a graph.
+     * @param name Static string, used in traces.
+     */
+    frame_graph(const char* name);
+
+    /**
+     * @brief Adds a task.
+     * @param name Static string, also the profiler scope of the task.
+     * @param func The work.
+     */
+    auto add(const char* name, task_func func) -> task_builder;
+
+    /**
+     * @brief Removes the tasks with a name.
+     */
+    void remove(const char* name);
+
+    /**
+     * @brief Removes all tasks.
+     */
+    void clear();
+
+    /**
+     * @brief Runs every task once and returns when all are done.
+     * @param ctx The context passed to the tasks.
+     * @param dt The delta time passed to the tasks.
+     * @param jobs Job system to run independent tasks on. When null the tasks run on the calling thread.
+     */
+    void run(rtti::context& ctx, delta_t dt, job_system* jobs);
+
+    auto get_name() const -> const char*;
+    auto get_schedule() const -> const schedule&;
+
+    /**
+     * @brief Writes the last schedule as Chrome trace event json, with the critical path on a row of its own.
+     * @param path The output file.
+     * @return True on success.
+     */
+    auto save_trace(const std::string& path) const -> bool;
+
+private:
+    struct task
+    {
+        const char* name{};
+        task_func func;
+        std::vector<entt::id_type> reads;
+        std::vector<entt::id_type> writes;
+        std::vector<const char*> after;
+        bool exclusive{};
+        bool main_thread{};
+    };
+
+    static auto conflicts(const task& lhs, const task& rhs) -> bool;
+
+    void add_access(size_t index, entt::id_type type, bool write);
+    void compile();
+    void run_task(rtti::context& ctx, delta_t dt, size_t index, job_system* jobs);
+    void finish_schedule();
+
+    const char* name_{};
+    std::vector<task> tasks_;
+
+    bool compiled_{};
+    bool serial_{}; ///< The explicit ordering has a cycle, tasks run in the order they were added.
+    std::vector<std::vector<size_t>> successors_;
+    std::vector<std::vector<size_t>> predecessors_;
+    std::vector<size_t> order_; ///< A topological order.
+
+    std::chrono::steady_clock::time_point start_{};
+    schedule schedule_;
+};
+
+} // namespace ace
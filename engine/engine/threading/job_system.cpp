@@ -0,0 +1,322 @@
+#include "job_system.h"
+
+#include <base/platform/thread.hpp>
+
+#include <string>
+
+namespace ace
+{
+
+namespace
+{
+struct thread_identity
+{
+    const job_system* owner{};
+    size_t index{};
+};
+
+thread_local thread_identity this_thread_identity{};
+// Jobs run while waiting inside another job, their time is already part of the outer one.
+thread_local size_t this_thread_job_depth{};
+
+// Tries before an idle worker goes to sleep, jobs of a parallel loop tend to arrive in bursts.
+constexpr size_t idle_spins = 64;
+} // namespace
+
+job_system::job_system()
+{
+    threads_.emplace_back(std::make_unique<thread_data>());
+}
+
+job_system::~job_system()
+{
+    deinit();
+}
+
+void job_system::init(const settings& s)
+{
+    deinit();
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t workers = s.workers > 0 ? s.workers : cores - 1;
+
+    threads_.clear();
+    for(size_t i = 0; i < workers + 1; ++i)
+    {
+        threads_.emplace_back(std::make_unique<thread_data>());
+    }
+
+    running_ = true;
+    for(size_t i = 0; i < workers; ++i)
+    {
+        workers_.emplace_back(
+            [this, i]()
+            {
+                worker_main(i);
+            });
+
+        if(s.pin_threads)
+        {
+            platform::set_thread_affinity(workers_.back(), (i + 1) % cores);
+        }
+    }
+}
+
+void job_system::deinit()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+
+    for(auto& worker : workers_)
+    {
+        worker.join();
+    }
+    workers_.clear();
+
+    // Jobs still queued belong to counters someone is waiting on.
+    const auto external = threads_.size() - 1;
+    while(try_run_one(external))
+    {
+    }
+}
+
+auto job_system::is_running() const noexcept -> bool
+{
+    return running_.load(std::memory_order_acquire);
+}
+
+auto job_system::get_thread_count() const noexcept -> size_t
+{
+    return workers_.size() + 1;
+}
+
+auto job_system::get_thread_index() const noexcept -> size_t
+{
+    if(this_thread_identity.owner == this)
+    {
+        return this_thread_identity.index;
+    }
+    return threads_.size() - 1;
+}
+
+auto job_system::get_auto_grain(size_t count) const noexcept -> size_t
+{
+    // A few ranges per thread so threads that finish early can steal the rest.
+    const auto ranges = get_thread_count() * 4;
+    return std::max<size_t>(1, (count + ranges - 1) / ranges);
+}
+
+void job_system::schedule(counter& c, std::function<void()> func)
+{
+    if(!is_running())
+    {
+        func();
+        return;
+    }
+
+    c.pending_.fetch_add(1, std::memory_order_relaxed);
+
+    auto& data = *threads_[get_thread_index()];
+    {
+        std::lock_guard<std::mutex> lock(data.mutex);
+        data.jobs.push_back({std::move(func), &c});
+    }
+
+    queued_.fetch_add(1);
+    if(sleeping_.load() > 0)
+    {
+        // Taking the lock orders the push before a worker that is about to sleep checks the queue.
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+}
+
+void job_system::wait(counter& c)
+{
+    const auto self = get_thread_index();
+    while(!c.is_done())
+    {
+        if(try_run_one(self))
+        {
+            helped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+auto job_system::run_pending() -> bool
+{
+    if(try_run_one(get_thread_index()))
+    {
+        helped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+auto job_system::pop(size_t self, job& out, bool& stolen) -> bool
+{
+    const auto count = threads_.size();
+    const auto external = count - 1;
+
+    auto take = [&](size_t index, bool newest) -> bool
+    {
+        auto& data = *threads_[index];
+        std::lock_guard<std::mutex> lock(data.mutex);
+        if(data.jobs.empty())
+        {
+            return false;
+        }
+
+        if(newest)
+        {
+            out = std::move(data.jobs.back());
+            data.jobs.pop_back();
+        }
+        else
+        {
+            out = std::move(data.jobs.front());
+            data.jobs.pop_front();
+        }
+        return true;
+    };
+
+    // Own jobs first, a worker takes its newest since their data is most likely still in cache.
+    stolen = false;
+    if(take(self, self != external))
+    {
+        return true;
+    }
+
+    if(self != external && take(external, false))
+    {
+        return true;
+    }
+
+    stolen = true;
+    for(size_t i = 1; i < count; ++i)
+    {
+        const auto victim = (self + i) % count;
+        if(victim != external && take(victim, false))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto job_system::try_run_one(size_t self) -> bool
+{
+    if(queued_.load(std::memory_order_relaxed) == 0)
+    {
+        return false;
+    }
+
+    job j;
+    bool stolen = false;
+    if(!pop(self, j, stolen))
+    {
+        return false;
+    }
+
+    queued_.fetch_sub(1);
+    run(j, self, stolen);
+    return true;
+}
+
+void job_system::run(job& j, size_t self, bool stolen)
+{
+    const auto start = clock_t::now();
+    this_thread_job_depth++;
+    j.func();
+    this_thread_job_depth--;
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start);
+
+    auto& data = *threads_[self];
+    data.executed.fetch_add(1, std::memory_order_relaxed);
+    data.stolen.fetch_add(stolen ? 1 : 0, std::memory_order_relaxed);
+    if(this_thread_job_depth == 0)
+    {
+        data.busy_ns.fetch_add(uint64_t(duration.count()), std::memory_order_relaxed);
+    }
+
+    j.done->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void job_system::worker_main(size_t index)
+{
+    this_thread_identity = {this, index};
+    platform::set_thread_name(("job_worker_" + std::to_string(index)).c_str());
+
+    while(is_running())
+    {
+        bool found = false;
+        for(size_t spin = 0; spin < idle_spins && !found; ++spin)
+        {
+            found = try_run_one(index);
+            if(!found)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if(found)
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleeping_.fetch_add(1);
+        wake_.wait(lock,
+                   [this]()
+                   {
+                       return !running_.load() || queued_.load() > 0;
+                   });
+        sleeping_.fetch_sub(1);
+    }
+}
+
+void job_system::end_frame()
+{
+    const auto now = clock_t::now();
+
+    frame_stats stats;
+    stats.threads.reserve(threads_.size());
+    for(auto& data : threads_)
+    {
+        thread_stats thread;
+        thread.jobs = data->executed.exchange(0, std::memory_order_relaxed);
+        thread.stolen = data->stolen.exchange(0, std::memory_order_relaxed);
+        thread.busy_ms = double(data->busy_ns.exchange(0, std::memory_order_relaxed)) / 1000000.0;
+
+        stats.jobs += thread.jobs;
+        stats.stolen += thread.stolen;
+        stats.busy_ms += thread.busy_ms;
+        stats.threads.emplace_back(thread);
+    }
+
+    stats.helped = helped_.exchange(0, std::memory_order_relaxed);
+    stats.parallel_fors = parallel_fors_.exchange(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats.frame_ms = std::chrono::duration<double, std::milli>(now - frame_start_).count();
+    frame_start_ = now;
+    last_frame_ = std::move(stats);
+}
+
+auto job_system::get_frame_stats() const -> frame_stats
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_frame_;
+}
+
+} // namespace ace
@@ -0,0 +1,292 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class job_system
+ * @brief Work stealing scheduler for the short, data parallel work of a frame.
+ *
+ * Every worker owns a queue it pushes to and pops from at the back, idle workers steal from the
+ * front of the others. Threads that are not workers, like the main thread, share one extra
+ * queue. Waiting on a counter does not block the thread, it keeps running queued jobs until the
+ * counter drops to zero, so parallel loops can nest inside jobs without starving the pool.
+ */
+class job_system
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /**
+     * @struct settings
+     * @brief Worker setup.
+     */
+    struct settings
+    {
+        size_t workers{};   ///< Worker threads, 0 for one per core besides the calling thread.
+        bool pin_threads{}; ///< Pins worker i to core i + 1, leaving core 0 to the main thread.
+    };
+
+    /**
+     * @struct thread_stats
+     * @brief What one thread did during a frame.
+     */
+    struct thread_stats
+    {
+        uint64_t jobs{};   ///< Jobs run.
+        uint64_t stolen{}; ///< Jobs taken from the queue of another thread.
+        double busy_ms{};  ///< Time spent running jobs.
+    };
+
+    /**
+     * @struct frame_stats
+     * @brief Totals of the last finished frame.
+     */
+    struct frame_stats
+    {
+        uint64_t jobs{};
+        uint64_t stolen{};
+        uint64_t helped{};        ///< Jobs run by threads while waiting on a counter.
+        uint64_t parallel_fors{}; ///< Loops that were split into jobs.
+        double busy_ms{};
+        double frame_ms{};
+        std::vector<thread_stats> threads; ///< One per worker, the last one is shared by all other threads.
+    };
+
+    /**
+     * @class counter
+     * @brief Counts the unfinished jobs of a batch. Must outlive the jobs scheduled with it.
+     */
+    class counter
+    {
+    public:
+        auto is_done() const noexcept -> bool
+        {
+            return pending_.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class job_system;
+        std::atomic<uint32_t> pending_{0};
+    };
+
+    job_system();
+    ~job_system();
+
+    job_system(const job_system&) = delete;
+    auto operator=(const job_system&) -> job_system& = delete;
+
+    /**
+     * @brief Starts the worker threads.
+     */
+    void init(const settings& s);
+
+    /**
+     * @brief Runs what is still queued and joins the worker threads.
+     */
+    void deinit();
+
+    auto is_running() const noexcept -> bool;
+
+    /**
+     * @brief Gets the number of threads that take part in a parallel loop, the workers and the caller.
+     */
+    auto get_thread_count() const noexcept -> size_t;
+
+    /**
+     * @brief Gets the index of the calling thread, workers first. Threads that are not workers share the last one.
+     */
+    auto get_thread_index() const noexcept -> size_t;
+
+    /**
+     * @brief Queues a job. Without workers the job runs right away.
+     */
+    void schedule(counter& c, std::function<void()> job);
+
+    /**
+     * @brief Runs queued jobs on the calling thread until every job of the counter is done.
+     */
+    void wait(counter& c);
+
+    /**
+     * @brief Runs one queued job on the calling thread, for callers that wait on something else than a counter.
+     * @return False when nothing was queued.
+     */
+    auto run_pending() -> bool;
+
+    /**
+     * @brief Calls body(begin, end) for consecutive ranges covering [0, count), in parallel.
+     * @param count The number of elements.
+     * @param grain Elements per range, 0 to split evenly over the threads.
+     * @param body Called once per range, the calling thread takes the first one.
+     */
+    template<typename F>
+    void parallel_for(size_t count, size_t grain, F&& body);
+
+    /**
+     * @brief Calls func(element) for every element of a random access range, in parallel.
+     */
+    template<typename It, typename F>
+    void parallel_for_each(It first, It last, F&& func);
+
+    /**
+     * @brief Sorts one run per thread and merges neighbouring runs. Not stable.
+     */
+    template<typename It, typename Compare>
+    void parallel_sort(It first, It last, Compare comp);
+
+    /**
+     * @brief Closes the stats of the current frame. Called once per frame by the threader.
+     */
+    void end_frame();
+
+    auto get_frame_stats() const -> frame_stats;
+
+private:
+    struct job
+    {
+        std::function<void()> func;
+        counter* done{};
+    };
+
+    struct alignas(64) thread_data
+    {
+        std::mutex mutex;
+        std::deque<job> jobs;
+
+        std::atomic<uint64_t> executed{};
+        std::atomic<uint64_t> stolen{};
+        std::atomic<uint64_t> busy_ns{};
+    };
+
+    auto get_auto_grain(size_t count) const noexcept -> size_t;
+    auto pop(size_t self, job& out, bool& stolen) -> bool;
+    auto try_run_one(size_t self) -> bool;
+    void run(job& j, size_t self, bool stolen);
+    void worker_main(size_t index);
+
+    std::vector<std::unique_ptr<thread_data>> threads_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    std::atomic<uint64_t> helped_{0};
+    std::atomic<uint64_t> parallel_fors_{0};
+
+    mutable std::mutex stats_mutex_;
+    frame_stats last_frame_;
+    clock_t::time_point frame_start_{clock_t::now()};
+};
+
+template<typename F>
+void job_system::parallel_for(size_t count, size_t grain, F&& body)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    grain = grain > 0 ? grain : get_auto_grain(count);
+    const auto ranges = (count + grain - 1) / grain;
+    if(ranges <= 1 || !is_running() || get_thread_count() <= 1)
+    {
+        body(size_t(0), count);
+        return;
+    }
+
+    parallel_fors_.fetch_add(1, std::memory_order_relaxed);
+
+    counter c;
+    for(size_t r = 1; r < ranges; ++r)
+    {
+        const auto begin = r * grain;
+        const auto end = std::min(count, begin + grain);
+        schedule(c,
+                 [&body, begin, end]()
+                 {
+                     body(begin, end);
+                 });
+    }
+
+    body(size_t(0), std::min(count, grain));
+    wait(c);
+}
+
+template<typename It, typename F>
+void job_system::parallel_for_each(It first, It last, F&& func)
+{
+    parallel_for(size_t(std::distance(first, last)),
+                 0,
+                 [&](size_t begin, size_t end)
+                 {
+                     std::for_each(first + begin, first + end, func);
+                 });
+}
+
+template<typename It, typename Compare>
+void job_system::parallel_sort(It first, It last, Compare comp)
+{
+    // Below this a single std::sort beats the cost of splitting.
+    constexpr size_t min_parallel_count = 4096;
+
+    const auto count = size_t(std::distance(first, last));
+    const auto runs = std::min(get_thread_count(), count / (min_parallel_count / 2));
+    if(count < min_parallel_count || runs <= 1 || !is_running())
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    const auto run_size = (count + runs - 1) / runs;
+    parallel_for(runs,
+                 1,
+                 [&](size_t begin, size_t end)
+                 {
+                     for(auto r = begin; r < end; ++r)
+                     {
+                         std::sort(first + std::min(count, r * run_size),
+                                   first + std::min(count, (r + 1) * run_size),
+                                   comp);
+                     }
+                 });
+
+    for(auto width = run_size; width < count; width *= 2)
+    {
+        const auto merges = (count + 2 * width - 1) / (2 * width);
+        parallel_for(merges,
+                     1,
+                     [&](size_t begin, size_t end)
+                     {
+                         for(auto m = begin; m < end; ++m)
+                         {
+                             const auto lo = m * 2 * width;
+                             const auto mid = std::min(count, lo + width);
+                             const auto hi = std::min(count, lo + 2 * width);
+                             if(mid < hi)
+                             {
+                                 std::inplace_merge(first + lo, first + mid, first + hi, comp);
+                             }
+                         }
+                     });
+    }
+}
+
+} // namespace ace
@@ -3,6 +3,9 @@
 #include <base/platform/thread.hpp>
 #include <logging/logging.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace ace
 {
 threader::threader()
@@ -24,7 +27,20 @@ threader::threader()
 
     tpp::init(data);
 
+    // The pool keeps a thread per core, its tasks mostly wait on disk, subprocesses or the main
+    // thread and the import and decode limits are sized from the core count. The job workers
+    // leave a quarter of the cores besides the main thread to the pool's busy tasks.
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t reserved = (cores - 1) / 4;
+
     pool = std::make_unique<tpp::thread_pool>();
+
+    job_system::settings settings{};
+    settings.workers = std::max<size_t>(cores - 1 - reserved, 1);
+
+    // Started right away, tools and tests create a threader without initing it.
+    jobs = std::make_unique<job_system>();
+    jobs->init(settings);
 }
 
 auto threader::init(rtti::context& ctx) -> bool
@@ -38,6 +54,11 @@ auto threader::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_TRACE("{}::{}", hpp::type_name_str(*this), __func__);
 
+    if(jobs)
+    {
+        jobs.reset();
+    }
+
     if(pool)
     {
         pool.reset();
@@ -50,6 +71,11 @@ auto threader::deinit(rtti::context& ctx) -> bool
 void threader::process()
 {
     tpp::this_thread::process();
+
+    if(jobs)
+    {
+        jobs->end_frame();
+    }
 }
 
 } // namespace ace
@@ -1,6 +1,8 @@
 #pragma once
 #include <engine/engine_export.h>
 
+#include "job_system.h"
+
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
 #include <threadpp/thread_pool.h>
@@ -19,6 +21,9 @@ struct threader
 
     void process();
 
+    ///< Futures and long running tasks, e.g. asset loading and compilation. Shares the cores with jobs.
     std::unique_ptr<tpp::thread_pool> pool{};
+    ///< Short data parallel work of a frame, e.g. systems, culling and render queues.
+    std::unique_ptr<job_system> jobs{};
 };
 } // namespace ace
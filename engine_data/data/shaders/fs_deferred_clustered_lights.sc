@@ -0,0 +1,98 @@
+$input v_texcoord0
+
+#include "common.sh"
+#include "lighting.sh"
+
+SAMPLER2D(s_tex0, 0);
+SAMPLER2D(s_tex1, 1);
+SAMPLER2D(s_tex2, 2);
+SAMPLER2D(s_tex3, 3);
+SAMPLER2D(s_tex4, 4);
+SAMPLER2D(s_tex5, 5); // reflection data
+SAMPLER2D(s_tex6, 6); // ibl_brdf_lut
+
+SAMPLER2D(s_light_data, 7);    // 4 texels per light
+SAMPLER2D(s_light_grid, 8);    // offset and count per cluster
+SAMPLER2D(s_light_indices, 9); // light indices referenced by the grid
+
+uniform vec4 u_camera_position;
+uniform vec4 u_cluster_params; // x, y, z cluster counts, w index texture width
+uniform vec4 u_cluster_depth;  // x near clip, y slices / log(far / near)
+
+void main()
+{
+    GBufferData data = DecodeGBuffer(v_texcoord0, s_tex0, s_tex1, s_tex2, s_tex3, s_tex4);
+    vec3 indirect_specular = texture2D(s_tex5, v_texcoord0).xyz;
+    vec3 clip = vec3(v_texcoord0 * 2.0 - 1.0, data.depth);
+    clip = clipTransform(clip);
+    vec3 world_position = clipToWorld(u_invViewProj, clip);
+    vec3 view_position = mul(u_view, vec4(world_position, 1.0)).xyz;
+
+    vec3 lobe_roughness = vec3(0.0f, data.roughness, 1.0f);
+    vec3 specular_color = data.specular_color * data.ambient_occlusion;
+    vec3 diffuse_color = data.diffuse_color * data.ambient_occlusion;
+    vec3 N = data.world_normal;
+    vec3 V = normalize(u_camera_position.xyz - world_position);
+
+    // Same cluster mapping as clustered_lighting_pass on the cpu.
+    vec2 tile = floor(saturate(clip.xy * 0.5 + 0.5) * u_cluster_params.xy);
+    tile = min(tile, u_cluster_params.xy - 1.0);
+    float slice = floor(log(max(view_position.z, u_cluster_depth.x) / u_cluster_depth.x) * u_cluster_depth.y);
+    slice = clamp(slice, 0.0, u_cluster_params.z - 1.0);
+
+    int grid_x = int(tile.y * u_cluster_params.x + tile.x);
+    vec2 cell = texelFetch(s_light_grid, ivec2(grid_x, int(slice)), 0).xy;
+    int offset = int(cell.x);
+    int count = int(cell.y);
+    int width = int(u_cluster_params.w);
+
+    vec3 lighting = data.emissive_color;
+
+    for(int i = 0; i < count; ++i)
+    {
+        int index_pos = offset + i;
+        int row = index_pos / width;
+        int light_index = int(texelFetch(s_light_indices, ivec2(index_pos - row * width, row), 0).x);
+
+        vec4 position_range = texelFetch(s_light_data, ivec2(0, light_index), 0);
+        vec4 color_intensity = texelFetch(s_light_data, ivec2(1, light_index), 0);
+        vec4 direction_type = texelFetch(s_light_data, ivec2(2, light_index), 0);
+        vec4 params = texelFetch(s_light_data, ivec2(3, light_index), 0);
+
+        vec3 vector_to_light = position_range.xyz - world_position;
+        float distance_sqr = dot(vector_to_light, vector_to_light);
+        vec3 L = vector_to_light / sqrt(distance_sqr);
+        float NoL = saturate(dot(N, L));
+
+        vec3 vector_to_light_over_radius = vector_to_light / position_range.w;
+        float light_radius_mask = 1.0f;
+        float light_falloff = 1.0f;
+        if(direction_type.w > 0.5f)
+        {
+            // Spot, params.x is the cosine of the inner angle and params.y of the outer one.
+            light_radius_mask = RadialAttenuation(vector_to_light_over_radius, 1.0f);
+            light_falloff = SpotAttenuation(vector_to_light_over_radius, normalize(direction_type.xyz), vec2(params.y, 1.0f / (params.x - params.y)));
+        }
+        else
+        {
+            // Point, params.x is the falloff exponent.
+            light_radius_mask = RadialAttenuation(vector_to_light_over_radius, params.x);
+        }
+
+        vec3 light_color = color_intensity.xyz;
+        float intensity = color_intensity.w;
+        float surface_attenuation = intensity * light_radius_mask * light_falloff;
+        float subsurface_attenuation = light_radius_mask * light_falloff;
+
+        vec3 energy = AreaLightSpecular(0.0f, 0.0f, normalize(vector_to_light), lobe_roughness, vector_to_light, L, V, N);
+        SurfaceShading surface_lighting = StandardShading(diffuse_color, vec3(0.0f, 0.0f, 0.0f), specular_color, indirect_specular, s_tex6, lobe_roughness, energy, data.metalness, data.ambient_occlusion, L, V, N);
+        vec3 subsurface_lighting = SubsurfaceShading(data.subsurface_color, data.subsurface_opacity, data.ambient_occlusion, L, V, N);
+
+        vec3 surface_multiplier = light_color * (NoL * surface_attenuation);
+        vec3 subsurface_multiplier = light_color * subsurface_attenuation;
+
+        lighting += surface_multiplier * surface_lighting.direct + (subsurface_lighting + surface_lighting.indirect) * subsurface_multiplier;
+    }
+
+    gl_FragColor = vec4(lighting, 1.0f);
+}
@@ -14,4 +14,8 @@ vec3 a_position  : POSITION;
 vec4 a_normal    : NORMAL;
 vec2 a_texcoord0 : TEXCOORD0;
 vec4 a_weight    : BLENDWEIGHT;
-vec4 a_indices   : BLENDINDICES;
\ No newline at end of file
+vec4 a_indices   : BLENDINDICES;
+vec4 i_data0     : TEXCOORD7;
+vec4 i_data1     : TEXCOORD6;
+vec4 i_data2     : TEXCOORD5;
+vec4 i_data3     : TEXCOORD4;
\ No newline at end of file
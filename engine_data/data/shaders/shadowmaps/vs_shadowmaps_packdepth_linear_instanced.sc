@@ -0,0 +1,18 @@
+$input a_position, i_data0, i_data1, i_data2, i_data3
+$output v_depth
+
+/*
+ * Copyright 2013-2014 Dario Manesku. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx/blob/master/LICENSE
+ */
+
+#include "../common.sh"
+
+void main()
+{
+    mat4 model = mtxFromCols(i_data0, i_data1, i_data2, i_data3);
+
+    vec4 wpos = mul(model, vec4(a_position, 1.0) );
+    gl_Position = mul(u_viewProj, wpos );
+	v_depth = gl_Position.z * 0.5 + 0.5;
+}
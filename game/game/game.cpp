@@ -1,14 +1,19 @@
 #include "game.h"
 
+#include <engine/animation/ecs/systems/animation_system.h>
 #include <engine/engine.h>
 #include <engine/events.h>
+#include <engine/rendering/ecs/systems/rendering_system.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/shadow_atlas.h>
+#include <engine/rendering/texture_streamer.h>
 #include <engine/meta/settings/settings.hpp>
 #include <engine/assets/asset_manager.h>
 #include <engine/meta/assets/asset_database.hpp>
 #include <engine/scripting/ecs/systems/script_system.h>
 #include "runner/runner.h"
 
+#include <filesystem/archive.h>
 #include <filesystem/filesystem.h>
 #include <logging/logging.h>
 #include <rttr/registration>
@@ -102,6 +107,33 @@ auto game::init_settings(rtti::context& ctx) -> bool
         return false;
     }
 
+    auto& streamer = get_texture_streamer();
+    auto streaming = streamer.get_settings();
+    streaming.budget = uint64_t(s.graphics.texture_streaming_budget) << 20;
+    streaming.initial_size = s.graphics.texture_streaming_initial_size;
+    streamer.set_settings(streaming);
+
+    auto& rpath = ctx.get_cached<rendering_system>();
+    rpath.set_culling_method(s.graphics.batched_culling ? rendering::pipeline::culling_method::batched
+                                                        : rendering::pipeline::culling_method::hierarchical);
+
+    auto& atlas = ctx.get_cached<shadow_atlas>();
+    auto shadows = atlas.get_settings();
+    shadows.budget_bytes = uint64_t(s.graphics.shadow_atlas_budget) << 20;
+    shadows.min_size = uint16_t(std::min<uint32_t>(s.graphics.shadow_map_min_size, 1u << 15));
+    shadows.max_size = uint16_t(std::min<uint32_t>(s.graphics.shadow_map_max_size, 1u << 15));
+    atlas.set_settings(shadows);
+
+    auto& anim = ctx.get_cached<animation_system>();
+    auto lod = anim.get_lod_settings();
+    lod.enabled = s.animation.lod_enabled;
+    lod.reduced_size = s.animation.lod_reduced_size;
+    lod.minimal_size = s.animation.lod_minimal_size;
+    lod.frozen_size = s.animation.lod_frozen_size;
+    lod.reduced_interval = s.animation.lod_reduced_interval;
+    lod.minimal_interval = s.animation.lod_minimal_interval;
+    anim.set_lod_settings(lod);
+
     return true;
 }
 
@@ -109,6 +141,19 @@ auto game::init_assets(rtti::context& ctx) -> bool
 {
     auto& am = ctx.get_cached<asset_manager>();
 
+    // Deployed builds ship compiled data as archives, loose files are still used when missing.
+    for(const auto& protocol : {"engine", "app"})
+    {
+        auto mount_point = std::string(protocol) + ":/compiled";
+        auto archive = fs::resolve_protocol(std::string(protocol) + ":/compiled.pak");
+
+        fs::error_code ec;
+        if(fs::exists(archive, ec) && !fs::mount_archive(mount_point, archive))
+        {
+            APPLOG_ERROR("Failed to mount {}", archive.string());
+        }
+    }
+
     if(!am.load_database("engine:/"))
     {
         APPLOG_CRITICAL("Failed to load engine asset pack.");